@@ -37,15 +37,45 @@
 /* locals */
 
 static inline uint16_t do_csum (const void*, uint16_t, uint32_t) PGM_GNUC_PURE;
+/* only the selected word width is built, SIMD kernels fall back to 64-bit words.
+ */
+#if defined( USE_8BIT_CHECKSUM )
 static uint16_t do_csum_8bit (const void*, uint16_t, uint32_t) PGM_GNUC_PURE;
+#endif
+#if defined( USE_16BIT_CHECKSUM )
 static uint16_t do_csum_16bit (const void*, uint16_t, uint32_t) PGM_GNUC_PURE;
+#endif
+#if defined( USE_32BIT_CHECKSUM )
 static uint16_t do_csum_32bit (const void*, uint16_t, uint32_t) PGM_GNUC_PURE;
+#endif
+#if defined( USE_64BIT_CHECKSUM ) || defined( USE_SIMD_CHECKSUM )
 static uint16_t do_csum_64bit (const void*, uint16_t, uint32_t) PGM_GNUC_PURE;
-#if defined(__amd64) || defined(__x86_64__) || defined(_WIN64)
+#endif
+#if ( defined(__amd64) || defined(__x86_64__) || defined(_WIN64) ) && defined( USE_VECTOR_CHECKSUM )
 static uint16_t do_csum_vector (const void*, uint16_t, uint32_t) PGM_GNUC_PURE;
 #endif
 
+/* wide SIMD kernels selected at runtime by processor feature, GCC 4.9 or
+ * later is required for intrinsics within target specific functions.
+ */
+#if defined( USE_SIMD_CHECKSUM ) && \
+    ( defined( __x86_64__ ) || defined( __amd64 ) || defined( __i386__ ) || defined( __i386 ) ) && \
+    ( defined( __clang__ ) || ( defined( __GNUC__ ) && ( __GNUC__ > 4 || ( __GNUC__ == 4 && __GNUC_MINOR__ >= 9 ) ) ) )
+#	define USE_CHECKSUM_VEC_X86
+#	include <immintrin.h>
+static uint16_t do_csum_sse2 (const void*, uint16_t, uint32_t) PGM_GNUC_PURE;
+static uint16_t do_csum_avx2 (const void*, uint16_t, uint32_t) PGM_GNUC_PURE;
+#endif
+
+#if defined( USE_SIMD_CHECKSUM )
+static uint16_t do_csum_select (const void*, uint16_t, uint32_t);
+static uint16_t do_csumcpy_select (const void*restrict, void*restrict, uint16_t, uint32_t);
+static uint16_t (*do_csum_simd) (const void*, uint16_t, uint32_t) = do_csum_select;
+static uint16_t (*do_csumcpy_simd) (const void*restrict, void*restrict, uint16_t, uint32_t) = do_csumcpy_select;
+#endif
+
 
+#if defined( USE_8BIT_CHECKSUM )
 /* Endian independent checksum routine.
  *
  * Avoid direct usage of reg8 & reg16 operators as latency cannot be eliminated
@@ -122,7 +152,9 @@ do_csumcpy_8bit (
 	acc += (acc >> 16);
 	return htons ((uint16_t)acc);
 }
+#endif /* USE_8BIT_CHECKSUM */
 
+#if defined( USE_16BIT_CHECKSUM )
 /* When handling 16-bit words do not assume the pointer provided is aligned on
  * a word.  Aligned reads will also perform faster on platforms that support
  * unaligned word accesses.
@@ -238,7 +270,9 @@ do_csumcpy_16bit (
 		acc = ((acc & 0xff) << 8) | ((acc & 0xff00) >> 8);
 	return (uint16_t)acc;
 }
+#endif /* USE_16BIT_CHECKSUM */
 
+#if defined( USE_32BIT_CHECKSUM )
 static
 uint16_t
 do_csum_32bit (
@@ -368,7 +402,9 @@ do_csumcpy_32bit (
 		acc = ((acc & 0xff) << 8) | ((acc & 0xff00) >> 8);
 	return (uint16_t)acc;
 }
+#endif /* USE_32BIT_CHECKSUM */
 
+#if defined( USE_64BIT_CHECKSUM ) || defined( USE_SIMD_CHECKSUM )
 /* best if architecture has native 64-bit words
  */
 
@@ -570,8 +606,9 @@ do_csumcpy_64bit (
 		acc = ((acc & 0xff) << 8) | ((acc & 0xff00) >> 8);
 	return (uint16_t)acc;
 }
+#endif /* USE_64BIT_CHECKSUM || USE_SIMD_CHECKSUM */
 
-#if defined(__amd64) || defined(__x86_64__)
+#if ( defined(__amd64) || defined(__x86_64__) ) && defined( USE_VECTOR_CHECKSUM )
 /* SIMD instructions unique to AMD/Intel 64-bit, so always little endian.
  *
  * TODO: TLB priming and prefetch with cache line size (128 bytes).
@@ -793,6 +830,336 @@ do_csumcpy_vector (
 
 #endif
 
+#ifdef USE_CHECKSUM_VEC_X86
+/* Each vector of 16-bit words is split into even and odd halves zero extended
+ * into 32-bit lanes, one 128-byte block adds at most 8 × 0xffff to a lane so
+ * a full 64KB TPDU cannot overflow the accumulators.  Unaligned loads remove
+ * the need for alignment prologues, trailing bytes fall back to the 64-bit
+ * word routine.
+ *
+ * The result matches do_csum_64bit() including the byte swapped partial
+ * checksum on odd source addresses.
+ */
+
+static inline
+uint16_t
+do_csum_combine (
+	uint64_t	acc,		/* vector lanes summed */
+	uint16_t	tail,		/* trailing bytes */
+	uint32_t	csum,
+	bool		is_odd
+	)
+{
+	uint64_t partial = csum;
+
+	if (PGM_UNLIKELY(is_odd)) {
+		partial  = (partial >> 16) + (partial & 0xffff);
+		partial  = (partial >> 16) + (partial & 0xffff);
+		partial  = ((partial & 0xff) << 8) | ((partial & 0xff00) >> 8);
+	}
+	acc += tail;
+	acc += partial;
+/* fold accumulator down to 16-bits */
+	acc  = (acc >> 32) + (acc & 0xffffffff);
+	acc  = (acc >> 16) + (acc & 0xffff);
+	acc  = (acc >> 16) + (acc & 0xffff);
+	acc += (acc >> 16);
+	return (uint16_t)acc;
+}
+
+static
+__attribute__((__target__("sse2")))
+uint64_t
+do_csum_sse2_lanes (
+	__m128i		acc
+	)
+{
+	uint32_t lanes[4];
+
+	_mm_storeu_si128 ((__m128i*)lanes, acc);
+	return (uint64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+static
+__attribute__((__target__("sse2")))
+uint16_t
+do_csum_sse2 (
+	const void*	addr,
+	uint16_t	len,
+	uint32_t	csum
+	)
+{
+	const uint8_t* buf = (const uint8_t*)addr;
+	const __m128i mask = _mm_set1_epi32 (0xffff);
+	__m128i even = _mm_setzero_si128(), odd = _mm_setzero_si128();
+	bool is_odd;
+
+/* empty buffer */
+	if (PGM_UNLIKELY(len == 0))
+		return (uint16_t)csum;
+	is_odd = ((uintptr_t)buf & 1);
+/* 128-byte blocks */
+	while (len >= 128) {
+		const __m128i x0 = _mm_loadu_si128 ((const __m128i*)buf + 0);
+		const __m128i x1 = _mm_loadu_si128 ((const __m128i*)buf + 1);
+		const __m128i x2 = _mm_loadu_si128 ((const __m128i*)buf + 2);
+		const __m128i x3 = _mm_loadu_si128 ((const __m128i*)buf + 3);
+		const __m128i x4 = _mm_loadu_si128 ((const __m128i*)buf + 4);
+		const __m128i x5 = _mm_loadu_si128 ((const __m128i*)buf + 5);
+		const __m128i x6 = _mm_loadu_si128 ((const __m128i*)buf + 6);
+		const __m128i x7 = _mm_loadu_si128 ((const __m128i*)buf + 7);
+		even = _mm_add_epi32 (even, _mm_and_si128 (x0, mask));
+		odd  = _mm_add_epi32 (odd,  _mm_srli_epi32 (x0, 16));
+		even = _mm_add_epi32 (even, _mm_and_si128 (x1, mask));
+		odd  = _mm_add_epi32 (odd,  _mm_srli_epi32 (x1, 16));
+		even = _mm_add_epi32 (even, _mm_and_si128 (x2, mask));
+		odd  = _mm_add_epi32 (odd,  _mm_srli_epi32 (x2, 16));
+		even = _mm_add_epi32 (even, _mm_and_si128 (x3, mask));
+		odd  = _mm_add_epi32 (odd,  _mm_srli_epi32 (x3, 16));
+		even = _mm_add_epi32 (even, _mm_and_si128 (x4, mask));
+		odd  = _mm_add_epi32 (odd,  _mm_srli_epi32 (x4, 16));
+		even = _mm_add_epi32 (even, _mm_and_si128 (x5, mask));
+		odd  = _mm_add_epi32 (odd,  _mm_srli_epi32 (x5, 16));
+		even = _mm_add_epi32 (even, _mm_and_si128 (x6, mask));
+		odd  = _mm_add_epi32 (odd,  _mm_srli_epi32 (x6, 16));
+		even = _mm_add_epi32 (even, _mm_and_si128 (x7, mask));
+		odd  = _mm_add_epi32 (odd,  _mm_srli_epi32 (x7, 16));
+		len -= 128; buf += 128;
+	}
+/* 16-byte vectors */
+	while (len >= 16) {
+		const __m128i x = _mm_loadu_si128 ((const __m128i*)buf);
+		even = _mm_add_epi32 (even, _mm_and_si128 (x, mask));
+		odd  = _mm_add_epi32 (odd,  _mm_srli_epi32 (x, 16));
+		len -= 16; buf += 16;
+	}
+	return do_csum_combine (do_csum_sse2_lanes (_mm_add_epi32 (even, odd)),
+				do_csum_64bit (buf, len, 0),
+				csum,
+				is_odd);
+}
+
+static
+__attribute__((__target__("sse2")))
+uint16_t
+do_csumcpy_sse2 (
+	const void* restrict srcaddr,
+	void*	    restrict dstaddr,
+	uint16_t	     len,
+	uint32_t	     csum
+	)
+{
+	const uint8_t* restrict src = (const uint8_t*restrict)srcaddr;
+	uint8_t* restrict dst = (uint8_t*restrict)dstaddr;
+	const __m128i mask = _mm_set1_epi32 (0xffff);
+	__m128i even = _mm_setzero_si128(), odd = _mm_setzero_si128();
+	bool is_odd;
+
+/* empty buffer */
+	if (PGM_UNLIKELY(len == 0))
+		return (uint16_t)csum;
+	is_odd = ((uintptr_t)src & 1);
+/* 64-byte blocks */
+	while (len >= 64) {
+		const __m128i x0 = _mm_loadu_si128 ((const __m128i*)src + 0);
+		const __m128i x1 = _mm_loadu_si128 ((const __m128i*)src + 1);
+		const __m128i x2 = _mm_loadu_si128 ((const __m128i*)src + 2);
+		const __m128i x3 = _mm_loadu_si128 ((const __m128i*)src + 3);
+		_mm_storeu_si128 ((__m128i*)dst + 0, x0);
+		_mm_storeu_si128 ((__m128i*)dst + 1, x1);
+		_mm_storeu_si128 ((__m128i*)dst + 2, x2);
+		_mm_storeu_si128 ((__m128i*)dst + 3, x3);
+		even = _mm_add_epi32 (even, _mm_and_si128 (x0, mask));
+		odd  = _mm_add_epi32 (odd,  _mm_srli_epi32 (x0, 16));
+		even = _mm_add_epi32 (even, _mm_and_si128 (x1, mask));
+		odd  = _mm_add_epi32 (odd,  _mm_srli_epi32 (x1, 16));
+		even = _mm_add_epi32 (even, _mm_and_si128 (x2, mask));
+		odd  = _mm_add_epi32 (odd,  _mm_srli_epi32 (x2, 16));
+		even = _mm_add_epi32 (even, _mm_and_si128 (x3, mask));
+		odd  = _mm_add_epi32 (odd,  _mm_srli_epi32 (x3, 16));
+		len -= 64; src += 64; dst += 64;
+	}
+/* 16-byte vectors */
+	while (len >= 16) {
+		const __m128i x = _mm_loadu_si128 ((const __m128i*)src);
+		_mm_storeu_si128 ((__m128i*)dst, x);
+		even = _mm_add_epi32 (even, _mm_and_si128 (x, mask));
+		odd  = _mm_add_epi32 (odd,  _mm_srli_epi32 (x, 16));
+		len -= 16; src += 16; dst += 16;
+	}
+	return do_csum_combine (do_csum_sse2_lanes (_mm_add_epi32 (even, odd)),
+				do_csumcpy_64bit (src, dst, len, 0),
+				csum,
+				is_odd);
+}
+
+static
+__attribute__((__target__("avx2")))
+uint64_t
+do_csum_avx2_lanes (
+	__m256i		acc
+	)
+{
+	uint32_t lanes[8];
+
+	_mm256_storeu_si256 ((__m256i*)lanes, acc);
+	return (uint64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3] +
+			 lanes[4] + lanes[5] + lanes[6] + lanes[7];
+}
+
+static
+__attribute__((__target__("avx2")))
+uint16_t
+do_csum_avx2 (
+	const void*	addr,
+	uint16_t	len,
+	uint32_t	csum
+	)
+{
+	const uint8_t* buf = (const uint8_t*)addr;
+	const __m256i mask = _mm256_set1_epi32 (0xffff);
+	__m256i even = _mm256_setzero_si256(), odd = _mm256_setzero_si256();
+	bool is_odd;
+
+/* empty buffer */
+	if (PGM_UNLIKELY(len == 0))
+		return (uint16_t)csum;
+	is_odd = ((uintptr_t)buf & 1);
+/* 128-byte blocks */
+	while (len >= 128) {
+		const __m256i x0 = _mm256_loadu_si256 ((const __m256i*)buf + 0);
+		const __m256i x1 = _mm256_loadu_si256 ((const __m256i*)buf + 1);
+		const __m256i x2 = _mm256_loadu_si256 ((const __m256i*)buf + 2);
+		const __m256i x3 = _mm256_loadu_si256 ((const __m256i*)buf + 3);
+		even = _mm256_add_epi32 (even, _mm256_and_si256 (x0, mask));
+		odd  = _mm256_add_epi32 (odd,  _mm256_srli_epi32 (x0, 16));
+		even = _mm256_add_epi32 (even, _mm256_and_si256 (x1, mask));
+		odd  = _mm256_add_epi32 (odd,  _mm256_srli_epi32 (x1, 16));
+		even = _mm256_add_epi32 (even, _mm256_and_si256 (x2, mask));
+		odd  = _mm256_add_epi32 (odd,  _mm256_srli_epi32 (x2, 16));
+		even = _mm256_add_epi32 (even, _mm256_and_si256 (x3, mask));
+		odd  = _mm256_add_epi32 (odd,  _mm256_srli_epi32 (x3, 16));
+		len -= 128; buf += 128;
+	}
+/* 32-byte vectors */
+	while (len >= 32) {
+		const __m256i x = _mm256_loadu_si256 ((const __m256i*)buf);
+		even = _mm256_add_epi32 (even, _mm256_and_si256 (x, mask));
+		odd  = _mm256_add_epi32 (odd,  _mm256_srli_epi32 (x, 16));
+		len -= 32; buf += 32;
+	}
+	return do_csum_combine (do_csum_avx2_lanes (_mm256_add_epi32 (even, odd)),
+				do_csum_64bit (buf, len, 0),
+				csum,
+				is_odd);
+}
+
+static
+__attribute__((__target__("avx2")))
+uint16_t
+do_csumcpy_avx2 (
+	const void* restrict srcaddr,
+	void*	    restrict dstaddr,
+	uint16_t	     len,
+	uint32_t	     csum
+	)
+{
+	const uint8_t* restrict src = (const uint8_t*restrict)srcaddr;
+	uint8_t* restrict dst = (uint8_t*restrict)dstaddr;
+	const __m256i mask = _mm256_set1_epi32 (0xffff);
+	__m256i even = _mm256_setzero_si256(), odd = _mm256_setzero_si256();
+	bool is_odd;
+
+/* empty buffer */
+	if (PGM_UNLIKELY(len == 0))
+		return (uint16_t)csum;
+	is_odd = ((uintptr_t)src & 1);
+/* 128-byte blocks */
+	while (len >= 128) {
+		const __m256i x0 = _mm256_loadu_si256 ((const __m256i*)src + 0);
+		const __m256i x1 = _mm256_loadu_si256 ((const __m256i*)src + 1);
+		const __m256i x2 = _mm256_loadu_si256 ((const __m256i*)src + 2);
+		const __m256i x3 = _mm256_loadu_si256 ((const __m256i*)src + 3);
+		_mm256_storeu_si256 ((__m256i*)dst + 0, x0);
+		_mm256_storeu_si256 ((__m256i*)dst + 1, x1);
+		_mm256_storeu_si256 ((__m256i*)dst + 2, x2);
+		_mm256_storeu_si256 ((__m256i*)dst + 3, x3);
+		even = _mm256_add_epi32 (even, _mm256_and_si256 (x0, mask));
+		odd  = _mm256_add_epi32 (odd,  _mm256_srli_epi32 (x0, 16));
+		even = _mm256_add_epi32 (even, _mm256_and_si256 (x1, mask));
+		odd  = _mm256_add_epi32 (odd,  _mm256_srli_epi32 (x1, 16));
+		even = _mm256_add_epi32 (even, _mm256_and_si256 (x2, mask));
+		odd  = _mm256_add_epi32 (odd,  _mm256_srli_epi32 (x2, 16));
+		even = _mm256_add_epi32 (even, _mm256_and_si256 (x3, mask));
+		odd  = _mm256_add_epi32 (odd,  _mm256_srli_epi32 (x3, 16));
+		len -= 128; src += 128; dst += 128;
+	}
+/* 32-byte vectors */
+	while (len >= 32) {
+		const __m256i x = _mm256_loadu_si256 ((const __m256i*)src);
+		_mm256_storeu_si256 ((__m256i*)dst, x);
+		even = _mm256_add_epi32 (even, _mm256_and_si256 (x, mask));
+		odd  = _mm256_add_epi32 (odd,  _mm256_srli_epi32 (x, 16));
+		len -= 32; src += 32; dst += 32;
+	}
+	return do_csum_combine (do_csum_avx2_lanes (_mm256_add_epi32 (even, odd)),
+				do_csumcpy_64bit (src, dst, len, 0),
+				csum,
+				is_odd);
+}
+#endif /* USE_CHECKSUM_VEC_X86 */
+
+#if defined( USE_SIMD_CHECKSUM )
+/* pick the widest kernels supported by the processor on first use.
+ */
+
+static
+void
+do_csum_resolve (void)
+{
+#ifdef USE_CHECKSUM_VEC_X86
+	__builtin_cpu_init ();
+	if (__builtin_cpu_supports ("avx2")) {
+		do_csumcpy_simd = do_csumcpy_avx2;
+		do_csum_simd	= do_csum_avx2;
+		return;
+	}
+	if (__builtin_cpu_supports ("sse2")) {
+		do_csumcpy_simd = do_csumcpy_sse2;
+		do_csum_simd	= do_csum_sse2;
+		return;
+	}
+#endif
+	do_csumcpy_simd = do_csumcpy_64bit;
+	do_csum_simd	= do_csum_64bit;
+}
+
+static
+uint16_t
+do_csum_select (
+	const void*	addr,
+	uint16_t	len,
+	uint32_t	csum
+	)
+{
+	do_csum_resolve ();
+	return do_csum_simd (addr, len, csum);
+}
+
+static
+uint16_t
+do_csumcpy_select (
+	const void* restrict src,
+	void*	    restrict dst,
+	uint16_t	     len,
+	uint32_t	     csum
+	)
+{
+	do_csum_resolve ();
+	return do_csumcpy_simd (src, dst, len, csum);
+}
+#endif /* USE_SIMD_CHECKSUM */
+
 static inline
 uint16_t
 do_csum (
@@ -811,6 +1178,8 @@ do_csum (
 	return do_csum_64bit (addr, len, csum);
 #elif defined( USE_VECTOR_CHECKSUM )
 	return do_csum_vector (addr, len, csum);
+#elif defined( USE_SIMD_CHECKSUM )
+	return do_csum_simd (addr, len, csum);
 #else
 #	error "checksum routine undefined"
 #endif
@@ -885,6 +1254,8 @@ pgm_compat_csum_partial_copy (
 	return do_csumcpy_64bit (src, dst, len, csum);
 #	elif defined( USE_VECTOR_CHECKSUM )
 	return do_csumcpy_vector (src, dst, len, csum);
+#	elif defined( USE_SIMD_CHECKSUM )
+	return do_csumcpy_simd (src, dst, len, csum);
 #	else
 	memcpy (dst, src, len);
 	return pgm_csum_partial (dst, len, csum);
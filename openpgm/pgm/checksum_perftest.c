@@ -34,6 +34,14 @@ static unsigned perf_testsize	= 0;
 static unsigned perf_answer	= 0;
 
 
+static
+void
+mock_setup_64b (void)
+{
+	perf_testsize	= 64;
+	perf_answer	= 0x300c;
+}
+
 static
 void
 mock_setup_100b (void)
@@ -572,6 +580,211 @@ START_TEST (test_vector_csumcpy)
 END_TEST
 #endif /* defined(__amd64) || defined(__x86_64__) || defined(_WIN64) */
 
+#ifdef USE_CHECKSUM_VEC_X86
+START_TEST (test_sse2)
+{
+	const unsigned iterations = 1000;
+	if (!__builtin_cpu_supports ("sse2")) {
+		g_message ("sse2/%u: not supported by processor", perf_testsize);
+		return;
+	}
+	char* source = alloca (perf_testsize);
+	for (unsigned i = 0, j = 0; i < perf_testsize; i++) {
+		j = j * 1103515245 + 12345;
+		source[i] = j;
+	}
+	const guint16 answer = perf_answer;		/* network order */
+
+	guint16 csum;
+	pgm_time_t start, check;
+
+	start = pgm_time_update_now();
+	for (unsigned i = iterations; i; i--) {
+		csum = ~do_csum_sse2 (source, perf_testsize, 0);
+/* function calculates answer in host order */
+		csum = g_htons (csum);
+		fail_unless (answer == csum, "checksum mismatch 0x%04x (0x%04x)", csum, answer);
+	}
+
+	check = pgm_time_update_now();
+	g_message ("sse2/%u: elapsed time %" PGM_TIME_FORMAT " us, unit time %" PGM_TIME_FORMAT " us",
+		perf_testsize,
+		(guint64)(check - start),
+		(guint64)((check - start) / iterations));
+}
+END_TEST
+
+START_TEST (test_sse2_memcpy)
+{
+	const unsigned iterations = 1000;
+	if (!__builtin_cpu_supports ("sse2")) {
+		g_message ("sse2/%u: not supported by processor", perf_testsize);
+		return;
+	}
+	char* source = alloca (perf_testsize);
+	char* target = alloca (perf_testsize);
+	for (unsigned i = 0, j = 0; i < perf_testsize; i++) {
+		j = j * 1103515245 + 12345;
+		source[i] = j;
+	}
+	const guint16 answer = perf_answer;		/* network order */
+
+	guint16 csum;
+	pgm_time_t start, check;
+
+	start = pgm_time_update_now();
+	for (unsigned i = iterations; i; i--) {
+		memcpy (target, source, perf_testsize);
+		csum = ~do_csum_sse2 (target, perf_testsize, 0);
+/* function calculates answer in host order */
+		csum = g_htons (csum);
+		fail_unless (answer == csum, "checksum mismatch 0x%04x (0x%04x)", csum, answer);
+	}
+
+	check = pgm_time_update_now();
+	g_message ("sse2/%u: elapsed time %" PGM_TIME_FORMAT " us, unit time %" PGM_TIME_FORMAT " us",
+		perf_testsize,
+		(guint64)(check - start),
+		(guint64)((check - start) / iterations));
+}
+END_TEST
+
+START_TEST (test_sse2_csumcpy)
+{
+	const unsigned iterations = 1000;
+	if (!__builtin_cpu_supports ("sse2")) {
+		g_message ("sse2/%u: not supported by processor", perf_testsize);
+		return;
+	}
+	char* source = alloca (perf_testsize);
+	char* target = alloca (perf_testsize);
+	for (unsigned i = 0, j = 0; i < perf_testsize; i++) {
+		j = j * 1103515245 + 12345;
+		source[i] = j;
+	}
+	const guint16 answer = perf_answer;		/* network order */
+
+	guint16 csum;
+	pgm_time_t start, check;
+
+	start = pgm_time_update_now();
+	for (unsigned i = iterations; i; i--) {
+		csum = ~do_csumcpy_sse2 (source, target, perf_testsize, 0);
+/* function calculates answer in host order */
+		csum = g_htons (csum);
+		fail_unless (answer == csum, "checksum mismatch 0x%04x (0x%04x)", csum, answer);
+	}
+
+	check = pgm_time_update_now();
+	g_message ("sse2/%u: elapsed time %" PGM_TIME_FORMAT " us, unit time %" PGM_TIME_FORMAT " us",
+		perf_testsize,
+		(guint64)(check - start),
+		(guint64)((check - start) / iterations));
+}
+END_TEST
+START_TEST (test_avx2)
+{
+	const unsigned iterations = 1000;
+	if (!__builtin_cpu_supports ("avx2")) {
+		g_message ("avx2/%u: not supported by processor", perf_testsize);
+		return;
+	}
+	char* source = alloca (perf_testsize);
+	for (unsigned i = 0, j = 0; i < perf_testsize; i++) {
+		j = j * 1103515245 + 12345;
+		source[i] = j;
+	}
+	const guint16 answer = perf_answer;		/* network order */
+
+	guint16 csum;
+	pgm_time_t start, check;
+
+	start = pgm_time_update_now();
+	for (unsigned i = iterations; i; i--) {
+		csum = ~do_csum_avx2 (source, perf_testsize, 0);
+/* function calculates answer in host order */
+		csum = g_htons (csum);
+		fail_unless (answer == csum, "checksum mismatch 0x%04x (0x%04x)", csum, answer);
+	}
+
+	check = pgm_time_update_now();
+	g_message ("avx2/%u: elapsed time %" PGM_TIME_FORMAT " us, unit time %" PGM_TIME_FORMAT " us",
+		perf_testsize,
+		(guint64)(check - start),
+		(guint64)((check - start) / iterations));
+}
+END_TEST
+
+START_TEST (test_avx2_memcpy)
+{
+	const unsigned iterations = 1000;
+	if (!__builtin_cpu_supports ("avx2")) {
+		g_message ("avx2/%u: not supported by processor", perf_testsize);
+		return;
+	}
+	char* source = alloca (perf_testsize);
+	char* target = alloca (perf_testsize);
+	for (unsigned i = 0, j = 0; i < perf_testsize; i++) {
+		j = j * 1103515245 + 12345;
+		source[i] = j;
+	}
+	const guint16 answer = perf_answer;		/* network order */
+
+	guint16 csum;
+	pgm_time_t start, check;
+
+	start = pgm_time_update_now();
+	for (unsigned i = iterations; i; i--) {
+		memcpy (target, source, perf_testsize);
+		csum = ~do_csum_avx2 (target, perf_testsize, 0);
+/* function calculates answer in host order */
+		csum = g_htons (csum);
+		fail_unless (answer == csum, "checksum mismatch 0x%04x (0x%04x)", csum, answer);
+	}
+
+	check = pgm_time_update_now();
+	g_message ("avx2/%u: elapsed time %" PGM_TIME_FORMAT " us, unit time %" PGM_TIME_FORMAT " us",
+		perf_testsize,
+		(guint64)(check - start),
+		(guint64)((check - start) / iterations));
+}
+END_TEST
+
+START_TEST (test_avx2_csumcpy)
+{
+	const unsigned iterations = 1000;
+	if (!__builtin_cpu_supports ("avx2")) {
+		g_message ("avx2/%u: not supported by processor", perf_testsize);
+		return;
+	}
+	char* source = alloca (perf_testsize);
+	char* target = alloca (perf_testsize);
+	for (unsigned i = 0, j = 0; i < perf_testsize; i++) {
+		j = j * 1103515245 + 12345;
+		source[i] = j;
+	}
+	const guint16 answer = perf_answer;		/* network order */
+
+	guint16 csum;
+	pgm_time_t start, check;
+
+	start = pgm_time_update_now();
+	for (unsigned i = iterations; i; i--) {
+		csum = ~do_csumcpy_avx2 (source, target, perf_testsize, 0);
+/* function calculates answer in host order */
+		csum = g_htons (csum);
+		fail_unless (answer == csum, "checksum mismatch 0x%04x (0x%04x)", csum, answer);
+	}
+
+	check = pgm_time_update_now();
+	g_message ("avx2/%u: elapsed time %" PGM_TIME_FORMAT " us, unit time %" PGM_TIME_FORMAT " us",
+		perf_testsize,
+		(guint64)(check - start),
+		(guint64)((check - start) / iterations));
+}
+END_TEST
+#endif /* USE_CHECKSUM_VEC_X86 */
+
 
 
 static
@@ -582,6 +795,22 @@ make_csum_performance_suite (void)
 
 	s = suite_create ("Raw checksum performance");
 
+	TCase* tc_64b = tcase_create ("64b");
+	suite_add_tcase (s, tc_64b);
+	tcase_add_checked_fixture (tc_64b, mock_setup, mock_teardown);
+	tcase_add_checked_fixture (tc_64b, mock_setup_64b, NULL);
+	tcase_add_test (tc_64b, test_8bit);
+	tcase_add_test (tc_64b, test_16bit);
+	tcase_add_test (tc_64b, test_32bit);
+	tcase_add_test (tc_64b, test_64bit);
+#if defined(__amd64) || defined(__x86_64__) || defined(_WIN64)
+	tcase_add_test (tc_64b, test_vector);
+#endif
+#ifdef USE_CHECKSUM_VEC_X86
+	tcase_add_test (tc_64b, test_sse2);
+	tcase_add_test (tc_64b, test_avx2);
+#endif
+
 	TCase* tc_100b = tcase_create ("100b");
 	suite_add_tcase (s, tc_100b);
 	tcase_add_checked_fixture (tc_100b, mock_setup, mock_teardown);
@@ -593,6 +822,10 @@ make_csum_performance_suite (void)
 #if defined(__amd64) || defined(__x86_64__) || defined(_WIN64)
 	tcase_add_test (tc_100b, test_vector);
 #endif
+#ifdef USE_CHECKSUM_VEC_X86
+	tcase_add_test (tc_100b, test_sse2);
+	tcase_add_test (tc_100b, test_avx2);
+#endif
 
 	TCase* tc_200b = tcase_create ("200b");
 	suite_add_tcase (s, tc_200b);
@@ -605,6 +838,10 @@ make_csum_performance_suite (void)
 #if defined(__amd64) || defined(__x86_64__) || defined(_WIN64)
 	tcase_add_test (tc_200b, test_vector);
 #endif
+#ifdef USE_CHECKSUM_VEC_X86
+	tcase_add_test (tc_200b, test_sse2);
+	tcase_add_test (tc_200b, test_avx2);
+#endif
 
 	TCase* tc_1500b = tcase_create ("1500b");
 	suite_add_tcase (s, tc_1500b);
@@ -617,6 +854,10 @@ make_csum_performance_suite (void)
 #if defined(__amd64) || defined(__x86_64__) || defined(_WIN64)
 	tcase_add_test (tc_1500b, test_vector);
 #endif
+#ifdef USE_CHECKSUM_VEC_X86
+	tcase_add_test (tc_1500b, test_sse2);
+	tcase_add_test (tc_1500b, test_avx2);
+#endif
 
 	TCase* tc_9kb = tcase_create ("9KB");
 	suite_add_tcase (s, tc_9kb);
@@ -629,6 +870,10 @@ make_csum_performance_suite (void)
 #if defined(__amd64) || defined(__x86_64__) || defined(_WIN64)
 	tcase_add_test (tc_9kb, test_vector);
 #endif
+#ifdef USE_CHECKSUM_VEC_X86
+	tcase_add_test (tc_9kb, test_sse2);
+	tcase_add_test (tc_9kb, test_avx2);
+#endif
 
 	TCase* tc_64kb = tcase_create ("64KB");
 	suite_add_tcase (s, tc_64kb);
@@ -641,6 +886,10 @@ make_csum_performance_suite (void)
 #if defined(__amd64) || defined(__x86_64__) || defined(_WIN64)
 	tcase_add_test (tc_64kb, test_vector);
 #endif
+#ifdef USE_CHECKSUM_VEC_X86
+	tcase_add_test (tc_64kb, test_sse2);
+	tcase_add_test (tc_64kb, test_avx2);
+#endif
 
 	return s;
 }
@@ -653,6 +902,22 @@ make_csum_memcpy_performance_suite (void)
 
 	s = suite_create ("Checksum and memcpy performance");
 
+	TCase* tc_64b = tcase_create ("64b");
+	suite_add_tcase (s, tc_64b);
+	tcase_add_checked_fixture (tc_64b, mock_setup, mock_teardown);
+	tcase_add_checked_fixture (tc_64b, mock_setup_64b, NULL);
+	tcase_add_test (tc_64b, test_8bit_memcpy);
+	tcase_add_test (tc_64b, test_16bit_memcpy);
+	tcase_add_test (tc_64b, test_32bit_memcpy);
+	tcase_add_test (tc_64b, test_64bit_memcpy);
+#if defined(__amd64) || defined(__x86_64__) || defined(_WIN64)
+	tcase_add_test (tc_64b, test_vector_memcpy);
+#endif
+#ifdef USE_CHECKSUM_VEC_X86
+	tcase_add_test (tc_64b, test_sse2_memcpy);
+	tcase_add_test (tc_64b, test_avx2_memcpy);
+#endif
+
 	TCase* tc_100b = tcase_create ("100b");
 	suite_add_tcase (s, tc_100b);
 	tcase_add_checked_fixture (tc_100b, mock_setup, mock_teardown);
@@ -664,6 +929,10 @@ make_csum_memcpy_performance_suite (void)
 #if defined(__amd64) || defined(__x86_64__) || defined(_WIN64)
 	tcase_add_test (tc_100b, test_vector_memcpy);
 #endif
+#ifdef USE_CHECKSUM_VEC_X86
+	tcase_add_test (tc_100b, test_sse2_memcpy);
+	tcase_add_test (tc_100b, test_avx2_memcpy);
+#endif
 
 	TCase* tc_200b = tcase_create ("200b");
 	suite_add_tcase (s, tc_200b);
@@ -676,6 +945,10 @@ make_csum_memcpy_performance_suite (void)
 #if defined(__amd64) || defined(__x86_64__) || defined(_WIN64)
 	tcase_add_test (tc_200b, test_vector_memcpy);
 #endif
+#ifdef USE_CHECKSUM_VEC_X86
+	tcase_add_test (tc_200b, test_sse2_memcpy);
+	tcase_add_test (tc_200b, test_avx2_memcpy);
+#endif
 
 	TCase* tc_1500b = tcase_create ("1500b");
 	suite_add_tcase (s, tc_1500b);
@@ -688,6 +961,10 @@ make_csum_memcpy_performance_suite (void)
 #if defined(__amd64) || defined(__x86_64__) || defined(_WIN64)
 	tcase_add_test (tc_1500b, test_vector_memcpy);
 #endif
+#ifdef USE_CHECKSUM_VEC_X86
+	tcase_add_test (tc_1500b, test_sse2_memcpy);
+	tcase_add_test (tc_1500b, test_avx2_memcpy);
+#endif
 
 	TCase* tc_9kb = tcase_create ("9KB");
 	suite_add_tcase (s, tc_9kb);
@@ -700,6 +977,10 @@ make_csum_memcpy_performance_suite (void)
 #if defined(__amd64) || defined(__x86_64__) || defined(_WIN64)
 	tcase_add_test (tc_9kb, test_vector_memcpy);
 #endif
+#ifdef USE_CHECKSUM_VEC_X86
+	tcase_add_test (tc_9kb, test_sse2_memcpy);
+	tcase_add_test (tc_9kb, test_avx2_memcpy);
+#endif
 
 	TCase* tc_64kb = tcase_create ("64KB");
 	suite_add_tcase (s, tc_64kb);
@@ -712,6 +993,10 @@ make_csum_memcpy_performance_suite (void)
 #if defined(__amd64) || defined(__x86_64__) || defined(_WIN64)
 	tcase_add_test (tc_64kb, test_vector_memcpy);
 #endif
+#ifdef USE_CHECKSUM_VEC_X86
+	tcase_add_test (tc_64kb, test_sse2_memcpy);
+	tcase_add_test (tc_64kb, test_avx2_memcpy);
+#endif
 
 	return s;
 }
@@ -724,6 +1009,22 @@ make_csumcpy_performance_suite (void)
 
 	s = suite_create ("Checksum copy performance");
 
+	TCase* tc_64b = tcase_create ("64b");
+	suite_add_tcase (s, tc_64b);
+	tcase_add_checked_fixture (tc_64b, mock_setup, mock_teardown);
+	tcase_add_checked_fixture (tc_64b, mock_setup_64b, NULL);
+	tcase_add_test (tc_64b, test_8bit_csumcpy);
+	tcase_add_test (tc_64b, test_16bit_csumcpy);
+	tcase_add_test (tc_64b, test_32bit_csumcpy);
+	tcase_add_test (tc_64b, test_64bit_csumcpy);
+#if defined(__amd64) || defined(__x86_64__) || defined(_WIN64)
+	tcase_add_test (tc_64b, test_vector_csumcpy);
+#endif
+#ifdef USE_CHECKSUM_VEC_X86
+	tcase_add_test (tc_64b, test_sse2_csumcpy);
+	tcase_add_test (tc_64b, test_avx2_csumcpy);
+#endif
+
 	TCase* tc_100b = tcase_create ("100b");
 	suite_add_tcase (s, tc_100b);
 	tcase_add_checked_fixture (tc_100b, mock_setup, mock_teardown);
@@ -735,6 +1036,10 @@ make_csumcpy_performance_suite (void)
 #if defined(__amd64) || defined(__x86_64__) || defined(_WIN64)
 	tcase_add_test (tc_100b, test_vector_csumcpy);
 #endif
+#ifdef USE_CHECKSUM_VEC_X86
+	tcase_add_test (tc_100b, test_sse2_csumcpy);
+	tcase_add_test (tc_100b, test_avx2_csumcpy);
+#endif
 
 	TCase* tc_200b = tcase_create ("200b");
 	suite_add_tcase (s, tc_200b);
@@ -747,6 +1052,10 @@ make_csumcpy_performance_suite (void)
 #if defined(__amd64) || defined(__x86_64__) || defined(_WIN64)
 	tcase_add_test (tc_200b, test_vector_csumcpy);
 #endif
+#ifdef USE_CHECKSUM_VEC_X86
+	tcase_add_test (tc_200b, test_sse2_csumcpy);
+	tcase_add_test (tc_200b, test_avx2_csumcpy);
+#endif
 
 	TCase* tc_1500b = tcase_create ("1500b");
 	suite_add_tcase (s, tc_1500b);
@@ -759,6 +1068,10 @@ make_csumcpy_performance_suite (void)
 #if defined(__amd64) || defined(__x86_64__) || defined(_WIN64)
 	tcase_add_test (tc_1500b, test_vector_csumcpy);
 #endif
+#ifdef USE_CHECKSUM_VEC_X86
+	tcase_add_test (tc_1500b, test_sse2_csumcpy);
+	tcase_add_test (tc_1500b, test_avx2_csumcpy);
+#endif
 
 	TCase* tc_9kb = tcase_create ("9KB");
 	suite_add_tcase (s, tc_9kb);
@@ -771,6 +1084,10 @@ make_csumcpy_performance_suite (void)
 #if defined(__amd64) || defined(__x86_64__) || defined(_WIN64)
 	tcase_add_test (tc_9kb, test_vector_csumcpy);
 #endif
+#ifdef USE_CHECKSUM_VEC_X86
+	tcase_add_test (tc_9kb, test_sse2_csumcpy);
+	tcase_add_test (tc_9kb, test_avx2_csumcpy);
+#endif
 
 	TCase* tc_64kb = tcase_create ("64KB");
 	suite_add_tcase (s, tc_64kb);
@@ -783,6 +1100,10 @@ make_csumcpy_performance_suite (void)
 #if defined(__amd64) || defined(__x86_64__) || defined(_WIN64)
 	tcase_add_test (tc_64kb, test_vector_csumcpy);
 #endif
+#ifdef USE_CHECKSUM_VEC_X86
+	tcase_add_test (tc_64kb, test_sse2_csumcpy);
+	tcase_add_test (tc_64kb, test_avx2_csumcpy);
+#endif
 
 	return s;
 }
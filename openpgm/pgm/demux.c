@@ -0,0 +1,426 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * process-wide shared raw receive sockets.
+ *
+ * Every raw PGM socket receives a copy of every PGM packet delivered to the
+ * host.  Sockets opting in with PGM_RECV_DEMUX instead share one raw socket
+ * per address family and bound interface, the packet is parsed once by
+ * whichever member reads it and handed to the queue of each member socket
+ * it is addressed to.
+ *
+ * Copyright (c) 2010-2011 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+#include <errno.h>
+#ifdef HAVE_EPOLL_CTL
+#	include <unistd.h>
+#	include <sys/epoll.h>
+#endif
+#include <impl/i18n.h>
+#include <impl/framework.h>
+#include <impl/socket.h>
+
+
+//#define DEMUX_DEBUG
+
+/* queue index arithmetic by mask */
+#if (PGM_DEMUX_QUEUE_LEN & (PGM_DEMUX_QUEUE_LEN - 1))
+#	error "PGM_DEMUX_QUEUE_LEN must be a power of two."
+#endif
+
+static pgm_slist_t*	demux_list = NULL;
+static pgm_mutex_t	demux_list_mutex;
+
+
+PGM_GNUC_INTERNAL
+void
+pgm_demux_init (void)
+{
+	pgm_mutex_init (&demux_list_mutex);
+}
+
+PGM_GNUC_INTERNAL
+void
+pgm_demux_shutdown (void)
+{
+	pgm_assert (NULL == demux_list);
+	pgm_mutex_free (&demux_list_mutex);
+}
+
+/* open the shared raw socket bound to addr, mirroring the options of a
+ * private PGM receive socket.
+ *
+ * returns new demultiplexer, returns NULL on error.
+ */
+
+static
+pgm_demux_t*
+demux_new (
+	const sa_family_t			family,
+	const int				protocol,
+	const struct sockaddr*	       restrict addr,
+	pgm_error_t**		       restrict error
+	)
+{
+	pgm_demux_t* demux;
+	SOCKET recv_sock;
+
+	recv_sock = socket (family, SOCK_RAW, protocol);
+	if (INVALID_SOCKET == recv_sock) {
+		const int save_errno = pgm_get_last_sock_error();
+		char errbuf[1024];
+		pgm_set_error (error,
+			       PGM_ERROR_DOMAIN_SOCKET,
+			       pgm_error_from_sock_errno (save_errno),
+			       _("Creating shared receive socket: %s"),
+			       pgm_sock_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		return NULL;
+	}
+
+	pgm_sockaddr_nonblocking (recv_sock, TRUE);
+
+/* include IP header only for incoming data, only works for IPv4 */
+	if ((AF_INET == family &&
+	     SOCKET_ERROR == pgm_sockaddr_hdrincl (recv_sock, family, TRUE)) ||
+	    (AF_INET6 == family &&
+	     SOCKET_ERROR == pgm_sockaddr_pktinfo (recv_sock, family, TRUE)))
+	{
+		const int save_errno = pgm_get_last_sock_error();
+		char errbuf[1024];
+		pgm_set_error (error,
+			       PGM_ERROR_DOMAIN_SOCKET,
+			       pgm_error_from_sock_errno (save_errno),
+			       _("Enabling packet headers on shared receive socket: %s"),
+			       pgm_sock_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		closesocket (recv_sock);
+		return NULL;
+	}
+
+	if (SOCKET_ERROR == bind (recv_sock, addr, pgm_sockaddr_len (addr)))
+	{
+		const int save_errno = pgm_get_last_sock_error();
+		char errbuf[1024];
+		char s[INET6_ADDRSTRLEN];
+		pgm_sockaddr_ntop (addr, s, sizeof(s));
+		pgm_set_error (error,
+			       PGM_ERROR_DOMAIN_SOCKET,
+			       pgm_error_from_sock_errno (save_errno),
+			       _("Binding shared receive socket to address %s: %s"),
+			       s,
+			       pgm_sock_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		closesocket (recv_sock);
+		return NULL;
+	}
+
+	demux = pgm_new0 (pgm_demux_t, 1);
+	demux->family	 = family;
+	demux->recv_sock = recv_sock;
+	memcpy (&demux->addr, addr, pgm_sockaddr_len (addr));
+	pgm_mutex_init (&demux->mutex);
+
+	if (PGM_UNLIKELY(pgm_log_mask & PGM_LOG_ROLE_NETWORK))
+	{
+		char s[INET6_ADDRSTRLEN];
+		pgm_sockaddr_ntop (addr, s, sizeof(s));
+		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Opened shared receive socket on %s"), s);
+	}
+	return demux;
+}
+
+static
+void
+demux_destroy (
+	pgm_demux_t*	demux
+	)
+{
+	pgm_assert (NULL == demux->members);
+
+	pgm_trace (PGM_LOG_ROLE_NETWORK,_("Closing shared receive socket."));
+	closesocket (demux->recv_sock);
+	if (demux->rx_buffer)
+		pgm_free_skb (demux->rx_buffer);
+	pgm_mutex_free (&demux->mutex);
+	pgm_free (demux);
+}
+
+#ifdef HAVE_EPOLL_CTL
+/* open a private epoll set holding only the shared socket of demux, one per
+ * member.
+ *
+ * returns descriptor, returns -1 on error.
+ */
+
+static
+int
+demux_epoll_new (
+	const pgm_demux_t*    restrict demux,
+	pgm_error_t**	      restrict error
+	)
+{
+	struct epoll_event event;
+	int epoll_fd;
+
+	epoll_fd = epoll_create (1);
+	if (-1 != epoll_fd) {
+		memset (&event, 0, sizeof(event));
+		event.events = EPOLLIN;
+		if (0 == epoll_ctl (epoll_fd, EPOLL_CTL_ADD, demux->recv_sock, &event))
+			return epoll_fd;
+	}
+	{
+		const int save_errno = errno;
+		char errbuf[1024];
+		pgm_set_error (error,
+			       PGM_ERROR_DOMAIN_SOCKET,
+			       pgm_error_from_errno (save_errno),
+			       _("Creating shared receive socket event set: %s"),
+			       pgm_strerror_s (errbuf, sizeof (errbuf), save_errno));
+	}
+	if (-1 != epoll_fd)
+		close (epoll_fd);
+	return -1;
+}
+#endif /* HAVE_EPOLL_CTL */
+
+/* join the shared receive socket for the family and bound interface of sock,
+ * opening it on first use.
+ *
+ * returns membership, returns NULL on error.
+ */
+
+PGM_GNUC_INTERNAL
+pgm_demux_member_t*
+pgm_demux_attach (
+	pgm_sock_t*   restrict sock,
+	pgm_error_t** restrict error
+	)
+{
+	pgm_demux_t* demux = NULL;
+	pgm_demux_member_t* member;
+	pgm_slist_t* list;
+
+	pgm_return_val_if_fail (NULL != sock, NULL);
+	pgm_return_val_if_fail (sock->use_demux, NULL);
+
+	pgm_mutex_lock (&demux_list_mutex);
+	for (list = demux_list; list; list = list->next)
+	{
+		pgm_demux_t* candidate = list->data;
+		if (candidate->family == sock->family &&
+		    0 == pgm_sockaddr_cmp ((const struct sockaddr*)&candidate->addr, (const struct sockaddr*)&sock->recv_addr))
+		{
+			demux = candidate;
+			break;
+		}
+	}
+	if (NULL == demux) {
+		demux = demux_new (sock->family, sock->protocol, (const struct sockaddr*)&sock->recv_addr, error);
+		if (NULL == demux) {
+			pgm_mutex_unlock (&demux_list_mutex);
+			return NULL;
+		}
+		demux_list = pgm_slist_prepend (demux_list, demux);
+	}
+
+	member = pgm_new0 (pgm_demux_member_t, 1);
+	member->demux = demux;
+	member->sock  = sock;
+#ifdef HAVE_EPOLL_CTL
+	member->epoll_fd = demux_epoll_new (demux, error);
+	if (-1 == member->epoll_fd) {
+		pgm_free (member);
+		if (0 == demux->ref_count) {
+			demux_list = pgm_slist_remove (demux_list, demux);
+			demux_destroy (demux);
+		}
+		pgm_mutex_unlock (&demux_list_mutex);
+		return NULL;
+	}
+#endif
+	member->queue = pgm_new (struct pgm_demux_slot_t, PGM_DEMUX_QUEUE_LEN);
+
+	pgm_mutex_lock (&demux->mutex);
+/* read buffer grows to the largest member TPDU */
+	if (sock->max_tpdu > demux->max_tpdu) {
+		demux->max_tpdu = sock->max_tpdu;
+		if (demux->rx_buffer) {
+			pgm_free_skb (demux->rx_buffer);
+			demux->rx_buffer = NULL;
+		}
+	}
+	if (sock->rcvbuf > demux->rcvbuf) {
+		const int rcvbuf = (int)sock->rcvbuf;
+		if (SOCKET_ERROR == setsockopt (demux->recv_sock, SOL_SOCKET, SO_RCVBUF, (const char*)&rcvbuf, sizeof(rcvbuf))) {
+			const int save_errno = pgm_get_last_sock_error();
+			char errbuf[1024];
+			pgm_warn (_("Raising shared receive socket buffer to %d bytes failed: %s"),
+				  rcvbuf,
+				  pgm_sock_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		} else
+			demux->rcvbuf = sock->rcvbuf;
+	}
+	demux->members = pgm_slist_append (demux->members, member);
+	demux->ref_count++;
+	pgm_mutex_unlock (&demux->mutex);
+	pgm_mutex_unlock (&demux_list_mutex);
+
+#ifdef DEMUX_DEBUG
+	pgm_debug ("demux %p attach sock %p, %u members", (void*)demux, (void*)sock, demux->ref_count);
+#endif
+	return member;
+}
+
+/* leave the shared receive socket discarding queued packets, the last
+ * member closes the socket.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_demux_detach (
+	pgm_demux_member_t*	member
+	)
+{
+	pgm_demux_t* demux;
+
+	pgm_return_if_fail (NULL != member);
+
+	demux = member->demux;
+	pgm_mutex_lock (&demux_list_mutex);
+	pgm_mutex_lock (&demux->mutex);
+	demux->members = pgm_slist_remove (demux->members, member);
+	while (member->queue_len) {
+		pgm_free_skb (member->queue[ member->queue_head ].skb);
+		member->queue_head = (member->queue_head + 1) & (PGM_DEMUX_QUEUE_LEN - 1);
+		member->queue_len--;
+	}
+	pgm_mutex_unlock (&demux->mutex);
+	if (0 == --demux->ref_count) {
+		demux_list = pgm_slist_remove (demux_list, demux);
+		demux_destroy (demux);
+	}
+	pgm_mutex_unlock (&demux_list_mutex);
+
+	if (member->cumulative_dropped)
+		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Shared receive queue dropped %" PRIu64 " packets."),
+			   member->cumulative_dropped);
+#ifdef HAVE_EPOLL_CTL
+/* removes the member from any application epoll set */
+	close (member->epoll_fd);
+#endif
+	pgm_free (member->queue);
+	pgm_free (member);
+}
+
+/* queue a parsed packet for member, the member is notified on first packet.
+ * caller must hold the demultiplexer mutex.
+ *
+ * returns TRUE on success, returns FALSE on full queue.
+ */
+
+PGM_GNUC_INTERNAL
+bool
+pgm_demux_push (
+	pgm_demux_member_t*    restrict member,
+	struct pgm_sk_buff_t*  restrict skb,
+	const struct sockaddr* restrict src_addr,
+	const struct sockaddr* restrict dst_addr
+	)
+{
+	struct pgm_demux_slot_t* slot;
+
+/* pre-conditions */
+	pgm_assert (NULL != member);
+	pgm_assert (NULL != skb);
+	pgm_assert (NULL != src_addr);
+	pgm_assert (NULL != dst_addr);
+
+	if (PGM_UNLIKELY(PGM_DEMUX_QUEUE_LEN == member->queue_len)) {
+		member->cumulative_dropped++;
+		return FALSE;
+	}
+	slot = &member->queue[ (member->queue_head + member->queue_len) & (PGM_DEMUX_QUEUE_LEN - 1) ];
+	slot->skb = skb;
+	memcpy (&slot->addr[0], src_addr, pgm_sockaddr_len (src_addr));
+	memcpy (&slot->addr[1], dst_addr, pgm_sockaddr_len (dst_addr));
+	member->queue_len++;
+	if (!member->is_notified) {
+		pgm_notify_send (&member->sock->pending_notify);
+		member->is_notified = TRUE;
+	}
+	return TRUE;
+}
+
+/* dequeue the oldest packet for member.  caller must hold the demultiplexer
+ * mutex.
+ *
+ * returns parsed packet, returns NULL on empty queue.
+ */
+
+PGM_GNUC_INTERNAL
+struct pgm_sk_buff_t*
+pgm_demux_pop (
+	pgm_demux_member_t* restrict member,
+	struct sockaddr*    restrict src_addr,
+	const socklen_t		     src_addrlen,
+	struct sockaddr*    restrict dst_addr,
+	const socklen_t		     dst_addrlen
+	)
+{
+	struct pgm_demux_slot_t* slot;
+
+/* pre-conditions */
+	pgm_assert (NULL != member);
+	pgm_assert (NULL != src_addr);
+	pgm_assert (NULL != dst_addr);
+
+	if (0 == member->queue_len) {
+		member->is_notified = FALSE;
+		return NULL;
+	}
+	slot = &member->queue[ member->queue_head ];
+	member->queue_head = (member->queue_head + 1) & (PGM_DEMUX_QUEUE_LEN - 1);
+	member->queue_len--;
+	memcpy (src_addr, &slot->addr[0], MIN(src_addrlen, sizeof(struct sockaddr_storage)));
+	memcpy (dst_addr, &slot->addr[1], MIN(dst_addrlen, sizeof(struct sockaddr_storage)));
+	return slot->skb;
+}
+
+/* re-send the member notification after the owner cleared it if packets were
+ * queued in the meantime.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_demux_rearm (
+	pgm_demux_member_t*	member
+	)
+{
+	pgm_assert (NULL != member);
+
+	pgm_mutex_lock (&member->demux->mutex);
+	if (member->queue_len) {
+		pgm_notify_send (&member->sock->pending_notify);
+		member->is_notified = TRUE;
+	} else
+		member->is_notified = FALSE;
+	pgm_mutex_unlock (&member->demux->mutex);
+}
+
+/* eof */
@@ -198,6 +198,7 @@ pgm_init (
 
 /* create global sock list lock */
 	pgm_rwlock_init (&pgm_sock_list_lock);
+	pgm_demux_init();
 
 	pgm_is_supported = TRUE;
 	return TRUE;
@@ -240,6 +241,7 @@ pgm_shutdown (void)
 		pgm_close ((pgm_sock_t*)pgm_sock_list->data, FALSE);
 	}
 
+	pgm_demux_shutdown();
 	pgm_rwlock_free (&pgm_sock_list_lock);
 
 	pgm_time_shutdown();
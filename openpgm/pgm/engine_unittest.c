@@ -45,6 +45,8 @@ static struct pgm_slist_t* mock_pgm_sock_list = NULL;
 #define pgm_time_init		mock_pgm_time_init
 #define pgm_time_shutdown	mock_pgm_time_shutdown
 #define pgm_close		mock_pgm_close
+#define pgm_demux_init		mock_pgm_demux_init
+#define pgm_demux_shutdown	mock_pgm_demux_shutdown
 #define pgm_sock_list_lock	mock_pgm_sock_list_lock
 #define pgm_sock_list		mock_pgm_sock_list
 
@@ -114,6 +116,16 @@ mock_pgm_close (
 	return TRUE;
 }
 
+void
+mock_pgm_demux_init (void)
+{
+}
+
+void
+mock_pgm_demux_shutdown (void)
+{
+}
+
 
 /* target:
  *	bool
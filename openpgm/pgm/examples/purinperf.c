@@ -0,0 +1,377 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * プリン PGM small message throughput.  One thread drives a sender and a
+ * receiver socket over multicast loopback and reports the send and receive
+ * call rates, optionally with PGM_SINGLE_THREAD to elide the socket locks.
+ *
+ * Copyright (c) 2006-2011 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <locale.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#	include <unistd.h>
+#	include <sys/time.h>
+#else
+#	include "getopt.h"
+#endif
+#ifdef __APPLE__
+#	include <pgm/in.h>
+#endif
+#include <pgm/pgm.h>
+
+
+/* globals */
+
+static int		port = 0;
+static const char*	network = ";239.192.0.1";
+static int		udp_encap_port = 7500;
+
+static int		max_tpdu = 1500;
+static int		sqns = 1000;
+static int		message_len = 64;
+static int		message_count = 200 * 1000;
+static int		burst = 100;			/* messages sent before draining the receiver */
+static bool		use_single_thread = FALSE;
+
+static pgm_sock_t*	tx_sock = NULL;
+static pgm_sock_t*	rx_sock = NULL;
+
+#ifndef _MSC_VER
+static void usage (const char*) __attribute__((__noreturn__));
+#else
+static void usage (const char*);
+#endif
+static bool create_sock (pgm_sock_t**, const bool);
+static pgm_time_t now_usecs (void);
+
+
+static void
+usage (
+	const char*	bin
+	)
+{
+	fprintf (stderr, "Usage: %s [options]\n", bin);
+	fprintf (stderr, "  -n <network>    : Multicast group or unicast IP address\n");
+	fprintf (stderr, "  -s <port>       : IP port\n");
+	fprintf (stderr, "  -p <port>       : Encapsulate PGM in UDP on IP port, 0 for PGM/IP\n");
+	fprintf (stderr, "  -c <count>      : Number of messages\n");
+	fprintf (stderr, "  -b <bytes>      : Message size\n");
+	fprintf (stderr, "  -B <burst>      : Messages sent between receives\n");
+	fprintf (stderr, "  -t              : Single-threaded sockets, elide internal locks\n");
+	fprintf (stderr, "  -i              : List available interfaces\n");
+	exit (EXIT_SUCCESS);
+}
+
+int
+main (
+	int	argc,
+	char   *argv[]
+	)
+{
+	pgm_error_t* pgm_err = NULL;
+	int status = EXIT_FAILURE;
+
+	setlocale (LC_ALL, "");
+
+	if (!pgm_init (&pgm_err)) {
+		fprintf (stderr, "Unable to start PGM engine: %s\n", pgm_err->message);
+		pgm_error_free (pgm_err);
+		return EXIT_FAILURE;
+	}
+
+/* parse program arguments */
+#ifdef _WIN32
+	const char* binary_name = strrchr (argv[0], '\\');
+#else
+	const char* binary_name = strrchr (argv[0], '/');
+#endif
+	if (NULL == binary_name)	binary_name = argv[0];
+	else				binary_name++;
+
+	int c;
+	while ((c = getopt (argc, argv, "s:n:p:c:b:B:tih")) != -1)
+	{
+		switch (c) {
+		case 'n':	network = optarg; break;
+		case 's':	port = atoi (optarg); break;
+		case 'p':	udp_encap_port = atoi (optarg); break;
+		case 'c':	message_count = atoi (optarg); break;
+		case 'b':	message_len = atoi (optarg); break;
+		case 'B':	burst = atoi (optarg); break;
+		case 't':	use_single_thread = TRUE; break;
+
+		case 'i':
+			pgm_if_print_all();
+			return EXIT_SUCCESS;
+
+		case 'h':
+		case '?':
+			usage (binary_name);
+		}
+	}
+
+	if (message_count <= 0 || message_len <= 0 || message_len > 1024 || burst <= 0 || burst > sqns / 2) {
+		fprintf (stderr, "Invalid message count, size or burst.\n");
+		usage (binary_name);
+	}
+
+/* both sockets share the port so are created by the same user */
+	if (!create_sock (&rx_sock, FALSE) || !create_sock (&tx_sock, TRUE))
+		goto cleanup;
+	pgm_drop_superuser();
+
+/* alternate bursts of sends with draining the receiver, timing each side */
+	char message[1024], buffer[4096];
+	pgm_time_t send_time = 0, recv_time = 0, last_progress;
+	int sent = 0, received = 0;
+
+	memset (message, 'x', sizeof(message));
+	last_progress = now_usecs();
+	while (received < message_count) {
+		const int target = sent + burst < message_count ? sent + burst : message_count;
+		pgm_time_t start = now_usecs();
+		while (sent < target) {
+			if (PGM_IO_STATUS_NORMAL != pgm_send (tx_sock, message, message_len, NULL))
+				break;
+			sent++;
+		}
+		pgm_time_t now = now_usecs();
+		send_time += now - start;
+
+		start = now;
+		while (received < sent) {
+			size_t bytes_read;
+			const int io_status = pgm_recv (rx_sock, buffer, sizeof(buffer), 0, &bytes_read, &pgm_err);
+			if (PGM_IO_STATUS_NORMAL == io_status) {
+				received++;
+				continue;
+			}
+			if (PGM_IO_STATUS_RESET == io_status || PGM_IO_STATUS_ERROR == io_status) {
+				fprintf (stderr, "pgm_recv() failed after %d messages%s%s.\n",
+					 received, pgm_err ? ": " : "", pgm_err ? pgm_err->message : "");
+				goto cleanup;
+			}
+			break;
+		}
+		now = now_usecs();
+		recv_time += now - start;
+
+		if (received == sent)
+			last_progress = now;
+		else if (now - last_progress > pgm_secs (1)) {
+			fprintf (stderr, "Stalled after %d of %d messages received.\n", received, sent);
+			goto cleanup;
+		}
+	}
+
+	printf ("%d messages of %d bytes, %s sockets: %.0f sends/s %.0f recvs/s\n",
+		message_count, message_len,
+		use_single_thread ? "single-threaded" : "locked",
+		send_time ? (double)message_count * 1000000.0 / (double)send_time : 0.0,
+		recv_time ? (double)message_count * 1000000.0 / (double)recv_time : 0.0);
+	status = EXIT_SUCCESS;
+
+cleanup:
+	if (NULL != pgm_err) {
+		pgm_error_free (pgm_err);
+		pgm_err = NULL;
+	}
+	if (tx_sock) {
+		pgm_close (tx_sock, FALSE);
+		tx_sock = NULL;
+	}
+	if (rx_sock) {
+		pgm_close (rx_sock, FALSE);
+		rx_sock = NULL;
+	}
+	pgm_shutdown();
+	return status;
+}
+
+static
+bool
+create_sock (
+	pgm_sock_t**	sock,
+	const bool	is_sender
+	)
+{
+	struct pgm_addrinfo_t* res = NULL;
+	pgm_error_t* pgm_err = NULL;
+	sa_family_t sa_family = AF_UNSPEC;
+
+/* parse network parameter into PGM socket address structure */
+	if (!pgm_getaddrinfo (network, NULL, &res, &pgm_err)) {
+		fprintf (stderr, "Parsing network parameter: %s\n", pgm_err->message);
+		goto err_abort;
+	}
+
+	sa_family = res->ai_send_addrs[0].gsr_group.ss_family;
+
+	if (udp_encap_port) {
+		if (!pgm_socket (sock, sa_family, SOCK_SEQPACKET, IPPROTO_UDP, &pgm_err)) {
+			fprintf (stderr, "Creating PGM/UDP socket: %s\n", pgm_err->message);
+			goto err_abort;
+		}
+		pgm_setsockopt (*sock, IPPROTO_PGM, PGM_UDP_ENCAP_UCAST_PORT, &udp_encap_port, sizeof(udp_encap_port));
+		pgm_setsockopt (*sock, IPPROTO_PGM, PGM_UDP_ENCAP_MCAST_PORT, &udp_encap_port, sizeof(udp_encap_port));
+	} else {
+		if (!pgm_socket (sock, sa_family, SOCK_SEQPACKET, IPPROTO_PGM, &pgm_err)) {
+			fprintf (stderr, "Creating PGM/IP socket: %s\n", pgm_err->message);
+			goto err_abort;
+		}
+	}
+
+/* Use RFC 2113 tagging for PGM Router Assist */
+	const int no_router_assist = 0;
+	pgm_setsockopt (*sock, IPPROTO_PGM, PGM_IP_ROUTER_ALERT, &no_router_assist, sizeof(no_router_assist));
+
+/* set PGM parameters */
+	const int single_thread = use_single_thread ? 1 : 0;
+	pgm_setsockopt (*sock, IPPROTO_PGM, PGM_SINGLE_THREAD, &single_thread, sizeof(single_thread));
+	pgm_setsockopt (*sock, IPPROTO_PGM, PGM_MTU, &max_tpdu, sizeof(max_tpdu));
+	if (is_sender) {
+		const int send_only = 1,
+			  ambient_spm = pgm_secs (30),
+			  heartbeat_spm[] = { pgm_msecs (100),
+					      pgm_msecs (100),
+					      pgm_msecs (100),
+					      pgm_msecs (100),
+					      pgm_msecs (1300),
+					      pgm_secs  (7),
+					      pgm_secs  (16),
+					      pgm_secs  (25),
+					      pgm_secs  (30) };
+
+		pgm_setsockopt (*sock, IPPROTO_PGM, PGM_SEND_ONLY, &send_only, sizeof(send_only));
+		pgm_setsockopt (*sock, IPPROTO_PGM, PGM_TXW_SQNS, &sqns, sizeof(sqns));
+		pgm_setsockopt (*sock, IPPROTO_PGM, PGM_AMBIENT_SPM, &ambient_spm, sizeof(ambient_spm));
+		pgm_setsockopt (*sock, IPPROTO_PGM, PGM_HEARTBEAT_SPM, &heartbeat_spm, sizeof(heartbeat_spm));
+	} else {
+		const int recv_only = 1,
+			  passive = 0,
+			  peer_expiry = pgm_secs (300),
+			  spmr_expiry = pgm_msecs (250),
+			  nak_bo_ivl = pgm_msecs (50),
+			  nak_rpt_ivl = pgm_secs (2),
+			  nak_rdata_ivl = pgm_secs (2),
+			  nak_data_retries = 50,
+			  nak_ncf_retries = 50;
+
+		pgm_setsockopt (*sock, IPPROTO_PGM, PGM_RECV_ONLY, &recv_only, sizeof(recv_only));
+		pgm_setsockopt (*sock, IPPROTO_PGM, PGM_PASSIVE, &passive, sizeof(passive));
+		pgm_setsockopt (*sock, IPPROTO_PGM, PGM_RXW_SQNS, &sqns, sizeof(sqns));
+		pgm_setsockopt (*sock, IPPROTO_PGM, PGM_PEER_EXPIRY, &peer_expiry, sizeof(peer_expiry));
+		pgm_setsockopt (*sock, IPPROTO_PGM, PGM_SPMR_EXPIRY, &spmr_expiry, sizeof(spmr_expiry));
+		pgm_setsockopt (*sock, IPPROTO_PGM, PGM_NAK_BO_IVL, &nak_bo_ivl, sizeof(nak_bo_ivl));
+		pgm_setsockopt (*sock, IPPROTO_PGM, PGM_NAK_RPT_IVL, &nak_rpt_ivl, sizeof(nak_rpt_ivl));
+		pgm_setsockopt (*sock, IPPROTO_PGM, PGM_NAK_RDATA_IVL, &nak_rdata_ivl, sizeof(nak_rdata_ivl));
+		pgm_setsockopt (*sock, IPPROTO_PGM, PGM_NAK_DATA_RETRIES, &nak_data_retries, sizeof(nak_data_retries));
+		pgm_setsockopt (*sock, IPPROTO_PGM, PGM_NAK_NCF_RETRIES, &nak_ncf_retries, sizeof(nak_ncf_retries));
+	}
+
+/* create global session identifier, the sender takes a distinct source port */
+	struct pgm_sockaddr_t addr;
+	memset (&addr, 0, sizeof(addr));
+	addr.sa_port = port ? port : DEFAULT_DATA_DESTINATION_PORT;
+	addr.sa_addr.sport = is_sender ? DEFAULT_DATA_SOURCE_PORT : DEFAULT_DATA_SOURCE_PORT + 1;
+	if (!pgm_gsi_create_from_hostname (&addr.sa_addr.gsi, &pgm_err)) {
+		fprintf (stderr, "Creating GSI: %s\n", pgm_err->message);
+		goto err_abort;
+	}
+
+/* assign socket to specified address */
+	struct pgm_interface_req_t if_req;
+	memset (&if_req, 0, sizeof(if_req));
+	if_req.ir_interface = res->ai_recv_addrs[0].gsr_interface;
+	if_req.ir_scope_id  = 0;
+	if (AF_INET6 == sa_family) {
+		struct sockaddr_in6 sa6;
+		memcpy (&sa6, &res->ai_recv_addrs[0].gsr_group, sizeof(sa6));
+		if_req.ir_scope_id = sa6.sin6_scope_id;
+	}
+	if (!pgm_bind3 (*sock,
+			&addr, sizeof(addr),
+			&if_req, sizeof(if_req),	/* tx interface */
+			&if_req, sizeof(if_req),	/* rx interface */
+			&pgm_err))
+	{
+		fprintf (stderr, "Binding PGM socket: %s\n", pgm_err->message);
+		goto err_abort;
+	}
+
+/* join IP multicast groups */
+	unsigned i;
+	for (i = 0; i < res->ai_recv_addrs_len; i++)
+		pgm_setsockopt (*sock, IPPROTO_PGM, PGM_JOIN_GROUP, &res->ai_recv_addrs[i], sizeof(struct group_req));
+	pgm_setsockopt (*sock, IPPROTO_PGM, PGM_SEND_GROUP, &res->ai_send_addrs[0], sizeof(struct group_req));
+	pgm_freeaddrinfo (res);
+
+/* set IP parameters, loopback delivers the sender to the receiver */
+	const int nonblocking = 1,
+		  multicast_loop = 1,
+		  multicast_hops = 0;
+
+	pgm_setsockopt (*sock, IPPROTO_PGM, PGM_MULTICAST_LOOP, &multicast_loop, sizeof(multicast_loop));
+	pgm_setsockopt (*sock, IPPROTO_PGM, PGM_MULTICAST_HOPS, &multicast_hops, sizeof(multicast_hops));
+	pgm_setsockopt (*sock, IPPROTO_PGM, PGM_NOBLOCK, &nonblocking, sizeof(nonblocking));
+
+	if (!pgm_connect (*sock, &pgm_err)) {
+		fprintf (stderr, "Connecting PGM socket: %s\n", pgm_err->message);
+		goto err_abort;
+	}
+
+	return TRUE;
+
+err_abort:
+	if (NULL != *sock) {
+		pgm_close (*sock, FALSE);
+		*sock = NULL;
+	}
+	if (NULL != res) {
+		pgm_freeaddrinfo (res);
+		res = NULL;
+	}
+	if (NULL != pgm_err) {
+		pgm_error_free (pgm_err);
+		pgm_err = NULL;
+	}
+	return FALSE;
+}
+
+/* wall clock in microseconds for the measurement only.
+ */
+
+static
+pgm_time_t
+now_usecs (void)
+{
+#ifndef _WIN32
+	struct timeval tv;
+	gettimeofday (&tv, NULL);
+	return pgm_secs (tv.tv_sec) + tv.tv_usec;
+#else
+	LARGE_INTEGER frequency, counter;
+	QueryPerformanceFrequency (&frequency);
+	QueryPerformanceCounter (&counter);
+	return (pgm_time_t)(counter.QuadPart * 1000000 / frequency.QuadPart);
+#endif
+}
+
+/* eof */
@@ -0,0 +1,258 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * kernel socket filter for the PGM receive socket.
+ *
+ * A raw PGM socket receives every PGM datagram delivered to the host, a
+ * classic BPF program attached with SO_ATTACH_FILTER drops packets for other
+ * sessions and groups before they are copied to user space.  The program
+ * mirrors the data-destination port, type and group checks of recv.c.
+ *
+ * Copyright (c) 2010-2011 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+#include <errno.h>
+#ifdef HAVE_SO_ATTACH_FILTER
+#	include <linux/filter.h>
+#endif
+#include <impl/i18n.h>
+#include <impl/framework.h>
+#include <impl/socket.h>
+#include <impl/filter.h>
+
+
+//#define FILTER_DEBUG
+
+#ifdef HAVE_SO_ATTACH_FILTER
+
+/* group tests, type tests and fixed prologue and epilogue */
+#define FILTER_MAX_INSNS	(IP_MAX_MEMBERSHIPS + 48)
+
+/* jump targets resolved once the program is complete */
+enum {
+	FILTER_NEXT = 0,
+	FILTER_PORTS,
+	FILTER_DOWNSTREAM,
+	FILTER_PEER,
+	FILTER_ACCEPT,
+	FILTER_REJECT,
+	FILTER_LABEL_MAX
+};
+
+struct filter_prog_t {
+	struct sock_filter	insns[ FILTER_MAX_INSNS ];
+	uint8_t			jt[ FILTER_MAX_INSNS ];		/* label per conditional jump */
+	uint8_t			jf[ FILTER_MAX_INSNS ];
+	unsigned		label[ FILTER_LABEL_MAX ];	/* instruction index */
+	unsigned		len;
+};
+
+static const uint8_t downstream_types[] = { PGM_SPM, PGM_POLL, PGM_ODATA, PGM_RDATA, PGM_NCF };
+static const uint8_t upstream_types[]   = { PGM_NAK, PGM_NNAK, PGM_SPMR, PGM_POLR, PGM_ACK };
+
+static inline
+void
+filter_stmt (
+	struct filter_prog_t*	prog,
+	const uint16_t		code,
+	const uint32_t		k
+	)
+{
+	pgm_assert (prog->len < FILTER_MAX_INSNS);
+	prog->insns[ prog->len ].code = code;
+	prog->insns[ prog->len ].jt   = 0;
+	prog->insns[ prog->len ].jf   = 0;
+	prog->insns[ prog->len ].k    = k;
+	prog->jt[ prog->len ] = prog->jf[ prog->len ] = FILTER_NEXT;
+	prog->len++;
+}
+
+static inline
+void
+filter_jump (
+	struct filter_prog_t*	prog,
+	const uint32_t		k,
+	const uint8_t		jt,
+	const uint8_t		jf
+	)
+{
+	filter_stmt (prog, BPF_JMP | BPF_JEQ | BPF_K, k);
+	prog->jt[ prog->len - 1 ] = jt;
+	prog->jf[ prog->len - 1 ] = jf;
+}
+
+static inline
+void
+filter_label (
+	struct filter_prog_t*	prog,
+	const unsigned		label
+	)
+{
+	prog->label[ label ] = prog->len;
+}
+
+/* generate the filter for the current bind, memberships and direction of
+ * sock.  offsets are relative to the IPv4 header on raw IPv4 sockets, the UDP
+ * header on encapsulated sockets and the PGM header on raw IPv6 sockets.
+ *
+ *	[IPv4]	    X = IP header length
+ *		    if dst is multicast and not a joined or send group: reject
+ *	PORTS:	    M[0] = type
+ *		    if type is downstream: goto DOWNSTREAM
+ *		    if sport != data-destination port: reject
+ *		    if dport == source port and type is upstream: accept
+ *	PEER:	    if type is SPMR or NAK: accept else reject
+ *	DOWNSTREAM: if dport == data-destination port: accept else reject
+ *
+ * returns program length.
+ */
+
+static
+unsigned
+filter_compile (
+	const pgm_sock_t*     const restrict sock,
+	struct filter_prog_t* const restrict prog
+	)
+{
+	const uint32_t dport = ntohs (sock->dport);
+	const uint32_t sport = ntohs (sock->tsi.sport);
+	const bool is_raw_ipv4 = (AF_INET == sock->family && 0 == sock->udp_encap_ucast_port);
+	unsigned i, label;
+
+	memset (prog, 0, sizeof(struct filter_prog_t));
+
+	if (is_raw_ipv4)
+	{
+		filter_stmt (prog, BPF_LDX | BPF_B | BPF_MSH, 0);
+/* loopback and unicast upstream messages pass to the port tests */
+		filter_stmt (prog, BPF_LD | BPF_W | BPF_ABS, offsetof (struct pgm_ip, ip_dst));
+		filter_stmt (prog, BPF_ALU | BPF_AND | BPF_K, 0xf0000000);
+		filter_jump (prog, 0xe0000000, FILTER_NEXT, FILTER_PORTS);
+		filter_stmt (prog, BPF_LD | BPF_W | BPF_ABS, offsetof (struct pgm_ip, ip_dst));
+		for (i = 0; i <= sock->recv_gsr_len; i++)
+		{
+			const struct sockaddr* group = (i < sock->recv_gsr_len) ?
+					(const struct sockaddr*)&sock->recv_gsr[i].gsr_group :
+					(const struct sockaddr*)&sock->send_gsr.gsr_group;
+			if (AF_INET != group->sa_family)
+				continue;
+			filter_jump (prog, ntohl (((const struct sockaddr_in*)group)->sin_addr.s_addr), FILTER_PORTS, FILTER_NEXT);
+		}
+		filter_stmt (prog, BPF_RET | BPF_K, 0);
+	}
+	else
+		filter_stmt (prog, BPF_LDX | BPF_W | BPF_IMM, sock->udp_encap_ucast_port ? sizeof(struct pgm_udphdr) : 0);
+
+	filter_label (prog, FILTER_PORTS);
+	filter_stmt (prog, BPF_LD | BPF_B | BPF_IND, offsetof (struct pgm_header, pgm_type));
+	filter_stmt (prog, BPF_ST, 0);
+	if (sock->can_recv_data)
+		for (i = 0; i < PGM_N_ELEMENTS(downstream_types); i++)
+			filter_jump (prog, downstream_types[i], FILTER_DOWNSTREAM, FILTER_NEXT);
+	filter_stmt (prog, BPF_LD | BPF_H | BPF_IND, offsetof (struct pgm_header, pgm_sport));
+	filter_jump (prog, dport, FILTER_NEXT, FILTER_REJECT);
+	if (sock->can_send_data)
+	{
+		filter_stmt (prog, BPF_LD | BPF_H | BPF_IND, offsetof (struct pgm_header, pgm_dport));
+		filter_jump (prog, sport, FILTER_NEXT, FILTER_PEER);
+		filter_stmt (prog, BPF_LD | BPF_MEM, 0);
+		for (i = 0; i < PGM_N_ELEMENTS(upstream_types); i++)
+			filter_jump (prog, upstream_types[i], FILTER_ACCEPT, FILTER_NEXT);
+		filter_stmt (prog, BPF_RET | BPF_K, 0);
+	}
+
+	filter_label (prog, FILTER_PEER);
+	if (sock->can_recv_data)
+	{
+		filter_stmt (prog, BPF_LD | BPF_MEM, 0);
+/* other receivers' NAKs for NAK suppression */
+		filter_jump (prog, PGM_SPMR, FILTER_ACCEPT, FILTER_NEXT);
+		filter_jump (prog, PGM_NAK, FILTER_ACCEPT, FILTER_REJECT);
+
+		filter_label (prog, FILTER_DOWNSTREAM);
+		filter_stmt (prog, BPF_LD | BPF_H | BPF_IND, offsetof (struct pgm_header, pgm_dport));
+		filter_jump (prog, dport, FILTER_ACCEPT, FILTER_REJECT);
+	}
+
+	filter_label (prog, FILTER_REJECT);
+	filter_stmt (prog, BPF_RET | BPF_K, 0);
+	filter_label (prog, FILTER_ACCEPT);
+	filter_stmt (prog, BPF_RET | BPF_K, 0xffffffff);
+
+/* resolve forward jumps */
+	for (i = 0; i < prog->len; i++)
+	{
+		label = prog->jt[i];
+		if (FILTER_NEXT != label) {
+			pgm_assert (prog->label[ label ] > i);
+			pgm_assert (prog->label[ label ] - i - 1 <= UINT8_MAX);
+			prog->insns[i].jt = (uint8_t)(prog->label[ label ] - i - 1);
+		}
+		label = prog->jf[i];
+		if (FILTER_NEXT != label) {
+			pgm_assert (prog->label[ label ] > i);
+			pgm_assert (prog->label[ label ] - i - 1 <= UINT8_MAX);
+			prog->insns[i].jf = (uint8_t)(prog->label[ label ] - i - 1);
+		}
+	}
+	return prog->len;
+}
+
+#endif /* HAVE_SO_ATTACH_FILTER */
+
+/* replace the filter on the receive socket of sock, called on bind, connect
+ * and every membership change.  failure leaves the previous filter in place
+ * as the receive path repeats every test.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_filter_attach (
+	pgm_sock_t* const	sock
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+
+#ifdef HAVE_SO_ATTACH_FILTER
+/* shared receive socket carries several sessions, membership socket carries none */
+	if (sock->use_demux)
+		return;
+
+	{
+		struct filter_prog_t prog;
+		struct sock_fprog fprog;
+
+		fprog.len    = (unsigned short)filter_compile (sock, &prog);
+		fprog.filter = prog.insns;
+		if (SOCKET_ERROR == setsockopt (sock->recv_sock, SOL_SOCKET, SO_ATTACH_FILTER, (const char*)&fprog, sizeof(fprog)))
+		{
+			const int save_errno = pgm_get_last_sock_error();
+			char errbuf[1024];
+			pgm_trace (PGM_LOG_ROLE_NETWORK,_("Attaching receive socket filter failed: %s"),
+				   pgm_sock_strerror_s (errbuf, sizeof (errbuf), save_errno));
+			return;
+		}
+		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Attached %u instruction receive socket filter."),
+			   (unsigned)fprog.len);
+	}
+#endif /* HAVE_SO_ATTACH_FILTER */
+}
+
+/* eof */
@@ -0,0 +1,319 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * unit tests for the kernel socket filter.
+ *
+ * Copyright (c) 2010-2011 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#	include <sys/socket.h>
+#endif
+#include <glib.h>
+#include <check.h>
+
+
+/* mock state */
+
+#define TEST_PORT		7500
+#define TEST_SPORT		1000
+#define TEST_GROUP		"239.192.0.1"
+#define TEST_OTHER_GROUP	"239.192.0.2"
+#define TEST_UNICAST		"127.0.0.1"
+
+/* mock functions for external references */
+
+size_t
+pgm_pkt_offset (
+        const bool                      can_fragment,
+        const sa_family_t		pgmcc_family	/* 0 = disable */
+        )
+{
+        return 0;
+}
+
+#define FILTER_DEBUG
+#include "filter.c"
+
+PGM_GNUC_INTERNAL
+int
+pgm_get_nprocs (void)
+{
+	return 1;
+}
+
+static
+struct pgm_sock_t*
+generate_sock (
+	const bool	can_send_data,
+	const bool	can_recv_data
+	)
+{
+	struct pgm_sock_t* sock = g_new0 (struct pgm_sock_t, 1);
+	struct sockaddr_in* sin;
+	sock->family = AF_INET;
+	sock->dport = g_htons(TEST_PORT);
+	sock->tsi.sport = g_htons(TEST_SPORT);
+	sock->can_send_data = can_send_data;
+	sock->can_recv_data = can_recv_data;
+	sin = (struct sockaddr_in*)&sock->recv_gsr[0].gsr_group;
+	sin->sin_family = AF_INET;
+	sin->sin_addr.s_addr = inet_addr (TEST_GROUP);
+	sock->recv_gsr_len = 1;
+	memcpy (&sock->send_gsr.gsr_group, &sock->recv_gsr[0].gsr_group, sizeof(struct sockaddr_in));
+	sock->recv_sock = INVALID_SOCKET;
+	return sock;
+}
+
+#ifdef HAVE_SO_ATTACH_FILTER
+/* build an IPv4 PGM datagram, optionally with a router alert option */
+static
+unsigned
+generate_packet (
+	char*		buf,
+	const char*	dst,
+	const bool	use_router_alert,
+	const uint8_t	type,
+	const uint16_t	sport,
+	const uint16_t	dport
+	)
+{
+	struct pgm_ip* ip = (struct pgm_ip*)buf;
+	struct pgm_header* header;
+	unsigned iphdr_len = sizeof(struct pgm_ip);
+	memset (buf, 0, 64);
+	if (use_router_alert)
+		iphdr_len += 4;
+	ip->ip_hl = iphdr_len / 4;
+	ip->ip_v = 4;
+	ip->ip_p = IPPROTO_PGM;
+	ip->ip_dst.s_addr = inet_addr (dst);
+	header = (struct pgm_header*)(buf + iphdr_len);
+	header->pgm_sport = g_htons(sport);
+	header->pgm_dport = g_htons(dport);
+	header->pgm_type  = type;
+	return iphdr_len + sizeof(struct pgm_header);
+}
+
+/* minimal classic BPF interpreter for the instructions generated */
+static
+uint32_t
+run_filter (
+	const struct filter_prog_t*	prog,
+	const char*			buf,
+	const unsigned			len
+	)
+{
+	const unsigned char* p = (const unsigned char*)buf;
+	uint32_t A = 0, X = 0, M[BPF_MEMWORDS];
+	unsigned pc = 0;
+
+	memset (M, 0, sizeof(M));
+	while (pc < prog->len) {
+		const struct sock_filter* insn = &prog->insns[ pc++ ];
+		uint32_t k = insn->k;
+		switch (insn->code) {
+		case BPF_LDX | BPF_B | BPF_MSH:	fail_unless (k < len, "read beyond packet"); X = 4 * (p[k] & 0xf); break;
+		case BPF_LDX | BPF_W | BPF_IMM:	X = k; break;
+		case BPF_LD | BPF_W | BPF_ABS:	fail_unless (k + 4 <= len, "read beyond packet"); A = (p[k] << 24) | (p[k+1] << 16) | (p[k+2] << 8) | p[k+3]; break;
+		case BPF_LD | BPF_H | BPF_IND:	k += X; fail_unless (k + 2 <= len, "read beyond packet"); A = (p[k] << 8) | p[k+1]; break;
+		case BPF_LD | BPF_B | BPF_IND:	k += X; fail_unless (k < len, "read beyond packet"); A = p[k]; break;
+		case BPF_LD | BPF_MEM:		A = M[k]; break;
+		case BPF_ST:			M[k] = A; break;
+		case BPF_ALU | BPF_AND | BPF_K:	A &= k; break;
+		case BPF_JMP | BPF_JEQ | BPF_K:	pc += (A == k) ? insn->jt : insn->jf; break;
+		case BPF_RET | BPF_K:		return k;
+		default:			fail ("unexpected instruction");
+		}
+	}
+	fail ("program fell off end");
+	return 0;
+}
+#endif /* HAVE_SO_ATTACH_FILTER */
+
+/* target:
+ *	unsigned
+ *	filter_compile (
+ *		const pgm_sock_t* const		sock,
+ *		struct filter_prog_t* const	prog
+ *		)
+ */
+
+#ifdef HAVE_SO_ATTACH_FILTER
+/* receiver takes downstream and peer messages for its session and groups */
+START_TEST (test_compile_pass_001)
+{
+	pgm_sock_t* sock = generate_sock (FALSE, TRUE);
+	struct filter_prog_t prog;
+	char buf[64];
+	unsigned len;
+	fail_unless (filter_compile (sock, &prog) > 0, "compile failed");
+	len = generate_packet (buf, TEST_GROUP, FALSE, PGM_ODATA, TEST_SPORT, TEST_PORT);
+	fail_unless (0 != run_filter (&prog, buf, len), "ODATA rejected");
+	len = generate_packet (buf, TEST_GROUP, TRUE, PGM_SPM, TEST_SPORT, TEST_PORT);
+	fail_unless (0 != run_filter (&prog, buf, len), "SPM with IP options rejected");
+	len = generate_packet (buf, TEST_GROUP, FALSE, PGM_SPMR, TEST_PORT, TEST_SPORT);
+	fail_unless (0 != run_filter (&prog, buf, len), "peer SPMR rejected");
+	len = generate_packet (buf, TEST_GROUP, FALSE, PGM_ODATA, TEST_SPORT, TEST_PORT + 1);
+	fail_unless (0 == run_filter (&prog, buf, len), "ODATA for other port accepted");
+	len = generate_packet (buf, TEST_OTHER_GROUP, FALSE, PGM_ODATA, TEST_SPORT, TEST_PORT);
+	fail_unless (0 == run_filter (&prog, buf, len), "ODATA for other group accepted");
+	len = generate_packet (buf, TEST_GROUP, FALSE, PGM_NAK, TEST_PORT, TEST_SPORT);
+	fail_unless (0 != run_filter (&prog, buf, len), "peer NAK rejected");
+	len = generate_packet (buf, TEST_GROUP, FALSE, PGM_NAK, TEST_PORT + 1, TEST_SPORT);
+	fail_unless (0 == run_filter (&prog, buf, len), "NAK for other port accepted");
+	len = generate_packet (buf, TEST_GROUP, FALSE, PGM_ACK, TEST_PORT, TEST_SPORT);
+	fail_unless (0 == run_filter (&prog, buf, len), "ACK accepted by receiver");
+}
+END_TEST
+
+/* source takes upstream messages for its session only */
+START_TEST (test_compile_pass_002)
+{
+	pgm_sock_t* sock = generate_sock (TRUE, FALSE);
+	struct filter_prog_t prog;
+	char buf[64];
+	unsigned len;
+	fail_unless (filter_compile (sock, &prog) > 0, "compile failed");
+	len = generate_packet (buf, TEST_UNICAST, TRUE, PGM_NAK, TEST_PORT, TEST_SPORT);
+	fail_unless (0 != run_filter (&prog, buf, len), "NAK rejected");
+	len = generate_packet (buf, TEST_UNICAST, FALSE, PGM_ACK, TEST_PORT, TEST_SPORT);
+	fail_unless (0 != run_filter (&prog, buf, len), "ACK rejected");
+	len = generate_packet (buf, TEST_GROUP, FALSE, PGM_SPMR, TEST_PORT, TEST_SPORT);
+	fail_unless (0 != run_filter (&prog, buf, len), "SPMR rejected");
+	len = generate_packet (buf, TEST_UNICAST, FALSE, PGM_NAK, TEST_PORT + 1, TEST_SPORT);
+	fail_unless (0 == run_filter (&prog, buf, len), "NAK for other session accepted");
+	len = generate_packet (buf, TEST_UNICAST, FALSE, PGM_NAK, TEST_PORT, TEST_SPORT + 1);
+	fail_unless (0 == run_filter (&prog, buf, len), "NAK for other source accepted");
+	len = generate_packet (buf, TEST_GROUP, FALSE, PGM_ODATA, TEST_SPORT, TEST_PORT);
+	fail_unless (0 == run_filter (&prog, buf, len), "ODATA accepted by send-only socket");
+}
+END_TEST
+
+/* every group joined is admitted */
+START_TEST (test_compile_pass_003)
+{
+	pgm_sock_t* sock = generate_sock (TRUE, TRUE);
+	struct filter_prog_t prog;
+	char buf[64];
+	unsigned len;
+	for (unsigned i = 1; i < IP_MAX_MEMBERSHIPS; i++) {
+		memcpy (&sock->recv_gsr[i], &sock->recv_gsr[0], sizeof(struct group_source_req));
+		((struct sockaddr_in*)&sock->recv_gsr[i].gsr_group)->sin_addr.s_addr = htonl (ntohl (inet_addr (TEST_GROUP)) + i);
+	}
+	sock->recv_gsr_len = IP_MAX_MEMBERSHIPS;
+	fail_unless (filter_compile (sock, &prog) <= FILTER_MAX_INSNS, "compile overflow");
+	len = generate_packet (buf, TEST_OTHER_GROUP, FALSE, PGM_RDATA, TEST_SPORT, TEST_PORT);
+	fail_unless (0 != run_filter (&prog, buf, len), "RDATA for joined group rejected");
+	len = generate_packet (buf, "239.192.1.1", FALSE, PGM_RDATA, TEST_SPORT, TEST_PORT);
+	fail_unless (0 == run_filter (&prog, buf, len), "RDATA for other group accepted");
+}
+END_TEST
+
+/* UDP encapsulated sockets test from the UDP header */
+START_TEST (test_compile_pass_004)
+{
+	pgm_sock_t* sock = generate_sock (FALSE, TRUE);
+	struct filter_prog_t prog;
+	char buf[64];
+	unsigned len;
+	sock->udp_encap_ucast_port = TEST_PORT;
+	fail_unless (filter_compile (sock, &prog) > 0, "compile failed");
+	len = generate_packet (buf, TEST_GROUP, FALSE, PGM_ODATA, TEST_SPORT, TEST_PORT);
+	fail_unless (0 != run_filter (&prog, buf + sizeof(struct pgm_ip) - sizeof(struct pgm_udphdr), len - sizeof(struct pgm_ip) + sizeof(struct pgm_udphdr)), "ODATA rejected");
+	len = generate_packet (buf, TEST_GROUP, FALSE, PGM_ODATA, TEST_SPORT, TEST_PORT + 1);
+	fail_unless (0 == run_filter (&prog, buf + sizeof(struct pgm_ip) - sizeof(struct pgm_udphdr), len - sizeof(struct pgm_ip) + sizeof(struct pgm_udphdr)), "ODATA for other port accepted");
+}
+END_TEST
+#endif /* HAVE_SO_ATTACH_FILTER */
+
+/* target:
+ *	void
+ *	pgm_filter_attach (
+ *		pgm_sock_t* const	sock
+ *		)
+ */
+
+START_TEST (test_attach_pass_001)
+{
+	pgm_sock_t* sock = generate_sock (TRUE, TRUE);
+	sock->udp_encap_ucast_port = TEST_PORT;
+	sock->recv_sock = socket (AF_INET, SOCK_DGRAM, 0);
+	fail_if (INVALID_SOCKET == sock->recv_sock, "socket failed");
+	pgm_filter_attach (sock);
+	closesocket (sock->recv_sock);
+}
+END_TEST
+
+/* shared receive sockets are left unfiltered */
+START_TEST (test_attach_pass_002)
+{
+	pgm_sock_t* sock = generate_sock (TRUE, TRUE);
+	sock->use_demux = TRUE;
+	pgm_filter_attach (sock);
+}
+END_TEST
+
+static
+Suite*
+make_test_suite (void)
+{
+	Suite* s;
+
+	s = suite_create (__FILE__);
+
+#ifdef HAVE_SO_ATTACH_FILTER
+	TCase* tc_compile = tcase_create ("compile");
+	suite_add_tcase (s, tc_compile);
+	tcase_add_test (tc_compile, test_compile_pass_001);
+	tcase_add_test (tc_compile, test_compile_pass_002);
+	tcase_add_test (tc_compile, test_compile_pass_003);
+	tcase_add_test (tc_compile, test_compile_pass_004);
+#endif
+
+	TCase* tc_attach = tcase_create ("attach");
+	suite_add_tcase (s, tc_attach);
+	tcase_add_test (tc_attach, test_attach_pass_001);
+	tcase_add_test (tc_attach, test_attach_pass_002);
+	return s;
+}
+
+static
+Suite*
+make_master_suite (void)
+{
+	Suite* s = suite_create ("Master");
+	return s;
+}
+
+int
+main (void)
+{
+	pgm_messages_init();
+	SRunner* sr = srunner_create (make_master_suite ());
+	srunner_add_suite (sr, make_test_suite ());
+	srunner_run_all (sr, CK_ENV);
+	int number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+	pgm_messages_shutdown();
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* eof */
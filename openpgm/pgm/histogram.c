@@ -22,8 +22,7 @@
 #ifdef HAVE_CONFIG_H
 #	include <config.h>
 #endif
-#include <limits.h>
-#include <math.h>
+#include <inttypes.h>
 #include <stdlib.h>
 #include <string.h>
 #include <impl/framework.h>
@@ -34,97 +33,133 @@
 
 pgm_slist_t* pgm_histograms = NULL;
 
+/* registration may happen before pgm_init(), guarded by a flag instead of a
+ * mutex that would need initialisation.
+ */
+static volatile uint32_t histograms_lock = 0;
 
-static void sample_set_accumulate (pgm_sample_set_t*, pgm_sample_t, pgm_count_t, unsigned);
-static pgm_count_t sample_set_total_count (const pgm_sample_set_t*) PGM_GNUC_PURE;
 
-static void set_bucket_range (pgm_histogram_t*, unsigned, pgm_sample_t);
-static void initialize_bucket_range (pgm_histogram_t*);
-static unsigned bucket_index (const pgm_histogram_t*, const pgm_sample_t);
-static void accumulate (pgm_histogram_t*, pgm_sample_t, pgm_count_t, unsigned);
-static double get_peak_bucket_size (const pgm_histogram_t*restrict, const pgm_sample_set_t*restrict);
-static double get_bucket_size (const pgm_histogram_t*, const pgm_count_t, const unsigned);
+static void atomic_min32 (volatile uint32_t*, const uint32_t);
+static void atomic_max32 (volatile uint32_t*, const uint32_t);
 
 static void pgm_histogram_write_html_graph (pgm_histogram_t*restrict, pgm_string_t*restrict);
 static void write_ascii (pgm_histogram_t*restrict, const char*restrict, pgm_string_t*restrict);
-static void write_ascii_header (pgm_histogram_t*restrict, pgm_sample_set_t*restrict, pgm_count_t, pgm_string_t*restrict);
+static void write_ascii_header (pgm_histogram_t*restrict, const struct pgm_histinfo_t*restrict, pgm_string_t*restrict);
 static void write_ascii_bucket_graph (double, double, pgm_string_t*);
-static void write_ascii_bucket_context (int64_t, pgm_count_t, int64_t, unsigned, pgm_string_t*);
-static void write_ascii_bucket_value (pgm_count_t, double, pgm_string_t*);
-static pgm_string_t* get_ascii_bucket_range (pgm_histogram_t*, unsigned);
+static void write_ascii_bucket_context (uint64_t, uint32_t, uint64_t, unsigned, pgm_string_t*);
+static void write_ascii_bucket_value (uint32_t, double, pgm_string_t*);
+static double get_peak_bucket_size (const struct pgm_histinfo_t*);
+static double get_bucket_size (const uint32_t, const unsigned);
+static pgm_string_t* get_ascii_bucket_range (unsigned);
 
 
-void
-pgm_histogram_add (
-	pgm_histogram_t*	histogram,
-	int			value
+/* lower bound of bucket i, the inverse of pgm_histogram_index().
+ */
+
+uint32_t
+pgm_histinfo_value (
+	const unsigned		i
 	)
 {
-	if (value > INT_MAX)
-		value = INT_MAX - 1;
-	if (value < 0)
-		value = 0;
-	const unsigned i = bucket_index (histogram, value);
-	pgm_assert_cmpint (value, >=, histogram->ranges[ i ]);
-	pgm_assert_cmpint (value,  <, histogram->ranges[ i + 1 ]);
-	accumulate (histogram, value, 1, i);
+	unsigned shift;
+
+	if (i < PGM_HISTOGRAM_SUB_COUNT)
+		return i;
+	shift = (i / PGM_HISTOGRAM_HALF_COUNT) - 1;
+	return (uint32_t)(PGM_HISTOGRAM_HALF_COUNT + (i % PGM_HISTOGRAM_HALF_COUNT)) << shift;
 }
 
-void
-pgm_histogram_write_html_graph_all (
-	pgm_string_t*		string
+/* value below which q percent of the samples fall, reported as the upper
+ * bound of the bucket holding that rank and clamped to the recorded range.
+ *
+ * returns 0 for an empty histogram.
+ */
+
+uint32_t
+pgm_histinfo_percentile (
+	const struct pgm_histinfo_t* const	info,
+	const double				q
 	)
 {
-	if (!pgm_histograms)
-		return;
-	pgm_slist_t* snapshot = pgm_histograms;
-	while (snapshot) {
-		pgm_histogram_t* histogram = snapshot->data;
-		pgm_histogram_write_html_graph (histogram, string);
-		snapshot = snapshot->next;
+	uint64_t rank, seen = 0;
+
+	pgm_return_val_if_fail (NULL != info, 0);
+	if (0 == info->hi_count)
+		return 0;
+	if (q <= 0.0)
+		return info->hi_min;
+	if (q >= 100.0)
+		return info->hi_max;
+
+	rank = (uint64_t)((q * info->hi_count) / 100.0 + 0.5);
+	if (0 == rank)
+		rank = 1;
+	for (unsigned i = 0; i < PGM_HISTOGRAM_BUCKETS; i++) {
+		seen += info->hi_counts[ i ];
+		if (seen >= rank) {
+			const uint32_t value = (i + 1 < PGM_HISTOGRAM_BUCKETS) ? pgm_histinfo_value (i + 1) - 1 : UINT32_MAX;
+			if (value < info->hi_min)
+				return info->hi_min;
+			return value < info->hi_max ? value : info->hi_max;
+		}
 	}
+	return info->hi_max;
 }
 
-static
+/* add a sample to a histogram shared between threads, every counter is
+ * updated with an atomic operation so that no lock is taken.
+ */
+
 void
-pgm_histogram_write_html_graph (
-	pgm_histogram_t* restrict histogram,
-	pgm_string_t*	 restrict string
+pgm_histogram_add (
+	pgm_histogram_t*	histogram,
+	int			value
 	)
 {
-	pgm_string_append (string, "<PRE>");
-	write_ascii (histogram, "<BR/>", string);
-	pgm_string_append (string, "</PRE>");
+	uint32_t sample;
+
+	if (value < 0)
+		value = 0;
+	sample = (uint32_t)value;
+	pgm_atomic_inc32 (&histogram->counts[ pgm_histogram_index (sample) ]);
+	atomic_min32 (&histogram->min, sample);
+	atomic_max32 (&histogram->max, sample);
+	pgm_atomic_inc32 (&histogram->count);
 }
 
+/* stored minimum is offset by one, zero when empty */
+
 static
 void
-sample_set_accumulate (
-	pgm_sample_set_t*	sample_set,
-	pgm_sample_t		value,
-	pgm_count_t		count,
-	unsigned		i
+atomic_min32 (
+	volatile uint32_t*	atomic,
+	const uint32_t		value
 	)
 {
-	pgm_assert (1 == count || -1 == count);
-	sample_set->counts[ i ] += count;
-	sample_set->sum += count * value;
-	sample_set->square_sum += (count * value) * (int64_t)value;
-	pgm_assert_cmpint (sample_set->counts[ i ], >=, 0);
-	pgm_assert_cmpint (sample_set->sum, >=, 0);
-	pgm_assert_cmpint (sample_set->square_sum, >=, 0);
+	const uint32_t min = (value < UINT32_MAX) ? value + 1 : value;
+	uint32_t current;
+
+	do {
+		current = pgm_atomic_read32 (atomic);
+		if (0 != current && current <= min)
+			return;
+	} while (!pgm_atomic_compare_and_exchange32 (atomic, min, current));
 }
 
 static
-pgm_count_t
-sample_set_total_count (
-	const pgm_sample_set_t*	sample_set
+void
+atomic_max32 (
+	volatile uint32_t*	atomic,
+	const uint32_t		value
 	)
 {
-	pgm_count_t total = 0;
-	for (unsigned i = 0; i < sample_set->counts_len; i++)
-		total += sample_set->counts[ i ];
-	return total;
+	uint32_t current;
+
+	do {
+		current = pgm_atomic_read32 (atomic);
+		if (current >= value)
+			return;
+	} while (!pgm_atomic_compare_and_exchange32 (atomic, value, current));
 }
 
 void
@@ -132,102 +167,101 @@ pgm_histogram_init (
 	pgm_histogram_t*	histogram
 	)
 {
-	if (histogram->declared_min <= 0)
-		histogram->declared_min = 1;
-	pgm_assert_cmpint (histogram->declared_min, >, 0);
-	histogram->declared_max = INT_MAX - 1;
-	pgm_assert_cmpint (histogram->declared_min, <=, histogram->declared_max);
-	pgm_assert_cmpuint (1, <, histogram->bucket_count);
-	set_bucket_range (histogram, histogram->bucket_count, INT_MAX);
-	initialize_bucket_range (histogram);
-
+	while (!pgm_atomic_compare_and_exchange32 (&histograms_lock, 1, 0));
+	if (!histogram->is_registered) {
 /* register with global list */
-	histogram->histograms_link.data = histogram;
-	histogram->histograms_link.next = pgm_histograms;
-	pgm_histograms = &histogram->histograms_link;
-	histogram->is_registered = TRUE;
+		histogram->histograms_link.data = histogram;
+		histogram->histograms_link.next = pgm_histograms;
+		pgm_histograms = &histogram->histograms_link;
+		histogram->is_registered = TRUE;
+	}
+	pgm_atomic_write32 (&histograms_lock, 0);
 }
 
-static
+/* add the counters of a single-writer histogram shard into a snapshot, the
+ * shard may be concurrently updated.
+ */
+
+PGM_GNUC_INTERNAL
 void
-set_bucket_range (
-	pgm_histogram_t*	histogram,
-	unsigned		i,
-	pgm_sample_t		value
+pgm_histogram_merge (
+	struct pgm_histinfo_t* restrict	info,
+	const pgm_histogram_t* restrict	histogram
 	)
 {
-	histogram->ranges[ i ] = value;
+	uint64_t count = 0;
+
+	pgm_assert (NULL != info);
+	pgm_assert (NULL != histogram);
+
+/* sample count is published last, bucket totals are at least as current */
+	if (0 == pgm_atomic_read32 (&histogram->count))
+		return;
+	for (unsigned i = 0; i < PGM_HISTOGRAM_BUCKETS; i++) {
+		const uint32_t current = pgm_atomic_read32 (&histogram->counts[ i ]);
+		info->hi_counts[ i ] += current;
+		count += current;
+	}
+	const uint32_t min = pgm_atomic_read32 (&histogram->min);
+	const uint32_t max = pgm_atomic_read32 (&histogram->max);
+	if (min > 0 && (0 == info->hi_count || min - 1 < info->hi_min))
+		info->hi_min = min - 1;
+	if (max > info->hi_max)
+		info->hi_max = max;
+	info->hi_count += count;
 }
 
-static
+/* fold a shard into another owned by the caller, e.g. the totals of an
+ * expiring peer into its socket.
+ */
+
+PGM_GNUC_INTERNAL
 void
-initialize_bucket_range (
-	pgm_histogram_t*	histogram
+pgm_histogram_accumulate (
+	pgm_histogram_t*	 restrict dst,
+	const pgm_histogram_t* restrict src
 	)
 {
-	const double log_max = log ((double)histogram->declared_max);
-	double log_ratio;
-	double log_next;
-	unsigned i = 1;
-	pgm_sample_t current = histogram->declared_min;
-
-	set_bucket_range (histogram, i, current);
-	while (histogram->bucket_count > ++i) {
-		const double log_current = log ((double)current);
-		log_ratio = (log_max - log_current) / (histogram->bucket_count - i);
-		log_next = log_current + log_ratio;
-#ifdef __GNUC__	
-		const int next = floor (exp (log_next) + 0.5);
-#else
-/* bad-function-cast warning in GCC */
-		const int next = (int)(floor (exp (log_next) + 0.5));
-#endif
-		if (next > current)
-			current = next;
-		else
-			current++;
-		set_bucket_range (histogram, i, current);
-	}
-	pgm_assert_cmpuint (histogram->bucket_count, ==, i);
+	pgm_assert (NULL != dst);
+	pgm_assert (NULL != src);
+
+	if (0 == src->count)
+		return;
+	for (unsigned i = 0; i < PGM_HISTOGRAM_BUCKETS; i++)
+		if (src->counts[ i ])
+			pgm_atomic_write32 (&dst->counts[ i ], dst->counts[ i ] + src->counts[ i ]);
+	if (0 == dst->min || src->min < dst->min)
+		pgm_atomic_write32 (&dst->min, src->min);
+	if (src->max > dst->max)
+		pgm_atomic_write32 (&dst->max, src->max);
+	pgm_atomic_write32 (&dst->count, dst->count + src->count);
 }
 
-static
-unsigned
-bucket_index (
-	const pgm_histogram_t*	histogram,
-	const pgm_sample_t	value
+void
+pgm_histogram_write_html_graph_all (
+	pgm_string_t*		string
 	)
 {
-	pgm_assert_cmpint (histogram->ranges[0], <=, value);
-	pgm_assert_cmpint (histogram->ranges[ histogram->bucket_count ], >, value);
-	unsigned under = 0;
-	unsigned over = histogram->bucket_count;
-	unsigned mid;
-
-	do {
-		pgm_assert_cmpuint (over, >=, under);
-		mid = ((unsigned)under + (unsigned)over) >> 1;
-		if (mid == under)
-			break;
-		if (histogram->ranges[ mid ] <= value)
-			under = mid;
-		else
-			over = mid;
-	} while (TRUE);
-	pgm_assert (histogram->ranges[ mid ] <= value && histogram->ranges[ mid + 1] > value);
-	return mid;
+	if (!pgm_histograms)
+		return;
+	pgm_slist_t* snapshot = pgm_histograms;
+	while (snapshot) {
+		pgm_histogram_t* histogram = snapshot->data;
+		pgm_histogram_write_html_graph (histogram, string);
+		snapshot = snapshot->next;
+	}
 }
 
 static
 void
-accumulate (
-	pgm_histogram_t*	histogram,
-	pgm_sample_t		value,
-	pgm_count_t		count,
-	unsigned		i
+pgm_histogram_write_html_graph (
+	pgm_histogram_t* restrict histogram,
+	pgm_string_t*	 restrict string
 	)
 {
-	sample_set_accumulate (&histogram->sample, value, count, i);
+	pgm_string_append (string, "<PRE>");
+	write_ascii (histogram, "<BR/>", string);
+	pgm_string_append (string, "</PRE>");
 }
 
 static
@@ -238,33 +272,25 @@ write_ascii (
 	pgm_string_t*	 restrict output
 	)
 {
-	pgm_count_t snapshot_counts[ histogram->sample.counts_len ];
-	pgm_sample_set_t snapshot = {
-		.counts		= snapshot_counts,
-		.counts_len	= histogram->sample.counts_len,
-		.sum		= histogram->sample.sum,
-		.square_sum	= histogram->sample.square_sum
-	};
-	memcpy (snapshot_counts, histogram->sample.counts, sizeof(pgm_count_t) * histogram->sample.counts_len);
-
-	pgm_count_t sample_count = sample_set_total_count (&snapshot);
-	write_ascii_header (histogram, &snapshot, sample_count, output);
+	struct pgm_histinfo_t snapshot;
+
+	memset (&snapshot, 0, sizeof(snapshot));
+	pgm_histogram_merge (&snapshot, histogram);
+
+	write_ascii_header (histogram, &snapshot, output);
 	pgm_string_append (output, newline);
+	if (0 == snapshot.hi_count)
+		return;
 
-	double max_size = get_peak_bucket_size (histogram, &snapshot);
-	unsigned largest_non_empty_bucket = histogram->bucket_count - 1;
-	while (0 == snapshot.counts[ largest_non_empty_bucket ])
-	{
-		if (0 == largest_non_empty_bucket)
-			break;
-		largest_non_empty_bucket--;
-	}
+	const double max_size = get_peak_bucket_size (&snapshot);
+	const unsigned first = pgm_histogram_index (snapshot.hi_min);
+	const unsigned last  = pgm_histogram_index (snapshot.hi_max);
 
 	int print_width = 1;
-	for (unsigned i = 0; i < histogram->bucket_count; ++i)
+	for (unsigned i = first; i <= last; ++i)
 	{
-		if (snapshot.counts[ i ]) {
-			pgm_string_t* bucket_range = get_ascii_bucket_range (histogram, i);
+		if (snapshot.hi_counts[ i ]) {
+			pgm_string_t* bucket_range = get_ascii_bucket_range (i);
 			const int width = (int)(bucket_range->len + 1);
 			pgm_string_free (bucket_range, TRUE);
 			if (width > print_width)
@@ -272,21 +298,21 @@ write_ascii (
 		}
 	}
 
-	int64_t remaining = sample_count;
-	int64_t past = 0;
-	for (unsigned i = 0; i < histogram->bucket_count; ++i)
+	uint64_t remaining = snapshot.hi_count;
+	uint64_t past = 0;
+	for (unsigned i = first; i <= last; ++i)
 	{
-		pgm_count_t current = snapshot.counts[ i ];
+		const uint32_t current = snapshot.hi_counts[ i ];
 		remaining -= current;
-		pgm_string_t* bucket_range = get_ascii_bucket_range (histogram, i);
+		pgm_string_t* bucket_range = get_ascii_bucket_range (i);
 		pgm_string_append_printf (output, "%*s ", print_width, bucket_range->str);
 		pgm_string_free (bucket_range, TRUE);
 		if (0 == current &&
-		    i < histogram->bucket_count - 1 &&
-		    0 == snapshot.counts[ i + 1 ])
+		    i < last &&
+		    0 == snapshot.hi_counts[ i + 1 ])
 		{
-			while (i < histogram->bucket_count - 1 &&
-			       0 == snapshot.counts[ i + 1 ])
+			while (i < last &&
+			       0 == snapshot.hi_counts[ i + 1 ])
 			{
 				i++;
 			}
@@ -295,7 +321,7 @@ write_ascii (
 			continue;
 		}
 
-		const double current_size = get_bucket_size (histogram, current, i);
+		const double current_size = get_bucket_size (current, i);
 		write_ascii_bucket_graph (current_size, max_size, output);
 		write_ascii_bucket_context (past, current, remaining, i, output);
 		pgm_string_append (output, newline);
@@ -306,24 +332,23 @@ write_ascii (
 static
 void
 write_ascii_header (
-	pgm_histogram_t*  restrict histogram,
-	pgm_sample_set_t* restrict sample_set,
-	pgm_count_t		   sample_count,
-	pgm_string_t*	  restrict output
+	pgm_histogram_t*	     restrict histogram,
+	const struct pgm_histinfo_t* restrict info,
+	pgm_string_t*		     restrict output
 	)
 {
 	pgm_string_append_printf (output,
-				 "Histogram: %s recorded %d samples",
+				 "Histogram: %s recorded %" PRIu64 " samples",
 				 histogram->histogram_name ? histogram->histogram_name : "(null)",
-				 sample_count);
-	if (sample_count > 0) {
-		const double average  = (float)(sample_set->sum) / sample_count;
-		const double variance = (float)(sample_set->square_sum) / sample_count
-						- average * average;
-		const double standard_deviation = sqrt (variance);
+				 info->hi_count);
+	if (info->hi_count > 0) {
 		pgm_string_append_printf (output,
-					 ", average = %.1f, standard deviation = %.1f",
-					 average, standard_deviation);
+					 ", min = %" PRIu32 ", p50 = %" PRIu32 ", p90 = %" PRIu32 ", p99 = %" PRIu32 ", max = %" PRIu32,
+					 info->hi_min,
+					 pgm_histinfo_percentile (info, 50.0),
+					 pgm_histinfo_percentile (info, 90.0),
+					 pgm_histinfo_percentile (info, 99.0),
+					 info->hi_max);
 	}
 }
 
@@ -348,9 +373,9 @@ write_ascii_bucket_graph (
 static
 void
 write_ascii_bucket_context (
-	int64_t			past,
-	pgm_count_t		current,
-	int64_t			remaining,
+	uint64_t		past,
+	uint32_t		current,
+	uint64_t		remaining,
 	unsigned		i,
 	pgm_string_t*		output
 	)
@@ -366,24 +391,23 @@ write_ascii_bucket_context (
 static
 void
 write_ascii_bucket_value (
-	pgm_count_t		current,
+	uint32_t		current,
 	double			scaled_sum,
 	pgm_string_t*		output
 	)
 {
-	pgm_string_append_printf (output, " (%d = %3.1f%%)", current, current/scaled_sum);
+	pgm_string_append_printf (output, " (%" PRIu32 " = %3.1f%%)", current, current/scaled_sum);
 }
 
 static
 double
 get_peak_bucket_size (
-	const pgm_histogram_t*	restrict histogram,
-	const pgm_sample_set_t* restrict sample_set
+	const struct pgm_histinfo_t*	info
 	)
 {
 	double max_size = 0;
-	for (unsigned i = 0; i < histogram->bucket_count; i++) {
-		const double current_size = get_bucket_size (histogram, sample_set->counts[ i ], i);
+	for (unsigned i = 0; i < PGM_HISTOGRAM_BUCKETS; i++) {
+		const double current_size = get_bucket_size (info->hi_counts[ i ], i);
 		if (current_size > max_size)
 			max_size = current_size;
 	}
@@ -393,14 +417,14 @@ get_peak_bucket_size (
 static
 double
 get_bucket_size (
-	const pgm_histogram_t*	histogram,
-	const pgm_count_t	current,
+	const uint32_t		current,
 	const unsigned		i
 	)
 {
-	pgm_assert_cmpint (histogram->ranges[ i + 1 ], >, histogram->ranges[ i ]);
 	static const double kTransitionWidth = 5;
-	double denominator = histogram->ranges[ i + 1 ] - histogram->ranges[ i ];
+	double denominator = (i + 1 < PGM_HISTOGRAM_BUCKETS) ?
+		(double)pgm_histinfo_value (i + 1) - pgm_histinfo_value (i) :
+		(double)UINT32_MAX - pgm_histinfo_value (i);
 	if (denominator > kTransitionWidth)
 		denominator = kTransitionWidth;
 	return current / denominator;
@@ -409,12 +433,11 @@ get_bucket_size (
 static
 pgm_string_t*
 get_ascii_bucket_range (
-	pgm_histogram_t*	histogram,
 	unsigned		i
 	)
 {
 	pgm_string_t* result = pgm_string_new (NULL);
-	pgm_string_printf (result, "%d", histogram->ranges[ i ]);
+	pgm_string_printf (result, "%" PRIu32, pgm_histinfo_value (i));
 	return result;
 }
 
@@ -0,0 +1,111 @@
+/* vim:ts=8:sts=4:sw=4:noai:noexpandtab
+ *
+ * process-wide shared raw receive sockets.
+ *
+ * Copyright (c) 2010-2011 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#	pragma once
+#endif
+#ifndef __PGM_IMPL_DEMUX_H__
+#define __PGM_IMPL_DEMUX_H__
+
+typedef struct pgm_demux_t pgm_demux_t;
+typedef struct pgm_demux_member_t pgm_demux_member_t;
+
+#ifndef _WIN32
+#	include <sys/socket.h>
+#endif
+#include <impl/framework.h>
+
+PGM_BEGIN_DECLS
+
+/* parsed packets held per member socket awaiting its next receive call */
+#ifndef PGM_DEMUX_QUEUE_LEN
+#	define PGM_DEMUX_QUEUE_LEN	256
+#endif
+
+struct pgm_demux_slot_t {
+	struct pgm_sk_buff_t*		skb;
+	struct sockaddr_storage		addr[2];		/* source, destination */
+};
+
+struct pgm_demux_member_t {
+	pgm_demux_t*			demux;
+	struct pgm_sock_t*		sock;
+	struct pgm_demux_slot_t*	queue;			/* ring of PGM_DEMUX_QUEUE_LEN */
+	unsigned			queue_head;
+	unsigned			queue_len;
+	bool				is_notified;		/* pending_notify sent for queue */
+	uint64_t			cumulative_dropped;	/* queue overflow */
+#ifdef HAVE_EPOLL_CTL
+	int				epoll_fd;		/* private set holding the shared socket */
+#endif
+};
+
+/* one raw socket per address family and bound interface, any member socket
+ * reading the shared socket routes packets for other members to their queues.
+ */
+struct pgm_demux_t {
+	sa_family_t			family;
+	struct sockaddr_storage		addr;			/* bound interface */
+	SOCKET				recv_sock;
+	pgm_mutex_t			mutex;			/* members, queues and reads of recv_sock */
+	pgm_slist_t*			members;
+	unsigned			ref_count;
+	uint16_t			max_tpdu;		/* largest of members */
+	size_t				rcvbuf;			/* largest of members */
+	struct pgm_sk_buff_t*		rx_buffer;		/* unused read buffer */
+};
+
+PGM_GNUC_INTERNAL void pgm_demux_init (void);
+PGM_GNUC_INTERNAL void pgm_demux_shutdown (void);
+PGM_GNUC_INTERNAL pgm_demux_member_t* pgm_demux_attach (struct pgm_sock_t*restrict, pgm_error_t**restrict) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL void pgm_demux_detach (pgm_demux_member_t*);
+PGM_GNUC_INTERNAL bool pgm_demux_push (pgm_demux_member_t*restrict, struct pgm_sk_buff_t*restrict, const struct sockaddr*restrict, const struct sockaddr*restrict);
+PGM_GNUC_INTERNAL struct pgm_sk_buff_t* pgm_demux_pop (pgm_demux_member_t*restrict, struct sockaddr*restrict, socklen_t, struct sockaddr*restrict, socklen_t);
+PGM_GNUC_INTERNAL void pgm_demux_rearm (pgm_demux_member_t*);
+
+static inline
+SOCKET
+pgm_demux_get_socket (
+	const pgm_demux_member_t* const	member
+	)
+{
+	return member->demux->recv_sock;
+}
+
+#ifdef HAVE_EPOLL_CTL
+/* descriptor readable with the shared socket unique to member, registered in
+ * application epoll sets in place of the shared socket so that each member
+ * carries its own event data and leaves the set on close.
+ */
+
+static inline
+int
+pgm_demux_get_epoll_socket (
+	const pgm_demux_member_t* const	member
+	)
+{
+	return member->epoll_fd;
+}
+#endif
+
+PGM_END_DECLS
+
+#endif /* __PGM_IMPL_DEMUX_H__ */
@@ -69,6 +69,7 @@
 #include <impl/rate_control.h>
 #include <impl/reed_solomon.h>
 #include <impl/security.h>
+#include <impl/skbuff.h>
 #include <impl/slist.h>
 #include <impl/sn.h>
 #include <impl/sockaddr.h>
@@ -76,6 +77,7 @@
 #include <impl/thread.h>
 #include <impl/time.h>
 #include <impl/tsi.h>
+#include <impl/tsitable.h>
 #include <impl/wsastrerror.h>
 
 #undef __PGM_IMPL_FRAMEWORK_H_INSIDE__
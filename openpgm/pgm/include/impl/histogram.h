@@ -30,74 +30,48 @@
 #define __PGM_IMPL_HISTOGRAM_H__
 
 #include <pgm/types.h>
+#include <pgm/atomic.h>
+#include <pgm/socket.h>
 #include <pgm/time.h>
+#include <impl/math.h>
 #include <impl/slist.h>
 #include <impl/string.h>
 
 PGM_BEGIN_DECLS
 
-typedef int pgm_sample_t;
-typedef int pgm_count_t;
+#define PGM_HISTOGRAM_SUB_COUNT		(1 << PGM_HISTOGRAM_SUB_BITS)
+#define PGM_HISTOGRAM_HALF_COUNT	(1 << (PGM_HISTOGRAM_SUB_BITS - 1))
 
-struct pgm_sample_set_t {
-	pgm_count_t*	counts;
-	unsigned	counts_len;
-	int64_t		sum;
-	int64_t		square_sum;
-};
-
-typedef struct pgm_sample_set_t pgm_sample_set_t;
+/* counters are only ever written whole so that any thread may read a
+ * histogram without locking while it is being updated.  min is stored plus
+ * one such that zero marks an empty histogram.
+ */
 
 struct pgm_histogram_t {
 	const char* restrict	histogram_name;
-	unsigned		bucket_count;
-	pgm_sample_t		declared_min;
-	pgm_sample_t		declared_max;
-	pgm_sample_t* restrict	ranges;
-	pgm_sample_set_t	sample;
+	volatile uint32_t	counts[ PGM_HISTOGRAM_BUCKETS ];
+	volatile uint32_t	count;
+	volatile uint32_t	min;
+	volatile uint32_t	max;
 	bool			is_registered;
 	pgm_slist_t		histograms_link;
 };
 
 typedef struct pgm_histogram_t pgm_histogram_t;
 
-#define PGM_HISTOGRAM_DEFINE(name, minimum, maximum, count) \
-		static pgm_count_t counts[ (count) ]; \
-		static pgm_sample_t ranges[ (count) + 1 ]; \
-		static pgm_histogram_t counter = { \
-			.histogram_name		= (name), \
-			.bucket_count		= (count), \
-			.declared_min		= (minimum), \
-			.declared_max		= (maximum), \
-			.ranges			= ranges, \
-			.sample = { \
-				.counts 		= counts, \
-				.counts_len		= (count), \
-				.sum			= 0, \
-				.square_sum		= 0 \
-			}, \
-			.is_registered		= FALSE \
-		}
-
 #ifdef USE_HISTOGRAMS
 
 #	define PGM_HISTOGRAM_TIMES(name, sample) do { \
-		PGM_HISTOGRAM_DEFINE(name, pgm_msecs(1), pgm_secs(10), 50); \
-		if (!counter.is_registered) { \
-			memset (counts, 0, sizeof(counts)); \
-			memset (ranges, 0, sizeof(ranges)); \
+		static pgm_histogram_t counter = { .histogram_name = (name) }; \
+		if (!counter.is_registered) \
 			pgm_histogram_init (&counter); \
-		} \
 		pgm_histogram_add_time (&counter, sample); \
 	} while (0)
 
 #	define PGM_HISTOGRAM_COUNTS(name, sample) do { \
-		PGM_HISTOGRAM_DEFINE(name, 1, 1000000, 50); \
-		if (!counter.is_registered) { \
-			memset (counts, 0, sizeof(counts)); \
-			memset (ranges, 0, sizeof(ranges)); \
+		static pgm_histogram_t counter = { .histogram_name = (name) }; \
+		if (!counter.is_registered) \
 			pgm_histogram_init (&counter); \
-		} \
 		pgm_histogram_add (&counter, (sample)); \
 	} while (0)
 
@@ -114,6 +88,48 @@ extern pgm_slist_t*	pgm_histograms;
 void pgm_histogram_init (pgm_histogram_t*);
 void pgm_histogram_add (pgm_histogram_t*, int);
 void pgm_histogram_write_html_graph_all (pgm_string_t*);
+PGM_GNUC_INTERNAL void pgm_histogram_merge (struct pgm_histinfo_t*restrict, const pgm_histogram_t*restrict);
+PGM_GNUC_INTERNAL void pgm_histogram_accumulate (pgm_histogram_t*restrict, const pgm_histogram_t*restrict);
+
+/* constant time bucket of a value, the position of the most significant bit
+ * selects the power of two and the following bits the linear step within it.
+ */
+
+static inline
+unsigned
+pgm_histogram_index (
+	const uint32_t		value
+	)
+{
+	unsigned shift;
+
+	if (value < PGM_HISTOGRAM_SUB_COUNT)
+		return value;
+	shift = pgm_log2 (value) - PGM_HISTOGRAM_SUB_BITS + 1;
+	return (shift * PGM_HISTOGRAM_HALF_COUNT) + (value >> shift);
+}
+
+/* add a sample to a histogram with a single writer, i.e. a shard owned by a
+ * peer or socket and updated under its receiver lock.
+ */
+
+static inline
+void
+pgm_histogram_record (
+	pgm_histogram_t*const	histogram,
+	const uint32_t		value
+	)
+{
+	const unsigned i = pgm_histogram_index (value);
+	const uint32_t min = (value < UINT32_MAX) ? value + 1 : value;
+
+	pgm_atomic_write32 (&histogram->counts[ i ], histogram->counts[ i ] + 1);
+	if (0 == histogram->min || min < histogram->min)
+		pgm_atomic_write32 (&histogram->min, min);
+	if (value > histogram->max)
+		pgm_atomic_write32 (&histogram->max, value);
+	pgm_atomic_write32 (&histogram->count, histogram->count + 1);
+}
 
 static inline
 void
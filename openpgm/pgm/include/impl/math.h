@@ -29,6 +29,9 @@
 #ifndef __PGM_IMPL_MATH_H__
 #define __PGM_IMPL_MATH_H__
 
+#if defined( _MSC_VER )
+#	include <intrin.h>
+#endif
 #include <pgm/types.h>
 
 PGM_BEGIN_DECLS
@@ -53,6 +56,31 @@ pgm_power2_log2 (
 	return r;
 }
 
+/* index of most significant set bit, v > 0
+ */
+
+static inline unsigned pgm_log2 (uint32_t) PGM_GNUC_CONST;
+
+static inline
+unsigned
+pgm_log2 (
+	uint32_t	v
+	)
+{
+#if defined( __GNUC__ ) && ( __GNUC__ * 100 + __GNUC_MINOR__ >= 304 )
+	return 31 - __builtin_clz (v);
+#elif defined( _MSC_VER )
+	unsigned long r;
+	_BitScanReverse (&r, v);
+	return (unsigned)r;
+#else
+	unsigned r = 0;
+	while (v >>= 1)
+		r++;
+	return r;
+#endif
+}
+
 /* nearest power of 2
  */
 
@@ -25,6 +25,8 @@
 #ifndef __PGM_IMPL_NET_H__
 #define __PGM_IMPL_NET_H__
 
+struct pgm_zerocopy_t;
+
 #ifndef _WIN32
 #	include <sys/socket.h>
 #endif
@@ -32,7 +34,13 @@
 
 PGM_BEGIN_DECLS
 
-PGM_GNUC_INTERNAL ssize_t pgm_sendto_hops (pgm_sock_t*restrict, bool, pgm_rate_t*restrict, bool, int, const void*restrict, size_t, const struct sockaddr*restrict, socklen_t);
+PGM_GNUC_INTERNAL ssize_t pgm_sendto_hops (pgm_sock_t*restrict, bool, pgm_rate_t*restrict, pgm_time_t*restrict, bool, int, const void*restrict, size_t, const struct sockaddr*restrict, socklen_t);
+PGM_GNUC_INTERNAL ssize_t pgm_sendto_skb (pgm_sock_t*restrict, bool, pgm_rate_t*restrict, pgm_time_t*restrict, bool, struct pgm_sk_buff_t*restrict, const struct sockaddr*restrict, socklen_t);
+PGM_GNUC_INTERNAL ssize_t pgm_sendto_repair (pgm_sock_t*restrict, bool, pgm_rate_t*restrict, pgm_time_t*restrict, struct pgm_sk_buff_t*restrict, const struct sockaddr*restrict, socklen_t);
+PGM_GNUC_INTERNAL ssize_t pgm_sendmmsg (pgm_sock_t*restrict, bool, pgm_rate_t*restrict, pgm_time_t*restrict, struct pgm_sk_buff_t**restrict, unsigned, const struct sockaddr*restrict, socklen_t);
+PGM_GNUC_INTERNAL void pgm_zerocopy_create (struct pgm_zerocopy_t*, unsigned);
+PGM_GNUC_INTERNAL void pgm_zerocopy_destroy (struct pgm_zerocopy_t*);
+PGM_GNUC_INTERNAL void pgm_zerocopy_reap (pgm_sock_t*);
 PGM_GNUC_INTERNAL int pgm_set_nonblocking (SOCKET fd[2]);
 
 static inline
@@ -41,6 +49,7 @@ pgm_sendto (
 	pgm_sock_t*restrict		sock,
 	bool				use_rate_limit,
 	pgm_rate_t*restrict		minor_rate_control,
+	pgm_time_t*restrict		now,
 	bool				use_router_alert,
 	const void*restrict		buf,
 	size_t				len,
@@ -48,7 +57,7 @@ pgm_sendto (
 	socklen_t			tolen
 	)
 {
-	return pgm_sendto_hops (sock, use_rate_limit, minor_rate_control, use_router_alert, -1, buf, len, to, tolen);
+	return pgm_sendto_hops (sock, use_rate_limit, minor_rate_control, now, use_router_alert, -1, buf, len, to, tolen);
 }
 
 PGM_END_DECLS
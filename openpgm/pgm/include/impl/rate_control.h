@@ -44,13 +44,18 @@ struct pgm_rate_t {
 
 	ssize_t		rate_limit;		/* signed for math */
 	pgm_time_t	last_rate_check;
+	bool		is_paced;		/* evenly spaced packets instead of token bucket */
+	uint64_t	next_departure;		/* paced: earliest departure of next packet in nanoseconds */
+	bool		is_single_threaded;	/* spinlock elided */
 	pgm_spinlock_t	spinlock;
 };
 
 PGM_GNUC_INTERNAL void pgm_rate_create (pgm_rate_t*, const ssize_t, const size_t, const uint16_t);
 PGM_GNUC_INTERNAL void pgm_rate_destroy (pgm_rate_t*);
-PGM_GNUC_INTERNAL bool pgm_rate_check2 (pgm_rate_t*, pgm_rate_t*, const size_t, const bool);
-PGM_GNUC_INTERNAL bool pgm_rate_check (pgm_rate_t*, const size_t, const bool);
+PGM_GNUC_INTERNAL void pgm_rate_set_pacing (pgm_rate_t*, const bool);
+PGM_GNUC_INTERNAL void pgm_rate_set_single_threaded (pgm_rate_t*, const bool);
+PGM_GNUC_INTERNAL bool pgm_rate_check2 (pgm_rate_t*, pgm_rate_t*, const size_t, const bool, pgm_time_t*);
+PGM_GNUC_INTERNAL bool pgm_rate_check (pgm_rate_t*, const size_t, const bool, pgm_time_t*);
 PGM_GNUC_INTERNAL pgm_time_t pgm_rate_remaining2 (pgm_rate_t*, pgm_rate_t*, const size_t);
 PGM_GNUC_INTERNAL pgm_time_t pgm_rate_remaining (pgm_rate_t*, const size_t);
 
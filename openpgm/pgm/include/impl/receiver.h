@@ -98,6 +98,8 @@ struct pgm_peer_t {
 
 	pgm_rxw_t*      restrict      	window;
 	pgm_list_t			peers_link;
+	pgm_time_t			next_expiry;		/* earliest pending timer */
+	unsigned			heap_index;		/* position in pgm_sock_t::peers_heap */
 	pgm_slist_t			pending_link;
 
 	unsigned			is_fec_enabled:1;
@@ -123,13 +125,16 @@ struct pgm_peer_t {
 
 	uint32_t			min_fail_time;
 	uint32_t			max_fail_time;
+	pgm_histogram_t			delivery_latency;	/* in microseconds, written by receiver only */
+	pgm_histogram_t			queue_latency;		/* kernel arrival to read */
 };
 
 PGM_GNUC_INTERNAL pgm_peer_t* pgm_new_peer (pgm_sock_t*const restrict, const pgm_tsi_t*const restrict, const struct sockaddr*const restrict, const socklen_t, const struct sockaddr*const restrict, const socklen_t, const pgm_time_t);
 PGM_GNUC_INTERNAL void pgm_peer_unref (pgm_peer_t*);
-PGM_GNUC_INTERNAL int pgm_flush_peers_pending (pgm_sock_t*const restrict, struct pgm_msgv_t**restrict, const struct pgm_msgv_t*const, size_t*const restrict, unsigned*const restrict);
+PGM_GNUC_INTERNAL int pgm_flush_peers_pending (pgm_sock_t*const restrict, struct pgm_msgv_t**restrict, const struct pgm_msgv_t*const, size_t*const restrict, unsigned*const restrict, const pgm_time_t);
 PGM_GNUC_INTERNAL bool pgm_peer_has_pending (pgm_peer_t*const) PGM_GNUC_WARN_UNUSED_RESULT;
 PGM_GNUC_INTERNAL void pgm_peer_set_pending (pgm_sock_t*const restrict, pgm_peer_t*const restrict);
+PGM_GNUC_INTERNAL void pgm_peer_update_timer (pgm_sock_t*const restrict, pgm_peer_t*const restrict);
 PGM_GNUC_INTERNAL bool pgm_check_peer_state (pgm_sock_t*const, const pgm_time_t);
 PGM_GNUC_INTERNAL void pgm_set_reset_error (pgm_sock_t*const restrict, pgm_peer_t*const restrict, struct pgm_msgv_t*const restrict);
 PGM_GNUC_INTERNAL pgm_time_t pgm_min_receiver_expiry (pgm_sock_t*, pgm_time_t) PGM_GNUC_WARN_UNUSED_RESULT;
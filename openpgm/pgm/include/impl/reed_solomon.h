@@ -35,17 +35,35 @@ typedef struct pgm_rs_t pgm_rs_t;
 
 PGM_BEGIN_DECLS
 
+#define PGM_RS_DEFAULT_N	255
+
+/* inverted recovery matrices retained per code, keyed by erasure pattern.
+ */
+#define PGM_RS_DECODE_PLANS	64
+
+struct pgm_rs_plan_t {
+	uint32_t	hash;		/* of offsets[] */
+	uint32_t	last_used;	/* LRU clock, 0 for an empty plan */
+	uint8_t*	offsets;	/* key, length rs_t::k */
+	pgm_gf8_t*	rows;		/* inverse rows of erased packets, in offset order */
+	uint8_t		row_count;
+	uint8_t		row_capacity;
+};
+
 struct pgm_rs_t {
 	uint8_t		n, k;		/* RS(n, k) */
 	pgm_gf8_t*	GM;
 	pgm_gf8_t*	RM;
-};
 
-#define PGM_RS_DEFAULT_N	255
+	uint32_t	plan_clock;
+	uint32_t	plan_hits, plan_misses;
+	struct pgm_rs_plan_t plans[ PGM_RS_DECODE_PLANS ];
+};
 
 PGM_GNUC_INTERNAL void pgm_rs_create (pgm_rs_t*, const uint8_t, const uint8_t);
 PGM_GNUC_INTERNAL void pgm_rs_destroy (pgm_rs_t*);
 PGM_GNUC_INTERNAL void pgm_rs_encode (pgm_rs_t*restrict, const pgm_gf8_t**restrict, const uint8_t, pgm_gf8_t*restrict, const uint16_t);
+PGM_GNUC_INTERNAL void pgm_rs_encode_fold (pgm_rs_t*restrict, const pgm_gf8_t*restrict, const uint8_t, const uint8_t, pgm_gf8_t*restrict, const uint16_t);
 PGM_GNUC_INTERNAL void pgm_rs_decode_parity_inline (pgm_rs_t*restrict, pgm_gf8_t**restrict, const uint8_t*restrict, const uint16_t);
 PGM_GNUC_INTERNAL void pgm_rs_decode_parity_appended (pgm_rs_t*restrict, pgm_gf8_t**restrict, const uint8_t*restrict, const uint16_t);
 
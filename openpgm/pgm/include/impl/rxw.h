@@ -85,6 +85,7 @@ struct pgm_rxw_t {
 	uint32_t		committed_count;	/* but still in window */
 
         uint16_t		max_tpdu;               /* maximum packet size */
+	pgm_skb_pool_t*		skb_pool;		/* packet buffer free-list */
         uint32_t		lead, trail;
         uint32_t		rxw_trail, rxw_trail_init;
 	uint32_t		commit_lead;
@@ -108,6 +109,10 @@ struct pgm_rxw_t {
 	uint32_t		cumulative_losses;
 	uint32_t		bytes_delivered;
 	uint32_t		msgs_delivered;
+	pgm_histogram_t		repair_latency;		/* in microseconds */
+
+	struct pgm_sk_buff_t*	coalesce_skbs;		/* APDUs unpacked by the last read */
+	uint16_t		coalesce_offset;	/* unpacked bytes of commit lead TSDU */
 
 	size_t			size;			/* in bytes */
 	unsigned		alloc;			/* in pkts */
@@ -0,0 +1,66 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * PGM socket buffer pool.
+ *
+ * Copyright (c) 2006-2011 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if !defined (__PGM_IMPL_FRAMEWORK_H_INSIDE__) && !defined (PGM_COMPILATION)
+#	error "Only <framework.h> can be included directly."
+#endif
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#	pragma once
+#endif
+#ifndef __PGM_IMPL_SKBUFF_H__
+#define __PGM_IMPL_SKBUFF_H__
+
+typedef struct pgm_skb_pool_t pgm_skb_pool_t;
+
+#include <pgm/types.h>
+#include <pgm/skbuff.h>
+#include <impl/thread.h>
+
+PGM_BEGIN_DECLS
+
+/* free-list of fixed size buffers, one size class per socket sized to the
+ * maximum TPDU.  buffers remain owned by the pool until released back with
+ * pgm_free_skb(), the pool is freed with the last outstanding buffer.
+ */
+
+struct pgm_skb_pool_t {
+	uint16_t		tpdu_size;		/* size class */
+	unsigned		max_free;		/* limit of cached buffers */
+
+	struct pgm_sk_buff_t*	free_list;		/* linked by pgm_sk_buff_t::link_.next */
+	unsigned		free_len;
+	unsigned		outstanding;		/* buffers in use */
+	unsigned		is_destroyed:1;
+
+	uint64_t		hits;			/* allocations from free-list */
+	uint64_t		misses;			/* allocations from heap */
+
+	pgm_spinlock_t		lock;
+};
+
+PGM_GNUC_INTERNAL pgm_skb_pool_t* pgm_skb_pool_create (const uint16_t, const unsigned) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL void pgm_skb_pool_destroy (pgm_skb_pool_t*);
+PGM_GNUC_INTERNAL struct pgm_sk_buff_t* pgm_skb_pool_alloc (pgm_skb_pool_t*, const uint16_t) PGM_GNUC_WARN_UNUSED_RESULT;
+
+PGM_END_DECLS
+
+#endif /* __PGM_IMPL_SKBUFF_H__ */
@@ -30,6 +30,7 @@ struct pgm_sock_t;
 #include <impl/framework.h>
 #include <impl/txw.h>
 #include <impl/source.h>
+#include <impl/demux.h>
 
 PGM_BEGIN_DECLS
 
@@ -37,6 +38,41 @@ PGM_BEGIN_DECLS
 #	define IP_MAX_MEMBERSHIPS	20
 #endif
 
+/* upper bound of PGM_SEND_BATCH, fragments handed to the kernel in one call */
+#ifndef PGM_MAX_SEND_BATCH
+#	define PGM_MAX_SEND_BATCH	64
+#endif
+
+/* upper bound of PGM_RECV_BATCH, datagrams read from the kernel in one call */
+#ifndef PGM_MAX_RECV_BATCH
+#	define PGM_MAX_RECV_BATCH	64
+#endif
+
+/* UDP GRO coalesced read, one maximum size UDP datagram */
+#ifndef PGM_MAX_GRO_LEN
+#	define PGM_MAX_GRO_LEN		65535
+#endif
+
+/* segments the kernel coalesces into one UDP GRO read, UDP_GRO_CNT_MAX */
+#define PGM_MAX_GRO_SEGMENTS		64
+
+/* upper bound of MSG_ZEROCOPY sends pinned per descriptor */
+#ifndef PGM_MAX_ZEROCOPY_PINS
+#	define PGM_MAX_ZEROCOPY_PINS	4096
+#endif
+
+/* socket buffers handed to the kernel with MSG_ZEROCOPY are held until the
+ * error queue reports their notification id, ids count the successful sends
+ * on one descriptor.
+ */
+typedef struct pgm_zerocopy_t {
+	pgm_mutex_t			mutex;
+	uint32_t			lead;		/* next notification id */
+	uint32_t			trail;		/* oldest pinned id */
+	uint32_t			mask;
+	struct pgm_sk_buff_t**		pinned;		/* NULL once released */
+} pgm_zerocopy_t;
+
 struct pgm_sock_t {
 	sa_family_t			family;				/* communications domain */
 	int				socket_type;
@@ -53,6 +89,11 @@ struct pgm_sock_t {
 	pgm_spinlock_t			txw_spinlock;			/* transmit window */
 	pgm_mutex_t			send_mutex;			/* non-router alert socket */
 	pgm_mutex_t			timer_mutex;			/* next timer expiration */
+	bool				is_single_threaded;		/* above locks elided */
+#ifdef PGM_DEBUG
+	unsigned			owner_depth;			/* elided locks held by owner */
+	pgm_thread_id_t			owner;				/* thread inside the socket */
+#endif
 
 	bool				is_bound;
 	bool				is_connected;
@@ -70,9 +111,13 @@ struct pgm_sock_t {
 	struct sockaddr_storage		send_addr;			/* unicast nla */
 	SOCKET				send_sock;
 	SOCKET				send_with_router_alert_sock;
+	SOCKET				repair_sock;			/* RDATA with lockless window, opened at bind */
 	struct group_source_req 	recv_gsr[IP_MAX_MEMBERSHIPS];	/* sa_family = 0 terminated */
 	unsigned			recv_gsr_len;
-	SOCKET				recv_sock;
+	SOCKET				recv_sock;			/* group membership only with use_demux */
+	struct sockaddr_storage		recv_addr;			/* bound receive interface */
+	bool				use_demux;
+	pgm_demux_member_t*		demux;				/* shared raw receive socket */
 
 	size_t				max_apdu;
 	uint16_t			max_tpdu;
@@ -80,18 +125,25 @@ struct pgm_sock_t {
 	uint16_t			max_tsdu_fragment;
 	size_t				iphdr_len;
 	bool				use_multicast_loop;    	    /* and reuseaddr for UDP encapsulation */
+	bool				use_router_alert;
 	unsigned			hops;
+	int				tos;			    /* 0 = kernel default */
 	unsigned			txw_sqns, txw_secs;
 	unsigned			rxw_sqns, rxw_secs;
 	ssize_t				txw_max_rte, rxw_max_rte;
 	ssize_t				odata_max_rte;
 	ssize_t				rdata_max_rte;
 	size_t				sndbuf, rcvbuf;		    /* setsockopt (SO_SNDBUF/SO_RCVBUF) */
+	unsigned			zerocopy_min;		    /* TPDU length sent with MSG_ZEROCOPY, 0 = disabled */
+	pgm_zerocopy_t			odata_zerocopy;		    /* send_sock */
+	pgm_zerocopy_t			rdata_zerocopy;		    /* repair_sock or send_with_router_alert_sock */
 
 	pgm_txw_t* restrict    		window;
+	bool				use_lockless_txw;	/* publisher and repair thread without txw_spinlock */
 	pgm_rate_t			rate_control;
 	pgm_rate_t			odata_rate_control;
 	pgm_rate_t			rdata_rate_control;
+	bool				use_pacing;		/* evenly spaced packets, kernel pacing where available */
 	pgm_time_t			adv_ivl;		/* advancing with data */
 	unsigned			adv_mode;		/* 0 = time, 1 = data */
 	bool				is_controlled_spm;
@@ -122,8 +174,8 @@ struct pgm_sock_t {
 	pgm_notify_t			ack_notify;
 	pgm_notify_t			rdata_notify;
 
-	pgm_hash_t			last_hash_key;
-	void* restrict			last_hash_value;
+	unsigned			shard_index;		    /* receive shard of shard_count, 0 = all sources */
+	unsigned			shard_count;
 	unsigned			last_commit;
 	size_t				blocklen;		    /* length of buffer blocked */
 	bool				is_apdu_eagain;		    /* writer-lock on window_lock exists as send would block */
@@ -140,7 +192,16 @@ struct pgm_sock_t {
 		unsigned			vector_index;
 		size_t				vector_offset;
 		bool				is_rate_limited;
+		unsigned			batch_len;	/* fragments pending in odata_batch */
+		unsigned			batch_offset;	/* fragments already sent */
 	} pkt_dontwait_state;
+	unsigned			send_batch;		    /* maximum fragments per send call */
+	bool				use_udp_gso;		    /* fragment runs as UDP GSO super-buffers */
+	struct pgm_sk_buff_t*		odata_batch[PGM_MAX_SEND_BATCH];
+	pgm_time_t			coalesce_ivl;		    /* small APDU hold time, 0 = disabled */
+	pgm_time_t			coalesce_expiry;
+	struct pgm_sk_buff_t*		coalesce_skb;		    /* pending TSDU of length-prefixed APDUs */
+	struct pgm_sk_buff_t*		claim_skb;		    /* payload reserved by pgm_send_claim() */
 
 	uint32_t			spm_sqn;
 	unsigned			spm_ambient_interval;	    /* microseconds */
@@ -162,15 +223,33 @@ struct pgm_sock_t {
 	uint8_t				rs_k;
 	uint8_t				rs_proactive_h;		    /* 0 <= proactive-h <= ( n - k ) */
 	uint8_t				tg_sqn_shift;
+	pgm_skb_pool_t*			skb_pool;		    /* packet buffer free-list */
 	struct pgm_sk_buff_t* restrict	rx_buffer;
+	unsigned			recv_batch;		    /* maximum datagrams per receive call */
+	struct pgm_sk_buff_t** restrict	rx_ring;		    /* pre-allocated receive batch */
+	struct sockaddr_storage* restrict rx_ring_addr;		    /* source, destination pairs */
+	unsigned			rx_ring_len;		    /* datagrams in batch */
+	unsigned			rx_ring_index;		    /* next datagram to parse */
+	uint64_t			rx_batch_calls;
+	uint64_t			rx_batch_datagrams;
+	uint64_t			rx_batch_discarded;
+	bool				use_udp_gro;
+	char* restrict			rx_gro_buffer;		    /* UDP GRO coalesced datagrams */
+	bool				use_kernel_tstamp;	    /* SO_TIMESTAMPNS on receive socket */
 
 	pgm_rwlock_t			peers_lock;
-	pgm_hashtable_t* restrict	peers_hashtable;	    /* fast lookup */
+	pgm_tsitable_t* restrict	peers_table;		    /* fast lookup, mutated by receiver only */
 	pgm_list_t*      restrict	peers_list;		    /* easy iteration */
+	pgm_peer_t**     restrict	peers_heap;		    /* min-heap on next timer expiry */
+	unsigned			peers_heap_len;
+	unsigned			peers_heap_alloc;
 	pgm_slist_t*     restrict	peers_pending;		    /* rxw: have or lost data */
 	pgm_notify_t			pending_notify;		    /* timer to rx */
 	bool				is_pending_read;
 	pgm_time_t			next_poll;
+	pgm_histogram_t			repair_latency;		    /* totals of expired peers */
+	pgm_histogram_t			delivery_latency;
+	pgm_histogram_t			queue_latency;
 
 	uint32_t			cumulative_stats[PGM_PC_SOURCE_MAX];
 	uint32_t			snap_stats[PGM_PC_SOURCE_MAX];
@@ -184,6 +263,138 @@ extern pgm_slist_t* pgm_sock_list;
 
 size_t pgm_pkt_offset (bool, sa_family_t);
 
+/* a single-threaded socket is driven by one application thread at a time so
+ * the send, receive and timer paths skip their locks.  debug builds check that
+ * no second thread enters while the first holds an elided lock.  ownership is
+ * released with the outermost lock, i.e. when the API call returns, so the
+ * socket may be handed to another thread between calls provided the
+ * application orders the handoff itself, e.g. with its own mutex or queue.
+ */
+
+static inline
+void
+pgm_sock_check_owner (
+	pgm_sock_t*const	sock
+	)
+{
+#ifdef PGM_DEBUG
+	const pgm_thread_id_t self = pgm_thread_self();
+	if (0 == sock->owner_depth)
+		sock->owner = self;
+	else
+		pgm_assert (pgm_thread_equal (sock->owner, self));
+	sock->owner_depth++;
+#else
+	(void)sock;
+#endif
+}
+
+static inline
+void
+pgm_sock_release_owner (
+	pgm_sock_t*const	sock
+	)
+{
+#ifdef PGM_DEBUG
+	pgm_assert (sock->owner_depth > 0);
+	pgm_assert (pgm_thread_equal (sock->owner, pgm_thread_self()));
+	sock->owner_depth--;
+#else
+	(void)sock;
+#endif
+}
+
+static inline
+bool
+pgm_sock_reader_trylock (
+	pgm_sock_t*const	sock
+	)
+{
+	if (sock->is_single_threaded) {
+		pgm_sock_check_owner (sock);
+		return TRUE;
+	}
+	return pgm_rwlock_reader_trylock (&sock->lock);
+}
+
+static inline
+void
+pgm_sock_reader_unlock (
+	pgm_sock_t*const	sock
+	)
+{
+	if (sock->is_single_threaded)
+		pgm_sock_release_owner (sock);
+	else
+		pgm_rwlock_reader_unlock (&sock->lock);
+}
+
+static inline
+void
+pgm_sock_mutex_lock (
+	pgm_sock_t*const	sock,
+	pgm_mutex_t*const	mutex
+	)
+{
+	if (sock->is_single_threaded)
+		pgm_sock_check_owner (sock);
+	else
+		pgm_mutex_lock (mutex);
+}
+
+static inline
+bool
+pgm_sock_mutex_trylock (
+	pgm_sock_t*const	sock,
+	pgm_mutex_t*const	mutex
+	)
+{
+	if (sock->is_single_threaded) {
+		pgm_sock_check_owner (sock);
+		return TRUE;
+	}
+	return pgm_mutex_trylock (mutex);
+}
+
+static inline
+void
+pgm_sock_mutex_unlock (
+	pgm_sock_t*const	sock,
+	pgm_mutex_t*const	mutex
+	)
+{
+	if (sock->is_single_threaded)
+		pgm_sock_release_owner (sock);
+	else
+		pgm_mutex_unlock (mutex);
+}
+
+static inline
+void
+pgm_sock_spinlock_lock (
+	pgm_sock_t*const	sock,
+	pgm_spinlock_t*const	spinlock
+	)
+{
+	if (sock->is_single_threaded)
+		pgm_sock_check_owner (sock);
+	else
+		pgm_spinlock_lock (spinlock);
+}
+
+static inline
+void
+pgm_sock_spinlock_unlock (
+	pgm_sock_t*const	sock,
+	pgm_spinlock_t*const	spinlock
+	)
+{
+	if (sock->is_single_threaded)
+		pgm_sock_release_owner (sock);
+	else
+		pgm_spinlock_unlock (spinlock);
+}
+
 PGM_END_DECLS
 
 #endif /* __PGM_IMPL_SOCKET_H__ */
@@ -325,6 +325,38 @@ PGM_GNUC_INTERNAL void pgm_rwlock_free (pgm_rwlock_t*);
 PGM_GNUC_INTERNAL void pgm_thread_init (void);
 PGM_GNUC_INTERNAL void pgm_thread_shutdown (void);
 
+/* identity of the calling thread */
+#ifndef _WIN32
+typedef pthread_t		pgm_thread_id_t;
+#else
+typedef DWORD			pgm_thread_id_t;
+#endif
+
+static inline
+pgm_thread_id_t
+pgm_thread_self (void)
+{
+#ifndef _WIN32
+	return pthread_self();
+#else
+	return GetCurrentThreadId();
+#endif
+}
+
+static inline
+bool
+pgm_thread_equal (
+	const pgm_thread_id_t	a,
+	const pgm_thread_id_t	b
+	)
+{
+#ifndef _WIN32
+	return (0 != pthread_equal (a, b));
+#else
+	return (a == b);
+#endif
+}
+
 static inline
 void
 pgm_thread_yield (void)
@@ -30,10 +30,10 @@
 
 PGM_BEGIN_DECLS
 
-PGM_GNUC_INTERNAL bool pgm_timer_prepare (pgm_sock_t*const);
-PGM_GNUC_INTERNAL bool pgm_timer_check (pgm_sock_t*const);
-PGM_GNUC_INTERNAL pgm_time_t pgm_timer_expiration (pgm_sock_t*const);
-PGM_GNUC_INTERNAL bool pgm_timer_dispatch (pgm_sock_t*const);
+PGM_GNUC_INTERNAL bool pgm_timer_prepare (pgm_sock_t*const, const pgm_time_t);
+PGM_GNUC_INTERNAL bool pgm_timer_check (pgm_sock_t*const, const pgm_time_t);
+PGM_GNUC_INTERNAL pgm_time_t pgm_timer_expiration (pgm_sock_t*const, const pgm_time_t);
+PGM_GNUC_INTERNAL bool pgm_timer_dispatch (pgm_sock_t*const, const pgm_time_t);
 
 static inline
 void
@@ -42,7 +42,7 @@ pgm_timer_lock (
 	)
 {
 	if (sock->can_send_data)
-		pgm_mutex_lock (&sock->timer_mutex);
+		pgm_sock_mutex_lock (sock, &sock->timer_mutex);
 }
 
 static inline
@@ -52,7 +52,7 @@ pgm_timer_unlock (
 	)
 {
 	if (sock->can_send_data)
-		pgm_mutex_unlock (&sock->timer_mutex);
+		pgm_sock_mutex_unlock (sock, &sock->timer_mutex);
 }
 
 PGM_END_DECLS
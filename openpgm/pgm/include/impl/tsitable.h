@@ -0,0 +1,160 @@
+/* vim:ts=8:sts=4:sw=4:noai:noexpandtab
+ *
+ * open addressing table of transport session identifiers.
+ *
+ * Copyright (c) 2010-2011 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#if !defined (__PGM_IMPL_FRAMEWORK_H_INSIDE__) && !defined (PGM_COMPILATION)
+#       error "Only <framework.h> can be included directly."
+#endif
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1200)
+#	pragma once
+#endif
+#ifndef __PGM_IMPL_TSITABLE_H__
+#define __PGM_IMPL_TSITABLE_H__
+
+typedef struct pgm_tsitable_t pgm_tsitable_t;
+
+#include <string.h>
+#include <pgm/types.h>
+#include <pgm/tsi.h>
+
+PGM_BEGIN_DECLS
+
+/* direct-mapped front cache */
+#define PGM_TSITABLE_CACHE_BITS		4
+#define PGM_TSITABLE_CACHE_SIZE		(1 << PGM_TSITABLE_CACHE_BITS)
+
+/* TSI packed into one 64-bit word, value NULL marks an empty slot */
+struct pgm_tsientry_t {
+	uint64_t		key;
+	void*			value;
+};
+
+/* lookups and mutations from the owning thread need no lock, other readers
+ * must be serialised against mutations by the caller and may only use
+ * pgm_tsitable_lookup() as the front cache is updated on lookup.
+ */
+struct pgm_tsitable_t {
+	struct pgm_tsientry_t	cache[PGM_TSITABLE_CACHE_SIZE];
+	struct pgm_tsientry_t*	entries;		/* cache line aligned */
+	void*			alloc;
+	uint32_t		mask;			/* size - 1 */
+	uint32_t		nnodes;
+	unsigned		shift;			/* 64 - log2(size) */
+};
+
+PGM_GNUC_INTERNAL pgm_tsitable_t* pgm_tsitable_new (void) PGM_GNUC_WARN_UNUSED_RESULT;
+PGM_GNUC_INTERNAL void pgm_tsitable_destroy (pgm_tsitable_t*);
+PGM_GNUC_INTERNAL void pgm_tsitable_insert (pgm_tsitable_t*restrict, const pgm_tsi_t*restrict, void*restrict);
+PGM_GNUC_INTERNAL bool pgm_tsitable_remove (pgm_tsitable_t*restrict, const pgm_tsi_t*restrict);
+
+static inline
+uint64_t
+_pgm_tsitable_key (
+	const pgm_tsi_t* const	tsi
+	)
+{
+	uint64_t key;
+	memcpy (&key, tsi, sizeof (key));
+	return key;
+}
+
+/* multiplicative hash, table index from the high order bits of the upper word
+ * and cache index from the high order bits of the lower word.
+ */
+static inline
+uint64_t
+_pgm_tsitable_hash (
+	const uint64_t		key
+	)
+{
+	return key * UINT64_C(0x9e3779b97f4a7c15);
+}
+
+static inline
+void*
+_pgm_tsitable_probe (
+	const pgm_tsitable_t* const restrict table,
+	const uint64_t			     key,
+	const uint64_t			     hash
+	)
+{
+	uint32_t i = (uint32_t)(hash >> table->shift);
+	for (;;) {
+		const struct pgm_tsientry_t* entry = &table->entries[i];
+		if (NULL == entry->value)
+			return NULL;
+		if (key == entry->key)
+			return entry->value;
+		i = (i + 1) & table->mask;
+	}
+}
+
+/* lookup without touching the front cache.
+ */
+
+static inline
+void*
+pgm_tsitable_lookup (
+	const pgm_tsitable_t* const restrict table,
+	const pgm_tsi_t*      const restrict tsi
+	)
+{
+	const uint64_t key = _pgm_tsitable_key (tsi);
+	return _pgm_tsitable_probe (table, key, _pgm_tsitable_hash (key));
+}
+
+/* packet fast path, owning thread only.
+ */
+
+static inline
+void*
+pgm_tsitable_lookup_cached (
+	pgm_tsitable_t*  const restrict table,
+	const pgm_tsi_t* const restrict tsi
+	)
+{
+	const uint64_t key  = _pgm_tsitable_key (tsi);
+	const uint64_t hash = _pgm_tsitable_hash (key);
+	struct pgm_tsientry_t* cached = &table->cache[(uint32_t)hash >> (32 - PGM_TSITABLE_CACHE_BITS)];
+	void* value;
+
+	if (PGM_LIKELY(key == cached->key && NULL != cached->value))
+		return cached->value;
+	value = _pgm_tsitable_probe (table, key, hash);
+	if (NULL != value) {
+		cached->key   = key;
+		cached->value = value;
+	}
+	return value;
+}
+
+static inline
+unsigned
+pgm_tsitable_size (
+	const pgm_tsitable_t* const table
+	)
+{
+	return table->nnodes;
+}
+
+PGM_END_DECLS
+
+#endif /* __PGM_IMPL_TSITABLE_H__ */
@@ -42,6 +42,8 @@ struct pgm_txw_state_t {
 
 	uint8_t		pkt_cnt_requested;	/* # parity packets to send */
 	uint8_t		pkt_cnt_sent;		/* # parity packets already sent */
+
+	struct pgm_sk_buff_t**	parity;		/* transmission group lead: precomputed parity */
 };
 
 struct pgm_txw_t {
@@ -50,6 +52,9 @@ struct pgm_txw_t {
 /* option: lockless atomics */
         volatile uint32_t		lead;
         volatile uint32_t		trail;
+	volatile uint32_t		pin;			/* repair thread hazard, window index + 1 */
+	struct pgm_sk_buff_t*		parked;			/* evicted whilst pinned */
+	uint32_t			parked_index;
 
         pgm_queue_t			retransmit_queue;
 
@@ -57,6 +62,16 @@ struct pgm_txw_t {
 	uint8_t				tg_sqn_shift;
 	struct pgm_sk_buff_t* restrict	parity_buffer;
 
+/* option: parity folded in by the publisher */
+	uint8_t				parity_h;		/* precomputed packets per group */
+	uint8_t				parity_folded;		/* original packets folded */
+	uint16_t			parity_length;		/* longest TSDU folded */
+	uint32_t			parity_tg_sqn;
+	unsigned			parity_is_var_pktlen:1;
+	unsigned			parity_is_op_encoded:1;
+	struct pgm_sk_buff_t**		parity_acc;		/* group being published */
+	struct pgm_sk_buff_t**		parity_ready;		/* complete, awaiting lead */
+
 /* Advance with data */
 	pgm_time_t			adv_ivl_expiry;	
 	unsigned			increment_window_naks;
@@ -65,6 +80,7 @@ struct pgm_txw_t {
 
 	unsigned			is_fec_enabled:1;
 	unsigned			adv_mode:1;		/* 0 = advance by time, 1 = advance by data */
+	unsigned			is_lockless:1;		/* single publisher, single repair thread */
 
 	size_t				size;			/* window content size in bytes */
 	unsigned			alloc;			/* length of pdata[] */
@@ -75,6 +91,7 @@ struct pgm_txw_t {
 PGM_GNUC_INTERNAL pgm_txw_t* pgm_txw_create (const pgm_tsi_t*const, const uint16_t, const uint32_t, const unsigned, const ssize_t, const bool, const uint8_t, const uint8_t) PGM_GNUC_WARN_UNUSED_RESULT;
 PGM_GNUC_INTERNAL void pgm_txw_shutdown (pgm_txw_t*const);
 PGM_GNUC_INTERNAL void pgm_txw_add (pgm_txw_t*const restrict, struct pgm_sk_buff_t*const restrict);
+PGM_GNUC_INTERNAL void pgm_txw_fold_parity (pgm_txw_t*const restrict, const struct pgm_sk_buff_t*const restrict);
 PGM_GNUC_INTERNAL struct pgm_sk_buff_t* pgm_txw_peek (const pgm_txw_t*const, const uint32_t) PGM_GNUC_WARN_UNUSED_RESULT;
 PGM_GNUC_INTERNAL bool pgm_txw_retransmit_push (pgm_txw_t*const, const uint32_t, const bool, const uint8_t) PGM_GNUC_WARN_UNUSED_RESULT;
 PGM_GNUC_INTERNAL struct pgm_sk_buff_t* pgm_txw_retransmit_try_peek (pgm_txw_t*const) PGM_GNUC_WARN_UNUSED_RESULT;
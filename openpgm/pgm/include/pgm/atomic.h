@@ -187,6 +187,60 @@ pgm_atomic_dec32 (
 #endif
 }
 
+/* 32-bit word CAS, returns TRUE if swap occurred.
+ *
+ *	if (*atomic == oldval) {
+ *		*atomic = newval;
+ *		return TRUE;
+ *	}
+ *	return FALSE;
+ *
+ * Sun Studio on x86 GCC-compatible assembler not implemented.
+ */
+
+static inline
+bool
+pgm_atomic_compare_and_exchange32 (
+	volatile uint32_t*	atomic,
+	const uint32_t		newval,
+	const uint32_t		oldval
+	)
+{
+#if defined( __GNUC__ ) && ( defined( __i386__ ) || defined( __x86_64__ ) )
+/* GCC assembler */
+	uint8_t result;
+	__asm__ volatile ("lock; cmpxchgl %2, %0\n\t"
+			  "setz %1\n\t"
+			: "+m" (*atomic), "=q" (result)
+			: "r" (newval),  "a" (oldval)
+			: "memory", "cc"  );
+	return (bool)result;
+#elif defined( __SUNPRO_C ) && ( defined( __i386__ ) || defined( __x86_64__ ) )
+/* GCC-compatible assembler */
+	uint8_t result;
+	__asm__ volatile ("lock; cmpxchgl %2, %0\n\t"
+			  "setz %1\n\t"
+			: "+m" (*atomic), "=q" (result)
+			: "r" (newval),  "a" (oldval)
+			: "memory", "cc"  );
+	return (bool)result;
+#elif defined( __sun )
+/* Solaris intrinsic */
+	const uint32_t original = atomic_cas_32 (atomic, oldval, newval);
+	return (oldval == original);
+#elif defined( __APPLE__ )
+/* Darwin intrinsic */
+	return OSAtomicCompareAndSwap32Barrier ((int32_t)oldval, (int32_t)newval, (volatile int32_t*)atomic);
+#elif defined( __GNUC__ ) && ( __GNUC__ * 100 + __GNUC_MINOR__ >= 401 )
+/* GCC 4.0.1 intrinsic */
+	return __sync_bool_compare_and_swap (atomic, oldval, newval);
+#elif defined( _WIN32 )
+/* Windows intrinsic */
+	const uint32_t original = _InterlockedCompareExchange ((volatile LONG*)atomic, newval, oldval);
+	return (oldval == original);
+#endif
+}
+
 /* 32-bit word load 
  */
 
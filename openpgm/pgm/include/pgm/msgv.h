@@ -27,6 +27,7 @@
 
 struct pgm_iovec;
 struct pgm_msgv_t;
+struct pgm_loan_t;
 
 #include <pgm/types.h>
 #include <pgm/packet.h>
@@ -52,6 +53,15 @@ struct pgm_msgv_t {
 	struct pgm_sk_buff_t*	msgv_skb[PGM_MAX_FRAGMENTS];	/* PGM socket buffer array */
 };
 
+/* zero-copy view of one APDU, valid until passed to pgm_loan_return() */
+struct pgm_loan_t {
+	const pgm_tsi_t*	loan_tsi;			/* originating transport */
+	size_t			loan_len;			/* APDU length in bytes */
+	uint32_t		loan_iovlen;			/* number of elements in loan_iov */
+	struct pgm_iovec*	loan_iov;			/* TSDU of each fragment */
+	struct pgm_sk_buff_t**	loan_skb;			/* referenced socket buffers */
+};
+
 PGM_END_DECLS
 
 #endif /* __PGM_MSGV_H__ */
@@ -211,6 +211,7 @@ struct pgm_opt_fragment {
 	uint8_t		opt_reserved;		/* reserved */
 	uint32_t	opt_sqn;		/* first sequence number */
 	uint32_t	opt_frag_off;		/* offset */
+#define PGM_OPT_FRAGMENT_COALESCED	0x80000000	/* length-prefixed APDUs, not RFC 3208 */
 	uint32_t	opt_frag_len;		/* length */
 };
 
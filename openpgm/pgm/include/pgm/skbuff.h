@@ -28,6 +28,7 @@
 #include <string.h>
 
 struct pgm_sk_buff_t;
+struct pgm_skb_pool_t;
 
 #include <pgm/types.h>
 #include <pgm/atomic.h>
@@ -45,6 +46,7 @@ struct pgm_sk_buff_t {
 
 	pgm_sock_t* restrict		sock;
 	pgm_time_t			tstamp;
+	pgm_time_t			kernel_tstamp;	/* kernel arrival on same clock, zero if unknown */
 	pgm_tsi_t			tsi;
 
 	uint32_t			sequence;
@@ -70,11 +72,13 @@ struct pgm_sk_buff_t {
 				       *end;
 	uint32_t			truesize;
 	volatile uint32_t		users;		/* atomic */
+	struct pgm_skb_pool_t*		pool;		/* NULL when allocated from heap */
 };
 
 void pgm_skb_over_panic (const struct pgm_sk_buff_t*const, const uint16_t) PGM_GNUC_NORETURN;
 void pgm_skb_under_panic (const struct pgm_sk_buff_t*const, const uint16_t) PGM_GNUC_NORETURN;
 bool pgm_skb_is_valid (const struct pgm_sk_buff_t*const) PGM_GNUC_PURE PGM_GNUC_WARN_UNUSED_RESULT;
+void pgm_skb_pool_release (struct pgm_sk_buff_t*const);
 
 /* attribute __pure__ only valid for platforms with atomic ops.
  * attribute __malloc__ not used as only part of the memory should be aliased.
@@ -125,8 +129,12 @@ pgm_free_skb (
 	struct pgm_sk_buff_t*const skb
 	)
 {
-	if (pgm_atomic_exchange_and_add32 (&skb->users, (uint32_t)-1) == 1)
-		pgm_free (skb);
+	if (pgm_atomic_exchange_and_add32 (&skb->users, (uint32_t)-1) == 1) {
+		if (NULL != skb->pool)
+			pgm_skb_pool_release (skb);
+		else
+			pgm_free (skb);
+	}
 }
 
 /* add data */
@@ -217,6 +225,7 @@ pgm_skb_copy (
 	memcpy (newskb, skb, PGM_OFFSETOF(struct pgm_sk_buff_t, pgm_header));
 	newskb->zero_padded = 0;
 	newskb->truesize = skb->truesize;
+	newskb->pool = NULL;
 	pgm_atomic_write32 (&newskb->users, 1);
 	newskb->head = newskb + 1;
 	newskb->end  = (char*)newskb->head + ((char*)skb->end  - (char*)skb->head);
@@ -79,6 +79,51 @@ struct pgm_pgmccinfo_t {
 	uint32_t				ack_c_p;
 };
 
+/* average batch fill = bi_datagrams / bi_calls */
+struct pgm_batchinfo_t {
+	uint64_t				bi_calls;	/* system calls */
+	uint64_t				bi_datagrams;	/* datagrams transferred */
+	uint64_t				bi_discarded;	/* coalesced segments discarded */
+};
+
+/* pool hit rate = pi_hits / (pi_hits + pi_misses) */
+struct pgm_poolinfo_t {
+	uint64_t				pi_hits;	/* buffers recycled from free-list */
+	uint64_t				pi_misses;	/* buffers allocated from heap */
+	uint32_t				pi_free;	/* buffers on free-list */
+	uint32_t				pi_outstanding;	/* buffers in use */
+};
+
+/* receive shard, accepts sources whose TSI hashes to si_index of si_count */
+struct pgm_shardinfo_t {
+	uint32_t				si_index;
+	uint32_t				si_count;
+};
+
+/* log-linear histogram of latencies in microseconds, values below
+ * 2^PGM_HISTOGRAM_SUB_BITS have a bucket each, every following power of two
+ * is split into 2^(PGM_HISTOGRAM_SUB_BITS-1) equal buckets.  hi_counts[i]
+ * holds samples from pgm_histinfo_value(i) up to pgm_histinfo_value(i+1).
+ */
+#define PGM_HISTOGRAM_SUB_BITS			5
+#define PGM_HISTOGRAM_BUCKETS			((1 << PGM_HISTOGRAM_SUB_BITS) + \
+						 (32 - PGM_HISTOGRAM_SUB_BITS) * (1 << (PGM_HISTOGRAM_SUB_BITS - 1)))
+
+struct pgm_histinfo_t {
+	uint64_t				hi_count;
+	uint32_t				hi_min;
+	uint32_t				hi_max;
+	uint32_t				hi_counts[PGM_HISTOGRAM_BUCKETS];
+};
+
+/* latencies of the peer li_tsi, or of every peer of the socket when zero */
+struct pgm_latencyinfo_t {
+	pgm_tsi_t				li_tsi;
+	struct pgm_histinfo_t			li_repair;	/* loss detection to repair */
+	struct pgm_histinfo_t			li_delivery;	/* arrival to delivery to application */
+	struct pgm_histinfo_t			li_queue;	/* kernel arrival to arrival, PGM_RECV_TIMESTAMP only */
+};
+
 /* socket options */
 enum {
 	PGM_SEND_SOCK		= 0x2000,
@@ -134,7 +179,22 @@ enum {
 	PGM_UNCONTROLLED_ODATA,
 	PGM_UNCONTROLLED_RDATA,
 	PGM_ODATA_MAX_RTE,
-	PGM_RDATA_MAX_RTE
+	PGM_RDATA_MAX_RTE,
+	PGM_SEND_BATCH,
+	PGM_RECV_BATCH,
+	PGM_RECV_BATCH_STATS,
+	PGM_SKB_POOL_STATS,
+	PGM_TXW_LOCKLESS,
+	PGM_RECV_SHARD,
+	PGM_RECV_DEMUX,
+	PGM_RATE_PACING,
+	PGM_LATENCY_STATS,
+	PGM_SINGLE_THREAD,
+	PGM_COALESCE,
+	PGM_ZEROCOPY,
+	PGM_UDP_GSO,
+	PGM_UDP_GRO,
+	PGM_RECV_TIMESTAMP
 };
 
 /* IO status */
@@ -170,10 +230,17 @@ void pgm_freeaddrinfo (struct pgm_addrinfo_t*);
 int pgm_send (pgm_sock_t*const restrict, const void*restrict, const size_t, size_t*restrict);
 int pgm_sendv (pgm_sock_t*const restrict, const struct pgm_iovec*const restrict, const unsigned, const bool, size_t*restrict);
 int pgm_send_skbv (pgm_sock_t*const restrict, struct pgm_sk_buff_t**const restrict, const unsigned, const bool, size_t*restrict);
+int pgm_send_flush (pgm_sock_t*const);
+void* pgm_send_claim (pgm_sock_t*const, const size_t) PGM_GNUC_WARN_UNUSED_RESULT;
+int pgm_send_commit (pgm_sock_t*const restrict, const size_t, size_t*restrict);
 int pgm_recvmsg (pgm_sock_t*const restrict, struct pgm_msgv_t*const restrict, const int, size_t*restrict, pgm_error_t**restrict) PGM_GNUC_WARN_UNUSED_RESULT;
 int pgm_recvmsgv (pgm_sock_t*const restrict, struct pgm_msgv_t*const restrict, const size_t, const int, size_t*restrict, pgm_error_t**restrict) PGM_GNUC_WARN_UNUSED_RESULT;
 int pgm_recv (pgm_sock_t*const restrict, void*restrict, const size_t, const int, size_t*const restrict, pgm_error_t**restrict) PGM_GNUC_WARN_UNUSED_RESULT;
 int pgm_recvfrom (pgm_sock_t*const restrict, void*restrict, const size_t, const int, size_t*restrict, struct pgm_sockaddr_t*restrict, socklen_t*restrict, pgm_error_t**restrict) PGM_GNUC_WARN_UNUSED_RESULT;
+int pgm_recvloan (pgm_sock_t*const restrict, struct pgm_loan_t**restrict, const int, size_t*restrict, pgm_error_t**restrict) PGM_GNUC_WARN_UNUSED_RESULT;
+void pgm_loan_return (struct pgm_loan_t*const);
+uint32_t pgm_histinfo_value (const unsigned) PGM_GNUC_CONST;
+uint32_t pgm_histinfo_percentile (const struct pgm_histinfo_t*const, const double) PGM_GNUC_PURE;
 
 bool pgm_getsockname (pgm_sock_t*const restrict, struct pgm_sockaddr_t*restrict, socklen_t*restrict);
 int pgm_select_info (pgm_sock_t*const restrict, fd_set*const restrict, fd_set*const restrict, int*const restrict);
@@ -51,6 +51,8 @@ typedef void (*pgm_time_since_epoch_func)(const pgm_time_t*const restrict, time_
 
 extern pgm_time_since_epoch_func	pgm_time_since_epoch;
 
+uint32_t pgm_time_read_count (void);
+
 PGM_END_DECLS
 
 #endif /* __PGM_TIME_H__ */
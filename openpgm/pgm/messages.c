@@ -22,16 +22,30 @@
 #ifdef HAVE_CONFIG_H
 #	include <config.h>
 #endif
+#include <errno.h>
 #include <stdarg.h>
 #include <stdio.h>
+#include <stdlib.h>
 #ifndef _WIN32
+#	include <time.h>
 #	include <unistd.h>
 #else
 #	include <io.h>
+#	include <process.h>
 #endif
 #include <impl/framework.h>
 
 
+/* Asynchronous logging is enabled by setting PGM_LOG_ASYNC to the number of
+ * records to queue.  Messages are formatted by the calling thread into a
+ * lock-free ring and written out by a background thread, a full ring drops
+ * the message instead of blocking.
+ */
+#define PGM_LOG_RECORD_LEN		1024
+#define PGM_LOG_MIN_RECORDS		16
+#define PGM_LOG_DRAIN_MSECS		10
+
+
 /* globals */
 
 /* bit mask for trace role modules */
@@ -57,7 +71,39 @@ static pgm_mutex_t		messages_mutex;
 static pgm_log_func_t 		log_handler PGM_GNUC_READ_MOSTLY = NULL;
 static void* 			log_handler_closure PGM_GNUC_READ_MOSTLY = NULL;
 
+/* bounded multi-producer queue, a slot is free for the producer at position
+ * pos when its sequence equals pos and holds a record for the consumer when
+ * it equals pos + 1.
+ */
+struct pgm_log_record_t {
+	volatile uint32_t	sequence;
+	int			log_level;
+	char			text[ PGM_LOG_RECORD_LEN ];
+};
+
+static struct pgm_log_record_t* log_ring PGM_GNUC_READ_MOSTLY = NULL;
+static uint32_t			log_ring_mask PGM_GNUC_READ_MOSTLY;
+static volatile uint32_t	log_enqueue_pos = 0;
+static uint32_t			log_dequeue_pos = 0;
+static volatile uint32_t	log_dropped = 0;		/* ring full */
+static uint32_t			log_dropped_reported = 0;
+static volatile uint32_t	log_is_draining = 0;
+static volatile uint32_t	log_is_async = 0;		/* producers may enqueue */
+static volatile uint32_t	log_producers = 0;		/* producers inside log_enqueue() */
+#ifndef _WIN32
+static pthread_t		log_thread;
+static void*			log_routine (void*);
+#else
+static HANDLE			log_thread;
+static unsigned __stdcall	log_routine (void*);
+#endif
+
 static inline const char* log_level_text (const int) PGM_GNUC_PURE;
+static void log_write (const int, const char*);
+static bool log_async_init (const unsigned);
+static void log_async_shutdown (void);
+static bool log_enqueue (const int, const char*, va_list) PGM_GNUC_PRINTF (2, 0);
+static void log_drain (void);
 
 
 static inline
@@ -84,7 +130,7 @@ log_level_text (
 void
 pgm_messages_init (void)
 {
-	char *log_mask, *min_log_level;
+	char *log_mask, *min_log_level, *log_async;
 	size_t len;
 	errno_t err;
 
@@ -115,6 +161,14 @@ pgm_messages_init (void)
 		}
 		pgm_free (min_log_level);
 	}
+
+	err = pgm_dupenv_s (&log_async, &len, "PGM_LOG_ASYNC");
+	if (!err && len > 0) {
+		const int records = atoi (log_async);
+		pgm_free (log_async);
+		if (records > 0)
+			log_async_init ((unsigned)records);
+	}
 }
 
 void
@@ -125,9 +179,176 @@ pgm_messages_shutdown (void)
 	if (pgm_atomic_exchange_and_add32 (&messages_ref_count, (uint32_t)-1) != 1)
 		return;
 
+	if (log_ring)
+		log_async_shutdown ();
 	pgm_mutex_free (&messages_mutex);
 }
 
+/* allocate the record ring and start the thread draining it, on failure
+ * logging remains synchronous.
+ */
+
+static
+bool
+log_async_init (
+	const unsigned		records
+	)
+{
+	const uint32_t len = (uint32_t)pgm_nearest_power (PGM_LOG_MIN_RECORDS, records);
+
+	log_ring = pgm_new0 (struct pgm_log_record_t, len);
+	for (uint32_t i = 0; i < len; i++)
+		log_ring[ i ].sequence = i;
+	log_ring_mask	    = len - 1;
+	log_enqueue_pos	    = log_dequeue_pos = 0;
+	log_dropped	    = log_dropped_reported = 0;
+	log_is_draining	    = 1;
+
+#ifndef _WIN32
+	const int status = pthread_create (&log_thread, NULL, &log_routine, NULL);
+	if (0 != status)
+		goto err_cleanup;
+#else
+	log_thread = (HANDLE)_beginthreadex (NULL, 0, &log_routine, NULL, 0, NULL);
+	if (0 == log_thread)
+		goto err_cleanup;
+#endif /* _WIN32 */
+	pgm_atomic_write32 (&log_is_async, 1);
+	return TRUE;
+
+err_cleanup:
+	pgm_free (log_ring);
+	log_ring = NULL;
+	return FALSE;
+}
+
+/* stop accepting records, wait for producers already inside the ring to
+ * leave, then stop the drainer and flush what remains before freeing.
+ */
+
+static
+void
+log_async_shutdown (void)
+{
+/* locked exchange as a full barrier: flag cleared before reading producers */
+	pgm_atomic_compare_and_exchange32 (&log_is_async, 0, 1);
+	while (pgm_atomic_read32 (&log_producers))
+		pgm_thread_yield();
+	pgm_atomic_write32 (&log_is_draining, 0);
+#ifndef _WIN32
+	pthread_join (log_thread, NULL);
+#else
+	WaitForSingleObject (log_thread, INFINITE);
+	CloseHandle (log_thread);
+#endif
+	log_drain ();
+	struct pgm_log_record_t* ring = log_ring;
+	log_ring = NULL;
+	pgm_free (ring);
+}
+
+/* background thread emitting queued records, polls so that producers never
+ * need a system call to wake it.
+ */
+
+static
+#ifndef _WIN32
+void*
+#else
+unsigned
+__stdcall
+#endif
+log_routine (
+	PGM_GNUC_UNUSED void*	arg
+	)
+{
+	while (pgm_atomic_read32 (&log_is_draining)) {
+		log_drain ();
+#ifndef _WIN32
+		struct timespec req = { .tv_sec = 0, .tv_nsec = PGM_LOG_DRAIN_MSECS * 1000 * 1000 };
+		while (-1 == nanosleep (&req, &req) && EINTR == errno);
+#else
+		Sleep (PGM_LOG_DRAIN_MSECS);
+#endif
+	}
+	log_drain ();
+#ifndef _WIN32
+	return NULL;
+#else
+	_endthreadex (0);
+	return 0;
+#endif
+}
+
+/* claim the next free slot and format the message into it, formatting in the
+ * calling thread as arguments may reference transient buffers.
+ *
+ * returns FALSE if the ring is full.
+ */
+
+static
+bool
+log_enqueue (
+	const int		log_level,
+	const char*		format,
+	va_list			args
+	)
+{
+	struct pgm_log_record_t* record;
+	uint32_t pos = pgm_atomic_read32 (&log_enqueue_pos);
+
+	for (;;) {
+		record = &log_ring[ pos & log_ring_mask ];
+		const int32_t diff = (int32_t)(pgm_atomic_read32 (&record->sequence) - pos);
+		if (0 == diff) {
+			if (pgm_atomic_compare_and_exchange32 (&log_enqueue_pos, pos + 1, pos))
+				break;
+		} else if (diff < 0) {
+			pgm_atomic_inc32 (&log_dropped);
+			return FALSE;
+		}
+		pos = pgm_atomic_read32 (&log_enqueue_pos);
+	}
+
+	record->log_level = log_level;
+	const int offset = pgm_snprintf_s (record->text, sizeof (record->text), _TRUNCATE, "%s: ", log_level_text (log_level));
+	pgm_vsnprintf_s (record->text + offset, sizeof (record->text) - offset, _TRUNCATE, format, args);
+/* locked add as a full barrier: record visible before the sequence */
+	pgm_atomic_inc32 (&record->sequence);
+	return TRUE;
+}
+
+/* emit every published record in order, called from the drainer only.
+ */
+
+static
+void
+log_drain (void)
+{
+	for (;;) {
+		struct pgm_log_record_t* record = &log_ring[ log_dequeue_pos & log_ring_mask ];
+		if (pgm_atomic_exchange_and_add32 (&record->sequence, 0) != log_dequeue_pos + 1)
+			break;
+		pgm_mutex_lock (&messages_mutex);
+		log_write (record->log_level, record->text);
+		pgm_mutex_unlock (&messages_mutex);
+/* release slot for the next lap */
+		pgm_atomic_add32 (&record->sequence, log_ring_mask);
+		log_dequeue_pos++;
+	}
+
+	const uint32_t dropped = pgm_atomic_read32 (&log_dropped);
+	if (dropped != log_dropped_reported) {
+		char tbuf[1024];
+		pgm_snprintf_s (tbuf, sizeof (tbuf), _TRUNCATE, "%s: %" PRIu32 " log messages dropped, queue full.",
+				log_level_text (PGM_LOG_LEVEL_WARNING), dropped - log_dropped_reported);
+		log_dropped_reported = dropped;
+		pgm_mutex_lock (&messages_mutex);
+		log_write (PGM_LOG_LEVEL_WARNING, tbuf);
+		pgm_mutex_unlock (&messages_mutex);
+	}
+}
+
 /* set application handler for log messages, returns previous value,
  * default handler value is NULL.
  */
@@ -178,18 +399,45 @@ pgm__logv (
 {
 	char tbuf[1024];
 
+/* fatal messages precede abort() and are never deferred.  announce the
+ * producer before re-testing the flag so shutdown cannot free the ring
+ * underneath the enqueue.
+ */
+	if (log_level < PGM_LOG_LEVEL_FATAL && pgm_atomic_read32 (&log_is_async)) {
+		pgm_atomic_inc32 (&log_producers);
+		if (pgm_atomic_read32 (&log_is_async)) {
+			log_enqueue (log_level, format, args);
+			pgm_atomic_dec32 (&log_producers);
+			return;
+		}
+		pgm_atomic_dec32 (&log_producers);
+	}
+
 	pgm_mutex_lock (&messages_mutex);
 	const int offset = pgm_snprintf_s (tbuf, sizeof (tbuf), _TRUNCATE, "%s: ", log_level_text (log_level));
 	pgm_vsnprintf_s (tbuf + offset, sizeof(tbuf) - offset, _TRUNCATE, format, args);
+	log_write (log_level, tbuf);
+	pgm_mutex_unlock (&messages_mutex);
+}
+
+/* pass a formatted message to the application handler or stdout, caller
+ * holds messages_mutex.
+ */
+
+static
+void
+log_write (
+	const int		log_level,
+	const char*		text
+	)
+{
 	if (log_handler)
-		log_handler (log_level, tbuf, log_handler_closure);
+		log_handler (log_level, text, log_handler_closure);
 	else {
 /* ignore return value */
-		(void) write (STDOUT_FILENO, tbuf, strlen (tbuf));
+		(void) write (STDOUT_FILENO, text, strlen (text));
 		(void) write (STDOUT_FILENO, "\n", 1);
 	}
-		
-	pgm_mutex_unlock (&messages_mutex);
 }
 
 /* eof */
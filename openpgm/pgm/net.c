@@ -22,6 +22,11 @@
 #ifdef HAVE_CONFIG_H
 #	include <config.h>
 #endif
+
+#if defined( HAVE_SENDMMSG ) && !defined( _GNU_SOURCE )
+#	define _GNU_SOURCE	/* sendmmsg */
+#endif
+
 #include <errno.h>
 #ifdef HAVE_POLL
 #	include <poll.h>
@@ -31,6 +36,12 @@
 #	include <netinet/in.h>
 #	include <arpa/inet.h>
 #endif
+#ifdef HAVE_MSG_ZEROCOPY
+#	include <linux/errqueue.h>
+#endif
+#ifdef HAVE_UDP_GSO
+#	include <netinet/udp.h>
+#endif
 #include <impl/i18n.h>
 #include <impl/framework.h>
 #include <impl/net.h>
@@ -40,20 +51,176 @@
 //#define NET_DEBUG
 
 
-/* locked and rate regulated sendto
+#ifdef HAVE_MSG_ZEROCOPY
+/* the kernel numbers each successful MSG_ZEROCOPY send on a descriptor, the
+ * pinned ring is indexed by that id.
+ */
+
+static inline
+uint32_t
+zerocopy_free_len (
+	const pgm_zerocopy_t*const	zc
+	)
+{
+	return zc->mask + 1 - (zc->lead - zc->trail);
+}
+
+static inline
+void
+zerocopy_pin (
+	pgm_zerocopy_t*	      const restrict	zc,
+	struct pgm_sk_buff_t* const restrict	skb
+	)
+{
+	pgm_assert (zerocopy_free_len (zc) > 0);
+	zc->pinned[ zc->lead++ & zc->mask ] = pgm_skb_get (skb);
+}
+
+/* drain completion notifications from the error queue, releasing the pinned
+ * socket buffers of every reported id range.  called with zc::mutex held.
+ */
+
+static
+void
+zerocopy_reap (
+	const SOCKET			fd,
+	pgm_zerocopy_t*	      restrict	zc
+	)
+{
+	while (zc->lead != zc->trail)
+	{
+		char control[ 64 ];
+		struct msghdr msg;
+		memset (&msg, 0, sizeof(msg));
+		msg.msg_control		= control;
+		msg.msg_controllen	= sizeof(control);
+		if (recvmsg (fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0)
+			break;
+		for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+		     NULL != cmsg;
+		     cmsg = CMSG_NXTHDR(&msg, cmsg))
+		{
+			const struct sock_extended_err* serr;
+			if (!(IPPROTO_IP == cmsg->cmsg_level && IP_RECVERR == cmsg->cmsg_type) &&
+			    !(IPPROTO_IPV6 == cmsg->cmsg_level && IPV6_RECVERR == cmsg->cmsg_type))
+				continue;
+			serr = (const struct sock_extended_err*)CMSG_DATA(cmsg);
+			if (SO_EE_ORIGIN_ZEROCOPY != serr->ee_origin || 0 != serr->ee_errno)
+				continue;
+/* inclusive range [ee_info, ee_data] */
+			for (uint32_t id = serr->ee_info; ; id++) {
+				if ((id - zc->trail) < (zc->lead - zc->trail)) {
+					struct pgm_sk_buff_t** pin = &zc->pinned[ id & zc->mask ];
+					if (NULL != *pin) {
+						pgm_free_skb (*pin);
+						*pin = NULL;
+					}
+				}
+				if (id == serr->ee_data)
+					break;
+			}
+		}
+	}
+/* notifications may arrive out of order */
+	while (zc->lead != zc->trail && NULL == zc->pinned[ zc->trail & zc->mask ])
+		zc->trail++;
+}
+
+/* sendto on the provided descriptor, with MSG_ZEROCOPY when a pinned ring is
+ * given and has room.  exhausted notification memory falls back to copying.
+ */
+
+static
+ssize_t
+sendto_zerocopy (
+	const SOCKET			send_sock,
+	pgm_zerocopy_t*	       restrict	zc,
+	struct pgm_sk_buff_t*  restrict	skb,
+	const void*	       restrict	buf,
+	size_t				len,
+	const struct sockaddr* restrict	to,
+	socklen_t			tolen
+	)
+{
+	if (NULL != zc) {
+		if (zerocopy_free_len (zc) <= zc->mask / 2)
+			zerocopy_reap (send_sock, zc);
+		if (zerocopy_free_len (zc) > 0) {
+			const ssize_t sent = sendto (send_sock, buf, len, MSG_ZEROCOPY, to, (socklen_t)tolen);
+			if (sent >= 0) {
+				zerocopy_pin (zc, skb);
+				return sent;
+			}
+			if (PGM_SOCK_ENOBUFS != pgm_get_last_sock_error())
+				return sent;
+			zerocopy_reap (send_sock, zc);
+		}
+	}
+	return sendto (send_sock, buf, len, 0, to, (socklen_t)tolen);
+}
+#else
+static inline
+ssize_t
+sendto_zerocopy (
+	const SOCKET			send_sock,
+	pgm_zerocopy_t*	       restrict	zc,
+	struct pgm_sk_buff_t*  restrict	skb,
+	const void*	       restrict	buf,
+	size_t				len,
+	const struct sockaddr* restrict	to,
+	socklen_t			tolen
+	)
+{
+	(void)zc; (void)skb;
+	return sendto (send_sock, buf, len, 0, to, (socklen_t)tolen);
+}
+#endif /* HAVE_MSG_ZEROCOPY */
+
+/* select the pinned ring for a TPDU, none for short or parity packets as
+ * on-demand parity reuses one buffer.
+ */
+
+static inline
+pgm_zerocopy_t*
+zerocopy_for_skb (
+	pgm_sock_t*	      const restrict	sock,
+	pgm_zerocopy_t*	      const restrict	zc,
+	const struct pgm_sk_buff_t*const restrict skb
+	)
+{
+#ifdef HAVE_MSG_ZEROCOPY
+	if (0 == sock->zerocopy_min ||
+	    NULL == zc->pinned ||
+	    (size_t)((char*)skb->tail - (char*)skb->head) < sock->zerocopy_min ||
+	    (skb->pgm_header->pgm_options & PGM_OPT_PARITY))
+		return NULL;
+	return zc;
+#else
+	(void)sock; (void)zc; (void)skb;
+	return NULL;
+#endif
+}
+
+/* rate regulated sendto on the provided descriptor, optionally serialised
+ * with send_mutex.  the caller's cached time is used for the rate check and
+ * refreshed if the check has to wait.
  *
  * on success, returns number of bytes sent.  on error, -1 is returned, and
  * errno set appropriately.
  */
 
-PGM_GNUC_INTERNAL
+static
 ssize_t
-pgm_sendto_hops (
+pgm_sendto_fd (
 	pgm_sock_t*	       restrict	sock,
+	const SOCKET			send_sock,
+	const bool			use_send_mutex,
 	bool				use_rate_limit,
 	pgm_rate_t*	       restrict	minor_rate_control,
-	bool				use_router_alert,
+	pgm_time_t*	       restrict	now,			/* NULL == read clock */
 	int				hops,			/* -1 == system default */
+	pgm_zerocopy_t*	       restrict	zc,			/* NULL == copy */
+	struct pgm_sk_buff_t*  restrict	skb,			/* pinned with zc */
 	const void*	       restrict	buf,
 	size_t				len,
 	const struct sockaddr* restrict	to,
@@ -62,6 +229,7 @@ pgm_sendto_hops (
 {
 	pgm_assert( NULL != sock );
 	pgm_assert( NULL != buf );
+	if (NULL != zc) pgm_assert( NULL != skb );
 	pgm_assert( len > 0 );
 	pgm_assert( NULL != to );
 	pgm_assert( tolen > 0 );
@@ -69,11 +237,12 @@ pgm_sendto_hops (
 #ifdef NET_DEBUG
 	char saddr[INET_ADDRSTRLEN];
 	pgm_sockaddr_ntop (to, saddr, sizeof(saddr));
-	pgm_debug ("pgm_sendto (sock:%p use_rate_limit:%s minor_rate_control:%p use_router_alert:%s buf:%p len:%" PRIzu " to:%s [toport:%d] tolen:%d)",
+	pgm_debug ("pgm_sendto (sock:%p send_sock:%d use_send_mutex:%s use_rate_limit:%s minor_rate_control:%p buf:%p len:%" PRIzu " to:%s [toport:%d] tolen:%d)",
 		(const void*)sock,
+		(int)send_sock,
+		use_send_mutex ? "TRUE" : "FALSE",
 		use_rate_limit ? "TRUE" : "FALSE",
 		(const void*)minor_rate_control,
-		use_router_alert ? "TRUE" : "FALSE",
 		(const void*)buf,
 		len,
 		saddr,
@@ -81,13 +250,11 @@ pgm_sendto_hops (
 		(int)tolen);
 #endif
 
-	const SOCKET send_sock = use_router_alert ? sock->send_with_router_alert_sock : sock->send_sock;
-
 	if (use_rate_limit)
 	{
 		if (NULL == minor_rate_control)
 		{
-			if (!pgm_rate_check (&sock->rate_control, len, sock->is_nonblocking))
+			if (!pgm_rate_check (&sock->rate_control, len, sock->is_nonblocking, now))
 			{
 				pgm_set_last_sock_error (PGM_SOCK_ENOBUFS);
 				return (const ssize_t)-1;
@@ -95,7 +262,7 @@ pgm_sendto_hops (
 		}
 		else
 		{
-			if (!pgm_rate_check2 (&sock->rate_control, minor_rate_control, len, sock->is_nonblocking))
+			if (!pgm_rate_check2 (&sock->rate_control, minor_rate_control, len, sock->is_nonblocking, now))
 			{
 				pgm_set_last_sock_error (PGM_SOCK_ENOBUFS);
 				return (const ssize_t)-1;
@@ -103,12 +270,14 @@ pgm_sendto_hops (
 		}
 	}
 
-	if (!use_router_alert && sock->can_send_data)
-		pgm_mutex_lock (&sock->send_mutex);
+	if (use_send_mutex)
+		pgm_sock_mutex_lock (sock, &sock->send_mutex);
 	if (-1 != hops)
 		pgm_sockaddr_multicast_hops (send_sock, sock->send_gsr.gsr_group.ss_family, hops);
+	if (NULL != zc)
+		pgm_sock_mutex_lock (sock, &zc->mutex);
 
-	ssize_t sent = sendto (send_sock, buf, len, 0, to, (socklen_t)tolen);
+	ssize_t sent = sendto_zerocopy (send_sock, zc, skb, buf, len, to, tolen);
 	pgm_debug ("sendto returned %" PRIzd, sent);
 	if (sent < 0) {
 		int save_errno = pgm_get_last_sock_error();
@@ -141,7 +310,7 @@ pgm_sendto_hops (
 #endif /* HAVE_POLL */
 			if (ready > 0)
 			{
-				sent = sendto (send_sock, buf, len, 0, to, (socklen_t)tolen);
+				sent = sendto_zerocopy (send_sock, zc, skb, buf, len, to, tolen);
 				if ( sent < 0 )
 				{
 					char errbuf[1024];
@@ -169,14 +338,454 @@ pgm_sendto_hops (
 		}
 	}
 
+	if (NULL != zc)
+		pgm_sock_mutex_unlock (sock, &zc->mutex);
 /* revert to default value hop limit */
 	if (-1 != hops)
 		pgm_sockaddr_multicast_hops (send_sock, sock->send_gsr.gsr_group.ss_family, sock->hops);
-	if (!use_router_alert && sock->can_send_data)
-		pgm_mutex_unlock (&sock->send_mutex);
+	if (use_send_mutex)
+		pgm_sock_mutex_unlock (sock, &sock->send_mutex);
 	return sent;
 }
 
+/* locked and rate regulated sendto
+ *
+ * on success, returns number of bytes sent.  on error, -1 is returned, and
+ * errno set appropriately.
+ */
+
+PGM_GNUC_INTERNAL
+ssize_t
+pgm_sendto_hops (
+	pgm_sock_t*	       restrict	sock,
+	bool				use_rate_limit,
+	pgm_rate_t*	       restrict	minor_rate_control,
+	pgm_time_t*	       restrict	now,			/* NULL == read clock */
+	bool				use_router_alert,
+	int				hops,			/* -1 == system default */
+	const void*	       restrict	buf,
+	size_t				len,
+	const struct sockaddr* restrict	to,
+	socklen_t			tolen
+	)
+{
+	pgm_assert( NULL != sock );
+
+	return pgm_sendto_fd (sock,
+			      use_router_alert ? sock->send_with_router_alert_sock : sock->send_sock,
+			      !use_router_alert && sock->can_send_data,
+			      use_rate_limit,
+			      minor_rate_control,
+			      now,
+			      hops,
+			      NULL, NULL,
+			      buf, len, to, tolen);
+}
+
+/* locked and rate regulated sendto of a transmit window socket buffer, handed
+ * to the kernel with MSG_ZEROCOPY when enabled for its length.  original
+ * data goes out on the regular socket, repairs on the router alert socket.
+ *
+ * on success, returns number of bytes sent.  on error, -1 is returned, and
+ * errno set appropriately.
+ */
+
+PGM_GNUC_INTERNAL
+ssize_t
+pgm_sendto_skb (
+	pgm_sock_t*	       restrict	sock,
+	bool				use_rate_limit,
+	pgm_rate_t*	       restrict	minor_rate_control,
+	pgm_time_t*	       restrict	now,			/* NULL == read clock */
+	bool				use_router_alert,
+	struct pgm_sk_buff_t*  restrict	skb,
+	const struct sockaddr* restrict	to,
+	socklen_t			tolen
+	)
+{
+	pgm_assert( NULL != sock );
+	pgm_assert( NULL != skb );
+
+	return pgm_sendto_fd (sock,
+			      use_router_alert ? sock->send_with_router_alert_sock : sock->send_sock,
+			      !use_router_alert && sock->can_send_data,
+			      use_rate_limit,
+			      minor_rate_control,
+			      now,
+			      -1,
+			      zerocopy_for_skb (sock, use_router_alert ? &sock->rdata_zerocopy : &sock->odata_zerocopy, skb),
+			      skb,
+			      skb->head,
+			      (char*)skb->tail - (char*)skb->head,
+			      to, tolen);
+}
+
+/* rate regulated sendto on the dedicated repair socket, never contends
+ * with original data on send_mutex.
+ *
+ * on success, returns number of bytes sent.  on error, -1 is returned, and
+ * errno set appropriately.
+ */
+
+PGM_GNUC_INTERNAL
+ssize_t
+pgm_sendto_repair (
+	pgm_sock_t*	       restrict	sock,
+	bool				use_rate_limit,
+	pgm_rate_t*	       restrict	minor_rate_control,
+	pgm_time_t*	       restrict	now,			/* NULL == read clock */
+	struct pgm_sk_buff_t*  restrict	skb,
+	const struct sockaddr* restrict	to,
+	socklen_t			tolen
+	)
+{
+	pgm_assert( NULL != sock );
+	pgm_assert( NULL != skb );
+
+	return pgm_sendto_fd (sock,
+			      sock->repair_sock,
+			      FALSE,
+			      use_rate_limit,
+			      minor_rate_control,
+			      now,
+			      -1,
+			      zerocopy_for_skb (sock, &sock->rdata_zerocopy, skb),
+			      skb,
+			      skb->head,
+			      (char*)skb->tail - (char*)skb->head,
+			      to, tolen);
+}
+
+#if defined( HAVE_SENDMMSG ) && defined( HAVE_UDP_GSO )
+/* transmit runs of equal length socket buffers as UDP GSO super-buffers, each
+ * one message segmented by the kernel or device, a shorter buffer may only
+ * end a run.  the kernel rejecting segmentation, e.g. a TPDU beyond the path
+ * MTU or no checksum offload, disables GSO on the socket.
+ *
+ * on success, returns number of socket buffers sent which may be less than
+ * count.  on error, returns -1, and errno set appropriately.
+ */
+
+static
+ssize_t
+sendmmsg_gso (
+	pgm_sock_t*	       const restrict	sock,
+	struct pgm_sk_buff_t**       restrict	vector,
+	const unsigned				count,
+	const struct sockaddr* const restrict	to,
+	const socklen_t				tolen
+	)
+{
+/* one UDP datagram: the IPv4 total length covers the IP header, the IPv6
+ * payload length does not.
+ */
+	const size_t max_len = (AF_INET6 == sock->family ? 65535 : 65535 - sock->iphdr_len) - sizeof (struct pgm_udphdr);
+	struct mmsghdr* msgvec = pgm_newa (struct mmsghdr, count);
+	struct iovec* iov = pgm_newa (struct iovec, count);
+	unsigned* runs = pgm_newa (unsigned, count);
+	char* control = pgm_newa (char, count * CMSG_SPACE(sizeof(uint16_t)));
+	unsigned vlen = 0, msg_count = 0, sent_count = 0;
+	ssize_t sent;
+
+	for (unsigned i = 0; i < count; vlen++)
+	{
+		const size_t gso_size = (char*)vector[i]->tail - (char*)vector[i]->head;
+		size_t total_len = 0;
+		unsigned n = 0;
+		do {
+			const size_t len = (char*)vector[i + n]->tail - (char*)vector[i + n]->head;
+			if (len > gso_size || total_len + len > max_len)
+				break;
+			iov[i + n].iov_base	= vector[i + n]->head;
+			iov[i + n].iov_len	= len;
+			total_len += len;
+			n++;
+			if (len < gso_size)
+				break;
+		} while (i + n < count);
+
+		msgvec[vlen].msg_hdr.msg_name		= (void*)to;
+		msgvec[vlen].msg_hdr.msg_namelen	= tolen;
+		msgvec[vlen].msg_hdr.msg_iov		= &iov[i];
+		msgvec[vlen].msg_hdr.msg_iovlen		= n;
+		msgvec[vlen].msg_hdr.msg_control	= NULL;
+		msgvec[vlen].msg_hdr.msg_controllen	= 0;
+		msgvec[vlen].msg_hdr.msg_flags		= 0;
+		msgvec[vlen].msg_len			= 0;
+		if (n > 1) {
+			struct cmsghdr* cmsg;
+			const uint16_t segment = (uint16_t)gso_size;
+			msgvec[vlen].msg_hdr.msg_control	= control + (vlen * CMSG_SPACE(sizeof(uint16_t)));
+			msgvec[vlen].msg_hdr.msg_controllen	= CMSG_SPACE(sizeof(uint16_t));
+			cmsg = CMSG_FIRSTHDR(&msgvec[vlen].msg_hdr);
+			cmsg->cmsg_level	= SOL_UDP;
+			cmsg->cmsg_type		= UDP_SEGMENT;
+			cmsg->cmsg_len		= CMSG_LEN(sizeof(uint16_t));
+			memcpy (CMSG_DATA(cmsg), &segment, sizeof(segment));
+		}
+		runs[vlen] = n;
+		i += n;
+	}
+
+	do {
+		sent = sendmmsg (sock->send_sock, msgvec + msg_count, vlen - msg_count, 0);
+		if (sent < 0 && runs[msg_count] > 1) {
+			const int save_errno = pgm_get_last_sock_error();
+			if (EMSGSIZE == save_errno || PGM_SOCK_EINVAL == save_errno || EIO == save_errno) {
+				char errbuf[1024];
+				pgm_trace (PGM_LOG_ROLE_NETWORK,_("UDP GSO disabled: %s"),
+					   pgm_sock_strerror_s (errbuf, sizeof (errbuf), save_errno));
+				sock->use_udp_gso = FALSE;
+				return sent_count;
+			}
+		}
+		for (unsigned i = 0; i < (unsigned)MAX(sent, 0); i++)
+			sent_count += runs[msg_count + i];
+		if (sent > 0)
+			msg_count += (unsigned)sent;
+	} while (sent > 0 && msg_count < vlen);
+	return sent_count > 0 ? (ssize_t)sent_count : sent;
+}
+#endif /* HAVE_SENDMMSG && HAVE_UDP_GSO */
+
+/* locked and rate regulated transmission of a batch of socket buffers to one
+ * destination.  the rate limit is debited once for the entire batch and the
+ * send lock is acquired once; where available the batch is handed to the
+ * kernel with one sendmmsg() call.
+ *
+ * on success, returns number of socket buffers sent which may be less than
+ * count.  on error, returns -1, and errno set appropriately.
+ */
+
+PGM_GNUC_INTERNAL
+ssize_t
+pgm_sendmmsg (
+	pgm_sock_t*	       restrict	sock,
+	bool				use_rate_limit,
+	pgm_rate_t*	       restrict	minor_rate_control,
+	pgm_time_t*	       restrict	now,			/* NULL == read clock */
+	struct pgm_sk_buff_t**restrict	vector,
+	unsigned			count,
+	const struct sockaddr* restrict	to,
+	socklen_t			tolen
+	)
+{
+	size_t		total_length = 0;
+	unsigned	sent_count = 0;
+	ssize_t		sent;
+
+	pgm_assert( NULL != sock );
+	pgm_assert( NULL != vector );
+	pgm_assert( count > 0 );
+	pgm_assert( NULL != to );
+	pgm_assert( tolen > 0 );
+
+#ifdef NET_DEBUG
+	char saddr[INET_ADDRSTRLEN];
+	pgm_sockaddr_ntop (to, saddr, sizeof(saddr));
+	pgm_debug ("pgm_sendmmsg (sock:%p use_rate_limit:%s minor_rate_control:%p vector:%p count:%u to:%s [toport:%d] tolen:%d)",
+		(const void*)sock,
+		use_rate_limit ? "TRUE" : "FALSE",
+		(const void*)minor_rate_control,
+		(const void*)vector,
+		count,
+		saddr,
+		ntohs (((const struct sockaddr_in*)to)->sin_port),
+		(int)tolen);
+#endif
+
+	if (use_rate_limit)
+	{
+		for (unsigned i = 0; i < count; i++)
+			total_length += (char*)vector[i]->tail - (char*)vector[i]->head;
+/* rate check includes 1 × IP header len */
+		total_length += (count - 1) * sock->iphdr_len;
+		if (NULL == minor_rate_control)
+		{
+			if (!pgm_rate_check (&sock->rate_control, total_length, sock->is_nonblocking, now))
+			{
+				pgm_set_last_sock_error (PGM_SOCK_ENOBUFS);
+				return (const ssize_t)-1;
+			}
+		}
+		else
+		{
+			if (!pgm_rate_check2 (&sock->rate_control, minor_rate_control, total_length, sock->is_nonblocking, now))
+			{
+				pgm_set_last_sock_error (PGM_SOCK_ENOBUFS);
+				return (const ssize_t)-1;
+			}
+		}
+	}
+
+	pgm_zerocopy_t* zc = zerocopy_for_skb (sock, &sock->odata_zerocopy, vector[0]);
+	if (sock->can_send_data)
+		pgm_sock_mutex_lock (sock, &sock->send_mutex);
+	if (NULL != zc)
+		pgm_sock_mutex_lock (sock, &zc->mutex);
+
+#ifdef HAVE_SENDMMSG
+	int flags = 0;
+#	ifdef HAVE_MSG_ZEROCOPY
+/* the whole batch is pinned or none of it */
+	if (NULL != zc) {
+		if (zerocopy_free_len (zc) <= MAX(zc->mask / 2, count))
+			zerocopy_reap (sock->send_sock, zc);
+		if (zerocopy_free_len (zc) >= count)
+			flags = MSG_ZEROCOPY;
+	}
+#	endif
+#	ifdef HAVE_UDP_GSO
+/* zero-copy completions are tracked per datagram so exclude super-buffers,
+ * the remainder follows per datagram when the kernel rejects segmentation.
+ */
+	if (sock->use_udp_gso && 0 == flags) {
+		sent = sendmmsg_gso (sock, vector, count, to, tolen);
+		if (sent > 0)
+			sent_count = (unsigned)sent;
+	}
+	if (!sock->use_udp_gso || 0 != flags)
+#	endif
+	{
+		struct mmsghdr* msgvec = pgm_newa (struct mmsghdr, count);
+		struct iovec* iov = pgm_newa (struct iovec, count);
+		for (unsigned i = 0; i < count; i++)
+		{
+			iov[i].iov_base			= vector[i]->head;
+			iov[i].iov_len			= (char*)vector[i]->tail - (char*)vector[i]->head;
+			msgvec[i].msg_hdr.msg_name	= (void*)to;
+			msgvec[i].msg_hdr.msg_namelen	= tolen;
+			msgvec[i].msg_hdr.msg_iov	= &iov[i];
+			msgvec[i].msg_hdr.msg_iovlen	= 1;
+			msgvec[i].msg_hdr.msg_control	= NULL;
+			msgvec[i].msg_hdr.msg_controllen	= 0;
+			msgvec[i].msg_hdr.msg_flags	= 0;
+			msgvec[i].msg_len		= 0;
+		}
+/* sendmmsg returns early on the first failed datagram after at least one success,
+ * continue until the kernel reports the error directly.
+ */
+		do {
+			sent = sendmmsg (sock->send_sock, msgvec + sent_count, count - sent_count, flags);
+#	ifdef HAVE_MSG_ZEROCOPY
+			if (sent < 0 && MSG_ZEROCOPY == flags && PGM_SOCK_ENOBUFS == pgm_get_last_sock_error()) {
+/* notification memory exhausted, copy the remainder */
+				zerocopy_reap (sock->send_sock, zc);
+				flags = 0;
+				sent = sendmmsg (sock->send_sock, msgvec + sent_count, count - sent_count, flags);
+			}
+			if (sent > 0 && MSG_ZEROCOPY == flags)
+				for (unsigned i = 0; i < (unsigned)sent; i++)
+					zerocopy_pin (zc, vector[sent_count + i]);
+#	endif
+			if (sent > 0)
+				sent_count += (unsigned)sent;
+		} while (sent > 0 && sent_count < count);
+	}
+#else
+	do {
+		const size_t len = (char*)vector[sent_count]->tail - (char*)vector[sent_count]->head;
+		sent = sendto_zerocopy (sock->send_sock, zc, vector[sent_count], vector[sent_count]->head, len, to, tolen);
+		if (sent >= 0)
+			sent_count++;
+	} while (sent >= 0 && sent_count < count);
+#endif /* HAVE_SENDMMSG */
+	pgm_debug ("sendmmsg sent %u of %u", sent_count, count);
+	if (sent < 0 && 0 == sent_count) {
+		const int save_errno = pgm_get_last_sock_error();
+		if (PGM_UNLIKELY(save_errno != PGM_SOCK_ENETUNREACH &&	/* Network is unreachable */
+				 save_errno != PGM_SOCK_EHOSTUNREACH &&	/* No route to host */
+				 save_errno != PGM_SOCK_EAGAIN))	/* would block on non-blocking send */
+		{
+			char errbuf[1024];
+			char toaddr[INET6_ADDRSTRLEN];
+			pgm_sockaddr_ntop (to, toaddr, sizeof(toaddr));
+			pgm_warn (_("sendmmsg() %s failed: %s"),
+				toaddr,
+				pgm_sock_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		}
+	}
+
+	if (NULL != zc)
+		pgm_sock_mutex_unlock (sock, &zc->mutex);
+	if (sock->can_send_data)
+		pgm_sock_mutex_unlock (sock, &sock->send_mutex);
+	return sent_count > 0 ? (ssize_t)sent_count : (ssize_t)-1;
+}
+
+/* prepare a pinned ring for up to len MSG_ZEROCOPY sends in flight, rounded
+ * up to a power of two.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_zerocopy_create (
+	pgm_zerocopy_t*		zc,
+	unsigned		len
+	)
+{
+	pgm_assert (NULL != zc);
+	pgm_assert (len > 0);
+
+	len = (unsigned)pgm_nearest_power (1, len);
+	pgm_mutex_init (&zc->mutex);
+	zc->lead = zc->trail = 0;
+	zc->mask = len - 1;
+	zc->pinned = pgm_new0 (struct pgm_sk_buff_t*, len);
+}
+
+/* release every pinned socket buffer after the descriptor is closed, the
+ * kernel holds its own reference to the pages of any send still queued.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_zerocopy_destroy (
+	pgm_zerocopy_t*		zc
+	)
+{
+	pgm_assert (NULL != zc);
+
+	if (NULL == zc->pinned)
+		return;
+	for (; zc->trail != zc->lead; zc->trail++) {
+		struct pgm_sk_buff_t* skb = zc->pinned[ zc->trail & zc->mask ];
+		if (NULL != skb)
+			pgm_free_skb (skb);
+	}
+	pgm_free (zc->pinned);
+	zc->pinned = NULL;
+	pgm_mutex_free (&zc->mutex);
+}
+
+/* release socket buffers the kernel has finished sending from, called by the
+ * timer and before repairs so that windowed packets are no longer in transit.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_zerocopy_reap (
+	pgm_sock_t*		sock
+	)
+{
+	pgm_assert (NULL != sock);
+
+#ifdef HAVE_MSG_ZEROCOPY
+	if (NULL != sock->odata_zerocopy.pinned) {
+		pgm_sock_mutex_lock (sock, &sock->odata_zerocopy.mutex);
+		zerocopy_reap (sock->send_sock, &sock->odata_zerocopy);
+		pgm_sock_mutex_unlock (sock, &sock->odata_zerocopy.mutex);
+	}
+	if (NULL != sock->rdata_zerocopy.pinned) {
+		pgm_sock_mutex_lock (sock, &sock->rdata_zerocopy.mutex);
+		zerocopy_reap (sock->use_lockless_txw ? sock->repair_sock : sock->send_with_router_alert_sock, &sock->rdata_zerocopy);
+		pgm_sock_mutex_unlock (sock, &sock->rdata_zerocopy.mutex);
+	}
+#else
+	(void)sock;
+#endif
+}
+
 /* socket helper, for setting pipe ends non-blocking
  *
  * on success, returns 0.  on error, returns -1, and sets errno appropriately.
@@ -19,6 +19,9 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#if defined( HAVE_SENDMMSG ) && !defined( _GNU_SOURCE )
+#	define _GNU_SOURCE	/* sendmmsg */
+#endif
 
 #include <signal.h>
 #include <stdbool.h>
@@ -41,8 +44,14 @@
 
 /* mock state */
 
+static unsigned mock_sendmmsg_vlen;
+static size_t mock_sendmmsg_len[ 64 ];
+
 #ifndef _WIN32
 ssize_t mock_sendto (int, const void*, size_t, int, const struct sockaddr*, socklen_t);
+#	ifdef HAVE_SENDMMSG
+int mock_sendmmsg (int, struct mmsghdr*, unsigned int, int);
+#	endif
 #else
 int mock_sendto (SOCKET, const char*, int, int, const struct sockaddr*, int);
 int mock_select (int, fd_set*, fd_set*, fd_set*, struct timeval*);
@@ -51,6 +60,7 @@ int mock_select (int, fd_set*, fd_set*, fd_set*, struct timeval*);
 
 #define pgm_rate_check		mock_pgm_rate_check
 #define sendto			mock_sendto
+#define sendmmsg		mock_sendmmsg
 #define poll			mock_poll
 #define select			mock_select
 #define fcntl			mock_fcntl
@@ -165,7 +175,8 @@ bool
 mock_pgm_rate_check (
 	pgm_rate_t*		bucket,
 	const size_t		data_size,
-	const bool		is_nonblocking
+	const bool		is_nonblocking,
+	pgm_time_t*		now
 	)
 {
 	g_debug ("mock_pgm_rate_check (bucket:%p data-size:%" PRIzu " is-nonblocking:%s)",
@@ -202,6 +213,29 @@ mock_sendto (
 	return len;
 }
 
+#ifdef HAVE_SENDMMSG
+/* record the datagram length of each message */
+int
+mock_sendmmsg (
+	int			s,
+	struct mmsghdr*		msgvec,
+	unsigned int		vlen,
+	int			flags
+	)
+{
+	g_debug ("mock_sendmmsg (s:%i msgvec:%p vlen:%u flags:%s)",
+		s, (gpointer)msgvec, vlen, flags_string (flags));
+	for (unsigned i = 0; i < vlen && mock_sendmmsg_vlen < G_N_ELEMENTS(mock_sendmmsg_len); i++) {
+		size_t len = 0;
+		for (size_t j = 0; j < msgvec[i].msg_hdr.msg_iovlen; j++)
+			len += msgvec[i].msg_hdr.msg_iov[j].iov_len;
+		msgvec[i].msg_len = (unsigned)len;
+		mock_sendmmsg_len[ mock_sendmmsg_vlen++ ] = len;
+	}
+	return (int)vlen;
+}
+#endif
+
 #ifdef HAVE_POLL
 int
 mock_poll (
@@ -265,6 +299,7 @@ mock_fcntl (
  *		pgm_sock_t*		sock,
  *		bool			use_rate_limit,
  *		pgm_rate_t*		minor_rate_control,
+ *		pgm_time_t*		now,
  *		bool			use_router_alert,
  *		const void*		buf,
  *		size_t			len,
@@ -281,7 +316,7 @@ START_TEST (test_sendto_pass_001)
 		.sin_family		= AF_INET,
 		.sin_addr.s_addr	= inet_addr ("172.12.90.1")
 	};
-	gssize len = pgm_sendto (sock, FALSE, NULL, FALSE, buf, sizeof(buf), (struct sockaddr*)&addr, sizeof(addr));
+	gssize len = pgm_sendto (sock, FALSE, NULL, NULL, FALSE, buf, sizeof(buf), (struct sockaddr*)&addr, sizeof(addr));
 	fail_unless (sizeof(buf) == len, "sendto underrun");
 }
 END_TEST
@@ -293,7 +328,7 @@ START_TEST (test_sendto_fail_001)
 		.sin_family		= AF_INET,
 		.sin_addr.s_addr	= inet_addr ("172.12.90.1")
 	};
-	gssize len = pgm_sendto (NULL, FALSE, NULL, FALSE, buf, sizeof(buf), (struct sockaddr*)&addr, sizeof(addr));
+	gssize len = pgm_sendto (NULL, FALSE, NULL, NULL, FALSE, buf, sizeof(buf), (struct sockaddr*)&addr, sizeof(addr));
 	fail ("reached");
 }
 END_TEST
@@ -306,7 +341,7 @@ START_TEST (test_sendto_fail_002)
 		.sin_family		= AF_INET,
 		.sin_addr.s_addr	= inet_addr ("172.12.90.1")
 	};
-	gssize len = pgm_sendto (sock, FALSE, NULL, FALSE, NULL, sizeof(buf), (struct sockaddr*)&addr, sizeof(addr));
+	gssize len = pgm_sendto (sock, FALSE, NULL, NULL, FALSE, NULL, sizeof(buf), (struct sockaddr*)&addr, sizeof(addr));
 	fail ("reached");
 }
 END_TEST
@@ -319,7 +354,7 @@ START_TEST (test_sendto_fail_003)
 		.sin_family		= AF_INET,
 		.sin_addr.s_addr	= inet_addr ("172.12.90.1")
 	};
-	gssize len = pgm_sendto (sock, FALSE, NULL, FALSE, buf, 0, (struct sockaddr*)&addr, sizeof(addr));
+	gssize len = pgm_sendto (sock, FALSE, NULL, NULL, FALSE, buf, 0, (struct sockaddr*)&addr, sizeof(addr));
 	fail ("reached");
 }
 END_TEST
@@ -332,7 +367,7 @@ START_TEST (test_sendto_fail_004)
 		.sin_family		= AF_INET,
 		.sin_addr.s_addr	= inet_addr ("172.12.90.1")
 	};
-	gssize len = pgm_sendto (sock, FALSE, NULL, FALSE, buf, sizeof(buf), NULL, sizeof(addr));
+	gssize len = pgm_sendto (sock, FALSE, NULL, NULL, FALSE, buf, sizeof(buf), NULL, sizeof(addr));
 	fail ("reached");
 }
 END_TEST
@@ -345,7 +380,7 @@ START_TEST (test_sendto_fail_005)
 		.sin_family		= AF_INET,
 		.sin_addr.s_addr	= inet_addr ("172.12.90.1")
 	};
-	gssize len = pgm_sendto (sock, FALSE, NULL, FALSE, buf, sizeof(buf), (struct sockaddr*)&addr, 0);
+	gssize len = pgm_sendto (sock, FALSE, NULL, NULL, FALSE, buf, sizeof(buf), (struct sockaddr*)&addr, 0);
 	fail ("reached");
 }
 END_TEST
@@ -372,6 +407,74 @@ START_TEST (test_set_nonblocking_fail_001)
 }
 END_TEST
 
+#if defined( HAVE_SENDMMSG ) && defined( HAVE_UDP_GSO )
+/* target:
+ *	ssize_t
+ *	sendmmsg_gso (
+ *		pgm_sock_t*		sock,
+ *		struct pgm_sk_buff_t**	vector,
+ *		unsigned		count,
+ *		const struct sockaddr*	to,
+ *		socklen_t		tolen
+ *	)
+ */
+
+static
+void
+generate_gso_vector (
+	struct pgm_sk_buff_t**	vector,
+	const unsigned		count,
+	const uint16_t		len
+	)
+{
+	for (unsigned i = 0; i < count; i++) {
+		vector[i] = pgm_alloc_skb (len);
+		pgm_skb_put (vector[i], len);
+	}
+}
+
+/* IPv4 super-buffer within 65535 less IP and UDP headers */
+START_TEST (test_sendmmsg_gso_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	struct pgm_sk_buff_t* vector[8];
+	struct sockaddr_in to = { .sin_family = AF_INET };
+	sock->family = AF_INET;
+	sock->iphdr_len = sizeof(struct pgm_ip);
+	sock->use_udp_gso = TRUE;
+	mock_sendmmsg_vlen = 0;
+/* 8 × 8189 = 65512, beyond 65507 */
+	generate_gso_vector (vector, G_N_ELEMENTS(vector), 8189);
+	const ssize_t sent = sendmmsg_gso (sock, vector, G_N_ELEMENTS(vector), (struct sockaddr*)&to, sizeof(to));
+	fail_unless ((ssize_t)G_N_ELEMENTS(vector) == sent, "sendmmsg_gso failed");
+	fail_unless (2 == mock_sendmmsg_vlen, "message count");
+	fail_unless (7 * 8189 == mock_sendmmsg_len[0], "first message length");
+	fail_unless (8189 == mock_sendmmsg_len[1], "second message length");
+	for (unsigned i = 0; i < mock_sendmmsg_vlen; i++)
+		fail_unless (mock_sendmmsg_len[i] <= 65535 - sizeof(struct pgm_ip) - sizeof(struct pgm_udphdr), "oversize datagram");
+}
+END_TEST
+
+/* IPv6 payload length excludes the IPv6 header */
+START_TEST (test_sendmmsg_gso_pass_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	struct pgm_sk_buff_t* vector[8];
+	struct sockaddr_in6 to = { .sin6_family = AF_INET6 };
+	sock->family = AF_INET6;
+	sock->iphdr_len = sizeof(struct pgm_ip6_hdr);
+	sock->use_udp_gso = TRUE;
+	mock_sendmmsg_vlen = 0;
+/* 8 × 8190 = 65520, within 65527 */
+	generate_gso_vector (vector, G_N_ELEMENTS(vector), 8190);
+	const ssize_t sent = sendmmsg_gso (sock, vector, G_N_ELEMENTS(vector), (struct sockaddr*)&to, sizeof(to));
+	fail_unless ((ssize_t)G_N_ELEMENTS(vector) == sent, "sendmmsg_gso failed");
+	fail_unless (1 == mock_sendmmsg_vlen, "message count");
+	fail_unless (8 * 8190 == mock_sendmmsg_len[0], "message length");
+}
+END_TEST
+#endif /* HAVE_SENDMMSG && HAVE_UDP_GSO */
+
 
 static
 Suite*
@@ -392,6 +495,13 @@ make_test_suite (void)
 	tcase_add_test_raise_signal (tc_sendto, test_sendto_fail_005, SIGABRT);
 #endif
 
+#if defined( HAVE_SENDMMSG ) && defined( HAVE_UDP_GSO )
+	TCase* tc_sendmmsg_gso = tcase_create ("sendmmsg-gso");
+	suite_add_tcase (s, tc_sendmmsg_gso);
+	tcase_add_test (tc_sendmmsg_gso, test_sendmmsg_gso_pass_001);
+	tcase_add_test (tc_sendmmsg_gso, test_sendmmsg_gso_pass_002);
+#endif
+
 	TCase* tc_set_nonblocking = tcase_create ("set-nonblocking");
 	suite_add_tcase (s, tc_set_nonblocking);
 	tcase_add_test (tc_set_nonblocking, test_set_nonblocking_pass_001);
@@ -22,9 +22,19 @@
 #ifdef HAVE_CONFIG_H
 #	include <config.h>
 #endif
+#ifndef _WIN32
+#	include <errno.h>
+#	include <time.h>
+#endif
 #include <impl/framework.h>
 
 
+/* final stretch of a paced wait that is spun on the clock instead of slept,
+ * covering timer slack and scheduler wake-up latency.
+ */
+#define PGM_RATE_SPIN_USECS	100
+
+
 /* create machinery for rate regulation.
  * the rate_per_sec is ammortized over millisecond time periods.
  *
@@ -69,7 +79,218 @@ pgm_rate_destroy (
 	pgm_spinlock_free (&bucket->spinlock);
 }
 
+/* bucket used by only one thread, i.e. of a single-threaded socket.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_rate_set_single_threaded (
+	pgm_rate_t*		bucket,
+	const bool		is_single_threaded
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != bucket);
+
+	bucket->is_single_threaded = is_single_threaded;
+}
+
+static inline
+void
+pgm_rate_lock (
+	pgm_rate_t*		bucket
+	)
+{
+	if (!bucket->is_single_threaded)
+		pgm_spinlock_lock (&bucket->spinlock);
+}
+
+static inline
+void
+pgm_rate_unlock (
+	pgm_rate_t*		bucket
+	)
+{
+	if (!bucket->is_single_threaded)
+		pgm_spinlock_unlock (&bucket->spinlock);
+}
+
+/* switch the bucket from token bucket regulation to pacing, each packet is
+ * given a departure time spaced from the previous by its transmission time at
+ * the bucket rate, tracked in nanoseconds so that small packets on fast links
+ * keep an exact average rate.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_rate_set_pacing (
+	pgm_rate_t*		bucket,
+	const bool		is_paced
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != bucket);
+
+	bucket->is_paced	= is_paced;
+	bucket->next_departure	= 0;
+}
+
+/* transmission time in nanoseconds of a packet at the bucket rate.
+ */
+
+static inline
+uint64_t
+pgm_rate_cost (
+	const pgm_rate_t*	bucket,
+	const size_t		data_size
+	)
+{
+	return ((uint64_t)(bucket->iphdr_len + data_size) * UINT64_C(1000000000)) / (uint64_t)bucket->rate_per_sec;
+}
+
+/* earliest departure permitted by the bucket, a sender running late may catch
+ * up by at most one packet.
+ */
+
+static inline
+uint64_t
+pgm_rate_slot (
+	const pgm_rate_t*	bucket,
+	const size_t		data_size,
+	const uint64_t		now
+	)
+{
+	const uint64_t cost = pgm_rate_cost (bucket, data_size);
+	const uint64_t earliest = now > cost ? now - cost : 0;
+	return MAX(bucket->next_departure, earliest);
+}
+
+/* block until departure, sleeping through all but the final stretch which is
+ * spun so that sleep overshoot does not delay the packet.
+ *
+ * returns time of departure.
+ */
+
+static
+pgm_time_t
+pgm_rate_wait (
+	const pgm_time_t	departure,
+	pgm_time_t		now
+	)
+{
+	if (departure > now + PGM_RATE_SPIN_USECS)
+	{
+#ifndef _WIN32
+		const pgm_time_t sleep_time = departure - now - PGM_RATE_SPIN_USECS;
+		struct timespec req;
+		req.tv_sec  = (time_t)pgm_to_secs (sleep_time);
+		req.tv_nsec = (long)pgm_to_nsecs (sleep_time % pgm_secs (1));
+#	ifdef HAVE_CLOCK_GETTIME
+		while (EINTR == clock_nanosleep (CLOCK_MONOTONIC, 0, &req, &req));
+#	else
+		while (-1 == nanosleep (&req, &req) && EINTR == errno);
+#	endif
+#else
+/* millisecond sleep granularity is too coarse, yield instead */
+		do {
+			pgm_thread_yield();
+			now = pgm_time_update_now();
+		} while (departure > now + PGM_RATE_SPIN_USECS);
+#endif
+	}
+	do {
+		now = pgm_time_update_now();
+	} while (now < departure);
+	return now;
+}
+
+/* paced check of one or two buckets, the packet departs at the later of now
+ * and the next departure of either bucket, both then advance by the packet's
+ * transmission time at their own rate.  credit beyond one packet is not kept
+ * while idle so packets never leave in bursts.  the departure is reserved
+ * under the major bucket lock and waited for outside of it.
+ */
+
+static
+bool
+pgm_rate_pace (
+	pgm_rate_t*		major_bucket,
+	pgm_rate_t*		minor_bucket,		/* NULL = single bucket */
+	const size_t		data_size,
+	const bool		is_nonblocking,
+	pgm_time_t*		cached_now
+	)
+{
+	const bool has_major = (0 != major_bucket->rate_per_sec);
+	const bool has_minor = (NULL != minor_bucket && 0 != minor_bucket->rate_per_sec);
+	pgm_time_t now = cached_now ? *cached_now : pgm_time_update_now();
+	uint64_t departure = 0;
+
+	if (has_major) {
+		pgm_rate_lock (major_bucket);
+		departure = pgm_rate_slot (major_bucket, data_size, pgm_to_nsecs (now));
+	}
+	if (has_minor) {
+		const uint64_t minor_departure = pgm_rate_slot (minor_bucket, data_size, pgm_to_nsecs (now));
+		departure = MAX(departure, minor_departure);
+	}
+
+	if (is_nonblocking && pgm_nsecs (departure) > now) {
+/* cached time may be stale */
+		if (cached_now)
+			now = pgm_time_update_now();
+		if (pgm_nsecs (departure) > now) {
+			if (has_major)
+				pgm_rate_unlock (major_bucket);
+			return FALSE;
+		}
+	}
+
+/* reserve departure */
+	if (has_major) {
+		major_bucket->next_departure = departure + pgm_rate_cost (major_bucket, data_size);
+		pgm_rate_unlock (major_bucket);
+	}
+	if (has_minor)
+		minor_bucket->next_departure = departure + pgm_rate_cost (minor_bucket, data_size);
+
+	if (pgm_nsecs (departure) > now)
+		now = pgm_rate_wait (pgm_nsecs (departure), now);
+	if (cached_now)
+		*cached_now = now;
+	return TRUE;
+}
+
+/* time until the next paced departure of either bucket.
+ */
+
+static
+pgm_time_t
+pgm_rate_pace_remaining (
+	pgm_rate_t*		major_bucket,
+	pgm_rate_t*		minor_bucket		/* NULL = single bucket */
+	)
+{
+	uint64_t departure = 0;
+	pgm_time_t now;
+
+	if (0 != major_bucket->rate_per_sec) {
+		pgm_rate_lock (major_bucket);
+		departure = major_bucket->next_departure;
+		pgm_rate_unlock (major_bucket);
+	}
+	if (NULL != minor_bucket && 0 != minor_bucket->rate_per_sec &&
+	    minor_bucket->next_departure > departure)
+		departure = minor_bucket->next_departure;
+
+	now = pgm_time_update_now();
+	return pgm_nsecs (departure) > now ? pgm_nsecs (departure) - now : 0;
+}
+
 /* check bit bucket whether an operation can proceed or should wait.
+ *
+ * optional now is the caller's cached time, refreshed when the check has to
+ * wait for tokens so the caller may continue to use it, NULL to read the clock.
  *
  * returns TRUE when leaky bucket permits unless non-blocking flag is set.
  * returns FALSE if operation should block and non-blocking flag is set.
@@ -81,7 +302,8 @@ pgm_rate_check2 (
 	pgm_rate_t*		major_bucket,
 	pgm_rate_t*		minor_bucket,
 	const size_t		data_size,
-	const bool		is_nonblocking
+	const bool		is_nonblocking,
+	pgm_time_t*		cached_now
 	)
 {
 	int64_t new_major_limit, new_minor_limit;
@@ -94,11 +316,16 @@ pgm_rate_check2 (
 
 	if (0 == major_bucket->rate_per_sec && 0 == minor_bucket->rate_per_sec)
 		return TRUE;
+	if (major_bucket->is_paced || minor_bucket->is_paced)
+		return pgm_rate_pace (major_bucket, minor_bucket, data_size, is_nonblocking, cached_now);
 
+	now = cached_now ? *cached_now : pgm_time_update_now();
 	if (0 != major_bucket->rate_per_sec)
 	{
-		pgm_spinlock_lock (&major_bucket->spinlock);
-		now = pgm_time_update_now();
+		pgm_rate_lock (major_bucket);
+/* cached time may predate another thread's check */
+		if (PGM_UNLIKELY(now < major_bucket->last_rate_check))
+			now = major_bucket->last_rate_check;
 
 		if (major_bucket->rate_per_msec)
 		{
@@ -125,7 +352,7 @@ pgm_rate_check2 (
 
 		new_major_limit -= ( major_bucket->iphdr_len + data_size );
 		if (is_nonblocking && new_major_limit < 0) {
-			pgm_spinlock_unlock (&major_bucket->spinlock);
+			pgm_rate_unlock (major_bucket);
 			return FALSE;
 		}
 
@@ -140,14 +367,11 @@ pgm_rate_check2 (
 			new_major_limit += sleep_amount;
 		} 
 	}
-	else
-	{
-/* ensure we have a timestamp */
-		now = pgm_time_update_now();
-	}
 
 	if (0 != minor_bucket->rate_per_sec)
 	{
+		if (PGM_UNLIKELY(now < minor_bucket->last_rate_check))
+			now = minor_bucket->last_rate_check;
 		if (minor_bucket->rate_per_msec)
 		{
 			const pgm_time_t time_since_last_rate_check = now - minor_bucket->last_rate_check;
@@ -174,7 +398,7 @@ pgm_rate_check2 (
 		new_minor_limit -= ( minor_bucket->iphdr_len + data_size );
 		if (is_nonblocking && new_minor_limit < 0) {
 			if (0 != major_bucket->rate_per_sec)
-				pgm_spinlock_unlock (&major_bucket->spinlock);
+				pgm_rate_unlock (major_bucket);
 			return FALSE;
 		}
 
@@ -186,7 +410,7 @@ pgm_rate_check2 (
 	if (0 != major_bucket->rate_per_sec) {
 		major_bucket->rate_limit = new_major_limit;
 		major_bucket->last_rate_check = now;
-		pgm_spinlock_unlock (&major_bucket->spinlock);
+		pgm_rate_unlock (major_bucket);
 	}
 
 /* sleep on minor bucket outside of lock */
@@ -201,6 +425,8 @@ pgm_rate_check2 (
 		minor_bucket->last_rate_check = now;
 	} 
 
+	if (cached_now)
+		*cached_now = now;
 	return TRUE;
 }
 
@@ -209,7 +435,8 @@ bool
 pgm_rate_check (
 	pgm_rate_t*		bucket,
 	const size_t		data_size,
-	const bool		is_nonblocking
+	const bool		is_nonblocking,
+	pgm_time_t*		cached_now
 	)
 {
 	int64_t new_rate_limit;
@@ -220,9 +447,13 @@ pgm_rate_check (
 
 	if (0 == bucket->rate_per_sec)
 		return TRUE;
+	if (bucket->is_paced)
+		return pgm_rate_pace (bucket, NULL, data_size, is_nonblocking, cached_now);
 
-	pgm_spinlock_lock (&bucket->spinlock);
-	pgm_time_t now = pgm_time_update_now();
+	pgm_rate_lock (bucket);
+	pgm_time_t now = cached_now ? *cached_now : pgm_time_update_now();
+	if (PGM_UNLIKELY(now < bucket->last_rate_check))
+		now = bucket->last_rate_check;
 
 	if (bucket->rate_per_msec)
 	{
@@ -249,7 +480,7 @@ pgm_rate_check (
 
 	new_rate_limit -= ( bucket->iphdr_len + data_size );
 	if (is_nonblocking && new_rate_limit < 0) {
-		pgm_spinlock_unlock (&bucket->spinlock);
+		pgm_rate_unlock (bucket);
 		return FALSE;
 	}
 
@@ -265,7 +496,9 @@ pgm_rate_check (
 		bucket->rate_limit += sleep_amount;
 		bucket->last_rate_check = now;
 	} 
-	pgm_spinlock_unlock (&bucket->spinlock);
+	pgm_rate_unlock (bucket);
+	if (cached_now)
+		*cached_now = now;
 	return TRUE;
 }
 
@@ -286,10 +519,12 @@ pgm_rate_remaining2 (
 
 	if (PGM_UNLIKELY(0 == major_bucket->rate_per_sec && 0 == minor_bucket->rate_per_sec))
 		return remaining;
+	if (major_bucket->is_paced || minor_bucket->is_paced)
+		return pgm_rate_pace_remaining (major_bucket, minor_bucket);
 
 	if (0 != major_bucket->rate_per_sec)
 	{
-		pgm_spinlock_lock (&major_bucket->spinlock);
+		pgm_rate_lock (major_bucket);
 		now = pgm_time_update_now();
 		const int64_t bucket_bytes = major_bucket->rate_limit + pgm_to_secs (major_bucket->rate_per_sec * (now - major_bucket->last_rate_check)) - n;
 
@@ -318,7 +553,7 @@ pgm_rate_remaining2 (
 
 	if (0 != major_bucket->rate_per_sec)
 	{
-		pgm_spinlock_unlock (&major_bucket->spinlock);
+		pgm_rate_unlock (major_bucket);
 	}
 
 	return remaining;
@@ -336,12 +571,14 @@ pgm_rate_remaining (
 
 	if (PGM_UNLIKELY(0 == bucket->rate_per_sec))
 		return 0;
+	if (bucket->is_paced)
+		return pgm_rate_pace_remaining (bucket, NULL);
 
-	pgm_spinlock_lock (&bucket->spinlock);
+	pgm_rate_lock (bucket);
 	const pgm_time_t now = pgm_time_update_now();
 	const pgm_time_t time_since_last_rate_check = now - bucket->last_rate_check;
 	const int64_t bucket_bytes = bucket->rate_limit + pgm_to_secs (bucket->rate_per_sec * time_since_last_rate_check) - n;
-	pgm_spinlock_unlock (&bucket->spinlock);
+	pgm_rate_unlock (bucket);
 
 	if (bucket_bytes >= 0)
 		return 0;
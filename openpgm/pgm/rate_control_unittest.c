@@ -126,7 +126,8 @@ END_TEST
  *	pgm_rate_check (
  *		pgm_rate_t*		bucket,
  *		const size_t		data_size,
- *		const bool		is_nonblocking
+ *		const bool		is_nonblocking,
+ *		pgm_time_t*		now
  *	)
  *
  * 001: should use seconds resolution to allow 2 packets through then fault.
@@ -138,16 +139,16 @@ START_TEST (test_check_pass_001)
 	memset (&rate, 0, sizeof(rate));
 	pgm_rate_create (&rate, 2*1010, 10, 1500);
 	mock_pgm_time_now += pgm_secs(2);
-	fail_unless (TRUE == pgm_rate_check (&rate, 1000, TRUE), "rate_check failed");
-	fail_unless (TRUE == pgm_rate_check (&rate, 1000, TRUE), "rate_check failed");
-	fail_unless (FALSE == pgm_rate_check (&rate, 1000, TRUE), "rate_check failed");
+	fail_unless (TRUE == pgm_rate_check (&rate, 1000, TRUE, NULL), "rate_check failed");
+	fail_unless (TRUE == pgm_rate_check (&rate, 1000, TRUE, NULL), "rate_check failed");
+	fail_unless (FALSE == pgm_rate_check (&rate, 1000, TRUE, NULL), "rate_check failed");
 	pgm_rate_destroy (&rate);
 }
 END_TEST
 
 START_TEST (test_check_fail_001)
 {
-	pgm_rate_check (NULL, 1000, FALSE);
+	pgm_rate_check (NULL, 1000, FALSE, NULL);
 	fail ("reached");
 }
 END_TEST
@@ -161,8 +162,8 @@ START_TEST (test_check_pass_002)
 	memset (&rate, 0, sizeof(rate));
 	pgm_rate_create (&rate, 2*900, 10, 1500);
 	mock_pgm_time_now += pgm_secs(2);
-	fail_unless (TRUE == pgm_rate_check (&rate, 1000, TRUE), "rate_check failed");
-	fail_unless (FALSE == pgm_rate_check (&rate, 1000, TRUE), "rate_check failed");
+	fail_unless (TRUE == pgm_rate_check (&rate, 1000, TRUE, NULL), "rate_check failed");
+	fail_unless (FALSE == pgm_rate_check (&rate, 1000, TRUE, NULL), "rate_check failed");
 	pgm_rate_destroy (&rate);
 }
 END_TEST
@@ -176,28 +177,46 @@ START_TEST (test_check_pass_003)
 	memset (&rate, 0, sizeof(rate));
 	pgm_rate_create (&rate, 2*1010*1000, 10, 1500);
 	mock_pgm_time_now += pgm_secs(2);
-	fail_unless (TRUE == pgm_rate_check (&rate, 1000, TRUE), "rate_check failed");
-	fail_unless (TRUE == pgm_rate_check (&rate, 1000, TRUE), "rate_check failed");
-	fail_unless (FALSE == pgm_rate_check (&rate, 1000, TRUE), "rate_check failed");
+	fail_unless (TRUE == pgm_rate_check (&rate, 1000, TRUE, NULL), "rate_check failed");
+	fail_unless (TRUE == pgm_rate_check (&rate, 1000, TRUE, NULL), "rate_check failed");
+	fail_unless (FALSE == pgm_rate_check (&rate, 1000, TRUE, NULL), "rate_check failed");
 /* duplicate check at same time point */
-	fail_unless (FALSE == pgm_rate_check (&rate, 1000, TRUE), "rate_check failed");
+	fail_unless (FALSE == pgm_rate_check (&rate, 1000, TRUE, NULL), "rate_check failed");
 /* advance time causing a millisecond fill to occur */
 	mock_pgm_time_now += pgm_msecs(1);
-	fail_unless (TRUE == pgm_rate_check (&rate, 1000, TRUE), "rate_check failed");
-	fail_unless (TRUE == pgm_rate_check (&rate, 1000, TRUE), "rate_check failed");
-	fail_unless (FALSE == pgm_rate_check (&rate, 1000, TRUE), "rate_check failed");
+	fail_unless (TRUE == pgm_rate_check (&rate, 1000, TRUE, NULL), "rate_check failed");
+	fail_unless (TRUE == pgm_rate_check (&rate, 1000, TRUE, NULL), "rate_check failed");
+	fail_unless (FALSE == pgm_rate_check (&rate, 1000, TRUE, NULL), "rate_check failed");
 /* advance time to fill bucket enough for only one packet */
 	mock_pgm_time_now += pgm_usecs(500);
-	fail_unless (TRUE == pgm_rate_check (&rate, 1000, TRUE), "rate_check failed");
-	fail_unless (FALSE == pgm_rate_check (&rate, 1000, TRUE), "rate_check failed");
+	fail_unless (TRUE == pgm_rate_check (&rate, 1000, TRUE, NULL), "rate_check failed");
+	fail_unless (FALSE == pgm_rate_check (&rate, 1000, TRUE, NULL), "rate_check failed");
 /* advance time to fill the bucket a little but not enough for one packet */
 	mock_pgm_time_now += pgm_usecs(100);
-	fail_unless (FALSE == pgm_rate_check (&rate, 1000, TRUE), "rate_check failed");
+	fail_unless (FALSE == pgm_rate_check (&rate, 1000, TRUE, NULL), "rate_check failed");
 /* advance time a lot, should be limited to millisecond fill rate */
 	mock_pgm_time_now += pgm_secs(10);
-	fail_unless (TRUE == pgm_rate_check (&rate, 1000, TRUE), "rate_check failed");
-	fail_unless (TRUE == pgm_rate_check (&rate, 1000, TRUE), "rate_check failed");
-	fail_unless (FALSE == pgm_rate_check (&rate, 1000, TRUE), "rate_check failed");
+	fail_unless (TRUE == pgm_rate_check (&rate, 1000, TRUE, NULL), "rate_check failed");
+	fail_unless (TRUE == pgm_rate_check (&rate, 1000, TRUE, NULL), "rate_check failed");
+	fail_unless (FALSE == pgm_rate_check (&rate, 1000, TRUE, NULL), "rate_check failed");
+	pgm_rate_destroy (&rate);
+}
+END_TEST
+
+/* 004: cached time is used in place of the clock and a stale time must not refill the bucket.
+ */
+
+START_TEST (test_check_pass_004)
+{
+	pgm_rate_t rate;
+	memset (&rate, 0, sizeof(rate));
+	pgm_rate_create (&rate, 2*1010, 10, 1500);
+	pgm_time_t now = mock_pgm_time_now + pgm_secs(2);
+	fail_unless (TRUE == pgm_rate_check (&rate, 1000, TRUE, &now), "rate_check failed");
+	fail_unless (TRUE == pgm_rate_check (&rate, 1000, TRUE, &now), "rate_check failed");
+	fail_unless (FALSE == pgm_rate_check (&rate, 1000, TRUE, &now), "rate_check failed");
+	now -= pgm_secs(2);
+	fail_unless (FALSE == pgm_rate_check (&rate, 1000, TRUE, &now), "rate_check failed");
 	pgm_rate_destroy (&rate);
 }
 END_TEST
@@ -208,7 +227,8 @@ END_TEST
  *		pgm_rate_t*		major_bucket,
  *		pgm_rate_t*		minor_bucket,
  *		const size_t		data_size,
- *		const bool		is_nonblocking
+ *		const bool		is_nonblocking,
+ *		pgm_time_t*		now
  *	)
  *
  * 001: should use seconds resolution to allow 2 packets through then fault.
@@ -224,9 +244,9 @@ START_TEST (test_check2_pass_001)
 	mock_pgm_time_now = 1;
 	pgm_rate_create (&major, 2*1010, 10, 1500);
 	mock_pgm_time_now += pgm_secs(2);
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:major#1 failed");
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:major#2 failed");
-	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:major#3 failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:major#1 failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:major#2 failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:major#3 failed");
 	pgm_rate_destroy (&major);
 
 /* minor-only */
@@ -235,9 +255,9 @@ START_TEST (test_check2_pass_001)
 	mock_pgm_time_now = 1;
 	pgm_rate_create (&minor, 2*1010, 10, 1500);
 	mock_pgm_time_now += pgm_secs(2);
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:minor failed");
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:minor failed");
-	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:minor failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:minor failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:minor failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:minor failed");
 	pgm_rate_destroy (&minor);
 
 /* major with large minor */
@@ -247,9 +267,9 @@ START_TEST (test_check2_pass_001)
 	pgm_rate_create (&major, 2*1010, 10, 1500);
 	pgm_rate_create (&minor, 999*1010, 10, 1500);
 	mock_pgm_time_now += pgm_secs(2);
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1<2 failed");
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1<2 failed");
-	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1<2 failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1<2 failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1<2 failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1<2 failed");
 	pgm_rate_destroy (&major);
 	pgm_rate_destroy (&minor);
 
@@ -260,9 +280,9 @@ START_TEST (test_check2_pass_001)
 	pgm_rate_create (&major, 999*1010, 10, 1500);
 	pgm_rate_create (&minor, 2*1010, 10, 1500);
 	mock_pgm_time_now += pgm_secs(2);
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1>2 failed");
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1>2 failed");
-	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1>2 failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1>2 failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1>2 failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1>2 failed");
 	pgm_rate_destroy (&major);
 	pgm_rate_destroy (&minor);
 
@@ -273,9 +293,9 @@ START_TEST (test_check2_pass_001)
 	pgm_rate_create (&major, 2*1010, 10, 1500);
 	pgm_rate_create (&minor, 2*1010, 10, 1500);
 	mock_pgm_time_now += pgm_secs(2);
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1=2 failed");
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1=2 failed");
-	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1=2 failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1=2 failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1=2 failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1=2 failed");
 	pgm_rate_destroy (&major);
 	pgm_rate_destroy (&minor);
 }
@@ -283,7 +303,7 @@ END_TEST
 
 START_TEST (test_check2_fail_001)
 {
-	pgm_rate_check2 (NULL, NULL, 1000, FALSE);
+	pgm_rate_check2 (NULL, NULL, 1000, FALSE, NULL);
 	fail ("reached");
 }
 END_TEST
@@ -301,8 +321,8 @@ START_TEST (test_check2_pass_002)
 	mock_pgm_time_now = 1;
 	pgm_rate_create (&major, 2*900, 10, 1500);
 	mock_pgm_time_now += pgm_secs(2);
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:major failed");
-	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:major failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:major failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:major failed");
 	pgm_rate_destroy (&major);
 
 /* minor-only */
@@ -311,8 +331,8 @@ START_TEST (test_check2_pass_002)
 	mock_pgm_time_now = 1;
 	pgm_rate_create (&minor, 2*900, 10, 1500);
 	mock_pgm_time_now += pgm_secs(2);
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:minor failed");
-	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:minor failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:minor failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:minor failed");
 	pgm_rate_destroy (&minor);
 
 /* major with large minor */
@@ -322,8 +342,8 @@ START_TEST (test_check2_pass_002)
 	pgm_rate_create (&major, 2*900, 10, 1500);
 	pgm_rate_create (&minor, 999*1010, 10, 1500);
 	mock_pgm_time_now += pgm_secs(2);
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1<2 failed");
-	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1<2 failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1<2 failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1<2 failed");
 	pgm_rate_destroy (&major);
 	pgm_rate_destroy (&minor);
 
@@ -334,8 +354,8 @@ START_TEST (test_check2_pass_002)
 	pgm_rate_create (&major, 999*1010, 10, 1500);
 	pgm_rate_create (&minor, 2*900, 10, 1500);
 	mock_pgm_time_now += pgm_secs(2);
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1>2 failed");
-	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1>2 failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1>2 failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1>2 failed");
 	pgm_rate_destroy (&major);
 	pgm_rate_destroy (&minor);
 
@@ -346,8 +366,8 @@ START_TEST (test_check2_pass_002)
 	pgm_rate_create (&major, 2*900, 10, 1500);
 	pgm_rate_create (&minor, 2*900, 10, 1500);
 	mock_pgm_time_now += pgm_secs(2);
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1=2 failed");
-	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1=2 failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1=2 failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1=2 failed");
 	pgm_rate_destroy (&major);
 	pgm_rate_destroy (&minor);
 }
@@ -366,28 +386,28 @@ START_TEST (test_check2_pass_003)
 	mock_pgm_time_now = 1;
 	pgm_rate_create (&major, 2*1010*1000, 10, 1500);
 	mock_pgm_time_now += pgm_secs(2);
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:major failed");
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:major failed");
-	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:major failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:major failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:major failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:major failed");
 /* duplicate check at same time point */
-	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:major failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:major failed");
 /* advance time causing a millisecond fill to occur */
 	mock_pgm_time_now += pgm_msecs(1);
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:major failed");
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:major failed");
-	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:major failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:major failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:major failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:major failed");
 /* advance time to fill bucket enough for only one packet */
 	mock_pgm_time_now += pgm_usecs(500);
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:major failed");
-	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:major failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:major failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:major failed");
 /* advance time to fill the bucket a little but not enough for one packet */
 	mock_pgm_time_now += pgm_usecs(100);
-	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:major failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:major failed");
 /* advance time a lot, should be limited to millisecond fill rate */
 	mock_pgm_time_now += pgm_secs(10);
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:major failed");
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:major failed");
-	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:major failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:major failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:major failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:major failed");
 	pgm_rate_destroy (&major);
 
 /** minor-only **/
@@ -396,28 +416,28 @@ START_TEST (test_check2_pass_003)
 	mock_pgm_time_now = 1;
 	pgm_rate_create (&minor, 2*1010*1000, 10, 1500);
 	mock_pgm_time_now += pgm_secs(2);
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:minor failed");
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:minor failed");
-	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:minor failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:minor failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:minor failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:minor failed");
 /* duplicate check at same time point */
-	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:minor failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:minor failed");
 /* advance time causing a millisecond fill to occur */
 	mock_pgm_time_now += pgm_msecs(1);
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:minor failed");
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:minor failed");
-	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:minor failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:minor failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:minor failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:minor failed");
 /* advance time to fill bucket enough for only one packet */
 	mock_pgm_time_now += pgm_usecs(500);
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:minor failed");
-	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:minor failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:minor failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:minor failed");
 /* advance time to fill the bucket a little but not enough for one packet */
 	mock_pgm_time_now += pgm_usecs(100);
-	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:minor failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:minor failed");
 /* advance time a lot, should be limited to millisecond fill rate */
 	mock_pgm_time_now += pgm_secs(10);
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:minor failed");
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:minor failed");
-	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:minor failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:minor failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:minor failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:minor failed");
 	pgm_rate_destroy (&minor);
 
 /** major with large minor **/
@@ -427,28 +447,28 @@ START_TEST (test_check2_pass_003)
 	pgm_rate_create (&major, 2*1010*1000, 10, 1500);
 	pgm_rate_create (&minor, 999*1010*1000, 10, 1500);
 	mock_pgm_time_now += pgm_secs(2);
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1<2 failed");
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1<2 failed");
-	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1<2 failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1<2 failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1<2 failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1<2 failed");
 /* duplicate check at same time point */
-	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1<2 failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1<2 failed");
 /* advance time causing a millisecond fill to occur */
 	mock_pgm_time_now += pgm_msecs(1);
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1<2 failed");
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1<2 failed");
-	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1<2 failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1<2 failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1<2 failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1<2 failed");
 /* advance time to fill bucket enough for only one packet */
 	mock_pgm_time_now += pgm_usecs(500);
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1<2 failed");
-	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1<2 failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1<2 failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1<2 failed");
 /* advance time to fill the bucket a little but not enough for one packet */
 	mock_pgm_time_now += pgm_usecs(100);
-	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1<2 failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1<2 failed");
 /* advance time a lot, should be limited to millisecond fill rate */
 	mock_pgm_time_now += pgm_secs(10);
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1<2 failed");
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1<2 failed");
-	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1<2 failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1<2 failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1<2 failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1<2 failed");
 	pgm_rate_destroy (&major);
 	pgm_rate_destroy (&minor);
 
@@ -459,28 +479,28 @@ START_TEST (test_check2_pass_003)
 	pgm_rate_create (&major, 999*1010*1000, 10, 1500);
 	pgm_rate_create (&minor, 2*1010*1000, 10, 1500);
 	mock_pgm_time_now += pgm_secs(2);
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1>2 failed");
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1>2 failed");
-	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1>2 failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1>2 failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1>2 failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1>2 failed");
 /* duplicate check at same time point */
-	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1>2 failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1>2 failed");
 /* advance time causing a millisecond fill to occur */
 	mock_pgm_time_now += pgm_msecs(1);
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1>2 failed");
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1>2 failed");
-	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:>>2 failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1>2 failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1>2 failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:>>2 failed");
 /* advance time to fill bucket enough for only one packet */
 	mock_pgm_time_now += pgm_usecs(500);
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1>2 failed");
-	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1>2 failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1>2 failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1>2 failed");
 /* advance time to fill the bucket a little but not enough for one packet */
 	mock_pgm_time_now += pgm_usecs(100);
-	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1>2 failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1>2 failed");
 /* advance time a lot, should be limited to millisecond fill rate */
 	mock_pgm_time_now += pgm_secs(10);
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1>2 failed");
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1>2 failed");
-	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1>2 failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1>2 failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1>2 failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1>2 failed");
 	pgm_rate_destroy (&major);
 	pgm_rate_destroy (&minor);
 
@@ -491,34 +511,102 @@ START_TEST (test_check2_pass_003)
 	pgm_rate_create (&major, 2*1010*1000, 10, 1500);
 	pgm_rate_create (&minor, 2*1010*1000, 10, 1500);
 	mock_pgm_time_now += pgm_secs(2);
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1=2 failed");
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1=2 failed");
-	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1=2 failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1=2 failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1=2 failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1=2 failed");
 /* duplicate check at same time point */
-	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1=2 failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1=2 failed");
 /* advance time causing a millisecond fill to occur */
 	mock_pgm_time_now += pgm_msecs(1);
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1=2 failed");
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1=2 failed");
-	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1=2 failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1=2 failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1=2 failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1=2 failed");
 /* advance time to fill bucket enough for only one packet */
 	mock_pgm_time_now += pgm_usecs(500);
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1=2 failed");
-	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1=2 failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1=2 failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1=2 failed");
 /* advance time to fill the bucket a little but not enough for one packet */
 	mock_pgm_time_now += pgm_usecs(100);
-	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1=2 failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1=2 failed");
 /* advance time a lot, should be limited to millisecond fill rate */
 	mock_pgm_time_now += pgm_secs(10);
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1=2 failed");
-	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1=2 failed");
-	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE), "rate_check2:1=2 failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1=2 failed");
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1=2 failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2:1=2 failed");
 	pgm_rate_destroy (&major);
 	pgm_rate_destroy (&minor);
 
 }
 END_TEST
 
+/* target:
+ *	void
+ *	pgm_rate_set_pacing (
+ *		pgm_rate_t*		bucket,
+ *		const bool		is_paced
+ *	)
+ *
+ * 001: paced bucket spaces packets by transmission time and keeps at most one packet of credit.
+ */
+
+START_TEST (test_pacing_pass_001)
+{
+	pgm_rate_t rate;
+	memset (&rate, 0, sizeof(rate));
+	pgm_rate_create (&rate, 1010*1000, 10, 1500);
+	pgm_rate_set_pacing (&rate, TRUE);
+	mock_pgm_time_now += pgm_secs(2);
+	fail_unless (TRUE == pgm_rate_check (&rate, 1000, TRUE, NULL), "rate_check failed");
+	fail_unless (TRUE == pgm_rate_check (&rate, 1000, TRUE, NULL), "rate_check failed");
+	fail_unless (FALSE == pgm_rate_check (&rate, 1000, TRUE, NULL), "rate_check failed");
+	fail_unless (pgm_msecs(1) == pgm_rate_remaining (&rate, 1000), "rate_remaining failed");
+/* half way to next departure */
+	mock_pgm_time_now += pgm_usecs(500);
+	fail_unless (FALSE == pgm_rate_check (&rate, 1000, TRUE, NULL), "rate_check failed");
+	fail_unless (pgm_usecs(500) == pgm_rate_remaining (&rate, 1000), "rate_remaining failed");
+	mock_pgm_time_now += pgm_usecs(500);
+	fail_unless (TRUE == pgm_rate_check (&rate, 1000, TRUE, NULL), "rate_check failed");
+	fail_unless (FALSE == pgm_rate_check (&rate, 1000, TRUE, NULL), "rate_check failed");
+/* idle time must not accumulate into a burst */
+	mock_pgm_time_now += pgm_secs(10);
+	fail_unless (TRUE == pgm_rate_check (&rate, 1000, TRUE, NULL), "rate_check failed");
+	fail_unless (TRUE == pgm_rate_check (&rate, 1000, TRUE, NULL), "rate_check failed");
+	fail_unless (FALSE == pgm_rate_check (&rate, 1000, TRUE, NULL), "rate_check failed");
+	pgm_rate_destroy (&rate);
+}
+END_TEST
+
+/* 002: paced major and minor buckets depart at the slower rate.
+ */
+
+START_TEST (test_pacing_pass_002)
+{
+	pgm_rate_t major, minor;
+	memset (&major, 0, sizeof(major));
+	memset (&minor, 0, sizeof(minor));
+	pgm_rate_create (&major, 2*1010*1000, 10, 1500);
+	pgm_rate_create (&minor, 1010*1000, 10, 1500);
+	pgm_rate_set_pacing (&major, TRUE);
+	pgm_rate_set_pacing (&minor, TRUE);
+	mock_pgm_time_now += pgm_secs(2);
+/* credit is limited to one packet of the faster major bucket */
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2 failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2 failed");
+	fail_unless (pgm_usecs(500) == pgm_rate_remaining2 (&major, &minor, 1000), "rate_remaining2 failed");
+	mock_pgm_time_now += pgm_usecs(500);
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2 failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2 failed");
+	fail_unless (pgm_msecs(1) == pgm_rate_remaining2 (&major, &minor, 1000), "rate_remaining2 failed");
+	mock_pgm_time_now += pgm_usecs(500);
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2 failed");
+	mock_pgm_time_now += pgm_usecs(500);
+	fail_unless (TRUE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2 failed");
+	fail_unless (FALSE == pgm_rate_check2 (&major, &minor, 1000, TRUE, NULL), "rate_check2 failed");
+	pgm_rate_destroy (&major);
+	pgm_rate_destroy (&minor);
+}
+END_TEST
+
 
 static
 Suite*
@@ -547,6 +635,7 @@ make_test_suite (void)
 	tcase_add_test (tc_check, test_check_pass_001);
 	tcase_add_test (tc_check, test_check_pass_002);
 	tcase_add_test (tc_check, test_check_pass_003);
+	tcase_add_test (tc_check, test_check_pass_004);
 #ifndef PGM_CHECK_NOFORK
 	tcase_add_test_raise_signal (tc_check, test_check_fail_001, SIGABRT);
 #endif
@@ -559,6 +648,11 @@ make_test_suite (void)
 #ifndef PGM_CHECK_NOFORK
 	tcase_add_test_raise_signal (tc_check2, test_check2_fail_001, SIGABRT);
 #endif
+
+	TCase* tc_pacing = tcase_create ("pacing");
+	suite_add_tcase (s, tc_pacing);
+	tcase_add_test (tc_pacing, test_pacing_pass_001);
+	tcase_add_test (tc_pacing, test_pacing_pass_002);
 	return s;
 }
 
@@ -150,6 +150,124 @@ nak_rb_ivl (
 	return pgm_rand_int_range (&sock->rand_, 1 /* us */, (int32_t)sock->nak_bo_ivl);
 }
 
+/* earliest timer expiration of a peer across SPMR, ACK and NAK state
+ * queues, and peer expiration.
+ */
+
+static
+pgm_time_t
+peer_next_expiry (
+	const pgm_peer_t*	peer
+	)
+{
+	pgm_time_t expiry = peer->expiry;
+
+	if (peer->spmr_expiry && pgm_time_after (expiry, peer->spmr_expiry))
+		expiry = peer->spmr_expiry;
+	if (peer->window->ack_backoff_queue.tail && pgm_time_after (expiry, next_ack_rb_expiry (peer->window)))
+		expiry = next_ack_rb_expiry (peer->window);
+	if (peer->window->nak_backoff_queue.tail && pgm_time_after (expiry, next_nak_rb_expiry (peer->window)))
+		expiry = next_nak_rb_expiry (peer->window);
+	if (peer->window->wait_ncf_queue.tail && pgm_time_after (expiry, next_nak_rpt_expiry (peer->window)))
+		expiry = next_nak_rpt_expiry (peer->window);
+	if (peer->window->wait_data_queue.tail && pgm_time_after (expiry, next_nak_rdata_expiry (peer->window)))
+		expiry = next_nak_rdata_expiry (peer->window);
+	return expiry;
+}
+
+/* binary min-heap of peers ordered by next timer expiration, the timer
+ * only visits peers that are due.
+ */
+
+static inline
+void
+peer_heap_swap (
+	pgm_sock_t*		sock,
+	const unsigned		i,
+	const unsigned		j
+	)
+{
+	pgm_peer_t* peer = sock->peers_heap[i];
+	sock->peers_heap[i] = sock->peers_heap[j];
+	sock->peers_heap[j] = peer;
+	sock->peers_heap[i]->heap_index = i;
+	sock->peers_heap[j]->heap_index = j;
+}
+
+static
+void
+peer_heap_sift_up (
+	pgm_sock_t*		sock,
+	unsigned		i
+	)
+{
+	while (i > 0) {
+		const unsigned parent = (i - 1) / 2;
+		if (!pgm_time_after (sock->peers_heap[parent]->next_expiry, sock->peers_heap[i]->next_expiry))
+			break;
+		peer_heap_swap (sock, i, parent);
+		i = parent;
+	}
+}
+
+static
+void
+peer_heap_sift_down (
+	pgm_sock_t*		sock,
+	unsigned		i
+	)
+{
+	for (;;) {
+		const unsigned left = (2 * i) + 1, right = left + 1;
+		unsigned smallest = i;
+		if (left < sock->peers_heap_len &&
+		    pgm_time_after (sock->peers_heap[smallest]->next_expiry, sock->peers_heap[left]->next_expiry))
+			smallest = left;
+		if (right < sock->peers_heap_len &&
+		    pgm_time_after (sock->peers_heap[smallest]->next_expiry, sock->peers_heap[right]->next_expiry))
+			smallest = right;
+		if (smallest == i)
+			break;
+		peer_heap_swap (sock, i, smallest);
+		i = smallest;
+	}
+}
+
+static
+void
+peer_heap_insert (
+	pgm_sock_t*	    restrict sock,
+	pgm_peer_t*	    restrict peer
+	)
+{
+	if (sock->peers_heap_len == sock->peers_heap_alloc) {
+		sock->peers_heap_alloc = sock->peers_heap_alloc ? (2 * sock->peers_heap_alloc) : 16;
+		sock->peers_heap = pgm_realloc (sock->peers_heap, sock->peers_heap_alloc * sizeof(pgm_peer_t*));
+	}
+	peer->heap_index = sock->peers_heap_len++;
+	peer->next_expiry = peer_next_expiry (peer);
+	sock->peers_heap[ peer->heap_index ] = peer;
+	peer_heap_sift_up (sock, peer->heap_index);
+}
+
+static
+void
+peer_heap_remove (
+	pgm_sock_t*	    restrict sock,
+	pgm_peer_t*	    restrict peer
+	)
+{
+	const unsigned i = peer->heap_index;
+
+	pgm_assert (sock->peers_heap[i] == peer);
+
+	if (i != --sock->peers_heap_len) {
+		peer_heap_swap (sock, i, sock->peers_heap_len);
+		peer_heap_sift_up (sock, i);
+		peer_heap_sift_down (sock, i);
+	}
+}
+
 /* mark sequence as recovery failed.
  */
 
@@ -416,14 +534,16 @@ pgm_new_peer (
 					sock->rxw_secs,
 					sock->rxw_max_rte,
 					sock->ack_c_p);
+	peer->window->skb_pool = sock->skb_pool;
 	peer->spmr_expiry = now + sock->spmr_expiry;
 
 /* add peer to hash table and linked list */
 	pgm_rwlock_writer_lock (&sock->peers_lock);
-	pgm_hashtable_insert (sock->peers_hashtable, &peer->tsi, _pgm_peer_ref (peer));
+	pgm_tsitable_insert (sock->peers_table, &peer->tsi, _pgm_peer_ref (peer));
 	peer->peers_link.data = peer;
 	sock->peers_list = pgm_list_prepend_link (sock->peers_list, &peer->peers_link);
 	pgm_rwlock_writer_unlock (&sock->peers_lock);
+	peer_heap_insert (sock, peer);
 
 	pgm_timer_lock (sock);
 	if (pgm_time_after( sock->next_poll, peer->spmr_expiry ))
@@ -445,7 +565,8 @@ pgm_flush_peers_pending (
 	struct pgm_msgv_t**    	       restrict	pmsg,
 	const struct pgm_msgv_t* const		msg_end,	/* at least pmsg + 1, same object */
 	size_t*		 	 const restrict	bytes_read,	/* added to, not set */
-	unsigned*	 	 const restrict	data_read
+	unsigned*	 	 const restrict	data_read,
+	const pgm_time_t			now
 	)
 {
 	int retval = 0;
@@ -458,16 +579,23 @@ pgm_flush_peers_pending (
 	pgm_assert (NULL != bytes_read);
 	pgm_assert (NULL != data_read);
 
-	pgm_debug ("pgm_flush_peers_pending (sock:%p pmsg:%p msg-end:%p bytes-read:%p data-read:%p)",
-		(const void*)sock, (const void*)pmsg, (const void*)msg_end, (const void*)bytes_read, (const void*)data_read);
+	pgm_debug ("pgm_flush_peers_pending (sock:%p pmsg:%p msg-end:%p bytes-read:%p data-read:%p now:%" PGM_TIME_FORMAT ")",
+		(const void*)sock, (const void*)pmsg, (const void*)msg_end, (const void*)bytes_read, (const void*)data_read, now);
 
 	while (sock->peers_pending)
 	{
 		pgm_peer_t* peer = sock->peers_pending->data;
 		if (peer->last_commit && peer->last_commit < sock->last_commit)
 			pgm_rxw_remove_commit (peer->window);
+		const struct pgm_msgv_t* msgv = *pmsg;
 		const ssize_t peer_bytes = pgm_rxw_readv (peer->window, pmsg, (unsigned)(msg_end - *pmsg + 1));
 
+/* arrival of the first fragment to delivery of the whole APDU */
+		for (; msgv < *pmsg; msgv++) {
+			const pgm_time_t tstamp = msgv->msgv_skb[0]->tstamp;
+			pgm_histogram_record (&peer->delivery_latency, pgm_time_after (now, tstamp) ? (uint32_t)(now - tstamp) : 0);
+		}
+
 		if (peer->last_cumulative_losses != ((pgm_rxw_t*)peer->window)->cumulative_losses)
 		{
 			sock->is_reset = TRUE;
@@ -535,6 +663,34 @@ pgm_peer_set_pending (
 	sock->peers_pending = pgm_slist_prepend_link (sock->peers_pending, &peer->pending_link);
 }
 
+/* re-position peer in the timer heap after processing a packet that may
+ * have moved its earliest timer.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_peer_update_timer (
+	pgm_sock_t* const restrict sock,
+	pgm_peer_t* const restrict peer
+	)
+{
+	pgm_time_t next_expiry;
+
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (NULL != peer);
+	pgm_assert (sock->peers_heap[ peer->heap_index ] == peer);
+
+	next_expiry = peer_next_expiry (peer);
+	if (pgm_time_after (peer->next_expiry, next_expiry)) {
+		peer->next_expiry = next_expiry;
+		peer_heap_sift_up (sock, peer->heap_index);
+	} else {
+		peer->next_expiry = next_expiry;
+		peer_heap_sift_down (sock, peer->heap_index);
+	}
+}
+
 /* Create a new error SKB detailing data loss.
  */
 
@@ -1011,6 +1167,7 @@ send_spmr (
 		sent = pgm_sendto_hops (sock,
 					FALSE,			/* not rate limited */
 					NULL,
+					NULL,
 					FALSE,			/* regular socket */
 					1,
 					header,
@@ -1023,6 +1180,7 @@ send_spmr (
 	sent = pgm_sendto (sock,
 			   FALSE,
 			   NULL,
+			   NULL,
 			   FALSE,
 			   header,
 			   tpdu_length,
@@ -1096,6 +1254,7 @@ send_nak (
 	sent = pgm_sendto (sock,
 			   FALSE,			/* not rate limited */
 			   NULL,
+			   NULL,
 			   TRUE,			/* with router alert */
 			   header,
 			   tpdu_length,
@@ -1171,6 +1330,7 @@ send_parity_nak (
 	sent = pgm_sendto (sock,
 			   FALSE,		/* not rate limited */
 			   NULL,
+			   NULL,
 			   TRUE,		/* with router alert */
 			   header,
 			   tpdu_length,
@@ -1286,6 +1446,7 @@ send_nak_list (
 	sent = pgm_sendto (sock,
 			   FALSE,			/* not rate limited */
 			   NULL,
+			   NULL,
 			   FALSE,			/* regular socket */
 			   header,
 			   tpdu_length,
@@ -1383,6 +1544,7 @@ send_ack (
 	sent = pgm_sendto (sock,
 			   FALSE,			/* not rate limited */
 			   NULL,
+			   NULL,
 			   FALSE,			/* regular socket */
 			   header,
 			   tpdu_length,
@@ -1712,8 +1874,9 @@ pgm_trace(PGM_LOG_ROLE_NETWORK,_("nak_rpt_expiry in %f seconds."),
 	return TRUE;
 }
 
-/* check this peer for NAK state timers, uses the tail of each queue for the nearest
- * timer execution.
+/* check due peers for NAK state timers, uses the tail of each queue for the nearest
+ * timer execution.  peers are visited in order of next expiration from the timer
+ * heap and each peer at most once per call.
  *
  * returns TRUE on complete sweep, returns FALSE if operation would block.
  */
@@ -1731,16 +1894,11 @@ pgm_check_peer_state (
 	pgm_debug ("pgm_check_peer_state (sock:%p now:%" PGM_TIME_FORMAT ")",
 		(const void*)sock, now);
 
-	if (!sock->peers_list)
-		return TRUE;
-
-	for (pgm_list_t *it = sock->peers_list, *next = it->next;
-	     NULL != it;
-	     it = next)
+	while (sock->peers_heap_len > 0 &&
+	       pgm_time_after_eq (now, sock->peers_heap[0]->next_expiry))
 	{
-		pgm_peer_t* peer = it->data;
-
-		next = it->next;
+		pgm_peer_t* peer = sock->peers_heap[0];
+		pgm_time_t next_expiry;
 
 		if (peer->spmr_expiry)
 		{
@@ -1786,7 +1944,7 @@ pgm_check_peer_state (
 				nak_rdata_state (sock, peer, now);
 		}
 
-/* expired, remove from hash table and linked list */
+/* expired, remove from hash table, linked list, and timer heap */
 		if (pgm_time_after_eq (now, peer->expiry))
 		{
 			if (peer->pending_link.data)
@@ -1802,14 +1960,23 @@ pgm_check_peer_state (
 			else
 			{
 				pgm_trace (PGM_LOG_ROLE_SESSION,_("Peer expired, tsi %s"), pgm_tsi_print (&peer->tsi));
-				pgm_hashtable_remove (sock->peers_hashtable, &peer->tsi);
+				pgm_rwlock_writer_lock (&sock->peers_lock);
+				pgm_tsitable_remove (sock->peers_table, &peer->tsi);
 				sock->peers_list = pgm_list_remove_link (sock->peers_list, &peer->peers_link);
-				if (sock->last_hash_value == peer)
-					sock->last_hash_value = NULL;
+				pgm_histogram_accumulate (&sock->repair_latency, &peer->window->repair_latency);
+				pgm_histogram_accumulate (&sock->delivery_latency, &peer->delivery_latency);
+				pgm_histogram_accumulate (&sock->queue_latency, &peer->queue_latency);
+				pgm_rwlock_writer_unlock (&sock->peers_lock);
+				peer_heap_remove (sock, peer);
 				pgm_peer_unref (peer);
+				continue;
 			}
 		}
 
+/* timers still due are deferred to the next call to bound the sweep */
+		next_expiry = peer_next_expiry (peer);
+		peer->next_expiry = pgm_time_after (next_expiry, now) ? next_expiry : now + 1;
+		peer_heap_sift_down (sock, peer->heap_index);
 	}
 
 /* check for waiting contiguous packets */
@@ -1822,7 +1989,8 @@ pgm_check_peer_state (
 	return TRUE;
 }
 
-/* find the next state expiration time among the socks peers.
+/* find the next state expiration time among the socks peers from the head of
+ * the timer heap.
  *
  * on success, returns the earliest of the expiration parameter or next
  * peer expiration time.
@@ -1841,49 +2009,9 @@ pgm_min_receiver_expiry (
 	pgm_debug ("pgm_min_receiver_expiry (sock:%p expiration:%" PGM_TIME_FORMAT ")",
 		(void*)sock, expiration);
 
-	if (!sock->peers_list)
-		return expiration;
-
-	for (pgm_list_t *it = sock->peers_list, *next = it->next;
-	     NULL != it;
-	     it = next)
-	{
-		pgm_peer_t* peer = it->data;
-
-		next = it->next;
-
-		if (peer->spmr_expiry)
-		{
-			if (pgm_time_after_eq (expiration, peer->spmr_expiry))
-				expiration = peer->spmr_expiry;
-		}
-
-		if (peer->window->ack_backoff_queue.tail)
-		{
-			pgm_assert (sock->use_pgmcc);
-			if (pgm_time_after_eq (expiration, next_ack_rb_expiry (peer->window)))
-				expiration = next_ack_rb_expiry (peer->window);
-		}
-
-		if (peer->window->nak_backoff_queue.tail)
-		{
-			if (pgm_time_after_eq (expiration, next_nak_rb_expiry (peer->window)))
-				expiration = next_nak_rb_expiry (peer->window);
-		}
-
-		if (peer->window->wait_ncf_queue.tail)
-		{
-			if (pgm_time_after_eq (expiration, next_nak_rpt_expiry (peer->window)))
-				expiration = next_nak_rpt_expiry (peer->window);
-		}
-
-		if (peer->window->wait_data_queue.tail)
-		{
-			if (pgm_time_after_eq (expiration, next_nak_rdata_expiry (peer->window)))
-				expiration = next_nak_rdata_expiry (peer->window);
-		}
-
-	}
+	if (sock->peers_heap_len > 0 &&
+	    pgm_time_after_eq (expiration, sock->peers_heap[0]->next_expiry))
+		expiration = sock->peers_heap[0]->next_expiry;
 
 	return expiration;
 }
@@ -2168,6 +2296,10 @@ pgm_on_data (
 		ntohs(*(uint16_t*)( (char*)( skb->pgm_data + 1 ) + sizeof(uint16_t))) :
 		0;
 
+/* time in the socket receive queue when stamped by the kernel */
+	if (skb->kernel_tstamp)
+		pgm_histogram_record (&source->queue_latency, pgm_time_after (skb->tstamp, skb->kernel_tstamp) ? (uint32_t)(skb->tstamp - skb->kernel_tstamp) : 0);
+
 /* advance data pointer to payload */
 	pgm_skb_pull (skb, (uint16_t)(sizeof(struct pgm_data) + opt_total_length));
 
@@ -155,6 +155,7 @@ mock_pgm_sendto_hops (
 	pgm_sock_t*			sock,
 	bool				use_rate_limit,
 	pgm_rate_t*			minor_rate_control,
+	pgm_time_t*			now,
 	bool				use_router_alert,
 	int				hops,
 	const void*			buf,
@@ -447,6 +448,29 @@ START_TEST (test_min_receiver_expiry_pass_001)
 }
 END_TEST
 
+/* earliest peer timer from heap */
+START_TEST (test_min_receiver_expiry_pass_002)
+{
+	pgm_sock_t* sock = generate_sock();
+	sock->is_bound = TRUE;
+	const pgm_time_t expiration = pgm_secs(10);
+	pgm_peer_t* peer[3];
+	for (unsigned i = 0; i < G_N_ELEMENTS(peer); i++) {
+		peer[i] = generate_peer();
+		peer[i]->expiry = pgm_secs(20);
+		peer[i]->spmr_expiry = pgm_secs(5 - i);
+		peer_heap_insert (sock, peer[i]);
+	}
+	fail_unless (pgm_secs(3) == pgm_min_receiver_expiry (sock, expiration), "earliest spmr expiry");
+	peer[2]->spmr_expiry = 0;
+	pgm_peer_update_timer (sock, peer[2]);
+	fail_unless (pgm_secs(4) == pgm_min_receiver_expiry (sock, expiration), "re-armed spmr expiry");
+	peer_heap_remove (sock, peer[1]);
+	fail_unless (pgm_secs(5) == pgm_min_receiver_expiry (sock, expiration), "removed peer");
+	fail_unless (2 == sock->peers_heap_len, "heap length");
+}
+END_TEST
+
 START_TEST (test_min_receiver_expiry_fail_001)
 {
 	const pgm_time_t expiration = pgm_secs(1);
@@ -832,6 +856,7 @@ make_test_suite (void)
 	suite_add_tcase (s, tc_min_receiver_expiry);
 	tcase_add_checked_fixture (tc_min_receiver_expiry, mock_setup, NULL);
 	tcase_add_test (tc_min_receiver_expiry, test_min_receiver_expiry_pass_001);
+	tcase_add_test (tc_min_receiver_expiry, test_min_receiver_expiry_pass_002);
 #ifndef PGM_CHECK_NOFORK
 	tcase_add_test_raise_signal (tc_min_receiver_expiry, test_min_receiver_expiry_fail_001, SIGABRT);
 #endif
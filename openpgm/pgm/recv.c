@@ -32,6 +32,12 @@
 #	include <sys/types.h>
 #	include <sys/socket.h>
 #	include <netinet/in.h>		/* _GNU_SOURCE for in6_pktinfo */
+#	ifdef HAVE_UDP_GRO
+#		include <netinet/udp.h>
+#	endif
+#	ifdef HAVE_SO_TIMESTAMPNS
+#		include <time.h>
+#	endif
 #else
 #	include <ws2tcpip.h>
 #	include <mswsock.h>
@@ -51,12 +57,14 @@
 #endif
 
 #ifndef _WIN32
+#	define pgm_msghdr			msghdr
 #	define PGM_CMSG_FIRSTHDR(msg)		CMSG_FIRSTHDR(msg)
 #	define PGM_CMSG_NXTHDR(msg, cmsg)	CMSG_NXTHDR(msg, cmsg)
 #	define PGM_CMSG_DATA(cmsg)		CMSG_DATA(cmsg)
 #	define PGM_CMSG_SPACE(len)		CMSG_SPACE(len)
 #	define PGM_CMSG_LEN(len)		CMSG_LEN(len)
 #else
+#	define pgm_msghdr			_WSAMSG
 #	define PGM_CMSG_FIRSTHDR(msg)		WSA_CMSG_FIRSTHDR(msg)
 #	define PGM_CMSG_NXTHDR(msg, cmsg)	WSA_CMSG_NXTHDR(msg, cmsg)
 #	define PGM_CMSG_DATA(cmsg)		WSA_CMSG_DATA(cmsg)
@@ -75,8 +83,143 @@
 #	define pgm_cmsghdr			cmsghdr
 #endif
 
+/* control buffer per datagram of a receive batch */
+#define PGM_RECV_BATCH_AUXLEN			256
 
-/* read a packet into a PGM skbuff
+
+/* extract the destination address of a received datagram from the control
+ * messages.
+ *
+ * returns FALSE on invalid address.
+ */
+
+static
+bool
+get_dst_addr (
+	struct pgm_msghdr*    const restrict msg,
+	struct sockaddr*      const restrict dst_addr
+	)
+{
+	struct pgm_cmsghdr* cmsg;
+	for (cmsg = PGM_CMSG_FIRSTHDR(msg);
+	     cmsg != NULL;
+	     cmsg = PGM_CMSG_NXTHDR(msg, cmsg))
+	{
+/* both IP_PKTINFO and IP_RECVDSTADDR exist on OpenSolaris, so capture
+ * each type if defined.
+ */
+#ifdef IP_PKTINFO
+		if (IPPROTO_IP == cmsg->cmsg_level && 
+		    IP_PKTINFO == cmsg->cmsg_type)
+		{
+			const void* pktinfo		= PGM_CMSG_DATA(cmsg);
+/* discard on invalid address */
+			if (PGM_UNLIKELY(NULL == pktinfo)) {
+				pgm_debug ("in_pktinfo is NULL");
+				return FALSE;
+			}
+			const struct in_pktinfo* in	= pktinfo;
+			struct sockaddr_in s4;
+			memset (&s4, 0, sizeof(s4));
+			s4.sin_family			= AF_INET;
+			s4.sin_addr.s_addr		= in->ipi_addr.s_addr;
+			memcpy (dst_addr, &s4, sizeof(s4));
+			break;
+		}
+#endif
+#ifdef IP_RECVDSTADDR
+		if (IPPROTO_IP == cmsg->cmsg_level &&
+		    IP_RECVDSTADDR == cmsg->cmsg_type)
+		{
+			const void* recvdstaddr		= PGM_CMSG_DATA(cmsg);
+/* discard on invalid address */
+			if (PGM_UNLIKELY(NULL == recvdstaddr)) {
+				pgm_debug ("in_recvdstaddr is NULL");
+				return FALSE;
+			}
+			const struct in_addr* in	= recvdstaddr;
+			struct sockaddr_in s4;
+			memset (&s4, 0, sizeof(s4));
+			s4.sin_family			= AF_INET;
+			s4.sin_addr.s_addr		= in->s_addr;
+			memcpy (dst_addr, &s4, sizeof(s4));
+			break;
+		}
+#endif
+#if !defined(IP_PKTINFO) && !defined(IP_RECVDSTADDR)
+#	error "No defined CMSG type for IPv4 destination address."
+#endif
+
+		if (IPPROTO_IPV6 == cmsg->cmsg_level && 
+		    IPV6_PKTINFO == cmsg->cmsg_type)
+		{
+			const void* pktinfo		= PGM_CMSG_DATA(cmsg);
+/* discard on invalid address */
+			if (PGM_UNLIKELY(NULL == pktinfo)) {
+				pgm_debug ("in6_pktinfo is NULL");
+				return FALSE;
+			}
+			const struct in6_pktinfo* in6	= pktinfo;
+			struct sockaddr_in6 s6;
+			memset (&s6, 0, sizeof(s6));
+			s6.sin6_family			= AF_INET6;
+			s6.sin6_addr			= in6->ipi6_addr;
+			s6.sin6_scope_id		= in6->ipi6_ifindex;
+			memcpy (dst_addr, &s6, sizeof(s6));
+/* does not set flow id */
+			break;
+		}
+	}
+	return TRUE;
+}
+
+#ifdef HAVE_SO_TIMESTAMPNS
+/* extract the kernel arrival time of a received datagram from the control
+ * messages.  the kernel stamps on CLOCK_REALTIME, converted to the library
+ * clock by the age against realtime read alongside now.
+ *
+ * returns zero without a time stamp.
+ */
+
+static
+pgm_time_t
+get_kernel_tstamp (
+	struct pgm_msghdr*     const restrict msg,
+	const pgm_time_t		      now,
+	const struct timespec* const restrict realtime
+	)
+{
+	struct pgm_cmsghdr* cmsg;
+	for (cmsg = PGM_CMSG_FIRSTHDR(msg);
+	     cmsg != NULL;
+	     cmsg = PGM_CMSG_NXTHDR(msg, cmsg))
+	{
+		struct timespec ts;
+		if (SOL_SOCKET != cmsg->cmsg_level)
+			continue;
+		if (SCM_TIMESTAMPNS == cmsg->cmsg_type)
+			memcpy (&ts, PGM_CMSG_DATA(cmsg), sizeof(ts));
+#	ifdef SCM_TIMESTAMPING
+/* application enabled SO_TIMESTAMPING, software stamp leads the triple */
+		else if (SCM_TIMESTAMPING == cmsg->cmsg_type)
+			memcpy (&ts, PGM_CMSG_DATA(cmsg), sizeof(ts));
+#	endif
+		else
+			continue;
+		if (0 == ts.tv_sec && 0 == ts.tv_nsec)
+			continue;
+		const int64_t age = (int64_t)(realtime->tv_sec - ts.tv_sec) * INT64_C(1000000) +
+				    (realtime->tv_nsec - ts.tv_nsec) / 1000;
+/* realtime stepped backwards */
+		if (age <= 0)
+			return now;
+		return (pgm_time_t)age < now ? now - (pgm_time_t)age : 0;
+	}
+	return 0;
+}
+#endif /* HAVE_SO_TIMESTAMPNS */
+
+/* read a packet into a PGM skbuff stamped with the caller's time.
  * on success returns packet length, on closed socket returns 0,
  * on error returns -1.
  */
@@ -90,7 +233,8 @@ recvskb (
 	struct sockaddr*      const restrict src_addr,
 	const socklen_t			     src_addrlen,
 	struct sockaddr*      const restrict dst_addr,
-	const socklen_t			     dst_addrlen
+	const socklen_t			     dst_addrlen,
+	const pgm_time_t		     now
 	)
 {
 /* pre-conditions */
@@ -153,87 +297,550 @@ recvskb (
 #endif
 
 	skb->sock		= sock;
-	skb->tstamp		= pgm_time_update_now();
+	skb->tstamp		= now;
 	skb->data		= skb->head;
 	skb->len		= (uint16_t)len;
 	skb->zero_padded	= 0;
 	skb->tail		= (char*)skb->data + len;
 
-	if (sock->udp_encap_ucast_port ||
-	    AF_INET6 == pgm_sockaddr_family (src_addr))
+#ifdef HAVE_SO_TIMESTAMPNS
+/* the caller's time may predate the arrival, re-read as the receive batch does */
+	if (sock->use_kernel_tstamp) {
+		struct timespec realtime;
+		skb->tstamp = pgm_time_update_now();
+		clock_gettime (CLOCK_REALTIME, &realtime);
+		skb->kernel_tstamp = get_kernel_tstamp (&msg, skb->tstamp, &realtime);
+	} else
+#endif
+		skb->kernel_tstamp = 0;
+
+	if ((sock->udp_encap_ucast_port ||
+	     AF_INET6 == pgm_sockaddr_family (src_addr)) &&
+	    !get_dst_addr (&msg, dst_addr))
 	{
-		struct pgm_cmsghdr* cmsg;
-		for (cmsg = PGM_CMSG_FIRSTHDR(&msg);
-		     cmsg != NULL;
-		     cmsg = PGM_CMSG_NXTHDR(&msg, cmsg))
-		{
-/* both IP_PKTINFO and IP_RECVDSTADDR exist on OpenSolaris, so capture
- * each type if defined.
+		return -1;
+	}
+	return len;
+}
+
+#ifdef HAVE_RECVMMSG
+/* refill the pre-allocated receive batch with one recvmmsg() call, datagrams
+ * with an invalid destination address are discarded.
+ *
+ * on success returns count of datagrams read, on closed socket returns 0,
+ * on error returns -1.
  */
-#ifdef IP_PKTINFO
-			if (IPPROTO_IP == cmsg->cmsg_level && 
-			    IP_PKTINFO == cmsg->cmsg_type)
-			{
-				const void* pktinfo		= PGM_CMSG_DATA(cmsg);
-/* discard on invalid address */
-				if (PGM_UNLIKELY(NULL == pktinfo)) {
-					pgm_debug ("in_pktinfo is NULL");
-					return -1;
-				}
-				const struct in_pktinfo* in	= pktinfo;
-				struct sockaddr_in s4;
-				memset (&s4, 0, sizeof(s4));
-				s4.sin_family			= AF_INET;
-				s4.sin_addr.s_addr		= in->ipi_addr.s_addr;
-				memcpy (dst_addr, &s4, sizeof(s4));
-				break;
+
+static
+ssize_t
+refill_recv_batch (
+	pgm_sock_t* const	sock,
+	const int		flags
+	)
+{
+	const unsigned vlen = sock->recv_batch;
+	struct mmsghdr* msgvec = pgm_newa (struct mmsghdr, vlen);
+	struct iovec* iov = pgm_newa (struct iovec, vlen);
+	char* aux = pgm_newa (char, vlen * PGM_RECV_BATCH_AUXLEN);
+	unsigned n = 0;
+
+/* pre-conditions */
+	pgm_assert (NULL != sock->rx_ring);
+	pgm_assert (vlen > 1);
+	pgm_assert (sock->rx_ring_index == sock->rx_ring_len);
+
+	for (unsigned i = 0; i < vlen; i++)
+	{
+		iov[i].iov_base			= sock->rx_ring[i]->head;
+		iov[i].iov_len			= sock->max_tpdu;
+		msgvec[i].msg_hdr.msg_name	= &sock->rx_ring_addr[ 2 * i ];
+		msgvec[i].msg_hdr.msg_namelen	= sizeof(struct sockaddr_storage);
+		msgvec[i].msg_hdr.msg_iov	= &iov[i];
+		msgvec[i].msg_hdr.msg_iovlen	= 1;
+		msgvec[i].msg_hdr.msg_control	= aux + (i * PGM_RECV_BATCH_AUXLEN);
+		msgvec[i].msg_hdr.msg_controllen = PGM_RECV_BATCH_AUXLEN;
+		msgvec[i].msg_hdr.msg_flags	= 0;
+		msgvec[i].msg_len		= 0;
+	}
+
+	sock->rx_ring_index = sock->rx_ring_len = 0;
+	const int received = recvmmsg (sock->recv_sock, msgvec, vlen, flags, NULL);
+	if (received <= 0)
+		return received;
+
+	sock->rx_batch_calls++;
+	sock->rx_batch_datagrams += received;
+
+	const pgm_time_t now = pgm_time_update_now();
+#	ifdef HAVE_SO_TIMESTAMPNS
+	struct timespec realtime;
+	if (sock->use_kernel_tstamp)
+		clock_gettime (CLOCK_REALTIME, &realtime);
+#	endif
+	for (unsigned i = 0; i < (unsigned)received; i++)
+	{
+		struct pgm_sk_buff_t* skb = sock->rx_ring[i];
+		struct sockaddr* src_addr = (struct sockaddr*)&sock->rx_ring_addr[ 2 * i ];
+		struct sockaddr* dst_addr = (struct sockaddr*)&sock->rx_ring_addr[ 2 * i + 1 ];
+
+#ifdef PGM_DEBUG
+		if (PGM_UNLIKELY(pgm_loss_rate > 0)) {
+			const unsigned percent = pgm_rand_int_range (&sock->rand_, 0, 100);
+			if (percent <= pgm_loss_rate) {
+				pgm_debug ("Simulated packet loss");
+				continue;
 			}
+		}
 #endif
-#ifdef IP_RECVDSTADDR
-			if (IPPROTO_IP == cmsg->cmsg_level &&
-			    IP_RECVDSTADDR == cmsg->cmsg_type)
-			{
-				const void* recvdstaddr		= PGM_CMSG_DATA(cmsg);
-/* discard on invalid address */
-				if (PGM_UNLIKELY(NULL == recvdstaddr)) {
-					pgm_debug ("in_recvdstaddr is NULL");
-					return -1;
-				}
-				const struct in_addr* in	= recvdstaddr;
-				struct sockaddr_in s4;
-				memset (&s4, 0, sizeof(s4));
-				s4.sin_family			= AF_INET;
-				s4.sin_addr.s_addr		= in->s_addr;
-				memcpy (dst_addr, &s4, sizeof(s4));
-				break;
+		if ((sock->udp_encap_ucast_port ||
+		     AF_INET6 == pgm_sockaddr_family (src_addr)) &&
+		    !get_dst_addr (&msgvec[i].msg_hdr, dst_addr))
+		{
+			continue;
+		}
+
+		skb->sock		= sock;
+		skb->tstamp		= now;
+		skb->data		= skb->head;
+		skb->len		= (uint16_t)msgvec[i].msg_len;
+		skb->zero_padded	= 0;
+		skb->tail		= (char*)skb->data + skb->len;
+#	ifdef HAVE_SO_TIMESTAMPNS
+		skb->kernel_tstamp	= sock->use_kernel_tstamp ? get_kernel_tstamp (&msgvec[i].msg_hdr, now, &realtime) : 0;
+#	else
+		skb->kernel_tstamp	= 0;
+#	endif
+
+/* compact valid datagrams to head of batch */
+		if (i != n) {
+			struct sockaddr_storage addr[2];
+			sock->rx_ring[i] = sock->rx_ring[n];
+			sock->rx_ring[n] = skb;
+			memcpy (addr, &sock->rx_ring_addr[ 2 * n ], sizeof(addr));
+			memcpy (&sock->rx_ring_addr[ 2 * n ], &sock->rx_ring_addr[ 2 * i ], sizeof(addr));
+			memcpy (&sock->rx_ring_addr[ 2 * i ], addr, sizeof(addr));
+		}
+		n++;
+	}
+	sock->rx_ring_len = n;
+	return received;
+}
+
+#	ifdef HAVE_UDP_GRO
+/* refill the receive batch with one read of datagrams coalesced by UDP GRO,
+ * split at the segment size reported by the kernel.  all segments share the
+ * source and destination address, segments exceeding the maximum TPDU or
+ * the receive batch are discarded and counted.
+ *
+ * on success returns count of bytes read, on closed socket returns 0,
+ * on error returns -1.
+ */
+
+static
+ssize_t
+refill_recv_gro (
+	pgm_sock_t* const	sock,
+	const int		flags
+	)
+{
+	struct sockaddr* src_addr = (struct sockaddr*)&sock->rx_ring_addr[0];
+	struct sockaddr* dst_addr = (struct sockaddr*)&sock->rx_ring_addr[1];
+	char aux[ PGM_RECV_BATCH_AUXLEN ];
+	struct iovec iov = {
+		.iov_base	= sock->rx_gro_buffer,
+		.iov_len	= PGM_MAX_GRO_LEN
+	};
+	struct msghdr msg = {
+		.msg_name	= src_addr,
+		.msg_namelen	= sizeof(struct sockaddr_storage),
+		.msg_iov	= &iov,
+		.msg_iovlen	= 1,
+		.msg_control	= aux,
+		.msg_controllen = sizeof(aux),
+		.msg_flags	= 0
+	};
+	unsigned n = 0;
+
+/* pre-conditions */
+	pgm_assert (NULL != sock->rx_ring);
+	pgm_assert (NULL != sock->rx_gro_buffer);
+	pgm_assert (sock->rx_ring_index == sock->rx_ring_len);
+
+	sock->rx_ring_index = sock->rx_ring_len = 0;
+	const ssize_t len = recvmsg (sock->recv_sock, &msg, flags);
+	if (len <= 0)
+		return len;
+	if (!get_dst_addr (&msg, dst_addr))
+		return len;
+
+/* without a UDP_GRO control message the read is one datagram */
+	size_t gso_size = (size_t)len;
+	for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+	     NULL != cmsg;
+	     cmsg = CMSG_NXTHDR(&msg, cmsg))
+	{
+		if (SOL_UDP == cmsg->cmsg_level && UDP_GRO == cmsg->cmsg_type) {
+			int segment;
+			memcpy (&segment, CMSG_DATA(cmsg), sizeof(segment));
+			if (segment > 0)
+				gso_size = (size_t)segment;
+			break;
+		}
+	}
+
+	const pgm_time_t now = pgm_time_update_now();
+/* coalesced segments share the stamp of the first */
+	pgm_time_t kernel_tstamp = 0;
+#		ifdef HAVE_SO_TIMESTAMPNS
+	if (sock->use_kernel_tstamp) {
+		struct timespec realtime;
+		clock_gettime (CLOCK_REALTIME, &realtime);
+		kernel_tstamp = get_kernel_tstamp (&msg, now, &realtime);
+	}
+#		endif
+	for (size_t offset = 0; offset < (size_t)len; offset += gso_size)
+	{
+		const size_t segment_len = MIN(gso_size, (size_t)len - offset);
+
+		if (PGM_UNLIKELY(segment_len > sock->max_tpdu || n == sock->recv_batch)) {
+			sock->rx_batch_discarded++;
+			continue;
+		}
+		struct pgm_sk_buff_t* skb = sock->rx_ring[n];
+#ifdef PGM_DEBUG
+		if (PGM_UNLIKELY(pgm_loss_rate > 0)) {
+			const unsigned percent = pgm_rand_int_range (&sock->rand_, 0, 100);
+			if (percent <= pgm_loss_rate) {
+				pgm_debug ("Simulated packet loss");
+				continue;
 			}
+		}
 #endif
-#if !defined(IP_PKTINFO) && !defined(IP_RECVDSTADDR)
-#	error "No defined CMSG type for IPv4 destination address."
-#endif
+		memcpy (skb->head, (const char*)sock->rx_gro_buffer + offset, segment_len);
+		skb->sock		= sock;
+		skb->tstamp		= now;
+		skb->kernel_tstamp	= kernel_tstamp;
+		skb->data		= skb->head;
+		skb->len		= (uint16_t)segment_len;
+		skb->zero_padded	= 0;
+		skb->tail		= (char*)skb->data + skb->len;
+		if (n > 0)
+			memcpy (&sock->rx_ring_addr[ 2 * n ], &sock->rx_ring_addr[0], 2 * sizeof(struct sockaddr_storage));
+		n++;
+	}
 
-			if (IPPROTO_IPV6 == cmsg->cmsg_level && 
-			    IPV6_PKTINFO == cmsg->cmsg_type)
-			{
-				const void* pktinfo		= PGM_CMSG_DATA(cmsg);
-/* discard on invalid address */
-				if (PGM_UNLIKELY(NULL == pktinfo)) {
-					pgm_debug ("in6_pktinfo is NULL");
-					return -1;
-				}
-				const struct in6_pktinfo* in6	= pktinfo;
-				struct sockaddr_in6 s6;
-				memset (&s6, 0, sizeof(s6));
-				s6.sin6_family			= AF_INET6;
-				s6.sin6_addr			= in6->ipi6_addr;
-				s6.sin6_scope_id		= in6->ipi6_ifindex;
-				memcpy (dst_addr, &s6, sizeof(s6));
-/* does not set flow id */
-				break;
+	sock->rx_batch_calls++;
+	sock->rx_batch_datagrams += n;
+	sock->rx_ring_len = n;
+	return len;
+}
+#	endif /* HAVE_UDP_GRO */
+
+/* move the next datagram of the receive batch into sock::rx_buffer, the
+ * previous receive buffer takes its place in the batch.
+ *
+ * returns packet length.
+ */
+
+static
+ssize_t
+shift_recv_batch (
+	pgm_sock_t*           const restrict sock,
+	struct sockaddr*      const restrict src_addr,
+	const socklen_t			     src_addrlen,
+	struct sockaddr*      const restrict dst_addr,
+	const socklen_t			     dst_addrlen
+	)
+{
+/* pre-conditions */
+	pgm_assert (sock->rx_ring_index < sock->rx_ring_len);
+
+	const unsigned i = sock->rx_ring_index++;
+	struct pgm_sk_buff_t* skb = sock->rx_ring[i];
+	sock->rx_ring[i] = sock->rx_buffer;
+	sock->rx_buffer = skb;
+	memcpy (src_addr, &sock->rx_ring_addr[ 2 * i ], MIN(src_addrlen, sizeof(struct sockaddr_storage)));
+	memcpy (dst_addr, &sock->rx_ring_addr[ 2 * i + 1 ], MIN(dst_addrlen, sizeof(struct sockaddr_storage)));
+	return skb->len;
+}
+
+/* read a packet into sock::rx_buffer from the receive batch, refilling the
+ * batch when exhausted.
+ *
+ * on success returns packet length, on closed socket returns 0,
+ * on error returns -1.
+ */
+
+static
+ssize_t
+recvskb_batch (
+	pgm_sock_t*           const restrict sock,
+	const int			     flags,
+	struct sockaddr*      const restrict src_addr,
+	const socklen_t			     src_addrlen,
+	struct sockaddr*      const restrict dst_addr,
+	const socklen_t			     dst_addrlen
+	)
+{
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (NULL != src_addr);
+	pgm_assert (src_addrlen > 0);
+	pgm_assert (NULL != dst_addr);
+	pgm_assert (dst_addrlen > 0);
+
+	pgm_debug ("recvskb_batch (sock:%p flags:%d src-addr:%p src-addrlen:%d dst-addr:%p dst-addrlen:%d)",
+		(void*)sock, flags, (void*)src_addr, (int)src_addrlen, (void*)dst_addr, (int)dst_addrlen);
+
+	if (PGM_UNLIKELY(sock->is_destroyed))
+		return 0;
+
+	while (sock->rx_ring_index == sock->rx_ring_len)
+	{
+#	ifdef HAVE_UDP_GRO
+		const ssize_t received = sock->rx_gro_buffer ?
+						refill_recv_gro (sock, flags) :
+						refill_recv_batch (sock, flags);
+#	else
+		const ssize_t received = refill_recv_batch (sock, flags);
+#	endif
+		if (received <= 0)
+			return received;
+	}
+	return shift_recv_batch (sock, src_addr, src_addrlen, dst_addr, dst_addrlen);
+}
+#endif /* HAVE_RECVMMSG */
+
+/* TRUE if the source identified by tsi belongs to this receive shard.  the
+ * TSI hash is mixed before reduction as GSIs commonly share high order bytes.
+ */
+
+static inline
+bool
+is_shard_source (
+	const pgm_sock_t* const restrict sock,
+	const pgm_tsi_t*  const restrict tsi
+	)
+{
+	if (PGM_LIKELY(sock->shard_count < 2))
+		return TRUE;
+	const uint32_t h = (uint32_t)pgm_tsi_hash (tsi) * UINT32_C(0x9e3779b1);
+	return ((uint64_t)h * sock->shard_count) >> 32 == sock->shard_index;
+}
+
+/* TRUE if multicast destination addr is a group of sock, unicast destinations
+ * always match.  IPv6 scope is ignored as packet info reports the receiving
+ * interface.
+ */
+
+static
+bool
+is_demux_group (
+	const pgm_sock_t*      const restrict sock,
+	const struct sockaddr* const restrict addr
+	)
+{
+	const struct sockaddr* group;
+
+	if (!pgm_sockaddr_is_addr_multicast (addr))
+		return TRUE;
+	for (unsigned i = 0; i <= sock->recv_gsr_len; i++)
+	{
+		group = (i < sock->recv_gsr_len) ? (const struct sockaddr*)&sock->recv_gsr[i].gsr_group
+						 : (const struct sockaddr*)&sock->send_gsr.gsr_group;
+		if (group->sa_family != addr->sa_family)
+			continue;
+		if (AF_INET6 == addr->sa_family) {
+			if (0 == memcmp (&((const struct sockaddr_in6*)group)->sin6_addr,
+					 &((const struct sockaddr_in6*)addr)->sin6_addr,
+					 sizeof(struct in6_addr)))
+				return TRUE;
+		} else if (0 == pgm_sockaddr_cmp (group, addr))
+			return TRUE;
+	}
+	return FALSE;
+}
+
+/* TRUE if parsed packet skb addressed to dst_addr belongs to the session of
+ * sock by data-destination port, group and receive shard.
+ */
+
+static
+bool
+is_demux_target (
+	const pgm_sock_t*           const restrict sock,
+	const struct pgm_sk_buff_t* const restrict skb,
+	const struct sockaddr*      const restrict dst_addr
+	)
+{
+	const struct pgm_header* header = skb->pgm_header;
+
+	if (PGM_IS_DOWNSTREAM (header->pgm_type)) {
+		if (!sock->can_recv_data ||
+		    header->pgm_dport != sock->dport ||
+		    !is_shard_source (sock, &skb->tsi))
+			return FALSE;
+	}
+/* upstream and peer-to-peer carry the data-destination port as source port */
+	else if (header->pgm_sport != sock->dport)
+		return FALSE;
+	return is_demux_group (sock, dst_addr);
+}
+
+/* read a parsed packet into sock::rx_buffer from the shared receive socket.
+ * packets queued for sock by other members are returned first, otherwise the
+ * shared socket is read routing packets for other members to their queues,
+ * copied when addressed to more than one member.
+ *
+ * on success returns packet length, on closed socket returns 0,
+ * on error returns -1.
+ */
+
+static
+ssize_t
+recvskb_demux (
+	pgm_sock_t*           const restrict sock,
+	struct sockaddr*      const restrict src_addr,
+	const socklen_t			     src_addrlen,
+	struct sockaddr*      const restrict dst_addr,
+	const socklen_t			     dst_addrlen,
+	const pgm_time_t		     now
+	)
+{
+	pgm_demux_t* const demux = sock->demux->demux;
+	struct pgm_sk_buff_t* skb;
+
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (NULL != sock->demux);
+	pgm_assert (NULL != src_addr);
+	pgm_assert (src_addrlen > 0);
+	pgm_assert (NULL != dst_addr);
+	pgm_assert (dst_addrlen > 0);
+
+	if (PGM_UNLIKELY(sock->is_destroyed))
+		return 0;
+
+	pgm_mutex_lock (&demux->mutex);
+	for (;;)
+	{
+		skb = pgm_demux_pop (sock->demux, src_addr, src_addrlen, dst_addr, dst_addrlen);
+		if (NULL != skb)
+			break;
+
+		if (NULL == demux->rx_buffer)
+			demux->rx_buffer = pgm_skb_pool_alloc (sock->skb_pool, demux->max_tpdu);
+		skb = demux->rx_buffer;
+
+		struct pgm_iovec iov = {
+			.iov_base	= skb->head,
+			.iov_len	= demux->max_tpdu
+		};
+		char aux[ 1024 ];
+#ifndef _WIN32
+		struct msghdr msg = {
+			.msg_name	= src_addr,
+			.msg_namelen	= src_addrlen,
+			.msg_iov	= (void*)&iov,
+			.msg_iovlen	= 1,
+			.msg_control	= aux,
+			.msg_controllen = sizeof(aux),
+			.msg_flags	= 0
+		};
+		const ssize_t len = recvmsg (demux->recv_sock, &msg, 0);
+		if (len <= 0) {
+			pgm_mutex_unlock (&demux->mutex);
+			return len;
+		}
+#else /* !_WIN32 */
+		WSAMSG msg = {
+			.name		= (LPSOCKADDR)src_addr,
+			.namelen	= src_addrlen,
+			.lpBuffers	= (LPWSABUF)&iov,
+			.dwBufferCount	= 1,
+			.dwFlags	= 0
+		};
+		msg.Control.buf		= aux;
+		msg.Control.len		= sizeof(aux);
+		DWORD len;
+		if (SOCKET_ERROR == pgm_WSARecvMsg (demux->recv_sock, &msg, &len, NULL, NULL)) {
+			pgm_mutex_unlock (&demux->mutex);
+			return SOCKET_ERROR;
+		}
+#endif /* !_WIN32 */
+
+		skb->tstamp		= now;
+		skb->kernel_tstamp	= 0;
+		skb->data		= skb->head;
+		skb->len		= (uint16_t)len;
+		skb->zero_padded	= 0;
+		skb->tail		= (char*)skb->data + len;
+
+		if (AF_INET6 == pgm_sockaddr_family (src_addr) &&
+		    !get_dst_addr (&msg, dst_addr))
+		{
+			continue;
+		}
+
+/* parse once for all members */
+		pgm_error_t* err = NULL;
+		const bool is_valid = (AF_INET6 == pgm_sockaddr_family (src_addr)) ?
+						pgm_parse_udp_encap (skb, &err) :
+						pgm_parse_raw (skb, dst_addr, &err);
+		if (PGM_UNLIKELY(!is_valid)) {
+			pgm_trace (PGM_LOG_ROLE_NETWORK,
+					_("Discarded invalid packet: %s"),
+					(err && err->message) ? err->message : "(null)");
+			pgm_error_free (err);
+			continue;
+		}
+
+		bool is_mine = FALSE;
+		unsigned others = 0;
+		for (pgm_slist_t* list = demux->members; list; list = list->next)
+		{
+			const pgm_demux_member_t* member = list->data;
+			if (!is_demux_target (member->sock, skb, dst_addr))
+				continue;
+			if (member == sock->demux)
+				is_mine = TRUE;
+			else
+				others++;
+		}
+		if (!is_mine && 0 == others) {
+			pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded packet for no member socket."));
+			continue;
+		}
+
+/* last other member takes the original unless kept by sock */
+		for (pgm_slist_t* list = demux->members; others && list; list = list->next)
+		{
+			pgm_demux_member_t* member = list->data;
+			if (member == sock->demux ||
+			    !is_demux_target (member->sock, skb, dst_addr))
+				continue;
+			struct pgm_sk_buff_t* target_skb = (is_mine || --others) ? pgm_skb_copy (skb) : skb;
+			target_skb->sock = member->sock;
+			if (PGM_UNLIKELY(!pgm_demux_push (member, target_skb, src_addr, dst_addr))) {
+				pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded packet on full shared receive queue."));
+				pgm_free_skb (target_skb);
 			}
 		}
+		demux->rx_buffer = NULL;
+		if (is_mine)
+			break;
 	}
-	return len;
+/* recycle the unused buffer of sock for the next read */
+	if (NULL == demux->rx_buffer &&
+	    (const char*)sock->rx_buffer->end - (const char*)sock->rx_buffer->head >= demux->max_tpdu)
+		demux->rx_buffer = sock->rx_buffer;
+	else
+		pgm_free_skb (sock->rx_buffer);
+	pgm_mutex_unlock (&demux->mutex);
+
+	skb->sock = sock;
+	sock->rx_buffer = skb;
+	return skb->len;
 }
 
 /* upstream = receiver to source, peer-to-peer = receive to receiver
@@ -354,9 +961,12 @@ on_peer (
 	memcpy (&upstream_tsi.gsi, &skb->tsi.gsi, sizeof(pgm_gsi_t));
 	upstream_tsi.sport = skb->pgm_header->pgm_dport;
 
-	pgm_rwlock_reader_lock (&sock->peers_lock);
-	*source = pgm_hashtable_lookup (sock->peers_hashtable, &upstream_tsi);
-	pgm_rwlock_reader_unlock (&sock->peers_lock);
+/* source serviced by another shard */
+	if (!is_shard_source (sock, &upstream_tsi))
+		return FALSE;
+
+/* receiver is the only writer, lookup without peers_lock */
+	*source = pgm_tsitable_lookup_cached (sock->peers_table, &upstream_tsi);
 	if (PGM_UNLIKELY(NULL == *source)) {
 /* this source is unknown, we don't care about messages about it */
 		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Discarded peer packet about new source."));
@@ -435,25 +1045,20 @@ on_downstream (
 		goto out_discarded;
 	}
 
-/* search for TSI peer context or create a new one */
-	if (PGM_LIKELY(pgm_tsi_hash (&skb->tsi) == sock->last_hash_key &&
-			NULL != sock->last_hash_value))
-	{
-		*source = sock->last_hash_value;
-	}
-	else
-	{
-		pgm_rwlock_reader_lock (&sock->peers_lock);
-		*source = pgm_hashtable_lookup_extended (sock->peers_hashtable, &skb->tsi, &sock->last_hash_key);
-		pgm_rwlock_reader_unlock (&sock->peers_lock);
-		if (PGM_UNLIKELY(NULL == *source)) {
-			*source = pgm_new_peer (sock,
-					       &skb->tsi,
-					       (struct sockaddr*)src_addr, pgm_sockaddr_len(src_addr),
-					       (struct sockaddr*)dst_addr, pgm_sockaddr_len(dst_addr),
-						skb->tstamp);
-		}
-		sock->last_hash_value = *source;
+/* source serviced by another shard */
+	if (!is_shard_source (sock, &skb->tsi))
+		return FALSE;
+
+/* search for TSI peer context or create a new one, receiver is the only writer
+ * so lookup proceeds without peers_lock.
+ */
+	*source = pgm_tsitable_lookup_cached (sock->peers_table, &skb->tsi);
+	if (PGM_UNLIKELY(NULL == *source)) {
+		*source = pgm_new_peer (sock,
+				       &skb->tsi,
+				       (struct sockaddr*)src_addr, pgm_sockaddr_len(src_addr),
+				       (struct sockaddr*)dst_addr, pgm_sockaddr_len(dst_addr),
+					skb->tstamp);
 	}
 
 	(*source)->cumulative_stats[PGM_PC_RECEIVER_BYTES_RECEIVED] += skb->len;
@@ -468,7 +1073,7 @@ on_downstream (
 	case PGM_RDATA:
 		if (PGM_UNLIKELY(!pgm_on_data (sock, *source, skb)))
 			goto out_discarded;
-		sock->rx_buffer = pgm_alloc_skb (sock->max_tpdu);
+		sock->rx_buffer = pgm_skb_pool_alloc (sock->skb_pool, sock->max_tpdu);
 		break;
 
 	case PGM_NCF:
@@ -554,15 +1159,126 @@ on_pgm (
 	return FALSE;
 }
 
+/* process the parsed packet held in sock::rx_buffer, marking the source
+ * pending on new contiguous data.
+ *
+ * returns TRUE on valid processed packet, returns FALSE on discarded packet.
+ */
+
+static
+bool
+on_parsed_packet (
+	pgm_sock_t*      const restrict sock,
+	struct sockaddr* const restrict src_addr,
+	struct sockaddr* const restrict dst_addr
+	)
+{
+	pgm_peer_t* source = NULL;
+	const bool is_processed = on_pgm (sock, sock->rx_buffer, src_addr, dst_addr, &source);
+/* re-arm the source timers for any new NAK state */
+	if (NULL != source)
+		pgm_peer_update_timer (sock, source);
+	if (PGM_UNLIKELY(!is_processed))
+		return FALSE;
+
+/* check whether this source has waiting data */
+	if (source && pgm_peer_has_pending (source)) {
+		pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("New pending data."));
+		pgm_peer_set_pending (sock, source);
+	}
+	return TRUE;
+}
+
+/* parse and process the packet held in sock::rx_buffer, marking the source
+ * pending on new contiguous data.
+ *
+ * returns TRUE on valid processed packet, returns FALSE on discarded packet.
+ */
+
+static
+bool
+on_packet (
+	pgm_sock_t*      const restrict sock,
+	struct sockaddr* const restrict src_addr,
+	struct sockaddr* const restrict dst_addr
+	)
+{
+	pgm_error_t* err = NULL;
+	const bool is_valid = (sock->udp_encap_ucast_port || AF_INET6 == src_addr->sa_family) ?
+					pgm_parse_udp_encap (sock->rx_buffer, &err) :
+					pgm_parse_raw (sock->rx_buffer, dst_addr, &err);
+	if (PGM_UNLIKELY(!is_valid))
+	{
+/* inherently cannot determine PGM_PC_RECEIVER_CKSUM_ERRORS unless only one receiver */
+		pgm_trace (PGM_LOG_ROLE_NETWORK,
+				_("Discarded invalid packet: %s"),
+				(err && err->message) ? err->message : "(null)");
+		pgm_error_free (err);
+		if (sock->can_send_data) {
+			if (err && PGM_ERROR_CKSUM == err->code)
+				sock->cumulative_stats[PGM_PC_SOURCE_CKSUM_ERRORS]++;
+			sock->cumulative_stats[PGM_PC_SOURCE_PACKETS_DISCARDED]++;
+		}
+		return FALSE;
+	}
+	return on_parsed_packet (sock, src_addr, dst_addr);
+}
+
+#ifdef HAVE_RECVMMSG
+/* process datagrams remaining in the receive batch, new contiguous data is
+ * left pending for the next call.
+ */
+
+static
+void
+drain_recv_batch (
+	pgm_sock_t* const	sock
+	)
+{
+	struct sockaddr_storage src, dst;
+
+	while (sock->rx_ring_index < sock->rx_ring_len)
+	{
+		shift_recv_batch (sock,
+				  (struct sockaddr*)&src,
+				  sizeof(src),
+				  (struct sockaddr*)&dst,
+				  sizeof(dst));
+		on_packet (sock, (struct sockaddr*)&src, (struct sockaddr*)&dst);
+	}
+}
+#endif /* HAVE_RECVMMSG */
+
 /* block on receiving socket whilst holding sock::waiting-mutex
  * returns EAGAIN for waiting data, returns EINTR for waiting timer event,
  * returns ENOENT on closed sock, and returns EFAULT for libc error.
  */
 
+/* empty the pending-pipe, a shared receive socket member re-notifies itself
+ * for packets queued by other members.
+ */
+
+static inline
+void
+clear_pending_notify (
+	pgm_sock_t* const	sock
+	)
+{
+	pgm_notify_clear (&sock->pending_notify);
+	sock->is_pending_read = FALSE;
+	if (sock->demux)
+		pgm_demux_rearm (sock->demux);
+}
+
+/* block until wire data or a timer is due, refreshing the caller's time on
+ * each wake up.
+ */
+
 static
 int
 wait_for_event (
-	pgm_sock_t* const	sock
+	pgm_sock_t* const	sock,
+	pgm_time_t* const	now
 	)
 {
 	int n_fds = 3;
@@ -593,16 +1309,14 @@ wait_for_event (
 #endif /* HAVE_POLL */
 
 /* flush any waiting notifications */
-		if (sock->is_pending_read) {
-			pgm_notify_clear (&sock->pending_notify);
-			sock->is_pending_read = FALSE;
-		}
+		if (sock->is_pending_read || sock->demux)
+			clear_pending_notify (sock);
 
 		int timeout;
 		if (sock->can_send_data && !pgm_txw_retransmit_is_empty (sock->window))
 			timeout = 0;
 		else
-			timeout = (int)pgm_timer_expiration (sock);
+			timeout = (int)pgm_timer_expiration (sock, *now);
 		
 #ifdef HAVE_POLL
 		const int ready = poll (fds, n_fds, timeout /* μs */ / 1000 /* to ms */);
@@ -613,6 +1327,7 @@ wait_for_event (
 		};
 		const int ready = select (n_fds, &readfds, NULL, NULL, &tv_timeout);
 #endif /* HAVE_POLL */
+		*now = pgm_time_update_now();
 		if (PGM_UNLIKELY(SOCKET_ERROR == ready)) {
 			pgm_debug ("block returned errno=%i",errno);
 			return EFAULT;
@@ -620,7 +1335,7 @@ wait_for_event (
 			pgm_debug ("recv again on empty");
 			return EAGAIN;
 		}
-	} while (pgm_timer_check (sock));
+	} while (pgm_timer_check (sock, *now));
 	pgm_debug ("state generated event");
 	return EINTR;
 }
@@ -640,35 +1355,38 @@ wait_for_event (
  * returns PGM_IO_STATUS_TIMER_PENDING and caller should also wait.  On
  * unrecoverable dataloss, returns PGM_IO_STATUS_CONN_RESET.  If connection is
  * closed, returns PGM_IO_STATUS_EOF.  On error, returns PGM_IO_STATUS_ERROR.
+ *
+ * with is_pinned a reference is taken on every returned socket buffer before
+ * the receiver lock is dropped, the next read on any thread commits and may
+ * recycle the buffers otherwise.
  */
 
+static
 int
-pgm_recvmsgv (
+recvmsgv (
 	pgm_sock_t*   	   const restrict sock,
 	struct pgm_msgv_t* const restrict msg_start,
 	const size_t			  msg_len,
 	const int			  flags,	/* MSG_DONTWAIT for non-blocking */
+	const bool			  is_pinned,
 	size_t*			 restrict _bytes_read,	/* may be NULL */
 	pgm_error_t**		 restrict error
 	)
 {
 	int status = PGM_IO_STATUS_WOULD_BLOCK;
 
-	pgm_debug ("pgm_recvmsgv (sock:%p msg-start:%p msg-len:%" PRIzu " flags:%d bytes-read:%p error:%p)",
-		(void*)sock, (void*)msg_start, msg_len, flags, (void*)_bytes_read, (void*)error);
-
 /* parameters */
 	pgm_return_val_if_fail (NULL != sock, PGM_IO_STATUS_ERROR);
 	if (PGM_LIKELY(msg_len)) pgm_return_val_if_fail (NULL != msg_start, PGM_IO_STATUS_ERROR);
 
 /* shutdown */
-	if (PGM_UNLIKELY(!pgm_rwlock_reader_trylock (&sock->lock)))
+	if (PGM_UNLIKELY(!pgm_sock_reader_trylock (sock)))
 		pgm_return_val_if_reached (PGM_IO_STATUS_ERROR);
 
 /* state */
 	if (PGM_UNLIKELY(!sock->is_bound || sock->is_destroyed))
 	{
-		pgm_rwlock_reader_unlock (&sock->lock);
+		pgm_sock_reader_unlock (sock);
 		pgm_return_val_if_reached (PGM_IO_STATUS_ERROR);
 	}
 
@@ -676,13 +1394,16 @@ pgm_recvmsgv (
 	pgm_assert (NULL != sock->rx_buffer);
 	pgm_assert (sock->max_tpdu > 0);
 	if (sock->can_recv_data) {
-		pgm_assert (NULL != sock->peers_hashtable);
+		pgm_assert (NULL != sock->peers_table);
 		pgm_assert_cmpuint (sock->nak_bo_ivl, >, 1);
 		pgm_assert (pgm_notify_is_valid (&sock->pending_notify));
 	}
 
 /* receiver */
-	pgm_mutex_lock (&sock->receiver_mutex);
+	pgm_sock_mutex_lock (sock, &sock->receiver_mutex);
+
+/* one time read for timers and every packet of the call, refreshed after blocking */
+	pgm_time_t now = pgm_time_update_now();
 
 	if (PGM_UNLIKELY(sock->is_reset)) {
 		pgm_assert (NULL != sock->peers_pending);
@@ -701,14 +1422,14 @@ pgm_recvmsgv (
 		}
 		if (!sock->is_abort_on_reset)
 			sock->is_reset = !sock->is_reset;
-		pgm_mutex_unlock (&sock->receiver_mutex);
-		pgm_rwlock_reader_unlock (&sock->lock);
+		pgm_sock_mutex_unlock (sock, &sock->receiver_mutex);
+		pgm_sock_reader_unlock (sock);
 		return PGM_IO_STATUS_RESET;
 	}
 
 /* timer status */
-	if (pgm_timer_check (sock) &&
-	    !pgm_timer_dispatch (sock))
+	if (pgm_timer_check (sock, now) &&
+	    !pgm_timer_dispatch (sock, now))
 	{
 /* block on send-in-recv */
 		status = PGM_IO_STATUS_RATE_LIMITED;
@@ -735,7 +1456,7 @@ pgm_recvmsgv (
 
 	/* second, flush any remaining contiguous messages from previous call(s) */
 	if (sock->peers_pending) {
-		if (0 != pgm_flush_peers_pending (sock, &pmsg, msg_end, &bytes_read, &data_read))
+		if (0 != pgm_flush_peers_pending (sock, &pmsg, msg_end, &bytes_read, &data_read, now))
 			goto out;
 /* returns on: reset or full buffer */
 	}
@@ -750,13 +1471,32 @@ pgm_recvmsgv (
 
 recv_again:
 
+	if (sock->demux)
+		len = recvskb_demux (sock,
+				     (struct sockaddr*)&src,
+				     sizeof(src),
+				     (struct sockaddr*)&dst,
+				     sizeof(dst),
+				     now);
+	else
+#ifdef HAVE_RECVMMSG
+	if (sock->rx_ring)
+		len = recvskb_batch (sock,
+				     0,
+				     (struct sockaddr*)&src,
+				     sizeof(src),
+				     (struct sockaddr*)&dst,
+				     sizeof(dst));
+	else
+#endif
 	len = recvskb (sock,
 		       sock->rx_buffer,		/* PGM skbuff */
 		       0,
 		       (struct sockaddr*)&src,
 		       sizeof(src),
 		       (struct sockaddr*)&dst,
-		       sizeof(dst));
+		       sizeof(dst),
+		       now);
 	if (len < 0)
 	{
 		const int save_errno = pgm_get_last_sock_error();
@@ -783,40 +1523,17 @@ recv_again:
 		bytes_received += len;
 	}
 
-	pgm_error_t* err = NULL;
-	const bool is_valid = (sock->udp_encap_ucast_port || AF_INET6 == src.ss_family) ?
-					pgm_parse_udp_encap (sock->rx_buffer, &err) :
-					pgm_parse_raw (sock->rx_buffer, (struct sockaddr*)&dst, &err);
-	if (PGM_UNLIKELY(!is_valid))
-	{
-/* inherently cannot determine PGM_PC_RECEIVER_CKSUM_ERRORS unless only one receiver */
-		pgm_trace (PGM_LOG_ROLE_NETWORK,
-				_("Discarded invalid packet: %s"),
-				(err && err->message) ? err->message : "(null)");
-		pgm_error_free (err);
-		if (sock->can_send_data) {
-			if (err && PGM_ERROR_CKSUM == err->code)
-				sock->cumulative_stats[PGM_PC_SOURCE_CKSUM_ERRORS]++;
-			sock->cumulative_stats[PGM_PC_SOURCE_PACKETS_DISCARDED]++;
-		}
-		goto recv_again;
-	}
-
-	pgm_peer_t* source = NULL;
-	if (PGM_UNLIKELY(!on_pgm (sock, sock->rx_buffer, (struct sockaddr*)&src, (struct sockaddr*)&dst, &source)))
+/* shared receive socket packets are already parsed */
+	if (PGM_UNLIKELY(sock->demux ?
+			 !on_parsed_packet (sock, (struct sockaddr*)&src, (struct sockaddr*)&dst) :
+			 !on_packet (sock, (struct sockaddr*)&src, (struct sockaddr*)&dst)))
 		goto recv_again;
 
-/* check whether this source has waiting data */
-	if (source && pgm_peer_has_pending (source)) {
-		pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("New pending data."));
-		pgm_peer_set_pending (sock, source);
-	}
-
 flush_pending:
 /* flush any congtiguous packets generated by the receipt of this packet */
 	if (sock->peers_pending)
 	{
-		if (0 != pgm_flush_peers_pending (sock, &pmsg, msg_end, &bytes_read, &data_read))
+		if (0 != pgm_flush_peers_pending (sock, &pmsg, msg_end, &bytes_read, &data_read, now))
 		{
 /* recv vector is now full */
 			goto out;
@@ -838,17 +1555,17 @@ check_for_repeat:
 /* repeat if blocking and empty, i.e. received non data packet.
  */
 		if (0 == data_read) {
-			const int wait_status = wait_for_event (sock);
+			const int wait_status = wait_for_event (sock, &now);
 			switch (wait_status) {
 			case EAGAIN:
 				goto recv_again;
 			case EINTR:
-				if (!pgm_timer_dispatch (sock))
+				if (!pgm_timer_dispatch (sock, now))
 					goto check_for_repeat;
 				goto flush_pending;
 			case ENOENT:
-				pgm_mutex_unlock (&sock->receiver_mutex);
-				pgm_rwlock_reader_unlock (&sock->lock);
+				pgm_sock_mutex_unlock (sock, &sock->receiver_mutex);
+				pgm_sock_reader_unlock (sock);
 				return PGM_IO_STATUS_EOF;
 			case EFAULT: {
 				const int save_errno = pgm_get_last_sock_error();
@@ -859,8 +1576,8 @@ check_for_repeat:
 						_("Waiting for event: %s"),
 						pgm_sock_strerror_s (errbuf, sizeof (errbuf), save_errno)
 						);
-				pgm_mutex_unlock (&sock->receiver_mutex);
-				pgm_rwlock_reader_unlock (&sock->lock);
+				pgm_sock_mutex_unlock (sock, &sock->receiver_mutex);
+				pgm_sock_reader_unlock (sock);
 				return PGM_IO_STATUS_ERROR;
 			}
 			default:
@@ -870,13 +1587,22 @@ check_for_repeat:
 	}
 
 out:
+#ifdef HAVE_RECVMMSG
+	if (sock->rx_ring)
+		drain_recv_batch (sock);
+#endif
 	if (0 == data_read)
 	{
 /* clear event notification */
-		if (sock->is_pending_read) {
-			pgm_notify_clear (&sock->pending_notify);
-			sock->is_pending_read = FALSE;
+		if (sock->is_pending_read || sock->demux)
+			clear_pending_notify (sock);
+#ifdef HAVE_RECVMMSG
+/* new data from the drained batch remains for the next call */
+		if (sock->rx_ring && sock->peers_pending && !sock->is_pending_read) {
+			pgm_notify_send (&sock->pending_notify);
+			sock->is_pending_read = TRUE;
 		}
+#endif
 /* report data loss */
 		if (PGM_UNLIKELY(sock->is_reset)) {
 			pgm_assert (NULL != sock->peers_pending);
@@ -895,12 +1621,12 @@ out:
 			}
 			if (!sock->is_abort_on_reset)
 				sock->is_reset = !sock->is_reset;
-			pgm_mutex_unlock (&sock->receiver_mutex);
-			pgm_rwlock_reader_unlock (&sock->lock);
+			pgm_sock_mutex_unlock (sock, &sock->receiver_mutex);
+			pgm_sock_reader_unlock (sock);
 			return PGM_IO_STATUS_RESET;
 		}
-		pgm_mutex_unlock (&sock->receiver_mutex);
-		pgm_rwlock_reader_unlock (&sock->lock);
+		pgm_sock_mutex_unlock (sock, &sock->receiver_mutex);
+		pgm_sock_reader_unlock (sock);
 		if (PGM_IO_STATUS_WOULD_BLOCK == status &&
 		    ( sock->can_send_data ||
 		      ( sock->can_recv_data && NULL != sock->peers_list )))
@@ -916,8 +1642,7 @@ out:
 		if (sock->is_pending_read && sock->is_edge_triggered_recv)
 		{
 /* empty pending-pipe */
-			pgm_notify_clear (&sock->pending_notify);
-			sock->is_pending_read = FALSE;
+			clear_pending_notify (sock);
 		}
 		else if (!sock->is_pending_read && !sock->is_edge_triggered_recv)
 		{
@@ -927,13 +1652,39 @@ out:
 		}
 	}
 
+	if (is_pinned) {
+		for (struct pgm_msgv_t* msgv = msg_start; msgv < pmsg; msgv++)
+			for (uint32_t i = 0; i < msgv->msgv_len; i++)
+				pgm_skb_get (msgv->msgv_skb[i]);
+	}
+
 	if (NULL != _bytes_read)
 		*_bytes_read = bytes_read;
-	pgm_mutex_unlock (&sock->receiver_mutex);
-	pgm_rwlock_reader_unlock (&sock->lock);
+	pgm_sock_mutex_unlock (sock, &sock->receiver_mutex);
+	pgm_sock_reader_unlock (sock);
 	return PGM_IO_STATUS_NORMAL;
 }
 
+/* read a vector of apdus, returned socket buffers remain owned by the receive
+ * window.
+ */
+
+int
+pgm_recvmsgv (
+	pgm_sock_t*   	   const restrict sock,
+	struct pgm_msgv_t* const restrict msg_start,
+	const size_t			  msg_len,
+	const int			  flags,	/* MSG_DONTWAIT for non-blocking */
+	size_t*			 restrict _bytes_read,	/* may be NULL */
+	pgm_error_t**		 restrict error
+	)
+{
+	pgm_debug ("pgm_recvmsgv (sock:%p msg-start:%p msg-len:%" PRIzu " flags:%d bytes-read:%p error:%p)",
+		(void*)sock, (void*)msg_start, msg_len, flags, (void*)_bytes_read, (void*)error);
+
+	return recvmsgv (sock, msg_start, msg_len, flags, FALSE, _bytes_read, error);
+}
+
 /* read one contiguous apdu and return as a IO scatter/gather array.  msgv is owned by
  * the caller, tpdu contents are owned by the receive window.
  *
@@ -1045,4 +1796,77 @@ pgm_recv (
 	return pgm_recvfrom (sock, buf, buflen, flags, bytes_read, NULL, NULL, error);
 }
 
+/* zero-copy read, lends the socket buffers of the next APDU to the application
+ * as a scatter/gather vector.  the loan holds its own reference on each buffer,
+ * taken before the receiver lock is released, so the receive window purges
+ * committed sequences as normal, the payload remains valid until the loan is
+ * returned with pgm_loan_return().
+ *
+ * a loan covers one APDU, at most PGM_MAX_FRAGMENTS socket buffers as larger
+ * APDUs are discarded by the receive window.
+ *
+ * on success, returns PGM_IO_STATUS_NORMAL.
+ */
+
+int
+pgm_recvloan (
+	pgm_sock_t*	  const restrict sock,
+	struct pgm_loan_t**	restrict loan,
+	const int			 flags,		/* MSG_DONTWAIT for non-blocking */
+	size_t*			restrict bytes_read,	/* may be NULL */
+	pgm_error_t**		restrict error
+	)
+{
+	struct pgm_msgv_t msgv;
+	struct pgm_loan_t* new_loan;
+	size_t apdu_len = 0;
+
+	pgm_return_val_if_fail (NULL != sock, PGM_IO_STATUS_ERROR);
+	pgm_return_val_if_fail (NULL != loan, PGM_IO_STATUS_ERROR);
+
+	pgm_debug ("pgm_recvloan (sock:%p loan:%p flags:%d bytes-read:%p error:%p)",
+		(const void*)sock, (const void*)loan, flags, (const void*)bytes_read, (const void*)error);
+
+	const int status = recvmsgv (sock, &msgv, 1, flags & ~(MSG_ERRQUEUE), TRUE, &apdu_len, error);
+	if (PGM_IO_STATUS_NORMAL != status)
+		return status;
+
+/* single allocation: loan, vector, then buffer references */
+	const uint32_t count = msgv.msgv_len;
+	new_loan = pgm_malloc (sizeof (struct pgm_loan_t) +
+			       count * (sizeof (struct pgm_iovec) + sizeof (struct pgm_sk_buff_t*)));
+	new_loan->loan_len    = apdu_len;
+	new_loan->loan_iovlen = count;
+	new_loan->loan_iov    = (struct pgm_iovec*)(new_loan + 1);
+	new_loan->loan_skb    = (struct pgm_sk_buff_t**)(new_loan->loan_iov + count);
+	for (uint32_t i = 0; i < count; i++) {
+		struct pgm_sk_buff_t* skb = msgv.msgv_skb[i];
+		new_loan->loan_skb[i]         = skb;
+		new_loan->loan_iov[i].iov_base = skb->data;
+		new_loan->loan_iov[i].iov_len  = skb->len;
+	}
+	new_loan->loan_tsi = &new_loan->loan_skb[0]->tsi;
+
+	*loan = new_loan;
+	if (bytes_read)
+		*bytes_read = apdu_len;
+	return PGM_IO_STATUS_NORMAL;
+}
+
+/* release socket buffers lent by pgm_recvloan().  may be called from any thread
+ * and after the socket has been closed.
+ */
+
+void
+pgm_loan_return (
+	struct pgm_loan_t* const loan
+	)
+{
+	pgm_return_if_fail (NULL != loan);
+
+	for (uint32_t i = 0; i < loan->loan_iovlen; i++)
+		pgm_free_skb (loan->loan_skb[i]);
+	pgm_free (loan);
+}
+
 /* eof */
@@ -80,6 +80,8 @@ GList* mock_recvmsg_list = NULL;
 static int mock_pgm_type = -1;
 static gboolean mock_reset_on_spmr = FALSE;
 static gboolean mock_data_on_spmr = FALSE;
+static gboolean mock_has_pending = FALSE;
+static gboolean mock_reset_on_flush = FALSE;
 static struct pgm_peer_t* mock_peer = NULL;
 GList* mock_data_list = NULL;
 unsigned mock_pgm_loss_rate = 0;
@@ -87,6 +89,9 @@ unsigned mock_pgm_loss_rate = 0;
 
 #ifndef _WIN32
 static ssize_t mock_recvmsg (int, struct msghdr*, int);
+#	ifdef __linux__
+static int mock_recvmmsg (int, struct mmsghdr*, unsigned int, int, struct timespec*);
+#	endif
 #else
 static int mock_recvfrom (SOCKET, char*, int, int, struct sockaddr*, int*);
 #endif
@@ -102,6 +107,7 @@ static int mock_recvfrom (SOCKET, char*, int, int, struct sockaddr*, int*);
 #define pgm_flush_peers_pending		mock_pgm_flush_peers_pending
 #define pgm_peer_has_pending		mock_pgm_peer_has_pending
 #define pgm_peer_set_pending		mock_pgm_peer_set_pending
+#define pgm_peer_update_timer		mock_pgm_peer_update_timer
 #define pgm_txw_retransmit_is_empty	mock_pgm_txw_retransmit_is_empty
 #define pgm_rxw_create			mock_pgm_rxw_create
 #define pgm_rxw_readv			mock_pgm_rxw_readv
@@ -123,6 +129,7 @@ static int mock_recvfrom (SOCKET, char*, int, int, struct sockaddr*, int*);
 #define pgm_time_now			mock_pgm_time_now
 #define pgm_time_update_now		mock_pgm_time_update_now
 #define recvmsg				mock_recvmsg
+#define recvmmsg			mock_recvmmsg
 #define recvfrom			mock_recvfrom
 #define pgm_WSARecvMsg			mock_pgm_WSARecvMsg
 #define pgm_loss_rate			mock_pgm_loss_rate
@@ -152,6 +159,8 @@ mock_teardown (void)
 	mock_pgm_type = -1;
 	mock_reset_on_spmr = FALSE;
 	mock_data_on_spmr = FALSE;
+	mock_has_pending = FALSE;
+	mock_reset_on_flush = FALSE;
 	mock_peer = NULL;
 	mock_data_list = NULL;
 	mock_pgm_loss_rate = 0;
@@ -176,7 +185,7 @@ generate_sock (void)
 	sock->can_send_data = TRUE;
 	sock->can_send_nak = TRUE;
 	sock->can_recv_data = TRUE;
-	sock->peers_hashtable = pgm_hashtable_new (pgm_tsi_hash, pgm_tsi_equal);
+	sock->peers_table = pgm_tsitable_new ();
 	pgm_rand_create (&sock->rand_);
 	sock->nak_bo_ivl = 100*1000;
 	pgm_notify_init (&sock->pending_notify);
@@ -671,7 +680,7 @@ mock_pgm_new_peer (
 					    sock->ack_c_p);
 	peer->spmr_expiry = now + sock->spmr_expiry;
 	gpointer entry = mock__pgm_peer_ref(peer);
-	pgm_hashtable_insert (sock->peers_hashtable, &peer->tsi, entry);
+	pgm_tsitable_insert (sock->peers_table, &peer->tsi, entry);
 	peer->peers_link.next = sock->peers_list;
 	peer->peers_link.data = peer;
 	if (sock->peers_list)
@@ -697,7 +706,8 @@ mock_pgm_flush_peers_pending (
 	struct pgm_msgv_t**		pmsg,
 	const struct pgm_msgv_t* const	msg_end,
 	size_t* const			bytes_read,
-	unsigned* const			data_read
+	unsigned* const			data_read,
+	const pgm_time_t		now
 	)
 {
 	if (mock_data_list) {
@@ -719,6 +729,10 @@ mock_pgm_flush_peers_pending (
 		if (*pmsg > msg_end)
 			return -PGM_SOCK_ENOBUFS;
 	}
+	else if (mock_reset_on_flush) {
+		sock->is_reset = TRUE;
+		return -PGM_SOCK_ECONNRESET;
+	}
 	return 0;
 }
 
@@ -728,7 +742,18 @@ mock_pgm_peer_has_pending (
 	pgm_peer_t* const               peer
 	)
 {
-	return FALSE;
+	return mock_has_pending;
+}
+
+PGM_GNUC_INTERNAL
+void
+mock_pgm_peer_update_timer (
+	pgm_sock_t* const		sock,
+	pgm_peer_t* const		peer
+	)
+{
+	g_assert (NULL != sock);
+	g_assert (NULL != peer);
 }
 
 PGM_GNUC_INTERNAL
@@ -926,7 +951,8 @@ mock_pgm_sendto (
 PGM_GNUC_INTERNAL
 bool
 mock_pgm_timer_prepare (
-	pgm_sock_t* const		sock
+	pgm_sock_t* const		sock,
+	const pgm_time_t		now
 	)
 {
 	return FALSE;
@@ -935,7 +961,8 @@ mock_pgm_timer_prepare (
 PGM_GNUC_INTERNAL
 bool
 mock_pgm_timer_check (
-	pgm_sock_t* const		sock
+	pgm_sock_t* const		sock,
+	const pgm_time_t		now
 	)
 {
 	return FALSE;
@@ -944,7 +971,8 @@ mock_pgm_timer_check (
 PGM_GNUC_INTERNAL
 pgm_time_t
 mock_pgm_timer_expiration (
-	pgm_sock_t* const		sock
+	pgm_sock_t* const		sock,
+	const pgm_time_t		now
 	)
 {
 	return 100L;
@@ -953,7 +981,8 @@ mock_pgm_timer_expiration (
 PGM_GNUC_INTERNAL
 bool
 mock_pgm_timer_dispatch (
-	pgm_sock_t* const		sock
+	pgm_sock_t* const		sock,
+	const pgm_time_t		now
 	)
 {
 	return TRUE;
@@ -1010,6 +1039,42 @@ mock_recvmsg (
 	errno = mock_errno;
 	return mock_retval;
 }
+
+#	ifdef HAVE_RECVMMSG
+/* fill the batch up to the next blocking event, which is only returned when
+ * first in line.
+ */
+static
+int
+mock_recvmmsg (
+	int			s,
+	struct mmsghdr*		msgvec,
+	unsigned int		vlen,
+	int			flags,
+	struct timespec*	timeout
+	)
+{
+	g_assert (NULL != msgvec);
+	g_assert (vlen > 0);
+	g_assert (NULL != mock_recvmsg_list);
+
+	g_debug ("mock_recvmmsg (s:%d msgvec:%p vlen:%u flags:%d timeout:%p)",
+		s, (gpointer)msgvec, vlen, flags, (gpointer)timeout);
+
+	unsigned i;
+	for (i = 0; i < vlen && NULL != mock_recvmsg_list; i++)
+	{
+		const struct mock_recvmsg_t* mr = mock_recvmsg_list->data;
+		if (NULL == mr->mr_msg && i > 0)
+			break;
+		const ssize_t len = mock_recvmsg (s, &msgvec[i].msg_hdr, flags);
+		if (len < 0)
+			return -1;
+		msgvec[i].msg_len = (unsigned)len;
+	}
+	return (int)i;
+}
+#	endif /* HAVE_RECVMMSG */
 #else
 static
 int
@@ -1171,6 +1236,325 @@ START_TEST (test_data_pass_001)
 }
 END_TEST
 
+/* recv -> on_data, source accepted by exactly one of two receive shards */
+START_TEST (test_shard_pass_001)
+{
+	const char source[] = "i am not a string";
+	guint processed = 0;
+	for (guint i = 0; i < 2; i++)
+	{
+		pgm_sock_t* sock = generate_sock();
+		fail_if (NULL == sock, "generate_sock failed");
+		sock->shard_index = i;
+		sock->shard_count = 2;
+		guint8 buffer[ TEST_TXW_SQNS * TEST_MAX_TPDU ];
+		gpointer packet; gsize packet_len;
+		generate_odata (source, sizeof(source), 0 /* sqn */, -1 /* trail */, &packet, &packet_len);
+		generate_msghdr (packet, packet_len);
+		push_block_event ();
+		gsize bytes_read;
+		pgm_error_t* err = NULL;
+		mock_pgm_type = -1;
+		const int status = pgm_recv (sock, buffer, sizeof(buffer), MSG_DONTWAIT, &bytes_read, &err);
+		fail_unless (PGM_IO_STATUS_TIMER_PENDING == status || PGM_IO_STATUS_WOULD_BLOCK == status, "recv failed");
+		if (PGM_ODATA == mock_pgm_type)
+			processed++;
+	}
+	fail_unless (1 == processed, "source not sharded");
+}
+END_TEST
+
+/* two member sockets on a shared receive socket by data-destination port
+ * and TSI, each reads only its own packets.
+ */
+
+static
+void
+generate_demux_member (
+	pgm_demux_t*		demux,
+	pgm_sock_t*		sock,
+	const guint16		dport
+	)
+{
+	struct sockaddr_in group = {
+		.sin_family		= AF_INET,
+		.sin_addr.s_addr	= inet_addr (TEST_GROUP_ADDR)
+	};
+	pgm_demux_member_t* member = g_new0 (pgm_demux_member_t, 1);
+	member->demux = demux;
+	member->sock = sock;
+	member->queue = g_new0 (struct pgm_demux_slot_t, PGM_DEMUX_QUEUE_LEN);
+	demux->members = pgm_slist_append (demux->members, member);
+	demux->ref_count++;
+	sock->dport = g_htons (dport);
+	sock->use_demux = TRUE;
+	sock->demux = member;
+	memcpy (&sock->recv_gsr[0].gsr_group, &group, sizeof(group));
+	sock->recv_gsr_len = 1;
+}
+
+static
+void
+generate_demux_odata (
+	const guint16		dport,
+	const guint8		gsi_tail,
+	const guint32		data_sqn
+	)
+{
+	const char source[] = "i am not a string";
+	gpointer packet; gsize packet_len;
+	generate_odata (source, sizeof(source), data_sqn, -1 /* trail */, &packet, &packet_len);
+	struct pgm_header* pgmhdr = (gpointer)((guint8*)packet + sizeof(struct pgm_ip));
+	pgmhdr->pgm_dport	= g_htons (dport);
+	pgmhdr->pgm_gsi[5]	= gsi_tail;
+	generate_msghdr (packet, packet_len);
+}
+
+START_TEST (test_demux_pass_001)
+{
+	pgm_demux_t demux;
+	memset (&demux, 0, sizeof(demux));
+	demux.family	= AF_INET;
+	demux.recv_sock	= INVALID_SOCKET;
+	demux.max_tpdu	= TEST_MAX_TPDU;
+	pgm_mutex_init (&demux.mutex);
+	pgm_sock_t* sock[2];
+	for (guint i = 0; i < 2; i++) {
+		sock[i] = generate_sock();
+		fail_if (NULL == sock[i], "generate_sock failed");
+		generate_demux_member (&demux, sock[i], TEST_DPORT + i);
+	}
+/* packets for the second, first, neither and second socket from two sources */
+	generate_demux_odata (TEST_DPORT + 1, 6, 10);
+	generate_demux_odata (TEST_DPORT, 7, 20);
+	generate_demux_odata (TEST_DPORT + 2, 6, 30);
+	generate_demux_odata (TEST_DPORT + 1, 7, 40);
+	push_block_event ();
+	struct sockaddr_storage src, dst;
+	ssize_t len = recvskb_demux (sock[0], (struct sockaddr*)&src, sizeof(src), (struct sockaddr*)&dst, sizeof(dst), 1);
+	fail_unless (len > 0, "recvskb_demux failed");
+	fail_unless (g_htons(TEST_DPORT) == sock[0]->rx_buffer->pgm_header->pgm_dport, "first socket read foreign port");
+	fail_unless (7 == sock[0]->rx_buffer->tsi.gsi.identifier[5], "first socket read foreign source");
+	fail_unless (sock[0] == sock[0]->rx_buffer->sock, "packet not owned by first socket");
+	fail_unless (1 == sock[1]->demux->queue_len, "packet not queued for second socket");
+	fail_unless (sock[1]->demux->is_notified, "second socket not notified");
+/* second socket takes its queued packet then reads the remainder */
+	len = recvskb_demux (sock[1], (struct sockaddr*)&src, sizeof(src), (struct sockaddr*)&dst, sizeof(dst), 1);
+	fail_unless (len > 0, "recvskb_demux failed");
+	fail_unless (g_htons(TEST_DPORT + 1) == sock[1]->rx_buffer->pgm_header->pgm_dport, "second socket read foreign port");
+	fail_unless (6 == sock[1]->rx_buffer->tsi.gsi.identifier[5], "second socket read out of order");
+	fail_unless (sock[1] == sock[1]->rx_buffer->sock, "packet not owned by second socket");
+	fail_unless (0 == sock[1]->demux->queue_len, "queue not drained");
+	len = recvskb_demux (sock[1], (struct sockaddr*)&src, sizeof(src), (struct sockaddr*)&dst, sizeof(dst), 1);
+	fail_unless (len > 0, "recvskb_demux failed");
+	fail_unless (g_htons(TEST_DPORT + 1) == sock[1]->rx_buffer->pgm_header->pgm_dport, "second socket read foreign port");
+	fail_unless (7 == sock[1]->rx_buffer->tsi.gsi.identifier[5], "second socket read foreign source");
+	fail_unless (0 == sock[0]->demux->queue_len, "packet queued for first socket");
+/* packet for no member discarded, shared socket drained */
+	len = recvskb_demux (sock[0], (struct sockaddr*)&src, sizeof(src), (struct sockaddr*)&dst, sizeof(dst), 1);
+	fail_unless (SOCKET_ERROR == len, "recvskb_demux returned packet");
+	fail_unless (NULL == mock_recvmsg_list, "shared socket not drained");
+}
+END_TEST
+
+#ifdef HAVE_RECVMMSG
+/* pre-allocated receive batch as created on connect */
+
+static
+void
+generate_recv_batch (
+	pgm_sock_t*		sock,
+	const unsigned		recv_batch
+	)
+{
+	sock->recv_batch = recv_batch;
+	sock->rx_ring = g_new0 (struct pgm_sk_buff_t*, recv_batch);
+	sock->rx_ring_addr = g_new0 (struct sockaddr_storage, 2 * recv_batch);
+	for (unsigned i = 0; i < recv_batch; i++)
+		sock->rx_ring[i] = pgm_alloc_skb (TEST_MAX_TPDU);
+}
+
+/* recvmmsg reads the batch once, packets are returned in order */
+START_TEST (test_recv_batch_pass_001)
+{
+	pgm_sock_t* sock = generate_sock();
+	fail_if (NULL == sock, "generate_sock failed");
+	generate_recv_batch (sock, 4);
+	for (guint i = 0; i < 3; i++)
+		generate_demux_odata (TEST_DPORT, 6, i);
+	push_block_event ();
+	struct sockaddr_storage src, dst;
+	for (guint i = 0; i < 3; i++) {
+		const ssize_t len = recvskb_batch (sock, 0, (struct sockaddr*)&src, sizeof(src), (struct sockaddr*)&dst, sizeof(dst));
+		fail_unless (len > 0, "recvskb_batch failed");
+		fail_unless (len == sock->rx_buffer->len, "unexpected packet length");
+		const struct pgm_data* data = (gpointer)((guint8*)sock->rx_buffer->data + sizeof(struct pgm_ip) + sizeof(struct pgm_header));
+		fail_unless (g_htonl (i) == data->data_sqn, "out of order");
+		fail_unless (inet_addr (TEST_SRC_ADDR) == ((struct sockaddr_in*)&src)->sin_addr.s_addr, "unexpected source address");
+		fail_unless (1 == sock->rx_batch_calls, "batch read more than once");
+	}
+	fail_unless (3 == sock->rx_batch_datagrams, "unexpected batch datagrams");
+	fail_unless (SOCKET_ERROR == recvskb_batch (sock, 0, (struct sockaddr*)&src, sizeof(src), (struct sockaddr*)&dst, sizeof(dst)), "recvskb_batch returned packet");
+	fail_unless (PGM_SOCK_EAGAIN == errno, "unexpected error");
+	fail_unless (1 == sock->rx_batch_calls, "empty read counted");
+	fail_unless (NULL == mock_recvmsg_list, "socket not drained");
+}
+END_TEST
+
+/* packets left in the batch are processed on return */
+START_TEST (test_recv_batch_pass_002)
+{
+	pgm_sock_t* sock = generate_sock();
+	fail_if (NULL == sock, "generate_sock failed");
+	generate_recv_batch (sock, 4);
+	for (guint i = 0; i < 3; i++)
+		generate_demux_odata (TEST_DPORT, 6, i);
+	fail_unless (3 == refill_recv_batch (sock, 0), "refill_recv_batch failed");
+	fail_unless (3 == sock->rx_ring_len, "unexpected batch length");
+	fail_unless (0 == sock->rx_ring_index, "unexpected batch index");
+	mock_pgm_type = -1;
+	drain_recv_batch (sock);
+	fail_unless (sock->rx_ring_index == sock->rx_ring_len, "batch not drained");
+	fail_unless (PGM_ODATA == mock_pgm_type, "batch not processed");
+/* buffers remain distinct after the swaps */
+	for (guint i = 0; i < sock->recv_batch; i++)
+		fail_unless (sock->rx_buffer != sock->rx_ring[i], "receive buffer shared with batch");
+}
+END_TEST
+
+/* new data drained from the batch on return without data is signalled */
+START_TEST (test_recv_batch_pass_003)
+{
+	pgm_sock_t* sock = generate_sock();
+	fail_if (NULL == sock, "generate_sock failed");
+	generate_recv_batch (sock, 4);
+	generate_demux_odata (TEST_DPORT, 6, 0);
+	generate_demux_odata (TEST_DPORT, 6, 1);
+	fail_unless (2 == refill_recv_batch (sock, 0), "refill_recv_batch failed");
+	const pgm_tsi_t peer_tsi = { { 9, 8, 7, 6, 5, 4 }, g_htons(9000) };
+	struct sockaddr_in grp_addr = {
+		.sin_family		= AF_INET,
+		.sin_addr.s_addr	= inet_addr(TEST_GROUP_ADDR)
+	}, peer_addr = {
+		.sin_family		= AF_INET,
+		.sin_addr.s_addr	= inet_addr(TEST_END_ADDR)
+	};
+	mock_peer = mock_pgm_new_peer (sock, &peer_tsi, (struct sockaddr*)&grp_addr, sizeof(grp_addr), (struct sockaddr*)&peer_addr, sizeof(peer_addr), mock_pgm_time_now);
+	fail_if (NULL == mock_peer, "new_peer failed");
+	mock_pgm_peer_set_pending (sock, mock_peer);
+	pgm_notify_send (&sock->pending_notify);
+	sock->is_pending_read = TRUE;
+	mock_reset_on_flush = TRUE;
+	mock_has_pending = TRUE;
+	guint8 buffer[ TEST_TXW_SQNS * TEST_MAX_TPDU ];
+	gsize bytes_read;
+	pgm_error_t* err = NULL;
+	fail_unless (PGM_IO_STATUS_RESET == pgm_recv (sock, buffer, sizeof(buffer), MSG_DONTWAIT, &bytes_read, &err), "recv failed");
+	fail_unless (sock->rx_ring_index == sock->rx_ring_len, "batch not drained");
+	fail_unless (sock->is_pending_read, "drained data not signalled");
+}
+END_TEST
+
+#	ifdef HAVE_UDP_GRO
+/* one read of gso_size segments coalesced by UDP GRO, each filled with its
+ * segment index.
+ */
+
+static
+void
+generate_gro_msghdr (
+	const gsize		gso_size,
+	const gsize		len
+	)
+{
+	struct sockaddr_in addr = {
+		.sin_family		= AF_INET,
+		.sin_addr.s_addr	= inet_addr (TEST_SRC_ADDR)
+	};
+	guint8* buffer = g_malloc (len);
+	for (gsize i = 0; i < len; i++)
+		buffer[i] = (guint8)(i / gso_size);
+	struct iovec iov = {
+		.iov_base		= buffer,
+		.iov_len		= len
+	};
+	struct cmsghdr* cmsg = g_malloc0 (CMSG_SPACE(sizeof(int)));
+	const int segment = (int)gso_size;
+	cmsg->cmsg_len   = CMSG_LEN(sizeof(int));
+	cmsg->cmsg_level = SOL_UDP;
+	cmsg->cmsg_type  = UDP_GRO;
+	memcpy (CMSG_DATA(cmsg), &segment, sizeof(segment));
+	struct msghdr msg = {
+		.msg_name		= g_memdup (&addr, sizeof(addr)),
+		.msg_namelen		= sizeof(addr),
+		.msg_iov		= g_memdup (&iov, sizeof(iov)),
+		.msg_iovlen		= 1,
+		.msg_control		= cmsg,
+		.msg_controllen		= CMSG_SPACE(sizeof(int)),
+		.msg_flags		= 0
+	};
+	struct mock_recvmsg_t* mr = g_malloc (sizeof(struct mock_recvmsg_t));
+	mr->mr_msg	= g_memdup (&msg, sizeof(msg));
+	mr->mr_errno	= 0;
+	mr->mr_retval	= len;
+	mock_recvmsg_list = g_list_append (mock_recvmsg_list, mr);
+}
+
+/* coalesced read split into the batch, short final segment kept */
+START_TEST (test_recv_gro_pass_001)
+{
+	pgm_sock_t* sock = generate_sock();
+	fail_if (NULL == sock, "generate_sock failed");
+	generate_recv_batch (sock, 8);
+	sock->rx_gro_buffer = g_malloc (PGM_MAX_GRO_LEN);
+	generate_gro_msghdr (100, 350);
+	fail_unless (350 == refill_recv_gro (sock, 0), "refill_recv_gro failed");
+	fail_unless (4 == sock->rx_ring_len, "unexpected batch length");
+	for (guint i = 0; i < 4; i++) {
+		fail_unless ((3 == i ? 50 : 100) == sock->rx_ring[i]->len, "unexpected segment length");
+		fail_unless (i == *(guint8*)sock->rx_ring[i]->data, "segment out of order");
+		fail_unless (inet_addr (TEST_SRC_ADDR) == ((struct sockaddr_in*)&sock->rx_ring_addr[ 2 * i ])->sin_addr.s_addr, "unexpected source address");
+	}
+	fail_unless (4 == sock->rx_batch_datagrams, "unexpected batch datagrams");
+	fail_unless (0 == sock->rx_batch_discarded, "unexpected discards");
+}
+END_TEST
+
+/* oversize segments are skipped, later segments are kept */
+START_TEST (test_recv_gro_pass_002)
+{
+	pgm_sock_t* sock = generate_sock();
+	fail_if (NULL == sock, "generate_sock failed");
+	generate_recv_batch (sock, 8);
+	sock->rx_gro_buffer = g_malloc (PGM_MAX_GRO_LEN);
+	sock->max_tpdu = 150;
+	generate_gro_msghdr (200, 450);
+	fail_unless (450 == refill_recv_gro (sock, 0), "refill_recv_gro failed");
+	fail_unless (1 == sock->rx_ring_len, "unexpected batch length");
+	fail_unless (50 == sock->rx_ring[0]->len, "unexpected segment length");
+	fail_unless (2 == *(guint8*)sock->rx_ring[0]->data, "final segment not kept");
+	fail_unless (1 == sock->rx_batch_datagrams, "unexpected batch datagrams");
+	fail_unless (2 == sock->rx_batch_discarded, "discards not counted");
+}
+END_TEST
+
+/* segments beyond the batch are counted */
+START_TEST (test_recv_gro_pass_003)
+{
+	pgm_sock_t* sock = generate_sock();
+	fail_if (NULL == sock, "generate_sock failed");
+	generate_recv_batch (sock, 2);
+	sock->rx_gro_buffer = g_malloc (PGM_MAX_GRO_LEN);
+	generate_gro_msghdr (100, 400);
+	fail_unless (400 == refill_recv_gro (sock, 0), "refill_recv_gro failed");
+	fail_unless (2 == sock->rx_ring_len, "unexpected batch length");
+	fail_unless (2 == sock->rx_batch_datagrams, "unexpected batch datagrams");
+	fail_unless (2 == sock->rx_batch_discarded, "discards not counted");
+}
+END_TEST
+#	endif /* HAVE_UDP_GRO */
+#endif /* HAVE_RECVMMSG */
+
 /* recv -> on_spm */
 START_TEST (test_spm_pass_001)
 {
@@ -1636,6 +2020,66 @@ START_TEST (test_recvmsgv_fail_001)
 }
 END_TEST
 
+/* target:
+ *	int
+ *	pgm_recvloan (
+ *		pgm_sock_t*		sock,
+ *		struct pgm_loan_t**	loan,
+ *		int			flags,
+ *		size_t*			bytes_read,
+ *		pgm_error_t**		error
+ *		)
+ */
+
+START_TEST (test_recvloan_pass_001)
+{
+	const char source[] = "i am not a string";
+	pgm_sock_t* sock = generate_sock();
+	fail_if (NULL == sock, "generate_sock failed");
+	mock_data_on_spmr = TRUE;
+	gpointer packet; gsize packet_len;
+	generate_spmr (&packet, &packet_len);
+	generate_msghdr (packet, packet_len);
+	const pgm_tsi_t peer_tsi = { { 9, 8, 7, 6, 5, 4 }, g_htons(9000) };
+	struct sockaddr_in grp_addr = {
+		.sin_family		= AF_INET,
+		.sin_addr.s_addr	= inet_addr(TEST_GROUP_ADDR)
+	}, peer_addr = {
+		.sin_family		= AF_INET,
+		.sin_addr.s_addr	= inet_addr(TEST_END_ADDR)
+	};
+	mock_peer = mock_pgm_new_peer (sock, &peer_tsi, (struct sockaddr*)&grp_addr, sizeof(grp_addr), (struct sockaddr*)&peer_addr, sizeof(peer_addr), mock_pgm_time_now);
+	fail_if (NULL == mock_peer, "new_peer failed");
+	struct pgm_sk_buff_t* skb = pgm_alloc_skb (TEST_MAX_TPDU);
+	pgm_skb_put (skb, sizeof(source));
+	memcpy (skb->data, source, sizeof(source));
+	struct pgm_msgv_t* msgv = g_new0 (struct pgm_msgv_t, 1);
+	msgv->msgv_len = 1;
+	msgv->msgv_skb[0] = skb;
+	mock_data_list = g_list_append (mock_data_list, msgv);
+	push_block_event ();
+	struct pgm_loan_t* loan = NULL;
+	gsize bytes_read;
+	pgm_error_t* err = NULL;
+	fail_unless (PGM_IO_STATUS_NORMAL == pgm_recvloan (sock, &loan, MSG_DONTWAIT, &bytes_read, &err), "recvloan failed");
+	fail_unless (NULL == err, "error raised");
+	fail_if (NULL == loan, "no loan");
+	fail_unless ((gsize)sizeof(source) == bytes_read, "unexpected data length");
+	fail_unless (1 == loan->loan_iovlen, "unexpected vector length");
+	fail_unless (skb->data == loan->loan_iov[0].iov_base, "payload copied");
+	fail_unless (2 == pgm_atomic_read32 (&skb->users), "reference not taken");
+	pgm_loan_return (loan);
+	fail_unless (1 == pgm_atomic_read32 (&skb->users), "reference not released");
+}
+END_TEST
+
+START_TEST (test_recvloan_fail_001)
+{
+	struct pgm_loan_t* loan;
+	fail_unless (PGM_IO_STATUS_ERROR == pgm_recvloan (NULL, &loan, 0, NULL, NULL), "recvloan failed");
+}
+END_TEST
+
 
 static
 Suite*
@@ -1655,6 +2099,30 @@ make_test_suite (void)
 	tcase_add_checked_fixture (tc_data, mock_setup, mock_teardown);
 	tcase_add_test (tc_data, test_data_pass_001);
 
+	TCase* tc_shard = tcase_create ("shard");
+	suite_add_tcase (s, tc_shard);
+	tcase_add_checked_fixture (tc_shard, mock_setup, mock_teardown);
+	tcase_add_test (tc_shard, test_shard_pass_001);
+
+	TCase* tc_demux = tcase_create ("demux");
+	suite_add_tcase (s, tc_demux);
+	tcase_add_checked_fixture (tc_demux, mock_setup, mock_teardown);
+	tcase_add_test (tc_demux, test_demux_pass_001);
+
+#ifdef HAVE_RECVMMSG
+	TCase* tc_recv_batch = tcase_create ("recv-batch");
+	suite_add_tcase (s, tc_recv_batch);
+	tcase_add_checked_fixture (tc_recv_batch, mock_setup, mock_teardown);
+	tcase_add_test (tc_recv_batch, test_recv_batch_pass_001);
+	tcase_add_test (tc_recv_batch, test_recv_batch_pass_002);
+	tcase_add_test (tc_recv_batch, test_recv_batch_pass_003);
+#	ifdef HAVE_UDP_GRO
+	tcase_add_test (tc_recv_batch, test_recv_gro_pass_001);
+	tcase_add_test (tc_recv_batch, test_recv_gro_pass_002);
+	tcase_add_test (tc_recv_batch, test_recv_gro_pass_003);
+#	endif
+#endif
+
 	TCase* tc_spm = tcase_create ("spm");
 	suite_add_tcase (s, tc_spm);
 	tcase_add_checked_fixture (tc_spm, mock_setup, mock_teardown);
@@ -1745,6 +2213,12 @@ make_test_suite (void)
 	tcase_add_checked_fixture (tc_recvmsgv, mock_setup, mock_teardown);
 	tcase_add_test (tc_recvmsgv, test_recvmsgv_fail_001);
 
+	TCase* tc_recvloan = tcase_create ("recvloan");
+	suite_add_tcase (s, tc_recvloan);
+	tcase_add_checked_fixture (tc_recvloan, mock_setup, mock_teardown);
+	tcase_add_test (tc_recvloan, test_recvloan_pass_001);
+	tcase_add_test (tc_recvloan, test_recvloan_fail_001);
+
 	return s;
 }
 
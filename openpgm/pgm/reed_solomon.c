@@ -29,6 +29,24 @@
 #endif
 #include <impl/framework.h>
 
+/* vectorised kernels selected at runtime by processor feature, GCC 4.9 or
+ * later is required for intrinsics within target specific functions.
+ */
+#if ( defined( __x86_64__ ) || defined( __amd64 ) || defined( __i386__ ) || defined( __i386 ) ) && \
+    ( defined( __clang__ ) || ( defined( __GNUC__ ) && ( __GNUC__ > 4 || ( __GNUC__ == 4 && __GNUC_MINOR__ >= 9 ) ) ) )
+#	define USE_GALOIS_VEC_X86
+#	include <immintrin.h>
+#elif defined( __aarch64__ ) && defined( __ARM_NEON )
+#	define USE_GALOIS_VEC_NEON
+#	include <arm_neon.h>
+#endif
+
+
+static void _pgm_gf_vec_addmul_select (pgm_gf8_t*restrict, const pgm_gf8_t, const pgm_gf8_t*restrict, uint16_t);
+
+/* d[] += b • s[] implementation, resolved on first call.
+ */
+static void (*_pgm_gf_vec_addmul) (pgm_gf8_t*restrict, const pgm_gf8_t, const pgm_gf8_t*restrict, uint16_t) = _pgm_gf_vec_addmul_select;
 
 /* Vector GF(2⁸) plus-equals multiplication.
  *
@@ -37,7 +55,7 @@
 
 static
 void
-_pgm_gf_vec_addmul (
+_pgm_gf_vec_addmul_generic (
 	pgm_gf8_t*	 restrict d,
 	const pgm_gf8_t		  b,
 	const pgm_gf8_t* restrict s,
@@ -95,6 +113,176 @@ _pgm_gf_vec_addmul (
 	}
 }
 
+#if defined( USE_GALOIS_VEC_X86 ) || defined( USE_GALOIS_VEC_NEON )
+/* split b • x into products of the low and high nibbles of x, each a
+ * sixteen entry table suitable for a byte shuffle.
+ *
+ * b • x = b • (x & 0x0f) ⊕ b • (x & 0xf0)
+ */
+
+static
+void
+_pgm_gf_nibble_tables (
+	const pgm_gf8_t		  b,
+	pgm_gf8_t*	 restrict lo,	/* 16 entries */
+	pgm_gf8_t*	 restrict hi	/* 16 entries */
+	)
+{
+	unsigned x;
+
+	for (x = 0; x < 16; x++) {
+		lo[x] = pgm_gfmul (b, (pgm_gf8_t)x);
+		hi[x] = pgm_gfmul (b, (pgm_gf8_t)(x << 4));
+	}
+}
+#endif
+
+#ifdef USE_GALOIS_VEC_X86
+/* 16 bytes per iteration with SSSE3 pshufb.
+ */
+
+static
+__attribute__((__target__("ssse3")))
+void
+_pgm_gf_vec_addmul_ssse3 (
+	pgm_gf8_t*	 restrict d,
+	const pgm_gf8_t		  b,
+	const pgm_gf8_t* restrict s,
+	uint16_t		  len
+	)
+{
+	pgm_gf8_t lo[16], hi[16];
+	__m128i tlo, thi, mask;
+	uint_fast16_t i = 0;
+
+	if (PGM_UNLIKELY(b == 0))
+		return;
+
+	_pgm_gf_nibble_tables (b, lo, hi);
+	tlo  = _mm_loadu_si128 ((const __m128i*)lo);
+	thi  = _mm_loadu_si128 ((const __m128i*)hi);
+	mask = _mm_set1_epi8 (0x0f);
+
+	for (; (i + 16) <= len; i += 16) {
+		const __m128i x  = _mm_loadu_si128 ((const __m128i*)&s[i]);
+		const __m128i pl = _mm_shuffle_epi8 (tlo, _mm_and_si128 (x, mask));
+		const __m128i ph = _mm_shuffle_epi8 (thi, _mm_and_si128 (_mm_srli_epi64 (x, 4), mask));
+		const __m128i y  = _mm_loadu_si128 ((const __m128i*)&d[i]);
+		_mm_storeu_si128 ((__m128i*)&d[i], _mm_xor_si128 (y, _mm_xor_si128 (pl, ph)));
+	}
+
+	if (i < len)
+		_pgm_gf_vec_addmul_generic (&d[i], b, &s[i], (uint16_t)(len - i));
+}
+
+/* 32 bytes per iteration with AVX2 vpshufb, the shuffle operates within
+ * each 128-bit lane so the tables are duplicated across both.
+ */
+
+static
+__attribute__((__target__("avx2")))
+void
+_pgm_gf_vec_addmul_avx2 (
+	pgm_gf8_t*	 restrict d,
+	const pgm_gf8_t		  b,
+	const pgm_gf8_t* restrict s,
+	uint16_t		  len
+	)
+{
+	pgm_gf8_t lo[16], hi[16];
+	__m256i tlo, thi, mask;
+	uint_fast16_t i = 0;
+
+	if (PGM_UNLIKELY(b == 0))
+		return;
+
+	_pgm_gf_nibble_tables (b, lo, hi);
+	tlo  = _mm256_broadcastsi128_si256 (_mm_loadu_si128 ((const __m128i*)lo));
+	thi  = _mm256_broadcastsi128_si256 (_mm_loadu_si128 ((const __m128i*)hi));
+	mask = _mm256_set1_epi8 (0x0f);
+
+	for (; (i + 32) <= len; i += 32) {
+		const __m256i x  = _mm256_loadu_si256 ((const __m256i*)&s[i]);
+		const __m256i pl = _mm256_shuffle_epi8 (tlo, _mm256_and_si256 (x, mask));
+		const __m256i ph = _mm256_shuffle_epi8 (thi, _mm256_and_si256 (_mm256_srli_epi64 (x, 4), mask));
+		const __m256i y  = _mm256_loadu_si256 ((const __m256i*)&d[i]);
+		_mm256_storeu_si256 ((__m256i*)&d[i], _mm256_xor_si256 (y, _mm256_xor_si256 (pl, ph)));
+	}
+
+	if (i < len)
+		_pgm_gf_vec_addmul_generic (&d[i], b, &s[i], (uint16_t)(len - i));
+}
+#endif /* USE_GALOIS_VEC_X86 */
+
+#ifdef USE_GALOIS_VEC_NEON
+/* 16 bytes per iteration with AArch64 tbl.
+ */
+
+static
+void
+_pgm_gf_vec_addmul_neon (
+	pgm_gf8_t*	 restrict d,
+	const pgm_gf8_t		  b,
+	const pgm_gf8_t* restrict s,
+	uint16_t		  len
+	)
+{
+	pgm_gf8_t lo[16], hi[16];
+	uint8x16_t tlo, thi, mask;
+	uint_fast16_t i = 0;
+
+	if (PGM_UNLIKELY(b == 0))
+		return;
+
+	_pgm_gf_nibble_tables (b, lo, hi);
+	tlo  = vld1q_u8 (lo);
+	thi  = vld1q_u8 (hi);
+	mask = vdupq_n_u8 (0x0f);
+
+	for (; (i + 16) <= len; i += 16) {
+		const uint8x16_t x  = vld1q_u8 (&s[i]);
+		const uint8x16_t pl = vqtbl1q_u8 (tlo, vandq_u8 (x, mask));
+		const uint8x16_t ph = vqtbl1q_u8 (thi, vshrq_n_u8 (x, 4));
+		vst1q_u8 (&d[i], veorq_u8 (vld1q_u8 (&d[i]), veorq_u8 (pl, ph)));
+	}
+
+	if (i < len)
+		_pgm_gf_vec_addmul_generic (&d[i], b, &s[i], (uint16_t)(len - i));
+}
+#endif /* USE_GALOIS_VEC_NEON */
+
+/* pick the widest kernel supported by the processor and forward the first
+ * call.
+ */
+
+static
+void
+_pgm_gf_vec_addmul_select (
+	pgm_gf8_t*	 restrict d,
+	const pgm_gf8_t		  b,
+	const pgm_gf8_t* restrict s,
+	uint16_t		  len
+	)
+{
+#if defined( USE_GALOIS_VEC_X86 )
+	__builtin_cpu_init ();
+	if (__builtin_cpu_supports ("avx2")) {
+		pgm_trace (PGM_LOG_ROLE_FEC,_("Using AVX2 Galois field multiplication."));
+		_pgm_gf_vec_addmul = _pgm_gf_vec_addmul_avx2;
+	} else if (__builtin_cpu_supports ("ssse3")) {
+		pgm_trace (PGM_LOG_ROLE_FEC,_("Using SSSE3 Galois field multiplication."));
+		_pgm_gf_vec_addmul = _pgm_gf_vec_addmul_ssse3;
+	} else
+		_pgm_gf_vec_addmul = _pgm_gf_vec_addmul_generic;
+#elif defined( USE_GALOIS_VEC_NEON )
+	pgm_trace (PGM_LOG_ROLE_FEC,_("Using NEON Galois field multiplication."));
+	_pgm_gf_vec_addmul = _pgm_gf_vec_addmul_neon;
+#else
+	_pgm_gf_vec_addmul = _pgm_gf_vec_addmul_generic;
+#endif
+	_pgm_gf_vec_addmul (d, b, s, len);
+}
+
 /* Basic matrix multiplication.
  *
  * C = AB
@@ -355,6 +543,8 @@ pgm_rs_create (
 	rs->k	= k;
 	rs->GM	= pgm_new0 (pgm_gf8_t, n * k);
 	rs->RM	= pgm_new0 (pgm_gf8_t, k * k);
+	rs->plan_clock = rs->plan_hits = rs->plan_misses = 0;
+	memset (rs->plans, 0, sizeof(rs->plans));
 
 /* alpha = root of primitive polynomial of degree m
  *                 ( 1 + x² + x³ + x⁴ + x⁸ )
@@ -421,6 +611,20 @@ pgm_rs_destroy (
 {
 	pgm_assert (NULL != rs);
 
+	for (uint_fast8_t i = 0; i < PGM_RS_DECODE_PLANS; i++)
+	{
+		struct pgm_rs_plan_t* plan = &rs->plans[ i ];
+		if (plan->offsets) {
+			pgm_free (plan->offsets);
+			plan->offsets = NULL;
+		}
+		if (plan->rows) {
+			pgm_free (plan->rows);
+			plan->rows = NULL;
+		}
+		plan->last_used = 0;
+	}
+
 	if (rs->RM) {
 		pgm_free (rs->RM);
 		rs->RM = NULL;
@@ -460,23 +664,81 @@ pgm_rs_encode (
 	}
 }
 
-/* original data block of packets with missing packet entries replaced
- * with on-demand parity packets.
+/* add the contribution of original packet i to a parity packet, encoding
+ * a transmission group one packet at a time.  dst must start zeroed, after
+ * folding all k originals it equals the output of pgm_rs_encode.
  */
 
 PGM_GNUC_INTERNAL
 void
-pgm_rs_decode_parity_inline (
-	pgm_rs_t*      restrict rs,
-	pgm_gf8_t**    restrict block,		/* length rs_t::k */
-	const uint8_t* restrict	offsets,	/* offsets within FEC block, 0 < offset < n */
-	const uint16_t	        len		/* packet length */
+pgm_rs_encode_fold (
+	pgm_rs_t*	  restrict rs,
+	const pgm_gf8_t*  restrict src,
+	const uint8_t		   i,		/* original packet index */
+	const uint8_t		   offset,
+	pgm_gf8_t*	  restrict dst,
+	const uint16_t		   len
 	)
 {
 	pgm_assert (NULL != rs);
-	pgm_assert (NULL != block);
-	pgm_assert (NULL != offsets);
-	pgm_assert (len > 0);
+	pgm_assert (NULL != src);
+	pgm_assert (i < rs->k);
+	pgm_assert (offset >= rs->k && offset < rs->n);	/* parity packet */
+	pgm_assert (NULL != dst);
+
+	_pgm_gf_vec_addmul (dst, rs->GM[ (offset * rs->k) + i ], src, len);
+}
+
+/* recovery matrix for an erasure pattern, only the rows of erased packets
+ * are needed to multiply out so only those are kept, in offset order.
+ *
+ * Inversion is O(k³) and random loss repeats the same few patterns, so the
+ * inverted rows are cached against offsets[] with least recently used
+ * replacement.  Consecutive transmission groups with the same losses, and the
+ * payload and fragment option passes over one group, share a single plan.
+ */
+
+static
+const pgm_gf8_t*
+_pgm_rs_decode_plan (
+	pgm_rs_t*      restrict rs,
+	const uint8_t* restrict offsets		/* length rs_t::k */
+	)
+{
+	struct pgm_rs_plan_t* victim = &rs->plans[ 0 ];
+	uint32_t hash = 2166136261u;		/* FNV-1a */
+	uint8_t row_count = 0;
+
+	for (uint_fast8_t i = 0; i < rs->k; i++) {
+		hash = (hash ^ offsets[ i ]) * 16777619u;
+		if (offsets[ i ] >= rs->k)
+			row_count++;
+	}
+
+	if (PGM_UNLIKELY(0 == ++rs->plan_clock)) {
+/* clock wrapped, restart ages leaving every valid plan at 1 */
+		for (uint_fast8_t i = 0; i < PGM_RS_DECODE_PLANS; i++)
+			if (rs->plans[ i ].last_used)
+				rs->plans[ i ].last_used = 1;
+		rs->plan_clock = 2;
+	}
+
+	for (uint_fast8_t i = 0; i < PGM_RS_DECODE_PLANS; i++)
+	{
+		struct pgm_rs_plan_t* plan = &rs->plans[ i ];
+		if (plan->last_used &&
+		    plan->hash == hash &&
+		    0 == memcmp (plan->offsets, offsets, rs->k))
+		{
+			plan->last_used = rs->plan_clock;
+			rs->plan_hits++;
+			return plan->rows;
+		}
+		if (plan->last_used < victim->last_used)
+			victim = plan;
+	}
+
+	rs->plan_misses++;
 
 /* create new recovery matrix from generator
  */
@@ -493,6 +755,49 @@ pgm_rs_decode_parity_inline (
 /* invert */
 	_pgm_matinv (rs->RM, rs->k);
 
+/* replace least recently used plan */
+	if (NULL == victim->offsets)
+		victim->offsets = pgm_new (uint8_t, rs->k);
+	if (row_count > victim->row_capacity) {
+		victim->rows = pgm_realloc (victim->rows, row_count * rs->k * sizeof(pgm_gf8_t));
+		victim->row_capacity = row_count;
+	}
+	memcpy (victim->offsets, offsets, rs->k);
+	victim->hash      = hash;
+	victim->row_count = row_count;
+	victim->last_used = rs->plan_clock;
+
+	pgm_gf8_t* dst = victim->rows;
+	for (uint_fast8_t j = 0; j < rs->k; j++)
+	{
+		if (offsets[ j ] < rs->k)
+			continue;
+		memcpy (dst, &rs->RM[ j * rs->k ], rs->k * sizeof(pgm_gf8_t));
+		dst += rs->k;
+	}
+	return victim->rows;
+}
+
+/* original data block of packets with missing packet entries replaced
+ * with on-demand parity packets.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_rs_decode_parity_inline (
+	pgm_rs_t*      restrict rs,
+	pgm_gf8_t**    restrict block,		/* length rs_t::k */
+	const uint8_t* restrict	offsets,	/* offsets within FEC block, 0 < offset < n */
+	const uint16_t	        len		/* packet length */
+	)
+{
+	pgm_assert (NULL != rs);
+	pgm_assert (NULL != block);
+	pgm_assert (NULL != offsets);
+	pgm_assert (len > 0);
+
+	const pgm_gf8_t* rows = _pgm_rs_decode_plan (rs, offsets);
+
 	pgm_gf8_t* repairs[ rs->k ];
 
 /* multiply out, through the length of erasures[] */
@@ -501,6 +806,9 @@ pgm_rs_decode_parity_inline (
 		if (offsets[ j ] < rs->k)
 			continue;
 
+		const pgm_gf8_t* row = rows;
+		rows += rs->k;
+
 #ifdef USE_MALLOC_MATRIX
 		pgm_gf8_t* erasure = repairs[ j ] = pgm_malloc0 (len);
 #else
@@ -510,7 +818,7 @@ pgm_rs_decode_parity_inline (
 		for (uint_fast8_t i = 0; i < rs->k; i++)
 		{
 			pgm_gf8_t* src = block[ i ];
-			pgm_gf8_t c = rs->RM[ (j * rs->k) + i ];
+			pgm_gf8_t c = row[ i ];
 			_pgm_gf_vec_addmul (erasure, c, src, len);
 		}
 	}
@@ -547,20 +855,7 @@ pgm_rs_decode_parity_appended (
 	pgm_assert (NULL != offsets);
 	pgm_assert (len > 0);
 
-/* create new recovery matrix from generator
- */
-	for (uint_fast8_t i = 0; i < rs->k; i++)
-	{
-		if (offsets[i] < rs->k) {
-			memset (&rs->RM[ i * rs->k ], 0, rs->k * sizeof(pgm_gf8_t));
-			rs->RM[ (i * rs->k) + i ] = 1;
-			continue;
-		}
-		memcpy (&rs->RM[ i * rs->k ], &rs->GM[ offsets[ i ] * rs->k ], rs->k * sizeof(pgm_gf8_t));
-	}
-
-/* invert */
-	_pgm_matinv (rs->RM, rs->k);
+	const pgm_gf8_t* rows = _pgm_rs_decode_plan (rs, offsets);
 
 /* multiply out, through the length of erasures[] */
 	for (uint_fast8_t j = 0; j < rs->k; j++)
@@ -568,6 +863,9 @@ pgm_rs_decode_parity_appended (
 		if (offsets[ j ] < rs->k)
 			continue;
 
+		const pgm_gf8_t* row = rows;
+		rows += rs->k;
+
 		uint_fast8_t p = rs->k;
 		pgm_gf8_t* erasure = block[ j ];
 		for (uint_fast8_t i = 0; i < rs->k; i++)
@@ -577,7 +875,7 @@ pgm_rs_decode_parity_appended (
 				src = block[ i ];
 			else
 				src = block[ p++ ];
-			const pgm_gf8_t c = rs->RM[ (j * rs->k) + i ];
+			const pgm_gf8_t c = row[ i ];
 			_pgm_gf_vec_addmul (erasure, c, src, len);
 		}
 	}
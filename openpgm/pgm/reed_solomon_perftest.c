@@ -0,0 +1,258 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * performance tests for Reed-Solomon decoding under random loss
+ *
+ * Copyright (c) 2010-2011 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <check.h>
+
+
+/* mock state */
+
+#define PERF_RS_K		64
+#define PERF_TPDU_LENGTH	1500
+#define PERF_GROUPS		20000
+
+static unsigned perf_loss	= 0;	/* per thousand original packets */
+
+
+static
+void
+mock_setup_1 (void)
+{
+	perf_loss	= 1;
+}
+
+static
+void
+mock_setup_10 (void)
+{
+	perf_loss	= 10;
+}
+
+static
+void
+mock_setup_50 (void)
+{
+	perf_loss	= 50;
+}
+
+static
+void
+mock_setup_100 (void)
+{
+	perf_loss	= 100;
+}
+
+/* mock functions for external references */
+
+size_t
+pgm_transport_pkt_offset2 (
+        const bool                      can_fragment,
+        const bool                      use_pgmcc
+        )
+{
+	return 0;
+}
+
+#define REED_SOLOMON_DEBUG
+#include "reed_solomon.c"
+
+static
+void
+mock_setup (void)
+{
+	g_assert (pgm_time_init (NULL));
+}
+
+static
+void
+mock_teardown (void)
+{
+	g_assert (pgm_time_shutdown ());
+}
+
+/* erasure offsets for each repaired transmission group, lost originals are
+ * independent and replaced by parity packets in sequence as a receiver
+ * would, groups without loss are skipped.
+ */
+
+static
+guint8*
+generate_patterns (
+	const unsigned	loss,
+	unsigned*	count
+	)
+{
+	guint8* offsets = g_new (guint8, PERF_GROUPS * PERF_RS_K);
+	unsigned groups = 0;
+	for (unsigned i = 0, j = 0; i < PERF_GROUPS; i++) {
+		guint8* group = &offsets[ groups * PERF_RS_K ];
+		unsigned h = PERF_RS_K;
+		for (unsigned k = 0; k < PERF_RS_K; k++) {
+			j = j * 1103515245 + 12345;
+			group[k] = (((j >> 8) % 1000) < loss) ? h++ : k;
+		}
+		if (h > PERF_RS_K)
+			groups++;
+	}
+	*count = groups;
+	return offsets;
+}
+
+/* forget every plan so each group pays for a full inversion.
+ */
+
+static
+void
+flush_plans (
+	pgm_rs_t*	rs
+	)
+{
+	for (unsigned i = 0; i < PGM_RS_DECODE_PLANS; i++)
+		rs->plans[i].last_used = 0;
+}
+
+static
+void
+decode_patterns (
+	const bool	use_plans
+	)
+{
+	unsigned groups;
+	guint8* offsets = generate_patterns (perf_loss, &groups);
+	pgm_gf8_t* block[ PGM_RS_DEFAULT_N ];
+	pgm_rs_t rs;
+	pgm_rs_create (&rs, PGM_RS_DEFAULT_N, PERF_RS_K);
+	for (unsigned i = 0; i < PGM_RS_DEFAULT_N; i++) {
+		block[i] = g_malloc0 (PERF_TPDU_LENGTH);
+		memset (block[i], i, PERF_TPDU_LENGTH);
+	}
+
+	pgm_time_t start, check;
+
+	start = pgm_time_update_now();
+	for (unsigned i = 0; i < groups; i++) {
+		if (!use_plans)
+			flush_plans (&rs);
+		pgm_rs_decode_parity_appended (&rs, block, &offsets[ i * PERF_RS_K ], PERF_TPDU_LENGTH);
+	}
+
+	check = pgm_time_update_now();
+	g_message ("%s/%u.%u%%: %u groups, elapsed time %" PGM_TIME_FORMAT " us, unit time %.1f us, plan hits %u misses %u",
+		use_plans ? "cached" : "uncached",
+		perf_loss / 10, perf_loss % 10,
+		groups,
+		(guint64)(check - start),
+		groups ? (double)(check - start) / groups : 0.0,
+		rs.plan_hits, rs.plan_misses);
+
+	pgm_rs_destroy (&rs);
+	for (unsigned i = 0; i < PGM_RS_DEFAULT_N; i++)
+		g_free (block[i]);
+	g_free (offsets);
+}
+
+/* target:
+ *	void
+ *	pgm_rs_decode_parity_appended (
+ *		pgm_rs_t*		rs,
+ *		pgm_gf8_t**		block,
+ *		const uint8_t*		offsets,
+ *		const uint16_t		len
+ *	)
+ */
+
+START_TEST (test_uncached)
+{
+	decode_patterns (FALSE);
+}
+END_TEST
+
+START_TEST (test_cached)
+{
+	decode_patterns (TRUE);
+}
+END_TEST
+
+
+static
+Suite*
+make_decode_performance_suite (void)
+{
+	Suite* s;
+
+	s = suite_create ("Reed-Solomon decode performance");
+
+	TCase* tc_1 = tcase_create ("0.1%");
+	suite_add_tcase (s, tc_1);
+	tcase_add_checked_fixture (tc_1, mock_setup, mock_teardown);
+	tcase_add_checked_fixture (tc_1, mock_setup_1, NULL);
+	tcase_add_test (tc_1, test_uncached);
+	tcase_add_test (tc_1, test_cached);
+
+	TCase* tc_10 = tcase_create ("1%");
+	suite_add_tcase (s, tc_10);
+	tcase_add_checked_fixture (tc_10, mock_setup, mock_teardown);
+	tcase_add_checked_fixture (tc_10, mock_setup_10, NULL);
+	tcase_add_test (tc_10, test_uncached);
+	tcase_add_test (tc_10, test_cached);
+
+	TCase* tc_50 = tcase_create ("5%");
+	suite_add_tcase (s, tc_50);
+	tcase_add_checked_fixture (tc_50, mock_setup, mock_teardown);
+	tcase_add_checked_fixture (tc_50, mock_setup_50, NULL);
+	tcase_add_test (tc_50, test_uncached);
+	tcase_add_test (tc_50, test_cached);
+
+	TCase* tc_100 = tcase_create ("10%");
+	suite_add_tcase (s, tc_100);
+	tcase_add_checked_fixture (tc_100, mock_setup, mock_teardown);
+	tcase_add_checked_fixture (tc_100, mock_setup_100, NULL);
+	tcase_add_test (tc_100, test_uncached);
+	tcase_add_test (tc_100, test_cached);
+
+	return s;
+}
+
+static
+Suite*
+make_master_suite (void)
+{
+	Suite* s = suite_create ("Master");
+	return s;
+}
+
+int
+main (void)
+{
+	SRunner* sr = srunner_create (make_master_suite ());
+	srunner_add_suite (sr, make_decode_performance_suite ());
+	srunner_run_all (sr, CK_ENV);
+	int number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* eof */
@@ -141,6 +141,49 @@ START_TEST (test_encode_fail_001)
 }
 END_TEST
 
+/* target:
+ *	void
+ *	pgm_rs_encode_fold (
+ *		pgm_rs_t*		rs,
+ *		const pgm_gf8_t*	src,
+ *		const uint8_t		i,
+ *		const uint8_t		offset,
+ *		pgm_gf8_t*		dst,
+ *		const uint16_t		len
+ *	)
+ */
+
+START_TEST (test_encode_fold_pass_001)
+{
+	pgm_rs_t rs;
+	const guint8 k = 8;
+	const guint16 packet_len = 100;
+	pgm_gf8_t* source_packets[k];
+	pgm_gf8_t parity_packet[packet_len], folded_packet[packet_len];
+	pgm_rs_create (&rs, 255, k);
+	for (unsigned i = 0; i < k; i++) {
+		source_packets[i] = g_malloc (packet_len);
+		for (unsigned j = 0; j < packet_len; j++)
+			source_packets[i][j] = (pgm_gf8_t)(i * 37 + j);
+	}
+	for (unsigned h = 0; h < 4; h++) {
+		pgm_rs_encode (&rs, (const pgm_gf8_t**)source_packets, k + h, parity_packet, packet_len);
+		memset (folded_packet, 0, packet_len);
+		for (unsigned i = 0; i < k; i++)
+			pgm_rs_encode_fold (&rs, source_packets[i], i, k + h, folded_packet, packet_len);
+		fail_unless (0 == memcmp (parity_packet, folded_packet, packet_len), "parity #%u mismatch", h);
+	}
+	pgm_rs_destroy (&rs);
+}
+END_TEST
+
+START_TEST (test_encode_fold_fail_001)
+{
+	pgm_rs_encode_fold (NULL, NULL, 0, 0, NULL, 0);
+	fail ("reached");
+}
+END_TEST
+
 /* target:
  *	void
  *	pgm_rs_decode_parity_inline (
@@ -256,6 +299,117 @@ START_TEST (test_decode_parity_appended_fail_001)
 }
 END_TEST
 
+/* repeated erasure patterns reuse the cached recovery matrix, every decode
+ * must still reproduce the original packets.
+ */
+
+START_TEST (test_decode_parity_appended_pass_002)
+{
+	pgm_rs_t rs;
+	const guint8 k = 8;
+	const guint16 packet_len = 64;
+	const guint erasures[][2] = { { 1, 5 }, { 1, 5 }, { 2, 7 }, { 1, 5 }, { 2, 7 } };
+	pgm_gf8_t original[k][packet_len];
+	pgm_gf8_t* block[k+2];
+	guint8 offsets[k];
+	pgm_rs_create (&rs, 255, k);
+	for (unsigned i = 0; i < k; i++)
+		for (unsigned j = 0; j < packet_len; j++)
+			original[i][j] = (pgm_gf8_t)(i * 37 + j * 11);
+	for (unsigned i = 0; i < k + 2; i++)
+		block[i] = g_malloc0 (packet_len);
+	for (unsigned t = 0; t < G_N_ELEMENTS(erasures); t++) {
+		for (unsigned i = 0; i < k; i++) {
+			memcpy (block[i], original[i], packet_len);
+			offsets[i] = i;
+		}
+		pgm_rs_encode (&rs, (const pgm_gf8_t**)block, k, block[k], packet_len);
+		pgm_rs_encode (&rs, (const pgm_gf8_t**)block, k + 1, block[k+1], packet_len);
+		for (unsigned e = 0; e < 2; e++) {
+			memset (block[ erasures[t][e] ], 0, packet_len);
+			offsets[ erasures[t][e] ] = k + e;
+		}
+		pgm_rs_decode_parity_appended (&rs, block, offsets, packet_len);
+		for (unsigned i = 0; i < k; i++)
+			fail_unless (0 == memcmp (block[i], original[i], packet_len), "pattern %u packet %u mismatch", t, i);
+	}
+	fail_unless (2 == rs.plan_misses, "plan_misses %u", rs.plan_misses);
+	fail_unless (3 == rs.plan_hits, "plan_hits %u", rs.plan_hits);
+	pgm_rs_destroy (&rs);
+	for (unsigned i = 0; i < k + 2; i++)
+		g_free (block[i]);
+}
+END_TEST
+
+/* more distinct patterns than plans evicts the least recently used.
+ */
+
+START_TEST (test_decode_parity_appended_pass_003)
+{
+	pgm_rs_t rs;
+	const guint8 k = PGM_RS_DECODE_PLANS + 1;
+	const guint16 packet_len = 16;
+	pgm_gf8_t* block[k+1];
+	guint8 offsets[k];
+	pgm_rs_create (&rs, 255, k);
+	for (unsigned i = 0; i < k + 1; i++)
+		block[i] = g_malloc0 (packet_len);
+	for (unsigned pass = 0; pass < 2; pass++) {
+		for (unsigned e = 0; e <= PGM_RS_DECODE_PLANS; e++) {
+			for (unsigned i = 0; i < k; i++) {
+				memset (block[i], i + 1, packet_len);
+				offsets[i] = i;
+			}
+			pgm_rs_encode (&rs, (const pgm_gf8_t**)block, k, block[k], packet_len);
+			memset (block[e], 0, packet_len);
+			offsets[e] = k;
+			pgm_rs_decode_parity_appended (&rs, block, offsets, packet_len);
+			for (unsigned j = 0; j < packet_len; j++)
+				fail_unless ((pgm_gf8_t)(e + 1) == block[e][j], "erasure %u not repaired", e);
+		}
+	}
+/* cycling one more pattern than plans always misses */
+	fail_unless (0 == rs.plan_hits, "plan_hits %u", rs.plan_hits);
+	fail_unless (2 * (PGM_RS_DECODE_PLANS + 1) == rs.plan_misses, "plan_misses %u", rs.plan_misses);
+	pgm_rs_destroy (&rs);
+	for (unsigned i = 0; i < k + 1; i++)
+		g_free (block[i]);
+}
+END_TEST
+
+/* target:
+ *	void
+ *	_pgm_gf_vec_addmul (
+ *		pgm_gf8_t*	 restrict d,
+ *		const pgm_gf8_t		  b,
+ *		const pgm_gf8_t* restrict s,
+ *		uint16_t		  len
+ *	)
+ */
+
+/* runtime selected kernel against scalar reference, lengths span the vector
+ * widths and unaligned tails.
+ */
+
+START_TEST (test_vec_addmul_pass_001)
+{
+	const uint16_t lens[] = { 0, 1, 15, 16, 17, 31, 32, 33, 63, 1500 };
+	pgm_gf8_t s[1500], d[1500], r[1500];
+	for (unsigned b = 0; b < 256; b++) {
+		for (unsigned l = 0; l < G_N_ELEMENTS(lens); l++) {
+			const uint16_t len = lens[l];
+			for (unsigned i = 0; i < len; i++) {
+				s[i] = (pgm_gf8_t)(i * 31 + b);
+				d[i] = r[i] = (pgm_gf8_t)(i * 17 ^ b);
+			}
+			_pgm_gf_vec_addmul (d, (pgm_gf8_t)b, s, len);
+			_pgm_gf_vec_addmul_generic (r, (pgm_gf8_t)b, s, len);
+			fail_unless (0 == memcmp (d, r, len), "b %u len %u mismatch", b, (unsigned)len);
+		}
+	}
+}
+END_TEST
+
 
 static
 Suite*
@@ -286,6 +440,13 @@ make_test_suite (void)
 	tcase_add_test_raise_signal (tc_encode, test_encode_fail_001, SIGABRT);
 #endif
 
+	TCase* tc_encode_fold = tcase_create ("encode-fold");
+	suite_add_tcase (s, tc_encode_fold);
+	tcase_add_test (tc_encode_fold, test_encode_fold_pass_001);
+#ifndef PGM_CHECK_NOFORK
+	tcase_add_test_raise_signal (tc_encode_fold, test_encode_fold_fail_001, SIGABRT);
+#endif
+
 	TCase* tc_decode_parity_inline = tcase_create ("decode-parity-inline");
 	suite_add_tcase (s, tc_decode_parity_inline);
 	tcase_add_test (tc_decode_parity_inline, test_decode_parity_inline_pass_001);
@@ -296,9 +457,15 @@ make_test_suite (void)
 	TCase* tc_decode_parity_appended = tcase_create ("decode-parity-appended");
 	suite_add_tcase (s, tc_decode_parity_appended);
 	tcase_add_test (tc_decode_parity_appended, test_decode_parity_appended_pass_001);
+	tcase_add_test (tc_decode_parity_appended, test_decode_parity_appended_pass_002);
+	tcase_add_test (tc_decode_parity_appended, test_decode_parity_appended_pass_003);
 #ifndef PGM_CHECK_NOFORK
 	tcase_add_test_raise_signal (tc_decode_parity_appended, test_decode_parity_appended_fail_001, SIGABRT);
 #endif
+
+	TCase* tc_vec_addmul = tcase_create ("vec-addmul");
+	suite_add_tcase (s, tc_vec_addmul);
+	tcase_add_test (tc_vec_addmul, test_vec_addmul_pass_001);
 	return s;
 }
 
@@ -76,6 +76,9 @@ static inline void _pgm_rxw_shuffle_parity (pgm_rxw_t*const restrict, struct pgm
 static inline ssize_t _pgm_rxw_incoming_read (pgm_rxw_t*const restrict, struct pgm_msgv_t**restrict, uint32_t);
 static bool _pgm_rxw_is_apdu_complete (pgm_rxw_t*const, const uint32_t);
 static inline ssize_t _pgm_rxw_incoming_read_apdu (pgm_rxw_t*const restrict, struct pgm_msgv_t**restrict);
+static inline bool _pgm_rxw_is_coalesced (const struct pgm_sk_buff_t*const);
+static ssize_t _pgm_rxw_incoming_read_coalesced (pgm_rxw_t*const restrict, struct pgm_msgv_t**restrict, const struct pgm_msgv_t*const, size_t*const restrict);
+static void _pgm_rxw_free_coalesced (pgm_rxw_t*const);
 static inline int _pgm_rxw_recovery_update (pgm_rxw_t*const, const uint32_t, const pgm_time_t);
 static inline int _pgm_rxw_recovery_append (pgm_rxw_t*const, const pgm_time_t, const pgm_time_t);
 
@@ -254,6 +257,7 @@ pgm_rxw_destroy (
 	pgm_debug ("destroy (window:%p)", (const void*)window);
 
 /* contents of window */
+	_pgm_rxw_free_coalesced (window);
 	while (!pgm_rxw_is_empty (window)) {
 		_pgm_rxw_remove_trail (window);
 	}
@@ -331,11 +335,19 @@ pgm_rxw_add (
 	if (PGM_UNLIKELY(skb->sequence - ntohl (skb->pgm_data->data_trail) >= ((UINT32_MAX/2)-1)))
 		return PGM_RXW_BOUNDS;
 
+/* protocol sanity check: packed APDUs of a coalescing source fill one TPDU */
+	if (!(skb->pgm_header->pgm_options & PGM_OPT_PARITY) &&
+	    _pgm_rxw_is_coalesced (skb) &&
+	    (ntohl (skb->of_apdu_len) != skb->len ||
+	     ntohl (skb->of_apdu_first_sqn) != skb->sequence))
+		return PGM_RXW_MALFORMED;
+
 /* verify fragment header for original data, parity packets include a
  * parity fragment header
  */
 	if (!(skb->pgm_header->pgm_options & PGM_OPT_PARITY) &&
-	    skb->pgm_opt_fragment)
+	    skb->pgm_opt_fragment &&
+	    !_pgm_rxw_is_coalesced (skb))
 	{
 /* protocol sanity check: single fragment APDU */
 		if (PGM_UNLIKELY(ntohl (skb->of_apdu_len) == skb->len))
@@ -638,7 +650,7 @@ _pgm_rxw_add_placeholder (
  */
 	window->data_loss = window->ack_c_p + pgm_fp16mul ((pgm_fp16 (1) - window->ack_c_p), window->data_loss);
 
-	skb			= pgm_alloc_skb (window->max_tpdu);
+	skb			= pgm_skb_pool_alloc (window->skb_pool, window->max_tpdu);
 	state			= (pgm_rxw_state_t*)&skb->cb;
 	skb->tstamp		= now;
 	skb->sequence		= window->lead;
@@ -1003,6 +1015,7 @@ _pgm_rxw_insert (
 /* statistics */
 	const uint32_t fill_time = (uint32_t)(new_skb->tstamp - skb->tstamp);
 	PGM_HISTOGRAM_TIMES("Rx.RepairTime", fill_time);
+	pgm_histogram_record (&window->repair_latency, fill_time);
 	PGM_HISTOGRAM_COUNTS("Rx.NakTransmits", state->nak_transmit_count);
 	PGM_HISTOGRAM_COUNTS("Rx.NcfRetries", state->ncf_retry_count);
 	PGM_HISTOGRAM_COUNTS("Rx.DataRetries", state->data_retry_count);
@@ -1145,7 +1158,7 @@ _pgm_rxw_append (
 	if (PGM_UNLIKELY(skb->pgm_opt_fragment &&
 	    _pgm_rxw_is_apdu_lost (window, skb)))
 	{
-		struct pgm_sk_buff_t* lost_skb	= pgm_alloc_skb (window->max_tpdu);
+		struct pgm_sk_buff_t* lost_skb	= pgm_skb_pool_alloc (window->skb_pool, window->max_tpdu);
 		lost_skb->tstamp		= now;
 		lost_skb->sequence		= skb->sequence;
 
@@ -1192,6 +1205,7 @@ pgm_rxw_remove_commit (
 
 	const uint32_t tg_sqn_of_commit_lead = _pgm_rxw_tg_sqn (window, window->commit_lead);
 
+	_pgm_rxw_free_coalesced (window);
 	while (!_pgm_rxw_commit_is_empty (window) &&
 	       tg_sqn_of_commit_lead != _pgm_rxw_tg_sqn (window, window->trail))
 	{
@@ -1305,6 +1319,7 @@ _pgm_rxw_remove_trail (
 	if (window->trail++ == window->commit_lead) {
 /* data-loss */
 		window->commit_lead++;
+		window->coalesce_offset = 0;
 		window->cumulative_losses++;
 		pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Data loss due to pulled trailing edge, fragment count %" PRIu32 "."),window->fragment_count);
 		return 1;
@@ -1360,8 +1375,12 @@ _pgm_rxw_incoming_read (
 		if (_pgm_rxw_is_apdu_complete (window,
 					      skb->pgm_opt_fragment ? ntohl (skb->of_apdu_first_sqn) : skb->sequence))
 		{
-			bytes_read += _pgm_rxw_incoming_read_apdu (window, pmsg);
-			data_read  ++;
+			if (_pgm_rxw_is_coalesced (skb)) {
+				bytes_read += _pgm_rxw_incoming_read_coalesced (window, pmsg, msg_end, &data_read);
+			} else {
+				bytes_read += _pgm_rxw_incoming_read_apdu (window, pmsg);
+				data_read  ++;
+			}
 		}
 		else
 		{
@@ -1458,7 +1477,7 @@ _pgm_rxw_reconstruct (
 		case PGM_PKT_STATE_WAIT_NCF:
 		case PGM_PKT_STATE_WAIT_DATA:
 		case PGM_PKT_STATE_LOST_DATA:
-			skb = pgm_alloc_skb (window->max_tpdu);
+			skb = pgm_skb_pool_alloc (window->skb_pool, window->max_tpdu);
 			pgm_skb_reserve (skb, sizeof(struct pgm_header) + sizeof(struct pgm_data));
 			skb->pgm_header = skb->head;
 			skb->pgm_data = (void*)( skb->pgm_header + 1 );
@@ -1495,7 +1514,7 @@ _pgm_rxw_reconstruct (
 				       offsets,
 				       parity_length);
 
-/* reconstruct opt_fragment option */
+/* reconstruct opt_fragment option, same erasures so the decode plan is reused */
 	if (is_op_encoded)
 		pgm_rs_decode_parity_appended (&window->rs,
 					       tg_opts,
@@ -1547,7 +1566,7 @@ _pgm_rxw_reconstruct (
  * replaced by the recovery calculation.
  *
  * packets with single fragment fragment headers must be normalised as regular
- * packets before calling.
+ * packets before calling, except coalesced TSDUs which keep the header.
  *
  * APDUs exceeding PGM_MAX_FRAGMENTS or PGM_MAX_APDU length will be discarded.
  *
@@ -1709,6 +1728,109 @@ _pgm_rxw_incoming_read_apdu (
 	return contiguous_len;
 }
 
+/* returns TRUE if the TSDU packs length-prefixed APDUs of a PGM_COALESCE source.
+ */
+
+static inline
+bool
+_pgm_rxw_is_coalesced (
+	const struct pgm_sk_buff_t* const skb
+	)
+{
+	return (NULL != skb->pgm_opt_fragment &&
+		(ntohl (skb->of_frag_offset) & PGM_OPT_FRAGMENT_COALESCED));
+}
+
+/* read the APDUs packed into the TSDU at the commit lead, one message each.
+ * each APDU is copied into its own skbuff held by the window until the next
+ * commit removal.  when the message array fills the read resumes from the
+ * same offset on the next call, the TSDU is committed once fully read.
+ * truncated framing ends the TSDU.
+ *
+ * returns count of bytes read, data_read is incremented per APDU.
+ */
+
+static
+ssize_t
+_pgm_rxw_incoming_read_coalesced (
+	pgm_rxw_t*    	       const restrict window,
+	struct pgm_msgv_t**	     restrict pmsg,		/* message array, updated as messages appended */
+	const struct pgm_msgv_t* const	      msg_end,
+	size_t*		       const restrict data_read
+	)
+{
+	struct pgm_sk_buff_t *skb;
+	const char	     *tsdu;
+	ssize_t		      bytes_read = 0;
+
+/* pre-conditions */
+	pgm_assert (NULL != window);
+	pgm_assert (NULL != pmsg);
+	pgm_assert (NULL != data_read);
+
+	pgm_debug ("_pgm_rxw_incoming_read_coalesced (window:%p pmsg:%p msg-end:%p data-read:%p)",
+		(const void*)window, (const void*)pmsg, (const void*)msg_end, (const void*)data_read);
+
+	skb = _pgm_rxw_peek (window, window->commit_lead);
+	pgm_assert (NULL != skb);
+	tsdu = skb->data;
+
+	while (window->coalesce_offset + sizeof(uint16_t) <= skb->len)
+	{
+		struct pgm_sk_buff_t* apdu_skb;
+		uint16_t apdu_len;
+
+		if (*pmsg > msg_end)
+			return bytes_read;
+
+		memcpy (&apdu_len, tsdu + window->coalesce_offset, sizeof(apdu_len));
+		apdu_len = ntohs (apdu_len);
+		if (PGM_UNLIKELY(window->coalesce_offset + sizeof(uint16_t) + apdu_len > skb->len)) {
+			pgm_trace (PGM_LOG_ROLE_RX_WINDOW,_("Truncated APDU in coalesced TSDU."));
+			break;
+		}
+
+		apdu_skb		= pgm_skb_pool_alloc (window->skb_pool, window->max_tpdu);
+		apdu_skb->tstamp	= skb->tstamp;
+		apdu_skb->kernel_tstamp	= skb->kernel_tstamp;
+		apdu_skb->tsi		= skb->tsi;
+		apdu_skb->sequence	= skb->sequence;
+		if (PGM_LIKELY(apdu_len))
+			memcpy (pgm_skb_put (apdu_skb, apdu_len), tsdu + window->coalesce_offset + sizeof(uint16_t), apdu_len);
+		apdu_skb->link_.next	= (pgm_list_t*)window->coalesce_skbs;
+		window->coalesce_skbs	= apdu_skb;
+
+		(*pmsg)->msgv_skb[ 0 ] = apdu_skb;
+		(*pmsg)->msgv_len = 1;
+		(*pmsg)++;
+		window->coalesce_offset += (uint16_t)(sizeof(uint16_t) + apdu_len);
+		bytes_read += apdu_len;
+		(*data_read)++;
+	}
+
+/* whole TSDU consumed */
+	_pgm_rxw_state (window, skb, PGM_PKT_STATE_COMMIT_DATA);
+	window->commit_lead++;
+	window->coalesce_offset = 0;
+	return bytes_read;
+}
+
+/* release APDUs unpacked from coalesced TSDUs by the previous read.
+ */
+
+static
+void
+_pgm_rxw_free_coalesced (
+	pgm_rxw_t* const	window
+	)
+{
+	while (window->coalesce_skbs) {
+		struct pgm_sk_buff_t* skb = window->coalesce_skbs;
+		window->coalesce_skbs = (struct pgm_sk_buff_t*)skb->link_.next;
+		pgm_free_skb (skb);
+	}
+}
+
 /* returns transmission group sequence (TG_SQN) from sequence (SQN).
  */
 
@@ -2114,7 +2236,7 @@ _pgm_rxw_recovery_append (
  */
 	window->data_loss = window->ack_c_p + pgm_fp16mul (pgm_fp16 (1) - window->ack_c_p, window->data_loss);
 
-	skb			= pgm_alloc_skb (window->max_tpdu);
+	skb			= pgm_skb_pool_alloc (window->skb_pool, window->max_tpdu);
 	state			= (pgm_rxw_state_t*)&skb->cb;
 	skb->tstamp		= now;
 	skb->sequence		= window->lead;
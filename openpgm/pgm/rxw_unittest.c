@@ -139,6 +139,49 @@ generate_valid_skb (void)
 	return skb;
 }
 
+/* generate coalesced skb packing APDUs of the given lengths, each preceded by a
+ * 16-bit length, data pointer pointing to PGM payload
+ */
+static
+struct pgm_sk_buff_t*
+generate_coalesced_skb (
+	const guint32		sequence,
+	const guint16*		apdu_lengths,
+	const unsigned		count
+	)
+{
+	const pgm_tsi_t tsi = { { 200, 202, 203, 204, 205, 206 }, 2000 };
+	const guint16 header_length = sizeof(struct pgm_header) + sizeof(struct pgm_data) +
+				      sizeof(struct pgm_opt_length) + sizeof(struct pgm_opt_header) +
+				      sizeof(struct pgm_opt_fragment);
+	struct pgm_sk_buff_t* skb = pgm_alloc_skb (1500);
+	guint16 tsdu_length = 0;
+	memcpy (&skb->tsi, &tsi, sizeof(tsi));
+	skb->sock = (pgm_sock_t*)0x1;
+	skb->tstamp = pgm_time_now;
+/* header */
+	pgm_skb_reserve (skb, header_length);
+	memset (skb->head, 0, header_length);
+	skb->pgm_header = (struct pgm_header*)skb->head;
+	skb->pgm_data   = (struct pgm_data*)(skb->pgm_header + 1);
+	skb->pgm_header->pgm_type = PGM_ODATA;
+	skb->pgm_header->pgm_options = PGM_OPT_PRESENT;
+	skb->pgm_data->data_sqn = g_htonl (sequence);
+	skb->pgm_opt_fragment = (struct pgm_opt_fragment*)((char*)skb->data - sizeof(struct pgm_opt_fragment));
+/* DATA */
+	for (unsigned i = 0; i < count; i++) {
+		const guint16 prefix = g_htons (apdu_lengths[i]);
+		memcpy (pgm_skb_put (skb, sizeof(prefix)), &prefix, sizeof(prefix));
+		memset (pgm_skb_put (skb, apdu_lengths[i]), 'a' + i, apdu_lengths[i]);
+		tsdu_length += sizeof(prefix) + apdu_lengths[i];
+	}
+	skb->pgm_header->pgm_tsdu_length = g_htons (tsdu_length);
+	skb->pgm_opt_fragment->opt_sqn = g_htonl (sequence);
+	skb->pgm_opt_fragment->opt_frag_off = g_htonl (PGM_OPT_FRAGMENT_COALESCED);
+	skb->pgm_opt_fragment->opt_frag_len = g_htonl (tsdu_length);
+	return skb;
+}
+
 /* target:
  *	pgm_rxw_t*
  *	pgm_rxw_create (
@@ -409,6 +452,28 @@ START_TEST (test_add_pass_005)
 }
 END_TEST
 
+/* coalesced TSDU must reference only itself */
+START_TEST (test_add_pass_006)
+{
+	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+	const uint32_t ack_c_p = 500;
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p);
+	fail_if (NULL == window, "create failed");
+	const guint16 apdu_lengths[] = { 10, 20 };
+	struct pgm_sk_buff_t* skb = generate_coalesced_skb (1, apdu_lengths, G_N_ELEMENTS(apdu_lengths));
+	skb->pgm_opt_fragment->opt_sqn = g_htonl (0);
+	const pgm_time_t now = 1;
+	const pgm_time_t nak_rb_expiry = 2;
+	fail_unless (PGM_RXW_MALFORMED == pgm_rxw_add (window, skb, now, nak_rb_expiry), "add not malformed");
+	pgm_free_skb (skb);
+	skb = generate_coalesced_skb (1, apdu_lengths, G_N_ELEMENTS(apdu_lengths));
+	skb->pgm_opt_fragment->opt_frag_len = g_htonl (100);
+	fail_unless (PGM_RXW_MALFORMED == pgm_rxw_add (window, skb, now, nak_rb_expiry), "add not malformed");
+	pgm_free_skb (skb);
+	pgm_rxw_destroy (window);
+}
+END_TEST
+
 /* null skb */
 START_TEST (test_add_fail_001)
 {
@@ -1507,6 +1572,7 @@ make_basic_test_suite (void)
 	tcase_add_test (tc_add, test_add_pass_003);
 	tcase_add_test (tc_add, test_add_pass_004);
 	tcase_add_test (tc_add, test_add_pass_005);
+	tcase_add_test (tc_add, test_add_pass_006);
 #ifndef PGM_CHECK_NOFORK
 	tcase_add_test_raise_signal (tc_add, test_add_fail_001, SIGABRT);
 	tcase_add_test_raise_signal (tc_add, test_add_fail_002, SIGABRT);
@@ -1846,6 +1912,55 @@ START_TEST (test_readv_pass_009)
 }
 END_TEST
 
+/* coalesced TSDU unpacked into one message per APDU, resuming when the
+ * message array fills.
+ */
+START_TEST (test_readv_pass_010)
+{
+	pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+	const uint32_t ack_c_p = 500;
+	pgm_rxw_t* window = pgm_rxw_create (&tsi, 1500, 100, 0, 0, ack_c_p);
+	fail_if (NULL == window, "create failed");
+	struct pgm_msgv_t msgv[2], *pmsg;
+	const guint16 apdu_lengths[] = { 10, 0, 300 };
+	struct pgm_sk_buff_t* skb = generate_coalesced_skb (0, apdu_lengths, G_N_ELEMENTS(apdu_lengths));
+	const pgm_time_t now = 1;
+	const pgm_time_t nak_rb_expiry = 2;
+	fail_unless (PGM_RXW_APPENDED == pgm_rxw_add (window, skb, now, nak_rb_expiry), "add not appended");
+	fail_unless (NULL != skb->pgm_opt_fragment, "coalesced header normalised");
+	pmsg = msgv;
+	fail_unless (10 == pgm_rxw_readv (window, &pmsg, G_N_ELEMENTS(msgv)), "readv failed");
+	fail_unless (&msgv[2] == pmsg, "msgv not full");
+	fail_unless (1 == msgv[0].msgv_len, "msgv_len failed");
+	fail_unless (10 == msgv[0].msgv_skb[0]->len, "apdu length failed");
+	fail_unless ('a' == *(char*)msgv[0].msgv_skb[0]->data, "apdu data failed");
+	fail_unless (0 == msgv[1].msgv_skb[0]->len, "apdu length failed");
+	fail_unless (_pgm_rxw_commit_is_empty (window), "partial TSDU committed");
+	pgm_rxw_remove_commit (window);
+	pmsg = msgv;
+	fail_unless (300 == pgm_rxw_readv (window, &pmsg, G_N_ELEMENTS(msgv)), "readv failed");
+	fail_unless (&msgv[1] == pmsg, "msgv count failed");
+	fail_unless ('c' == *(char*)msgv[0].msgv_skb[0]->data, "apdu data failed");
+	fail_unless (1 == _pgm_rxw_commit_length (window), "commit_length failed");
+	fail_unless (3 == window->msgs_delivered, "msgs_delivered failed");
+	pmsg = msgv;
+	fail_unless (-1 == pgm_rxw_readv (window, &pmsg, G_N_ELEMENTS(msgv)), "readv failed");
+/* truncated framing of the last APDU ends the TSDU */
+	skb = generate_coalesced_skb (1, apdu_lengths, G_N_ELEMENTS(apdu_lengths));
+	*(guint16*)((char*)skb->data + 2 + 10 + 2) = g_htons (1000);
+	fail_unless (PGM_RXW_APPENDED == pgm_rxw_add (window, skb, now, nak_rb_expiry), "add not appended");
+	pmsg = msgv;
+	fail_unless (10 == pgm_rxw_readv (window, &pmsg, G_N_ELEMENTS(msgv)), "readv failed");
+	fail_unless (&msgv[2] == pmsg, "msgv count failed");
+	pgm_rxw_remove_commit (window);
+	pmsg = msgv;
+	fail_unless (-1 == pgm_rxw_readv (window, &pmsg, G_N_ELEMENTS(msgv)), "readv failed");
+	fail_unless (msgv == pmsg, "msgv count failed");
+	fail_unless (1 == _pgm_rxw_commit_length (window), "commit_length failed");
+	pgm_rxw_destroy (window);
+}
+END_TEST
+
 /* a.k.a. unreliable delivery
  */
 
@@ -1862,6 +1977,7 @@ make_best_effort_test_suite (void)
 	tcase_add_test (tc_readv, test_readv_pass_007);
 	tcase_add_test (tc_readv, test_readv_pass_008);
 	tcase_add_test (tc_readv, test_readv_pass_009);
+	tcase_add_test (tc_readv, test_readv_pass_010);
 
 	return s;
 }
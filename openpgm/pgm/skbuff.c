@@ -48,6 +48,144 @@ pgm_skb_under_panic (
 	pgm_assert_not_reached();
 }
 
+/* create a buffer pool for size class tpdu_size caching at most max_free
+ * released buffers.
+ */
+
+PGM_GNUC_INTERNAL
+pgm_skb_pool_t*
+pgm_skb_pool_create (
+	const uint16_t		tpdu_size,
+	const unsigned		max_free
+	)
+{
+	pgm_skb_pool_t* pool;
+
+	pool = pgm_new0 (pgm_skb_pool_t, 1);
+	pool->tpdu_size	= tpdu_size;
+	pool->max_free	= max_free;
+	pgm_spinlock_init (&pool->lock);
+	return pool;
+}
+
+/* release cached buffers, the pool itself survives until the last
+ * outstanding buffer is returned.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_skb_pool_destroy (
+	pgm_skb_pool_t*		pool
+	)
+{
+	struct pgm_sk_buff_t* skb;
+	bool is_idle;
+
+/* pre-conditions */
+	pgm_assert (NULL != pool);
+	pgm_assert (!pool->is_destroyed);
+
+	pgm_spinlock_lock (&pool->lock);
+	skb = pool->free_list;
+	pool->free_list = NULL;
+	pool->free_len = 0;
+	pool->is_destroyed = TRUE;
+	is_idle = (0 == pool->outstanding);
+	pgm_spinlock_unlock (&pool->lock);
+
+	while (NULL != skb) {
+		struct pgm_sk_buff_t* next = (struct pgm_sk_buff_t*)skb->link_.next;
+		pgm_free (skb);
+		skb = next;
+	}
+	if (is_idle) {
+		pgm_spinlock_free (&pool->lock);
+		pgm_free (pool);
+	}
+}
+
+/* allocate a buffer from the pool free-list, falling back to the heap on
+ * an empty list.  sizes other than the pool size class bypass the pool.
+ */
+
+PGM_GNUC_INTERNAL
+struct pgm_sk_buff_t*
+pgm_skb_pool_alloc (
+	pgm_skb_pool_t*		pool,
+	const uint16_t		size
+	)
+{
+	struct pgm_sk_buff_t* skb;
+
+	if (NULL == pool || size != pool->tpdu_size)
+		return pgm_alloc_skb (size);
+
+	pgm_spinlock_lock (&pool->lock);
+	skb = pool->free_list;
+	if (PGM_LIKELY(NULL != skb)) {
+		pool->free_list = (struct pgm_sk_buff_t*)skb->link_.next;
+		pool->free_len--;
+		pool->hits++;
+	} else {
+		pool->misses++;
+	}
+	pool->outstanding++;
+	pgm_spinlock_unlock (&pool->lock);
+
+	if (PGM_UNLIKELY(NULL == skb))
+		skb = (struct pgm_sk_buff_t*)pgm_malloc (size + sizeof(struct pgm_sk_buff_t));
+	if (PGM_UNLIKELY(pgm_mem_gc_friendly)) {
+		memset (skb, 0, size + sizeof(struct pgm_sk_buff_t));
+		skb->zero_padded = 1;
+	} else {
+		memset (skb, 0, sizeof(struct pgm_sk_buff_t));
+	}
+	skb->truesize = size + sizeof(struct pgm_sk_buff_t);
+	pgm_atomic_write32 (&skb->users, 1);
+	skb->head = skb + 1;
+	skb->data = skb->tail = skb->head;
+	skb->end  = (char*)skb->data + size;
+	skb->pool = pool;
+	return skb;
+}
+
+/* return a buffer to its pool on release of the last reference, buffers
+ * beyond the free-list limit are returned to the heap.
+ */
+
+void
+pgm_skb_pool_release (
+	struct pgm_sk_buff_t*const skb
+	)
+{
+	pgm_skb_pool_t* pool;
+	bool is_cached = FALSE, is_last = FALSE;
+
+/* pre-conditions */
+	pgm_assert (NULL != skb);
+	pgm_assert (NULL != skb->pool);
+
+	pool = skb->pool;
+	pgm_spinlock_lock (&pool->lock);
+	pool->outstanding--;
+	if (pool->is_destroyed) {
+		is_last = (0 == pool->outstanding);
+	} else if (pool->free_len < pool->max_free) {
+		skb->link_.next = (pgm_list_t*)pool->free_list;
+		pool->free_list = skb;
+		pool->free_len++;
+		is_cached = TRUE;
+	}
+	pgm_spinlock_unlock (&pool->lock);
+
+	if (!is_cached)
+		pgm_free (skb);
+	if (is_last) {
+		pgm_spinlock_free (&pool->lock);
+		pgm_free (pool);
+	}
+}
+
 #ifndef SKB_DEBUG
 bool
 pgm_skb_is_valid (
@@ -0,0 +1,314 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * unit tests for PGM socket buffer pool.
+ *
+ * Copyright (c) 2011 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <signal.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <glib.h>
+#include <check.h>
+
+#ifdef _WIN32
+#	define PGM_CHECK_NOFORK		1
+#endif
+
+
+/* mock state */
+
+static const void*	mock_last_free = NULL;
+static unsigned		mock_free_count = 0;
+
+#define pgm_free	mock_pgm_free
+
+/* mock functions for external references */
+
+size_t
+pgm_transport_pkt_offset2 (
+        const bool                      can_fragment,
+        const bool                      use_pgmcc
+        )
+{
+        return 0;
+}
+
+#include "skbuff.c"
+
+#undef pgm_free
+void pgm_free (void*);
+
+PGM_GNUC_INTERNAL
+int
+pgm_get_nprocs (void)
+{
+	return 1;
+}
+
+static
+void
+mock_setup (void)
+{
+	mock_last_free = NULL;
+	mock_free_count = 0;
+}
+
+/* record release to the heap for the pool lifetime tests.
+ */
+
+void
+mock_pgm_free (
+	void*		mem
+	)
+{
+	mock_last_free = mem;
+	mock_free_count++;
+	pgm_free (mem);
+}
+
+/* target:
+ *	pgm_skb_pool_t*
+ *	pgm_skb_pool_create (
+ *		const uint16_t		tpdu_size,
+ *		const unsigned		max_free
+ *	)
+ */
+
+START_TEST (test_create_pass_001)
+{
+	pgm_skb_pool_t* pool = pgm_skb_pool_create (1500, 8);
+	fail_if (NULL == pool, "create failed");
+	fail_unless (1500 == pool->tpdu_size, "tpdu_size");
+	fail_unless (8 == pool->max_free, "max_free");
+	fail_unless (NULL == pool->free_list, "free_list");
+	fail_unless (0 == pool->free_len, "free_len");
+	fail_unless (0 == pool->outstanding, "outstanding");
+	fail_unless (0 == pool->hits, "hits");
+	fail_unless (0 == pool->misses, "misses");
+	pgm_skb_pool_destroy (pool);
+}
+END_TEST
+
+/* target:
+ *	struct pgm_sk_buff_t*
+ *	pgm_skb_pool_alloc (
+ *		pgm_skb_pool_t*		pool,
+ *		const uint16_t		size
+ *	)
+ */
+
+/* released buffer is recycled by the next allocation */
+START_TEST (test_alloc_pass_001)
+{
+	pgm_skb_pool_t* pool = pgm_skb_pool_create (1500, 8);
+	struct pgm_sk_buff_t* skb = pgm_skb_pool_alloc (pool, 1500);
+	fail_if (NULL == skb, "alloc failed");
+	fail_unless (pool == skb->pool, "pool");
+	fail_unless (1 == pgm_atomic_read32 (&skb->users), "users");
+	fail_unless (1500 == (char*)skb->end - (char*)skb->head, "size");
+	fail_unless (0 == pool->hits, "hits");
+	fail_unless (1 == pool->misses, "misses");
+	fail_unless (1 == pool->outstanding, "outstanding");
+	pgm_skb_put (skb, 100);
+	pgm_free_skb (skb);
+	fail_unless (0 == mock_free_count, "released to heap");
+	fail_unless (1 == pool->free_len, "free_len");
+	fail_unless (0 == pool->outstanding, "outstanding");
+	struct pgm_sk_buff_t* skb2 = pgm_skb_pool_alloc (pool, 1500);
+	fail_unless (skb == skb2, "not recycled");
+	fail_unless (0 == skb2->len, "len not reset");
+	fail_unless (skb2->data == skb2->head, "data not reset");
+	fail_unless (skb2->tail == skb2->head, "tail not reset");
+	fail_unless (1 == pool->hits, "hits");
+	fail_unless (1 == pool->misses, "misses");
+	fail_unless (0 == pool->free_len, "free_len");
+	fail_unless (1 == pool->outstanding, "outstanding");
+	pgm_free_skb (skb2);
+	pgm_skb_pool_destroy (pool);
+}
+END_TEST
+
+/* other size classes bypass the pool */
+START_TEST (test_alloc_pass_002)
+{
+	pgm_skb_pool_t* pool = pgm_skb_pool_create (1500, 8);
+	struct pgm_sk_buff_t* skb = pgm_skb_pool_alloc (pool, 9000);
+	fail_if (NULL == skb, "alloc failed");
+	fail_unless (NULL == skb->pool, "pool");
+	fail_unless (0 == pool->hits + pool->misses, "pool counters");
+	fail_unless (0 == pool->outstanding, "outstanding");
+	pgm_free_skb (skb);
+	fail_unless (skb == mock_last_free, "not released to heap");
+	fail_unless (0 == pool->free_len, "free_len");
+	skb = pgm_skb_pool_alloc (NULL, 1500);
+	fail_if (NULL == skb, "alloc failed");
+	fail_unless (NULL == skb->pool, "pool");
+	pgm_free_skb (skb);
+	pgm_skb_pool_destroy (pool);
+}
+END_TEST
+
+/* target:
+ *	void
+ *	pgm_skb_pool_release (
+ *		struct pgm_sk_buff_t*const	skb
+ *	)
+ */
+
+/* free-list is capped at max_free */
+START_TEST (test_release_pass_001)
+{
+	pgm_skb_pool_t* pool = pgm_skb_pool_create (1500, 2);
+	struct pgm_sk_buff_t* skb[3];
+	for (unsigned i = 0; i < G_N_ELEMENTS(skb); i++)
+		skb[i] = pgm_skb_pool_alloc (pool, 1500);
+	fail_unless (3 == pool->outstanding, "outstanding");
+	for (unsigned i = 0; i < G_N_ELEMENTS(skb); i++)
+		pgm_free_skb (skb[i]);
+	fail_unless (2 == pool->free_len, "free_len");
+	fail_unless (0 == pool->outstanding, "outstanding");
+	fail_unless (1 == mock_free_count, "heap releases");
+	fail_unless (skb[2] == mock_last_free, "excess buffer cached");
+	pgm_skb_pool_destroy (pool);
+}
+END_TEST
+
+/* shared buffer returns to the pool with the last reference */
+START_TEST (test_release_pass_002)
+{
+	pgm_skb_pool_t* pool = pgm_skb_pool_create (1500, 8);
+	struct pgm_sk_buff_t* skb = pgm_skb_pool_alloc (pool, 1500);
+	pgm_skb_get (skb);
+	pgm_free_skb (skb);
+	fail_unless (0 == pool->free_len, "released with reference");
+	fail_unless (1 == pool->outstanding, "outstanding");
+	pgm_free_skb (skb);
+	fail_unless (1 == pool->free_len, "free_len");
+	fail_unless (0 == pool->outstanding, "outstanding");
+	pgm_skb_pool_destroy (pool);
+}
+END_TEST
+
+/* target:
+ *	void
+ *	pgm_skb_pool_destroy (
+ *		pgm_skb_pool_t*		pool
+ *	)
+ */
+
+/* idle pool is freed immediately with its cached buffers */
+START_TEST (test_destroy_pass_001)
+{
+	pgm_skb_pool_t* pool = pgm_skb_pool_create (1500, 8);
+	struct pgm_sk_buff_t* skb = pgm_skb_pool_alloc (pool, 1500);
+	pgm_free_skb (skb);
+	fail_unless (0 == mock_free_count, "released to heap");
+	pgm_skb_pool_destroy (pool);
+	fail_unless (2 == mock_free_count, "heap releases");
+	fail_unless (pool == mock_last_free, "pool not freed");
+}
+END_TEST
+
+/* outstanding buffers outlive the pool, the last release frees it */
+START_TEST (test_destroy_pass_002)
+{
+	pgm_skb_pool_t* pool = pgm_skb_pool_create (1500, 8);
+	struct pgm_sk_buff_t* skb[3];
+	for (unsigned i = 0; i < G_N_ELEMENTS(skb); i++)
+		skb[i] = pgm_skb_pool_alloc (pool, 1500);
+	pgm_free_skb (skb[0]);
+	pgm_skb_pool_destroy (pool);
+	fail_unless (1 == mock_free_count, "cached buffers not released");
+	fail_unless (skb[0] == mock_last_free, "cached buffer not released");
+/* buffers remain usable after destruction */
+	memset (pgm_skb_put (skb[1], 1500), 0xa5, 1500);
+	fail_unless (1500 == skb[1]->len, "put failed");
+	pgm_free_skb (skb[1]);
+	fail_unless (2 == mock_free_count, "heap releases");
+	fail_unless (skb[1] == mock_last_free, "buffer cached after destroy");
+	pgm_free_skb (skb[2]);
+	fail_unless (4 == mock_free_count, "heap releases");
+	fail_unless (pool == mock_last_free, "pool not freed");
+}
+END_TEST
+
+START_TEST (test_destroy_fail_001)
+{
+	pgm_skb_pool_destroy (NULL);
+	fail ("reached");
+}
+END_TEST
+
+
+static
+Suite*
+make_test_suite (void)
+{
+	Suite* s;
+
+	s = suite_create (__FILE__);
+
+	TCase* tc_create = tcase_create ("create");
+	suite_add_tcase (s, tc_create);
+	tcase_add_checked_fixture (tc_create, mock_setup, NULL);
+	tcase_add_test (tc_create, test_create_pass_001);
+
+	TCase* tc_alloc = tcase_create ("alloc");
+	suite_add_tcase (s, tc_alloc);
+	tcase_add_checked_fixture (tc_alloc, mock_setup, NULL);
+	tcase_add_test (tc_alloc, test_alloc_pass_001);
+	tcase_add_test (tc_alloc, test_alloc_pass_002);
+
+	TCase* tc_release = tcase_create ("release");
+	suite_add_tcase (s, tc_release);
+	tcase_add_checked_fixture (tc_release, mock_setup, NULL);
+	tcase_add_test (tc_release, test_release_pass_001);
+	tcase_add_test (tc_release, test_release_pass_002);
+
+	TCase* tc_destroy = tcase_create ("destroy");
+	suite_add_tcase (s, tc_destroy);
+	tcase_add_checked_fixture (tc_destroy, mock_setup, NULL);
+	tcase_add_test (tc_destroy, test_destroy_pass_001);
+	tcase_add_test (tc_destroy, test_destroy_pass_002);
+#ifndef PGM_CHECK_NOFORK
+	tcase_add_test_raise_signal (tc_destroy, test_destroy_fail_001, SIGABRT);
+#endif
+	return s;
+}
+
+static
+Suite*
+make_master_suite (void)
+{
+	Suite* s = suite_create ("Master");
+	return s;
+}
+
+int
+main (void)
+{
+	SRunner* sr = srunner_create (make_master_suite ());
+	srunner_add_suite (sr, make_test_suite ());
+	srunner_run_all (sr, CK_ENV);
+	int number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* eof */
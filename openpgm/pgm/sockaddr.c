@@ -595,6 +595,34 @@ pgm_sockaddr_tos (
 	return retval;
 }
 
+/* Kernel pacing rate in bytes per second, enforced by the fq queueing
+ * discipline on the egress interface.
+ *
+ * Linux:socket(7) "SO_MAX_PACING_RATE ... Sets the maximum transmit rate in
+ * bytes per second.  The type is an unsigned integer."
+ *
+ * If no error occurs, pgm_sockaddr_max_pacing_rate returns zero.  Otherwise, a
+ * value of SOCKET_ERROR is returned, and a specific error code can be
+ * retrieved by calling pgm_get_last_sock_error().
+ */
+
+PGM_GNUC_INTERNAL
+int
+pgm_sockaddr_max_pacing_rate (
+	const SOCKET		s,
+	const ssize_t		rate_per_sec
+	)
+{
+	int retval = SOCKET_ERROR;
+#ifdef SO_MAX_PACING_RATE
+	const unsigned optval = (unsigned)rate_per_sec;
+	retval = setsockopt (s, SOL_SOCKET, SO_MAX_PACING_RATE, (const char*)&optval, sizeof(optval));
+#else
+	pgm_set_last_sock_error (PGM_SOCK_EINVAL);
+#endif
+	return retval;
+}
+
 /* Join multicast group.
  * NB: IPV6_JOIN_GROUP == IPV6_ADD_MEMBERSHIP
  *
@@ -30,6 +30,9 @@
 #ifdef HAVE_EPOLL_CTL
 #	include <sys/epoll.h>
 #endif
+#if defined( HAVE_UDP_GSO ) || defined( HAVE_UDP_GRO )
+#	include <netinet/udp.h>
+#endif
 #include <stdio.h>
 #include <impl/i18n.h>
 #include <impl/framework.h>
@@ -37,6 +40,8 @@
 #include <impl/receiver.h>
 #include <impl/source.h>
 #include <impl/timer.h>
+#include <impl/filter.h>
+#include <impl/net.h>
 
 
 //#define SOCK_DEBUG
@@ -72,6 +77,92 @@ pgm_pkt_offset (
 	return pkt_size;
 }
 
+/* socket carrying incoming packets, shared between sockets using the
+ * process-wide demultiplexer.
+ */
+
+static inline
+SOCKET
+recv_socket (
+	const pgm_sock_t* const	sock
+	)
+{
+	return sock->demux ? pgm_demux_get_socket (sock->demux) : sock->recv_sock;
+}
+
+/* open the repair socket of a lockless transmit window, replaying the options
+ * already applied to the router alert socket it mirrors so that RDATA never
+ * shares a descriptor with ODATA.
+ *
+ * returns TRUE on success, returns FALSE on error.
+ */
+
+static
+bool
+open_repair_socket (
+	pgm_sock_t*    restrict sock,
+	pgm_error_t**  restrict error
+	)
+{
+	const int socket_type = (IPPROTO_UDP == sock->protocol) ? SOCK_DGRAM : SOCK_RAW;
+	const int sndbuf = (int)sock->sndbuf;
+	const int v = 1;
+
+	pgm_trace (PGM_LOG_ROLE_NETWORK,_("Opening repair send socket."));
+	if ((sock->repair_sock = socket (sock->family,
+					 socket_type,
+					 sock->protocol)) == INVALID_SOCKET)
+	{
+		const int save_errno = pgm_get_last_sock_error();
+		char errbuf[1024];
+		pgm_set_error (error,
+			       PGM_ERROR_DOMAIN_SOCKET,
+			       pgm_error_from_sock_errno (save_errno),
+			       _("Creating repair send socket: %s"),
+			       pgm_sock_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		return FALSE;
+	}
+
+	pgm_sockaddr_nonblocking (sock->repair_sock, sock->is_nonblocking);
+	if ((IPPROTO_UDP == sock->protocol &&
+#ifndef SO_REUSEPORT
+	     SOCKET_ERROR == setsockopt (sock->repair_sock, SOL_SOCKET, SO_REUSEADDR, (const char*)&v, sizeof(v))) ||
+#else
+	     SOCKET_ERROR == setsockopt (sock->repair_sock, SOL_SOCKET, SO_REUSEPORT, (const char*)&v, sizeof(v))) ||
+#endif
+	    (sock->sndbuf > 0 &&
+	     SOCKET_ERROR == setsockopt (sock->repair_sock, SOL_SOCKET, SO_SNDBUF, (const char*)&sndbuf, sizeof(sndbuf))) ||
+	    (sock->use_router_alert &&
+	     SOCKET_ERROR == pgm_sockaddr_router_alert (sock->repair_sock, sock->family, TRUE)) ||
+#if !defined(_WIN32) && !defined(__CYGWIN__)
+	    (sock->use_multicast_loop &&
+	     SOCKET_ERROR == pgm_sockaddr_multicast_loop (sock->repair_sock, sock->family, TRUE)) ||
+#endif
+	    (sock->hops > 0 &&
+	     SOCKET_ERROR == pgm_sockaddr_multicast_hops (sock->repair_sock, sock->family, sock->hops)) ||
+	    (0 != sock->tos &&
+	     SOCKET_ERROR == pgm_sockaddr_tos (sock->repair_sock, sock->family, sock->tos)) ||
+#ifdef HAVE_MSG_ZEROCOPY
+	    (sock->zerocopy_min > 0 &&
+	     SOCKET_ERROR == setsockopt (sock->repair_sock, SOL_SOCKET, SO_ZEROCOPY, (const char*)&v, sizeof(v))) ||
+#endif
+	    (sock->family == sock->send_gsr.gsr_group.ss_family &&
+	     SOCKET_ERROR == pgm_sockaddr_multicast_if (sock->repair_sock,
+							(const struct sockaddr*)&sock->send_addr,
+							sock->send_gsr.gsr_interface)))
+	{
+		const int save_errno = pgm_get_last_sock_error();
+		char errbuf[1024];
+		pgm_set_error (error,
+			       PGM_ERROR_DOMAIN_SOCKET,
+			       pgm_error_from_sock_errno (save_errno),
+			       _("Configuring repair send socket: %s"),
+			       pgm_sock_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		return FALSE;
+	}
+	return TRUE;
+}
+
 #ifdef _MSC_VER
 /* How to Determine Whether a Process or Thread Is Running As an Administrator
  * http://msdn.microsoft.com/en-us/windows/ff420334.aspx
@@ -242,6 +333,9 @@ pgm_close (
 		closesocket (sock->recv_sock);
 		sock->recv_sock = INVALID_SOCKET;
 	}
+/* shared receive socket stays open for other members */
+	if (sock->demux)
+		pgm_notify_send (&sock->pending_notify);
 	if (INVALID_SOCKET != sock->send_sock) {
 		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Closing send socket."));
 		closesocket (sock->send_sock);
@@ -256,6 +350,12 @@ pgm_close (
 	pgm_sock_list = pgm_slist_remove (pgm_sock_list, sock);
 	pgm_rwlock_writer_unlock (&pgm_sock_list_lock);
 
+	if (sock->demux) {
+		pgm_debug ("leaving shared receive socket.");
+		pgm_demux_detach (sock->demux);
+		sock->demux = NULL;
+	}
+
 /* flush source side by sending heartbeat SPMs */
 	if (sock->can_send_data &&
 	    sock->is_connected && 
@@ -270,10 +370,10 @@ pgm_close (
 		}
 	}
 
-	if (sock->peers_hashtable) {
+	if (sock->peers_table) {
 		pgm_debug ("destroying peer lookup table.");
-		pgm_hashtable_destroy (sock->peers_hashtable);
-		sock->peers_hashtable = NULL;
+		pgm_tsitable_destroy (sock->peers_table);
+		sock->peers_table = NULL;
 	}
 	if (sock->peers_list) {
 		pgm_debug ("destroying peer list.");
@@ -284,7 +384,23 @@ pgm_close (
 			sock->peers_list = next;
 		} while (sock->peers_list);
 	}
+	if (sock->peers_heap) {
+		pgm_free (sock->peers_heap);
+		sock->peers_heap = NULL;
+		sock->peers_heap_len = sock->peers_heap_alloc = 0;
+	}
 
+/* held small APDUs are discarded, a blocked flush is already windowed */
+	if (sock->coalesce_skb) {
+		if (!sock->is_apdu_eagain)
+			pgm_free_skb (sock->coalesce_skb);
+		sock->coalesce_skb = NULL;
+	}
+/* an uncommitted claim is released, a blocked commit is already windowed */
+	if (sock->claim_skb) {
+		pgm_free_skb (sock->claim_skb);
+		sock->claim_skb = NULL;
+	}
 	if (sock->window) {
 		pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Destroying transmit window."));
 		pgm_txw_shutdown (sock->window);
@@ -297,6 +413,11 @@ pgm_close (
 		closesocket (sock->send_with_router_alert_sock);
 		sock->send_with_router_alert_sock = INVALID_SOCKET;
 	}
+	if (INVALID_SOCKET != sock->repair_sock) {
+		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Closing repair send socket."));
+		closesocket (sock->repair_sock);
+		sock->repair_sock = INVALID_SOCKET;
+	}
 	if (sock->spm_heartbeat_interval) {
 		pgm_debug ("freeing SPM heartbeat interval data.");
 		pgm_free (sock->spm_heartbeat_interval);
@@ -307,6 +428,27 @@ pgm_close (
 		pgm_free_skb (sock->rx_buffer);
 		sock->rx_buffer = NULL;
 	}
+	if (sock->rx_ring) {
+		pgm_debug ("freeing receive batch.");
+		for (unsigned i = 0; i < sock->recv_batch; i++)
+			pgm_free_skb (sock->rx_ring[i]);
+		pgm_free (sock->rx_ring);
+		pgm_free (sock->rx_ring_addr);
+		sock->rx_ring = NULL;
+		sock->rx_ring_addr = NULL;
+	}
+	if (sock->rx_gro_buffer) {
+		pgm_free (sock->rx_gro_buffer);
+		sock->rx_gro_buffer = NULL;
+	}
+/* descriptors are closed, nothing more will complete */
+	pgm_zerocopy_destroy (&sock->odata_zerocopy);
+	pgm_zerocopy_destroy (&sock->rdata_zerocopy);
+	if (sock->skb_pool) {
+		pgm_debug ("destroying packet buffer pool.");
+		pgm_skb_pool_destroy (sock->skb_pool);
+		sock->skb_pool = NULL;
+	}
 	pgm_debug ("destroying notification channels.");
 	if (sock->can_send_data) {
 		if (sock->use_pgmcc) {
@@ -378,6 +520,9 @@ pgm_socket (
 	new_sock->dport		= DEFAULT_DATA_DESTINATION_PORT;
 	new_sock->tsi.sport	= DEFAULT_DATA_SOURCE_PORT;
 	new_sock->adv_mode	= 0;	/* advance with time */
+	new_sock->send_batch	= 1;	/* one fragment per send call */
+	new_sock->recv_batch	= 1;	/* one datagram per receive call */
+	new_sock->repair_sock	= INVALID_SOCKET;	/* opened at bind */
 
 /* PGMCC */
 	new_sock->acker_nla.ss_family = family;
@@ -600,6 +745,15 @@ err_destroy:
 		}
 		new_sock->send_with_router_alert_sock = INVALID_SOCKET;
 	}
+	if (INVALID_SOCKET != new_sock->repair_sock) {
+		if (SOCKET_ERROR == closesocket (new_sock->repair_sock)) {
+			const int save_errno = pgm_get_last_sock_error();
+			char errbuf[1024];
+			pgm_warn (_("Close on repair send socket failed: %s"),
+				  pgm_sock_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		}
+		new_sock->repair_sock = INVALID_SOCKET;
+	}
 	pgm_free (new_sock);
 	return FALSE;
 }
@@ -638,7 +792,7 @@ pgm_getsockopt (
 
 /* socket receive buffer */
 	case SO_RCVBUF:
-		if (SOCKET_ERROR == getsockopt (sock->recv_sock, SOL_SOCKET, SO_RCVBUF, optval, optlen))
+		if (SOCKET_ERROR == getsockopt (recv_socket (sock), SOL_SOCKET, SO_RCVBUF, optval, optlen))
 			break;
 		status = TRUE;
 		break;
@@ -692,7 +846,7 @@ pgm_getsockopt (
 			break;
 		if (PGM_UNLIKELY(*optlen != sizeof (SOCKET)))
 			break;
-		*(SOCKET*restrict)optval = sock->recv_sock;
+		*(SOCKET*restrict)optval = recv_socket (sock);
 		status = TRUE;
 		break;
 
@@ -737,7 +891,7 @@ pgm_getsockopt (
 			break;
 		{
 			struct timeval* tv = optval;
-			const long usecs = (long)pgm_timer_expiration (sock);
+			const long usecs = (long)pgm_timer_expiration (sock, pgm_time_update_now());
 			tv->tv_sec  = usecs / 1000000L;
 			tv->tv_usec = usecs % 1000000L;
 		}
@@ -759,6 +913,82 @@ pgm_getsockopt (
 		status = TRUE;
 		break;
 
+/* receive batch utilisation */
+	case PGM_RECV_BATCH_STATS:
+		if (PGM_UNLIKELY(!sock->is_connected))
+			break;
+		if (PGM_UNLIKELY(*optlen != sizeof (struct pgm_batchinfo_t)))
+			break;
+		{
+			struct pgm_batchinfo_t* bi = optval;
+			pgm_mutex_lock (&sock->receiver_mutex);
+			bi->bi_calls	 = sock->rx_batch_calls;
+			bi->bi_datagrams = sock->rx_batch_datagrams;
+			bi->bi_discarded = sock->rx_batch_discarded;
+			pgm_mutex_unlock (&sock->receiver_mutex);
+		}
+		status = TRUE;
+		break;
+
+/* packet buffer pool utilisation */
+	case PGM_SKB_POOL_STATS:
+		if (PGM_UNLIKELY(!sock->is_bound))
+			break;
+		if (PGM_UNLIKELY(*optlen != sizeof (struct pgm_poolinfo_t)))
+			break;
+		{
+			struct pgm_poolinfo_t* pi = optval;
+			pgm_spinlock_lock (&sock->skb_pool->lock);
+			pi->pi_hits	   = sock->skb_pool->hits;
+			pi->pi_misses	   = sock->skb_pool->misses;
+			pi->pi_free	   = sock->skb_pool->free_len;
+			pi->pi_outstanding = sock->skb_pool->outstanding;
+			pgm_spinlock_unlock (&sock->skb_pool->lock);
+		}
+		status = TRUE;
+		break;
+
+/* repair, delivery and socket queue latency histograms, merged from the per-peer shards
+ * without stopping the receiver.  a zero li_tsi includes every peer, past
+ * and present.
+ */
+	case PGM_LATENCY_STATS:
+		if (PGM_UNLIKELY(!sock->is_connected || !sock->can_recv_data))
+			break;
+		if (PGM_UNLIKELY(*optlen != sizeof (struct pgm_latencyinfo_t)))
+			break;
+		{
+			struct pgm_latencyinfo_t* li = optval;
+			const pgm_tsi_t tsi = li->li_tsi;
+			const pgm_tsi_t null_tsi = { { { 0 } }, 0 };
+			memset (&li->li_repair, 0, sizeof (li->li_repair));
+			memset (&li->li_delivery, 0, sizeof (li->li_delivery));
+			memset (&li->li_queue, 0, sizeof (li->li_queue));
+			pgm_rwlock_reader_lock (&sock->peers_lock);
+			if (pgm_tsi_equal (&tsi, &null_tsi)) {
+				pgm_histogram_merge (&li->li_repair, &sock->repair_latency);
+				pgm_histogram_merge (&li->li_delivery, &sock->delivery_latency);
+				pgm_histogram_merge (&li->li_queue, &sock->queue_latency);
+				for (pgm_list_t* list = sock->peers_list; list; list = list->next) {
+					const pgm_peer_t* peer = list->data;
+					pgm_histogram_merge (&li->li_repair, &peer->window->repair_latency);
+					pgm_histogram_merge (&li->li_delivery, &peer->delivery_latency);
+					pgm_histogram_merge (&li->li_queue, &peer->queue_latency);
+				}
+				status = TRUE;
+			} else {
+				const pgm_peer_t* peer = pgm_tsitable_lookup (sock->peers_table, &tsi);
+				if (NULL != peer) {
+					pgm_histogram_merge (&li->li_repair, &peer->window->repair_latency);
+					pgm_histogram_merge (&li->li_delivery, &peer->delivery_latency);
+					pgm_histogram_merge (&li->li_queue, &peer->queue_latency);
+					status = TRUE;
+				}
+			}
+			pgm_rwlock_reader_unlock (&sock->peers_lock);
+		}
+		break;
+
 /** read-write options **/
 /* maximum transmission packet size */
 	case PGM_MTU:
@@ -840,6 +1070,94 @@ pgm_getsockopt (
 		status = TRUE;
 		break;
 
+	case PGM_SEND_BATCH:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
+			break;
+		*(int*restrict)optval = (int)sock->send_batch;
+		status = TRUE;
+		break;
+
+	case PGM_RECV_BATCH:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
+			break;
+		*(int*restrict)optval = (int)sock->recv_batch;
+		status = TRUE;
+		break;
+
+	case PGM_TXW_LOCKLESS:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
+			break;
+		*(int*restrict)optval = sock->use_lockless_txw ? 1 : 0;
+		status = TRUE;
+		break;
+
+	case PGM_RECV_SHARD:
+		if (PGM_UNLIKELY(*optlen != sizeof (struct pgm_shardinfo_t)))
+			break;
+		{
+			struct pgm_shardinfo_t*restrict shardinfo = optval;
+			shardinfo->si_index = sock->shard_index;
+			shardinfo->si_count = sock->shard_count;
+		}
+		status = TRUE;
+		break;
+
+	case PGM_RECV_DEMUX:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
+			break;
+		*(int*restrict)optval = sock->use_demux ? 1 : 0;
+		status = TRUE;
+		break;
+
+	case PGM_RATE_PACING:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
+			break;
+		*(int*restrict)optval = sock->use_pacing ? 1 : 0;
+		status = TRUE;
+		break;
+
+	case PGM_SINGLE_THREAD:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
+			break;
+		*(int*restrict)optval = sock->is_single_threaded ? 1 : 0;
+		status = TRUE;
+		break;
+
+	case PGM_COALESCE:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
+			break;
+		*(int*restrict)optval = (int)sock->coalesce_ivl;
+		status = TRUE;
+		break;
+
+	case PGM_ZEROCOPY:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
+			break;
+		*(int*restrict)optval = (int)sock->zerocopy_min;
+		status = TRUE;
+		break;
+
+	case PGM_UDP_GSO:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
+			break;
+		*(int*restrict)optval = sock->use_udp_gso ? 1 : 0;
+		status = TRUE;
+		break;
+
+	case PGM_UDP_GRO:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
+			break;
+		*(int*restrict)optval = sock->use_udp_gro ? 1 : 0;
+		status = TRUE;
+		break;
+
+	case PGM_RECV_TIMESTAMP:
+		if (PGM_UNLIKELY(*optlen != sizeof (int)))
+			break;
+		*(int*restrict)optval = sock->use_kernel_tstamp ? 1 : 0;
+		status = TRUE;
+		break;
+
 	case PGM_UNCONTROLLED_ODATA:
 		if (PGM_UNLIKELY(*optlen != sizeof (int)))
 			break;
@@ -1092,8 +1410,13 @@ pgm_setsockopt (
  */
 	case SO_SNDBUF:
 		if (SOCKET_ERROR == setsockopt (sock->send_sock, SOL_SOCKET, SO_SNDBUF, (const char*)optval, optlen) ||
-		    SOCKET_ERROR == setsockopt (sock->send_with_router_alert_sock, SOL_SOCKET, SO_SNDBUF, (const char*)optval, optlen))
+		    SOCKET_ERROR == setsockopt (sock->send_with_router_alert_sock, SOL_SOCKET, SO_SNDBUF, (const char*)optval, optlen) ||
+		    (INVALID_SOCKET != sock->repair_sock &&
+		     SOCKET_ERROR == setsockopt (sock->repair_sock, SOL_SOCKET, SO_SNDBUF, (const char*)optval, optlen)))
 			break;
+/* applied to the repair socket on bind */
+		if (sizeof (int) == optlen && *(const int*)optval > 0)
+			sock->sndbuf = *(const int*)optval;
 		status = TRUE;
 		break;
 
@@ -1104,6 +1427,9 @@ pgm_setsockopt (
 	case SO_RCVBUF:
 		if (SOCKET_ERROR == setsockopt (sock->recv_sock, SOL_SOCKET, SO_RCVBUF, (const char*)optval, optlen))
 			break;
+/* applied to the shared receive socket on connect */
+		if (sizeof (int) == optlen && *(const int*)optval > 0)
+			sock->rcvbuf = *(const int*)optval;
 		status = TRUE;
 		break;
 
@@ -1122,8 +1448,11 @@ pgm_setsockopt (
 			break;
 		{
 			const bool v = (0 != *(const int*)optval);
-			if (SOCKET_ERROR == pgm_sockaddr_router_alert (sock->send_with_router_alert_sock, sock->family, v))
+			if (SOCKET_ERROR == pgm_sockaddr_router_alert (sock->send_with_router_alert_sock, sock->family, v) ||
+			    (INVALID_SOCKET != sock->repair_sock &&
+			     SOCKET_ERROR == pgm_sockaddr_router_alert (sock->repair_sock, sock->family, v)))
 				break;
+			sock->use_router_alert = v;
 		}
 		status = TRUE;
 		break;
@@ -1152,9 +1481,14 @@ pgm_setsockopt (
 			const bool v = (0 != *(const int*)optval);
 #if !defined(_WIN32) && !defined(__CYGWIN__)	/* loop on send */
 			if (SOCKET_ERROR == pgm_sockaddr_multicast_loop (sock->send_sock, sock->family, v) ||
-			    SOCKET_ERROR == pgm_sockaddr_multicast_loop (sock->send_with_router_alert_sock, sock->family, v))
+			    SOCKET_ERROR == pgm_sockaddr_multicast_loop (sock->send_with_router_alert_sock, sock->family, v) ||
+			    (INVALID_SOCKET != sock->repair_sock &&
+			     SOCKET_ERROR == pgm_sockaddr_multicast_loop (sock->repair_sock, sock->family, v)))
+				break;
+			sock->use_multicast_loop = v;
+#else		/* loop on receive, cannot apply per member of a shared receive socket */
+			if (PGM_UNLIKELY(sock->use_demux))
 				break;
-#else		/* loop on receive */
 			if (SOCKET_ERROR == pgm_sockaddr_multicast_loop (sock->recv_sock, sock->family, v))
 				break;
 #endif
@@ -1174,7 +1508,9 @@ pgm_setsockopt (
 		{
 			sock->hops = *(const int*)optval;
 			if (SOCKET_ERROR == pgm_sockaddr_multicast_hops (sock->send_sock, sock->family, sock->hops) ||
-			    SOCKET_ERROR == pgm_sockaddr_multicast_hops (sock->send_with_router_alert_sock, sock->family, sock->hops))
+			    SOCKET_ERROR == pgm_sockaddr_multicast_hops (sock->send_with_router_alert_sock, sock->family, sock->hops) ||
+			    (INVALID_SOCKET != sock->repair_sock &&
+			     SOCKET_ERROR == pgm_sockaddr_multicast_hops (sock->repair_sock, sock->family, sock->hops)))
 				break;
 		}
 		status = TRUE;
@@ -1186,11 +1522,14 @@ pgm_setsockopt (
 		if (PGM_UNLIKELY(optlen != sizeof (int)))
 			break;
 		if (SOCKET_ERROR == pgm_sockaddr_tos (sock->send_sock, sock->family, *(const int*)optval) ||
-		    SOCKET_ERROR == pgm_sockaddr_tos (sock->send_with_router_alert_sock, sock->family, *(const int*)optval))
+		    SOCKET_ERROR == pgm_sockaddr_tos (sock->send_with_router_alert_sock, sock->family, *(const int*)optval) ||
+		    (INVALID_SOCKET != sock->repair_sock &&
+		     SOCKET_ERROR == pgm_sockaddr_tos (sock->repair_sock, sock->family, *(const int*)optval)))
 		{
 			pgm_warn (_("ToS/DSCP setting requires CAP_NET_ADMIN or ADMIN capability."));
 			break;
 		}
+		sock->tos = *(const int*)optval;
 		status = TRUE;
 		break;
 
@@ -1288,6 +1627,245 @@ pgm_setsockopt (
 		status = TRUE;
 		break;
 
+/* maximum count of APDU fragments passed to the kernel per system call.
+ * 0 < send_batch <= PGM_MAX_SEND_BATCH
+ */
+	case PGM_SEND_BATCH:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval <= 0 ||
+				 *(const int*)optval > PGM_MAX_SEND_BATCH))
+			break;
+		sock->send_batch = *(const int*)optval;
+		status = TRUE;
+		break;
+
+/* maximum count of datagrams read from the kernel per system call.
+ * 0 < recv_batch <= PGM_MAX_RECV_BATCH
+ */
+	case PGM_RECV_BATCH:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval <= 0 ||
+				 *(const int*)optval > PGM_MAX_RECV_BATCH))
+			break;
+		sock->recv_batch = *(const int*)optval;
+		status = TRUE;
+		break;
+
+/* 1 = publisher and repair thread share the transmit window without txw_spinlock,
+ *     repairs are sent on a dedicated socket opened at bind.  must be set
+ *     before bind.
+ * 0 = default, serialise window access with txw_spinlock.
+ */
+	case PGM_TXW_LOCKLESS:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		sock->use_lockless_txw = (0 != *(const int*)optval);
+		status = TRUE;
+		break;
+
+/* partition sources across sockets bound to the same group and port, each
+ * socket keeps its own peers, windows and timers so that every shard may be
+ * serviced by a dedicated thread.
+ * 0 <= si_index < si_count, si_count = 0 to disable.
+ */
+	case PGM_RECV_SHARD:
+		if (PGM_UNLIKELY(optlen != sizeof (struct pgm_shardinfo_t)))
+			break;
+		{
+			const struct pgm_shardinfo_t* shardinfo = optval;
+			if (PGM_UNLIKELY(shardinfo->si_count > 0 &&
+					 shardinfo->si_index >= shardinfo->si_count))
+				break;
+			sock->shard_index = shardinfo->si_index;
+			sock->shard_count = shardinfo->si_count;
+		}
+		status = TRUE;
+		break;
+
+/* share one process-wide raw receive socket per interface and family with
+ * other sockets opting in, the private raw socket is replaced by a socket
+ * only holding group memberships.  must be set before bind and before
+ * joining any group, not available with UDP encapsulation which is already
+ * demultiplexed by port.  SO_RCVBUF is carried over to the shared socket.
+ * PGM_UDP_GRO and PGM_RECV_TIMESTAMP only act on a private socket and are
+ * refused before and after this option, as is PGM_MULTICAST_LOOP after it
+ * where loopback applies on receive.
+ * 0 = default, private receive socket, cannot be reverted.
+ */
+	case PGM_RECV_DEMUX:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound || sock->recv_gsr_len > 0 || sock->udp_encap_ucast_port))
+			break;
+		if (PGM_UNLIKELY(sock->use_udp_gro || sock->use_kernel_tstamp))
+			break;
+		if (0 == *(const int*)optval) {
+			if (PGM_UNLIKELY(sock->use_demux))
+				break;
+		} else if (!sock->use_demux) {
+			const SOCKET membership_sock = socket (sock->family, SOCK_DGRAM, 0);
+			if (PGM_UNLIKELY(INVALID_SOCKET == membership_sock))
+				break;
+			pgm_sockaddr_nonblocking (membership_sock, TRUE);
+			closesocket (sock->recv_sock);
+			sock->recv_sock = membership_sock;
+			sock->use_demux = TRUE;
+		}
+		status = TRUE;
+		break;
+
+/* 1 = space packets evenly at the regulated rates instead of refilling the
+ *     token buckets every millisecond, the socket rate is also passed to the
+ *     kernel for fq qdisc pacing where available.  must be set before bind.
+ * 0 = default, token bucket regulation.
+ */
+	case PGM_RATE_PACING:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		sock->use_pacing = (0 != *(const int*)optval);
+		status = TRUE;
+		break;
+
+/* 1 = the application guarantees that only one thread at a time calls into
+ *     the socket, the send, receive and timer paths skip their locks.  the
+ *     calling thread may change between calls when the application orders
+ *     the handoff.  must be set before bind.
+ * 0 = default, internal locking.
+ */
+	case PGM_SINGLE_THREAD:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		sock->is_single_threaded = (0 != *(const int*)optval);
+		status = TRUE;
+		break;
+
+/* > 0 = pgm_send() holds APDUs small enough to share a TPDU for up to this
+ *       many microseconds, packing them with a 16-bit length prefix each into
+ *       one ODATA packet.  receivers unpack transparently.  the timer sends a
+ *       held packet, pgm_send_flush() sends it immediately and should be
+ *       called before pgm_close().  must be set before bind.
+ * 0   = default, one APDU per packet.
+ */
+	case PGM_COALESCE:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval < 0))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		sock->coalesce_ivl = *(const int*)optval;
+		status = TRUE;
+		break;
+
+/* > 0 = TPDUs of at least this many bytes, original data and repairs, are
+ *       sent with MSG_ZEROCOPY.  the transmit window keeps each packet until
+ *       the kernel reports completion, repairs of a packet wait for it.  only
+ *       UDP encapsulated sockets on Linux support it.  must be set before bind.
+ * 0   = default, the kernel copies every packet.
+ */
+	case PGM_ZEROCOPY:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(*(const int*)optval < 0))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		if (*(const int*)optval > 0) {
+#ifdef HAVE_MSG_ZEROCOPY
+			const int v = 1;
+			if (SOCKET_ERROR == setsockopt (sock->send_sock, SOL_SOCKET, SO_ZEROCOPY, (const char*)&v, sizeof(v)) ||
+			    SOCKET_ERROR == setsockopt (sock->send_with_router_alert_sock, SOL_SOCKET, SO_ZEROCOPY, (const char*)&v, sizeof(v)))
+				break;
+#else
+			break;
+#endif
+		}
+		sock->zerocopy_min = *(const int*)optval;
+		status = TRUE;
+		break;
+
+/* 1 = runs of equal size APDU fragments are handed to the kernel as one UDP
+ *     GSO super-buffer, segmented by the kernel or device.  implies a send
+ *     batch of PGM_MAX_SEND_BATCH unless PGM_SEND_BATCH is set, reverts to
+ *     one datagram per fragment if the kernel rejects segmentation.  only
+ *     UDP encapsulated sockets on Linux support it.  must be set before bind.
+ * 0 = default, one datagram per fragment.
+ */
+	case PGM_UDP_GSO:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound))
+			break;
+		if (0 != *(const int*)optval) {
+#if defined( HAVE_SENDMMSG ) && defined( HAVE_UDP_GSO )
+/* segment size is set per message, probe for support */
+			const int v = 0;
+			if (SOCKET_ERROR == setsockopt (sock->send_sock, SOL_UDP, UDP_SEGMENT, (const char*)&v, sizeof(v)))
+				break;
+#else
+			break;
+#endif
+		}
+		sock->use_udp_gso = (0 != *(const int*)optval);
+		status = TRUE;
+		break;
+
+/* 1 = the kernel coalesces arriving datagrams of a flow with UDP GRO, each
+ *     read is split back into TPDUs by the receive engine.  implies a
+ *     receive batch of PGM_MAX_RECV_BATCH.  only UDP encapsulated sockets on
+ *     Linux support it.  must be set before bind.
+ * 0 = default, one datagram per read.
+ */
+	case PGM_UDP_GRO:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound || sock->use_demux))
+			break;
+		if ((0 != *(const int*)optval) != sock->use_udp_gro) {
+#if defined( HAVE_RECVMMSG ) && defined( HAVE_UDP_GRO )
+			const int v = (0 != *(const int*)optval);
+			if (SOCKET_ERROR == setsockopt (sock->recv_sock, SOL_UDP, UDP_GRO, (const char*)&v, sizeof(v)))
+				break;
+#else
+			break;
+#endif
+		}
+		sock->use_udp_gro = (0 != *(const int*)optval);
+		status = TRUE;
+		break;
+
+/* 1 = the kernel stamps each datagram on arrival with SO_TIMESTAMPNS, read
+ *     into pgm_sk_buff_t::kernel_tstamp and the li_queue histogram of
+ *     PGM_LATENCY_STATS.  not available with PGM_RECV_DEMUX.  must be set
+ *     before bind.
+ * 0 = default, no kernel time stamps.
+ */
+	case PGM_RECV_TIMESTAMP:
+		if (PGM_UNLIKELY(optlen != sizeof (int)))
+			break;
+		if (PGM_UNLIKELY(sock->is_bound || sock->use_demux))
+			break;
+		if ((0 != *(const int*)optval) != sock->use_kernel_tstamp) {
+#ifdef HAVE_SO_TIMESTAMPNS
+			const int v = (0 != *(const int*)optval);
+			if (SOCKET_ERROR == setsockopt (sock->recv_sock, SOL_SOCKET, SO_TIMESTAMPNS, (const char*)&v, sizeof(v)))
+				break;
+#else
+			break;
+#endif
+		}
+		sock->use_kernel_tstamp = (0 != *(const int*)optval);
+		status = TRUE;
+		break;
+
 /* ignore rate limit for original data packets, i.e. only apply to repairs.
  */
 	case PGM_UNCONTROLLED_ODATA:
@@ -1552,6 +2130,8 @@ pgm_setsockopt (
 		sock->is_nonblocking = (0 != *(const int*)optval);
 		pgm_sockaddr_nonblocking (sock->send_sock, sock->is_nonblocking);
 		pgm_sockaddr_nonblocking (sock->send_with_router_alert_sock, sock->is_nonblocking);
+		if (INVALID_SOCKET != sock->repair_sock)
+			pgm_sockaddr_nonblocking (sock->repair_sock, sock->is_nonblocking);
 		status = TRUE;
 		break;
 
@@ -1572,6 +2152,10 @@ pgm_setsockopt (
 								   (const struct sockaddr*)&sock->send_addr,
 								   sock->send_gsr.gsr_interface)) ||
 		    (SOCKET_ERROR == pgm_sockaddr_multicast_if (sock->send_with_router_alert_sock,
+								   (const struct sockaddr*)&sock->send_addr,
+								   sock->send_gsr.gsr_interface)) ||
+		    (INVALID_SOCKET != sock->repair_sock &&
+		     SOCKET_ERROR == pgm_sockaddr_multicast_if (sock->repair_sock,
 								   (const struct sockaddr*)&sock->send_addr,
 								   sock->send_gsr.gsr_interface)))
 		{
@@ -1585,6 +2169,9 @@ pgm_setsockopt (
 				addr,
 				(unsigned)sock->send_gsr.gsr_interface);
 		}
+/* re-generate kernel filter for new group set */
+		if (sock->is_bound)
+			pgm_filter_attach (sock);
 		status = TRUE;
 		break;
 
@@ -1636,6 +2223,8 @@ pgm_setsockopt (
 			}
 			sock->recv_gsr_len++;
 		}
+		if (sock->is_bound)
+			pgm_filter_attach (sock);
 		status = TRUE;
 		break;
 
@@ -1678,6 +2267,8 @@ pgm_setsockopt (
 					(unsigned)gr->gr_interface);
 			}
 		}
+		if (sock->is_bound)
+			pgm_filter_attach (sock);
 		status = TRUE;
 		break;
 
@@ -1757,6 +2348,8 @@ pgm_setsockopt (
 			memcpy (&sock->recv_gsr[sock->recv_gsr_len], gsr, sizeof(struct group_source_req));
 			sock->recv_gsr_len++;
 		}
+		if (sock->is_bound)
+			pgm_filter_attach (sock);
 		status = TRUE;
 		break;
 
@@ -1791,6 +2384,8 @@ pgm_setsockopt (
 			if (SOCKET_ERROR == pgm_sockaddr_leave_source_group (sock->recv_sock, sock->family, gsr))
 				break;
 		}
+		if (sock->is_bound)
+			pgm_filter_attach (sock);
 		status = TRUE;
 		break;
 
@@ -1811,6 +2406,8 @@ pgm_setsockopt (
 			if (SOCKET_ERROR == pgm_sockaddr_msfilter (sock->recv_sock, sock->family, gf_list))
 				break;
 		}
+		if (sock->is_bound)
+			pgm_filter_attach (sock);
 		status = TRUE;
 #endif
 		break;
@@ -1841,6 +2438,9 @@ pgm_setsockopt (
 	case PGM_ACK_SOCK:
 	case PGM_TIME_REMAIN:
 	case PGM_RATE_REMAIN:
+	case PGM_RECV_BATCH_STATS:
+	case PGM_SKB_POOL_STATS:
+	case PGM_LATENCY_STATS:
 	default:
 		break;
 	}
@@ -2122,12 +2722,53 @@ pgm_bind3 (
 							sock->rs_n,
 							sock->rs_k);
 		pgm_assert (NULL != sock->window);
+/* pro-active parity is queued from the publisher, breaking the single repair consumer */
+		if (sock->use_lockless_txw && sock->use_proactive_parity) {
+			pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Pro-active parity enabled, disabling lockless transmit window."));
+			sock->use_lockless_txw = FALSE;
+		}
+		sock->window->is_lockless = sock->use_lockless_txw;
+/* publisher folds each packet into the leading parity packets of its group,
+ * a lockless window already encodes outside of any lock.
+ */
+		if ((sock->use_ondemand_parity || sock->use_proactive_parity) && !sock->use_lockless_txw) {
+			sock->window->parity_h = MIN(MAX(sock->rs_proactive_h, 1), sock->rs_n - sock->rs_k);
+			pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Precomputing %u parity packets per transmission group."),
+				(unsigned)sock->window->parity_h);
+		}
 	}
 
 /* create peer list */
 	if (sock->can_recv_data) {
-		sock->peers_hashtable = pgm_hashtable_new (pgm_tsi_hash, pgm_tsi_equal);
-		pgm_assert (NULL != sock->peers_hashtable);
+		sock->peers_table = pgm_tsitable_new ();
+		pgm_assert (NULL != sock->peers_table);
+	}
+
+/* one coalesced read splits into up to PGM_MAX_GRO_SEGMENTS TPDUs, and
+ * super-buffers are built from send batches.
+ */
+	if (sock->use_udp_gro)
+		sock->recv_batch = MAX(sock->recv_batch, PGM_MAX_GRO_SEGMENTS);
+	if (sock->use_udp_gso && 1 == sock->send_batch)
+		sock->send_batch = PGM_MAX_SEND_BATCH;
+
+/* packet buffer pool sized to hold one full transmit and receive window */
+	{
+		unsigned max_free = sock->recv_batch + 1;
+		if (sock->can_send_data)
+			max_free += pgm_txw_max_length (sock->window);
+		if (sock->can_recv_data)
+			max_free += sock->rxw_sqns ? sock->rxw_sqns : (unsigned)( (sock->rxw_secs * sock->rxw_max_rte) / sock->max_tpdu );
+		pgm_trace (PGM_LOG_ROLE_MEMORY,_("Create packet buffer pool caching up to %u buffers."), max_free);
+		sock->skb_pool = pgm_skb_pool_create (sock->max_tpdu, max_free);
+	}
+
+/* zero-copy sends in flight bounded by the transmit window */
+	if (sock->can_send_data && sock->zerocopy_min) {
+		const unsigned pins = (unsigned)MIN(pgm_txw_max_length (sock->window), PGM_MAX_ZEROCOPY_PINS);
+		pgm_trace (PGM_LOG_ROLE_NETWORK,_("Pin up to %u zero-copy sends per socket."), pins);
+		pgm_zerocopy_create (&sock->odata_zerocopy, pins);
+		pgm_zerocopy_create (&sock->rdata_zerocopy, pins);
 	}
 
 /* Bind UDP sockets to interfaces, note multicast on a bound interface is
@@ -2211,6 +2852,8 @@ pgm_bind3 (
 		return FALSE;
 	}
 
+	memcpy (&sock->recv_addr, &recv_addr, pgm_sockaddr_len (&recv_addr.sa));
+
 	if (PGM_UNLIKELY(pgm_log_mask & PGM_LOG_ROLE_NETWORK))
 	{
 		char s[INET6_ADDRSTRLEN];
@@ -2309,6 +2952,33 @@ pgm_bind3 (
 		pgm_debug ("bind (router alert) succeeded on send_gsr interface %s", s);
 	}
 
+/* repairs of a lockless window leave on their own socket */
+	if (sock->use_lockless_txw && sock->can_send_data &&
+	    !open_repair_socket (sock, error))
+	{
+		pgm_rwlock_writer_unlock (&sock->lock);
+		return FALSE;
+	}
+
+	if (INVALID_SOCKET != sock->repair_sock &&
+	    SOCKET_ERROR == bind (sock->repair_sock,
+				      (struct sockaddr*)&send_with_router_alert_addr,
+				      pgm_sockaddr_len((struct sockaddr*)&send_with_router_alert_addr)))
+	{
+		const int save_errno = pgm_get_last_sock_error();
+		char errbuf[1024];
+		char addr[INET6_ADDRSTRLEN];
+		pgm_sockaddr_ntop ((struct sockaddr*)&send_with_router_alert_addr, addr, sizeof(addr));
+		pgm_set_error (error,
+			       PGM_ERROR_DOMAIN_SOCKET,
+			       pgm_error_from_sock_errno (save_errno),
+			       _("Binding repair send socket to address %s: %s"),
+			       addr,
+			       pgm_sock_strerror_s (errbuf, sizeof (errbuf), save_errno));
+		pgm_rwlock_writer_unlock (&sock->lock);
+		return FALSE;
+	}
+
 /* save send side address for broadcasting as source nla */
 	memcpy (&sock->send_addr, &send_addr, pgm_sockaddr_len ((struct sockaddr*)&send_addr));
 
@@ -2336,10 +3006,47 @@ pgm_bind3 (
 			pgm_rate_create (&sock->rdata_rate_control, sock->rdata_max_rte, sock->iphdr_len, sock->max_tpdu);
 			sock->is_controlled_rdata = TRUE;
 		}
+
+/* only the calling thread touches the token buckets */
+		if (sock->is_single_threaded) {
+			pgm_trace (PGM_LOG_ROLE_RATE_CONTROL,_("Single-threaded socket, eliding rate control locks."));
+			pgm_rate_set_single_threaded (&sock->rate_control, TRUE);
+			pgm_rate_set_single_threaded (&sock->odata_rate_control, TRUE);
+			pgm_rate_set_single_threaded (&sock->rdata_rate_control, TRUE);
+		}
+
+/* space packets evenly in user space, the kernel is additionally given the
+ * socket rate as a ceiling so that fq can smooth what the scheduler bunches.
+ */
+		if (sock->use_pacing) {
+			const ssize_t max_rte = sock->txw_max_rte > 0 ? sock->txw_max_rte : MAX(sock->odata_max_rte, sock->rdata_max_rte);
+			pgm_trace (PGM_LOG_ROLE_RATE_CONTROL,_("Pacing packets at regulated rates."));
+			pgm_rate_set_pacing (&sock->rate_control, TRUE);
+			pgm_rate_set_pacing (&sock->odata_rate_control, TRUE);
+			pgm_rate_set_pacing (&sock->rdata_rate_control, TRUE);
+			if (max_rte > 0) {
+				if (SOCKET_ERROR == pgm_sockaddr_max_pacing_rate (sock->send_sock, max_rte) ||
+				    SOCKET_ERROR == pgm_sockaddr_max_pacing_rate (sock->send_with_router_alert_sock, max_rte) ||
+				    (INVALID_SOCKET != sock->repair_sock &&
+				     SOCKET_ERROR == pgm_sockaddr_max_pacing_rate (sock->repair_sock, max_rte)))
+				{
+					char errbuf[1024];
+					const int save_errno = pgm_get_last_sock_error();
+					pgm_trace (PGM_LOG_ROLE_RATE_CONTROL,_("Kernel pacing unavailable: %s"),
+							pgm_sock_strerror_s (errbuf, sizeof (errbuf), save_errno));
+				}
+				else
+					pgm_trace (PGM_LOG_ROLE_RATE_CONTROL,_("Setting kernel pacing rate to %" PRIzd " bytes per second."),
+							max_rte);
+			}
+		}
 	}
 
 /* allocate first incoming packet buffer */
-	sock->rx_buffer = pgm_alloc_skb (sock->max_tpdu);
+	sock->rx_buffer = pgm_skb_pool_alloc (sock->skb_pool, sock->max_tpdu);
+
+/* drop other sessions in the kernel, re-generated on membership changes */
+	pgm_filter_attach (sock);
 
 /* bind complete */
 	sock->is_bound = TRUE;
@@ -2415,6 +3122,38 @@ pgm_connect (
 		sock->next_poll = pgm_time_update_now() + pgm_secs( 30 );
 	}
 
+#ifdef HAVE_RECVMMSG
+/* PGM_RECV_BATCH may be lowered after bind, the batch must still hold every
+ * segment of a coalesced read.
+ */
+	if (sock->use_udp_gro)
+		sock->recv_batch = MAX(sock->recv_batch, PGM_MAX_GRO_SEGMENTS);
+
+/* pre-allocate receive batch buffers, coalesced reads reach send-only sockets too */
+	if ((sock->can_recv_data || sock->use_udp_gro) && sock->recv_batch > 1 && !sock->use_demux)
+	{
+		sock->rx_ring = pgm_new (struct pgm_sk_buff_t*, sock->recv_batch);
+		sock->rx_ring_addr = pgm_new0 (struct sockaddr_storage, 2 * sock->recv_batch);
+		for (unsigned i = 0; i < sock->recv_batch; i++)
+			sock->rx_ring[i] = pgm_skb_pool_alloc (sock->skb_pool, sock->max_tpdu);
+		sock->rx_ring_len = sock->rx_ring_index = 0;
+		if (sock->use_udp_gro)
+			sock->rx_gro_buffer = pgm_malloc (PGM_MAX_GRO_LEN);
+	}
+#endif
+
+/* final kernel filter with send group and direction */
+	pgm_filter_attach (sock);
+
+/* join shared receive socket, group memberships are fixed from here on */
+	if (sock->use_demux) {
+		sock->demux = pgm_demux_attach (sock, error);
+		if (NULL == sock->demux) {
+			pgm_rwlock_writer_unlock (&sock->lock);
+			return FALSE;
+		}
+	}
+
 	sock->is_connected = TRUE;
 
 /* cleanup */
@@ -2475,9 +3214,10 @@ pgm_select_info (
 
 	if (readfds)
 	{
-		FD_SET(sock->recv_sock, readfds);
+		const SOCKET recv_fd = recv_socket (sock);
+		FD_SET(recv_fd, readfds);
 #ifndef _WIN32
-		fds = sock->recv_sock + 1;
+		fds = recv_fd + 1;
 #else
 		fds = 1;
 #endif
@@ -2579,7 +3319,7 @@ pgm_wsapoll_info (
 	if (events & PGM_POLLIN)
 	{
 		pgm_assert ( (1 + nfds) <= *n_fds );
-		fds[nfds].fd = sock->recv_sock;
+		fds[nfds].fd = recv_socket (sock);
 		fds[nfds].events = PGM_POLLIN;
 		nfds++;
 		if (sock->can_send_data) {
@@ -2647,7 +3387,8 @@ pgm_epoll_ctl (
 	{
 		event.events = events & (EPOLLIN | EPOLLET | EPOLLONESHOT);
 		event.data.ptr = sock;
-		retval = epoll_ctl (epfd, op, sock->recv_sock, &event);
+/* shared receive socket is represented by a descriptor private to the member */
+		retval = epoll_ctl (epfd, op, sock->demux ? pgm_demux_get_epoll_socket (sock->demux) : sock->recv_sock, &event);
 		if (retval)
 			goto out;
 		if (sock->can_send_data) {
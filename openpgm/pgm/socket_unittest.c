@@ -66,10 +66,15 @@
 #define pgm_txw_shutdown	mock_pgm_txw_shutdown
 #define pgm_rate_create		mock_pgm_rate_create
 #define pgm_rate_destroy	mock_pgm_rate_destroy
+#define pgm_rate_set_pacing	mock_pgm_rate_set_pacing
+#define pgm_rate_set_single_threaded	mock_pgm_rate_set_single_threaded
 #define pgm_rate_remaining	mock_pgm_rate_remaining
 #define pgm_rs_create		mock_pgm_rs_create
 #define pgm_rs_destroy		mock_pgm_rs_destroy
 #define pgm_time_update_now	mock_pgm_time_update_now
+#define pgm_filter_attach	mock_pgm_filter_attach
+#define pgm_zerocopy_create	mock_pgm_zerocopy_create
+#define pgm_zerocopy_destroy	mock_pgm_zerocopy_destroy
 
 #define SOCK_DEBUG
 #include "socket.c"
@@ -180,6 +185,7 @@ generate_sock (void)
 	sock->recv_sock = socket (AF_INET, SOCK_RAW, 113);
 	sock->send_sock = socket (AF_INET, SOCK_RAW, 113);
 	sock->send_with_router_alert_sock = socket (AF_INET, SOCK_RAW, 113);
+	sock->repair_sock = INVALID_SOCKET;
 	((struct sockaddr*)&sock->send_addr)->sa_family = AF_INET;
 	((struct sockaddr_in*)&sock->send_addr)->sin_addr.s_addr = inet_addr ("127.0.0.2");
 	sock->dport = g_htons(TEST_PORT);
@@ -225,7 +231,8 @@ mock_pgm_send_spm (
 PGM_GNUC_INTERNAL
 bool
 mock_pgm_timer_prepare (
-	pgm_sock_t* const		sock
+	pgm_sock_t* const		sock,
+	const pgm_time_t		now
 	)
 {
 	return FALSE;
@@ -234,7 +241,8 @@ mock_pgm_timer_prepare (
 PGM_GNUC_INTERNAL
 bool
 mock_pgm_timer_check (
-	pgm_sock_t* const		sock
+	pgm_sock_t* const		sock,
+	const pgm_time_t		now
 	)
 {
 	return FALSE;
@@ -243,7 +251,8 @@ mock_pgm_timer_check (
 PGM_GNUC_INTERNAL
 pgm_time_t
 mock_pgm_timer_expiration (
-	pgm_sock_t* const		sock
+	pgm_sock_t* const		sock,
+	const pgm_time_t		now
 	)
 {
 	return 100L;
@@ -252,7 +261,8 @@ mock_pgm_timer_expiration (
 PGM_GNUC_INTERNAL
 bool
 mock_pgm_timer_dispatch (
-	pgm_sock_t* const		sock
+	pgm_sock_t* const		sock,
+	const pgm_time_t		now
 	)
 {
 	return TRUE;
@@ -303,6 +313,24 @@ mock_pgm_rate_destroy (
 {
 }
 
+PGM_GNUC_INTERNAL
+void
+mock_pgm_rate_set_pacing (
+	pgm_rate_t*		bucket,
+	const bool		is_paced
+	)
+{
+}
+
+PGM_GNUC_INTERNAL
+void
+mock_pgm_rate_set_single_threaded (
+	pgm_rate_t*		bucket,
+	const bool		is_single_threaded
+	)
+{
+}
+
 PGM_GNUC_INTERNAL
 pgm_time_t
 mock_pgm_rate_remaining (
@@ -330,6 +358,33 @@ mock_pgm_rs_destroy (
 {
 }
 
+/** filter module */
+PGM_GNUC_INTERNAL
+void
+mock_pgm_filter_attach (
+	pgm_sock_t*		sock
+	)
+{
+}
+
+/** net module */
+PGM_GNUC_INTERNAL
+void
+mock_pgm_zerocopy_create (
+	struct pgm_zerocopy_t*	zc,
+	unsigned		pins
+	)
+{
+}
+
+PGM_GNUC_INTERNAL
+void
+mock_pgm_zerocopy_destroy (
+	struct pgm_zerocopy_t*	zc
+	)
+{
+}
+
 /** time module */
 static pgm_time_t _mock_pgm_time_update_now (void);
 pgm_time_update_func mock_pgm_time_update_now = _mock_pgm_time_update_now;
@@ -731,6 +786,7 @@ START_TEST (test_set_sndbuf_pass_001)
 	const void* optval	= &bufsize;
 	const socklen_t optlen	= sizeof(bufsize);
 	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_sndbuf failed");
+	fail_unless ((size_t)bufsize == sock->sndbuf, "sndbuf not recorded for repair socket");
 }
 END_TEST
 
@@ -1154,6 +1210,820 @@ START_TEST (test_set_udp_multicast_fail_001)
 }
 END_TEST
 
+/* target:
+ *	bool
+ *	pgm_setsockopt (
+ *		pgm_sock_t* const	sock,
+ *		const int		level = IPPROTO_PGM,
+ *		const int		optname = PGM_RECV_DEMUX,
+ *		const void*		optval,
+ *		const socklen_t		optlen = sizeof(int)
+ *	)
+ */
+
+START_TEST (test_set_recv_demux_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_RECV_DEMUX;
+	const int demux		= 1;
+	const void* optval	= &demux;
+	const socklen_t optlen	= sizeof(demux);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_recv_demux failed");
+	fail_unless (TRUE == sock->use_demux, "use_demux not set");
+}
+END_TEST
+
+/* cannot revert to a private receive socket */
+START_TEST (test_set_recv_demux_pass_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_RECV_DEMUX;
+	int demux		= 1;
+	const void* optval	= &demux;
+	const socklen_t optlen	= sizeof(demux);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_recv_demux failed");
+	demux = 0;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_recv_demux failed");
+	fail_unless (TRUE == sock->use_demux, "use_demux cleared");
+}
+END_TEST
+
+START_TEST (test_set_recv_demux_fail_001)
+{
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_RECV_DEMUX;
+	const int demux		= 1;
+	const void* optval	= &demux;
+	const socklen_t optlen	= sizeof(demux);
+	fail_unless (FALSE == pgm_setsockopt (NULL, level, optname, optval, optlen), "set_recv_demux failed");
+}
+END_TEST
+
+/* not with UDP encapsulation */
+START_TEST (test_set_recv_demux_fail_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->udp_encap_ucast_port = g_htons(TEST_PORT);
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_RECV_DEMUX;
+	const int demux		= 1;
+	const void* optval	= &demux;
+	const socklen_t optlen	= sizeof(demux);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_recv_demux failed");
+}
+END_TEST
+
+/* not with options acting on a private receive socket */
+START_TEST (test_set_recv_demux_fail_003)
+{
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_RECV_DEMUX;
+	const int demux		= 1;
+	const void* optval	= &demux;
+	const socklen_t optlen	= sizeof(demux);
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->use_udp_gro = TRUE;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_recv_demux failed");
+	sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->use_kernel_tstamp = TRUE;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_recv_demux failed");
+	fail_unless (FALSE == sock->use_demux, "use_demux set");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_setsockopt (
+ *		pgm_sock_t* const	sock,
+ *		const int		level = IPPROTO_PGM,
+ *		const int		optname = PGM_RATE_PACING,
+ *		const void*		optval,
+ *		const socklen_t		optlen = sizeof(int)
+ *	)
+ */
+
+START_TEST (test_set_rate_pacing_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_RATE_PACING;
+	const int pacing	= 1;
+	const void* optval	= &pacing;
+	const socklen_t optlen	= sizeof(pacing);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_rate_pacing failed");
+	fail_unless (TRUE == sock->use_pacing, "use_pacing not set");
+}
+END_TEST
+
+START_TEST (test_set_rate_pacing_fail_001)
+{
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_RATE_PACING;
+	const int pacing	= 1;
+	const void* optval	= &pacing;
+	const socklen_t optlen	= sizeof(pacing);
+	fail_unless (FALSE == pgm_setsockopt (NULL, level, optname, optval, optlen), "set_rate_pacing failed");
+}
+END_TEST
+
+/* rates are created at bind */
+START_TEST (test_set_rate_pacing_fail_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_RATE_PACING;
+	const int pacing	= 1;
+	const void* optval	= &pacing;
+	const socklen_t optlen	= sizeof(pacing);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_rate_pacing failed");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_getsockopt (
+ *		pgm_sock_t* const	sock,
+ *		const int		level = IPPROTO_PGM,
+ *		const int		optname = PGM_LATENCY_STATS,
+ *		void*			optval,
+ *		socklen_t*		optlen = sizeof(struct pgm_latencyinfo_t)
+ *	)
+ */
+
+START_TEST (test_get_latency_stats_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_connected = TRUE;
+	sock->can_recv_data = TRUE;
+	pgm_rwlock_init (&sock->peers_lock);
+	pgm_histogram_record (&sock->repair_latency, 100);
+	pgm_histogram_record (&sock->repair_latency, 3000);
+	pgm_histogram_record (&sock->delivery_latency, 10);
+	pgm_histogram_record (&sock->queue_latency, 25);
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_LATENCY_STATS;
+	struct pgm_latencyinfo_t li;
+	memset (&li, 0, sizeof(li));
+	socklen_t optlen	= sizeof(li);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &li, &optlen), "get_latency_stats failed");
+	fail_unless (2 == li.li_repair.hi_count, "repair count mismatch");
+	fail_unless (100 == li.li_repair.hi_min, "repair min mismatch");
+	fail_unless (3000 == li.li_repair.hi_max, "repair max mismatch");
+	fail_unless (1 == li.li_delivery.hi_count, "delivery count mismatch");
+	fail_unless (10 == pgm_histinfo_percentile (&li.li_delivery, 50.0), "delivery median mismatch");
+	fail_unless (1 == li.li_queue.hi_count, "queue count mismatch");
+	fail_unless (25 == li.li_queue.hi_max, "queue max mismatch");
+}
+END_TEST
+
+START_TEST (test_get_latency_stats_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->can_recv_data = TRUE;
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_LATENCY_STATS;
+	struct pgm_latencyinfo_t li;
+	memset (&li, 0, sizeof(li));
+	socklen_t optlen	= sizeof(li);
+	fail_unless (FALSE == pgm_getsockopt (sock, level, optname, &li, &optlen), "get_latency_stats failed");
+}
+END_TEST
+
+/* unknown peer */
+START_TEST (test_get_latency_stats_fail_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_connected = TRUE;
+	sock->can_recv_data = TRUE;
+	sock->peers_table = pgm_tsitable_new ();
+	pgm_rwlock_init (&sock->peers_lock);
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_LATENCY_STATS;
+	const pgm_tsi_t tsi	= { { 9, 8, 7, 6, 5, 4 }, g_htons(1000) };
+	struct pgm_latencyinfo_t li;
+	memset (&li, 0, sizeof(li));
+	li.li_tsi		= tsi;
+	socklen_t optlen	= sizeof(li);
+	fail_unless (FALSE == pgm_getsockopt (sock, level, optname, &li, &optlen), "get_latency_stats failed");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_setsockopt (
+ *		pgm_sock_t* const	sock,
+ *		const int		level = IPPROTO_PGM,
+ *		const int		optname = PGM_RECV_BATCH,
+ *		const void*		optval,
+ *		const socklen_t		optlen = sizeof(int)
+ *	)
+ */
+
+START_TEST (test_set_recv_batch_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_RECV_BATCH;
+	const int recv_batch	= 16;
+	const void* optval	= &recv_batch;
+	const socklen_t optlen	= sizeof(recv_batch);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_recv_batch failed");
+	fail_unless (16 == sock->recv_batch, "recv_batch not set");
+}
+END_TEST
+
+START_TEST (test_set_recv_batch_fail_001)
+{
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_RECV_BATCH;
+	const int recv_batch	= 16;
+	const void* optval	= &recv_batch;
+	const socklen_t optlen	= sizeof(recv_batch);
+	fail_unless (FALSE == pgm_setsockopt (NULL, level, optname, optval, optlen), "set_recv_batch failed");
+}
+END_TEST
+
+/* 0 < recv_batch <= PGM_MAX_RECV_BATCH */
+START_TEST (test_set_recv_batch_fail_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->recv_batch = 1;
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_RECV_BATCH;
+	int recv_batch		= 0;
+	const void* optval	= &recv_batch;
+	const socklen_t optlen	= sizeof(recv_batch);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_recv_batch failed");
+	recv_batch = PGM_MAX_RECV_BATCH + 1;
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_recv_batch failed");
+	fail_unless (1 == sock->recv_batch, "recv_batch changed");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_getsockopt (
+ *		pgm_sock_t* const	sock,
+ *		const int		level = IPPROTO_PGM,
+ *		const int		optname = PGM_RECV_BATCH_STATS,
+ *		void*			optval,
+ *		socklen_t*		optlen = sizeof(struct pgm_batchinfo_t)
+ *	)
+ */
+
+START_TEST (test_get_recv_batch_stats_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_connected = TRUE;
+	pgm_mutex_init (&sock->receiver_mutex);
+	sock->rx_batch_calls = 4;
+	sock->rx_batch_datagrams = 100;
+	sock->rx_batch_discarded = 2;
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_RECV_BATCH_STATS;
+	struct pgm_batchinfo_t bi;
+	memset (&bi, 0, sizeof(bi));
+	socklen_t optlen	= sizeof(bi);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &bi, &optlen), "get_recv_batch_stats failed");
+	fail_unless (4 == bi.bi_calls, "calls mismatch");
+	fail_unless (100 == bi.bi_datagrams, "datagrams mismatch");
+	fail_unless (2 == bi.bi_discarded, "discarded mismatch");
+}
+END_TEST
+
+/* not connected */
+START_TEST (test_get_recv_batch_stats_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_RECV_BATCH_STATS;
+	struct pgm_batchinfo_t bi;
+	socklen_t optlen	= sizeof(bi);
+	fail_unless (FALSE == pgm_getsockopt (sock, level, optname, &bi, &optlen), "get_recv_batch_stats failed");
+}
+END_TEST
+
+/* invalid length */
+START_TEST (test_get_recv_batch_stats_fail_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_connected = TRUE;
+	pgm_mutex_init (&sock->receiver_mutex);
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_RECV_BATCH_STATS;
+	struct pgm_batchinfo_t bi;
+	socklen_t optlen	= sizeof(bi) - 1;
+	fail_unless (FALSE == pgm_getsockopt (sock, level, optname, &bi, &optlen), "get_recv_batch_stats failed");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_getsockopt (
+ *		pgm_sock_t* const	sock,
+ *		const int		level = IPPROTO_PGM,
+ *		const int		optname = PGM_SKB_POOL_STATS,
+ *		void*			optval,
+ *		socklen_t*		optlen = sizeof(struct pgm_poolinfo_t)
+ *	)
+ */
+
+START_TEST (test_get_skb_pool_stats_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	sock->skb_pool = pgm_skb_pool_create (1500, 8);
+	struct pgm_sk_buff_t* skb[3];
+	for (unsigned i = 0; i < G_N_ELEMENTS(skb); i++)
+		skb[i] = pgm_skb_pool_alloc (sock->skb_pool, 1500);
+	pgm_free_skb (skb[0]);
+	skb[0] = pgm_skb_pool_alloc (sock->skb_pool, 1500);
+	pgm_free_skb (skb[1]);
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_SKB_POOL_STATS;
+	struct pgm_poolinfo_t pi;
+	memset (&pi, 0, sizeof(pi));
+	socklen_t optlen	= sizeof(pi);
+	fail_unless (TRUE == pgm_getsockopt (sock, level, optname, &pi, &optlen), "get_skb_pool_stats failed");
+	fail_unless (1 == pi.pi_hits, "hits mismatch");
+	fail_unless (3 == pi.pi_misses, "misses mismatch");
+	fail_unless (1 == pi.pi_free, "free mismatch");
+	fail_unless (2 == pi.pi_outstanding, "outstanding mismatch");
+	pgm_free_skb (skb[0]);
+	pgm_free_skb (skb[2]);
+	pgm_skb_pool_destroy (sock->skb_pool);
+}
+END_TEST
+
+/* not bound */
+START_TEST (test_get_skb_pool_stats_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_SKB_POOL_STATS;
+	struct pgm_poolinfo_t pi;
+	socklen_t optlen	= sizeof(pi);
+	fail_unless (FALSE == pgm_getsockopt (sock, level, optname, &pi, &optlen), "get_skb_pool_stats failed");
+}
+END_TEST
+
+/* invalid length */
+START_TEST (test_get_skb_pool_stats_fail_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	sock->skb_pool = pgm_skb_pool_create (1500, 8);
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_SKB_POOL_STATS;
+	struct pgm_poolinfo_t pi;
+	socklen_t optlen	= sizeof(pi) - 1;
+	fail_unless (FALSE == pgm_getsockopt (sock, level, optname, &pi, &optlen), "get_skb_pool_stats failed");
+	pgm_skb_pool_destroy (sock->skb_pool);
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_setsockopt (
+ *		pgm_sock_t* const	sock,
+ *		const int		level = IPPROTO_PGM,
+ *		const int		optname = PGM_SINGLE_THREAD,
+ *		const void*		optval,
+ *		const socklen_t		optlen = sizeof(int)
+ *	)
+ */
+
+START_TEST (test_set_single_thread_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_SINGLE_THREAD;
+	const int single	= 1;
+	const void* optval	= &single;
+	const socklen_t optlen	= sizeof(single);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_single_thread failed");
+	fail_unless (TRUE == sock->is_single_threaded, "is_single_threaded not set");
+}
+END_TEST
+
+START_TEST (test_set_single_thread_fail_001)
+{
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_SINGLE_THREAD;
+	const int single	= 1;
+	const void* optval	= &single;
+	const socklen_t optlen	= sizeof(single);
+	fail_unless (FALSE == pgm_setsockopt (NULL, level, optname, optval, optlen), "set_single_thread failed");
+}
+END_TEST
+
+/* locks are in use once bound */
+START_TEST (test_set_single_thread_fail_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_SINGLE_THREAD;
+	const int single	= 1;
+	const void* optval	= &single;
+	const socklen_t optlen	= sizeof(single);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_single_thread failed");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_setsockopt (
+ *		pgm_sock_t* const	sock,
+ *		const int		level = IPPROTO_PGM,
+ *		const int		optname = PGM_COALESCE,
+ *		const void*		optval,
+ *		const socklen_t		optlen = sizeof(int)
+ *	)
+ */
+
+START_TEST (test_set_coalesce_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_COALESCE;
+	const int coalesce_ivl	= 200;
+	const void* optval	= &coalesce_ivl;
+	const socklen_t optlen	= sizeof(coalesce_ivl);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_coalesce failed");
+	fail_unless (200 == sock->coalesce_ivl, "coalesce_ivl not set");
+}
+END_TEST
+
+START_TEST (test_set_coalesce_fail_001)
+{
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_COALESCE;
+	const int coalesce_ivl	= 200;
+	const void* optval	= &coalesce_ivl;
+	const socklen_t optlen	= sizeof(coalesce_ivl);
+	fail_unless (FALSE == pgm_setsockopt (NULL, level, optname, optval, optlen), "set_coalesce failed");
+}
+END_TEST
+
+/* negative hold time */
+START_TEST (test_set_coalesce_fail_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_COALESCE;
+	const int coalesce_ivl	= -1;
+	const void* optval	= &coalesce_ivl;
+	const socklen_t optlen	= sizeof(coalesce_ivl);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_coalesce failed");
+}
+END_TEST
+
+/* packet layout is fixed once bound */
+START_TEST (test_set_coalesce_fail_003)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_COALESCE;
+	const int coalesce_ivl	= 200;
+	const void* optval	= &coalesce_ivl;
+	const socklen_t optlen	= sizeof(coalesce_ivl);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_coalesce failed");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_setsockopt (
+ *		pgm_sock_t* const	sock,
+ *		const int		level = IPPROTO_PGM,
+ *		const int		optname = PGM_ZEROCOPY,
+ *		const void*		optval,
+ *		const socklen_t		optlen = sizeof(int)
+ *	)
+ */
+
+/* zero disables zero-copy transmit without touching the descriptors */
+START_TEST (test_set_zerocopy_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->zerocopy_min = 8192;
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_ZEROCOPY;
+	const int zerocopy_min	= 0;
+	const void* optval	= &zerocopy_min;
+	const socklen_t optlen	= sizeof(zerocopy_min);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_zerocopy failed");
+	fail_unless (0 == sock->zerocopy_min, "zerocopy_min not cleared");
+}
+END_TEST
+
+START_TEST (test_set_zerocopy_fail_001)
+{
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_ZEROCOPY;
+	const int zerocopy_min	= 8192;
+	const void* optval	= &zerocopy_min;
+	const socklen_t optlen	= sizeof(zerocopy_min);
+	fail_unless (FALSE == pgm_setsockopt (NULL, level, optname, optval, optlen), "set_zerocopy failed");
+}
+END_TEST
+
+/* negative threshold */
+START_TEST (test_set_zerocopy_fail_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_ZEROCOPY;
+	const int zerocopy_min	= -1;
+	const void* optval	= &zerocopy_min;
+	const socklen_t optlen	= sizeof(zerocopy_min);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_zerocopy failed");
+}
+END_TEST
+
+/* pin ring is sized at bind */
+START_TEST (test_set_zerocopy_fail_003)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_ZEROCOPY;
+	const int zerocopy_min	= 8192;
+	const void* optval	= &zerocopy_min;
+	const socklen_t optlen	= sizeof(zerocopy_min);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_zerocopy failed");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_setsockopt (
+ *		pgm_sock_t* const	sock,
+ *		const int		level = IPPROTO_PGM,
+ *		const int		optname = PGM_UDP_GSO,
+ *		const void*		optval,
+ *		const socklen_t		optlen = sizeof(int)
+ *	)
+ */
+
+START_TEST (test_set_udp_gso_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_UDP_GSO;
+	const int udp_gso	= 0;
+	const void* optval	= &udp_gso;
+	const socklen_t optlen	= sizeof(udp_gso);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_udp_gso failed");
+	fail_unless (FALSE == sock->use_udp_gso, "use_udp_gso set");
+}
+END_TEST
+
+START_TEST (test_set_udp_gso_fail_001)
+{
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_UDP_GSO;
+	const int udp_gso	= 1;
+	const void* optval	= &udp_gso;
+	const socklen_t optlen	= sizeof(udp_gso);
+	fail_unless (FALSE == pgm_setsockopt (NULL, level, optname, optval, optlen), "set_udp_gso failed");
+}
+END_TEST
+
+/* must be set before bind */
+START_TEST (test_set_udp_gso_fail_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_UDP_GSO;
+	const int udp_gso	= 1;
+	const void* optval	= &udp_gso;
+	const socklen_t optlen	= sizeof(udp_gso);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_udp_gso failed");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_setsockopt (
+ *		pgm_sock_t* const	sock,
+ *		const int		level = IPPROTO_PGM,
+ *		const int		optname = PGM_UDP_GRO,
+ *		const void*		optval,
+ *		const socklen_t		optlen = sizeof(int)
+ *	)
+ */
+
+START_TEST (test_set_udp_gro_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_UDP_GRO;
+	const int udp_gro	= 0;
+	const void* optval	= &udp_gro;
+	const socklen_t optlen	= sizeof(udp_gro);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_udp_gro failed");
+	fail_unless (FALSE == sock->use_udp_gro, "use_udp_gro set");
+}
+END_TEST
+
+START_TEST (test_set_udp_gro_fail_001)
+{
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_UDP_GRO;
+	const int udp_gro	= 1;
+	const void* optval	= &udp_gro;
+	const socklen_t optlen	= sizeof(udp_gro);
+	fail_unless (FALSE == pgm_setsockopt (NULL, level, optname, optval, optlen), "set_udp_gro failed");
+}
+END_TEST
+
+/* must be set before bind */
+START_TEST (test_set_udp_gro_fail_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_UDP_GRO;
+	const int udp_gro	= 1;
+	const void* optval	= &udp_gro;
+	const socklen_t optlen	= sizeof(udp_gro);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_udp_gro failed");
+}
+END_TEST
+
+/* not with a shared receive socket */
+START_TEST (test_set_udp_gro_fail_003)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->use_demux = TRUE;
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_UDP_GRO;
+	const int udp_gro	= 1;
+	const void* optval	= &udp_gro;
+	const socklen_t optlen	= sizeof(udp_gro);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_udp_gro failed");
+	fail_unless (FALSE == sock->use_udp_gro, "use_udp_gro set");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_setsockopt (
+ *		pgm_sock_t* const	sock,
+ *		const int		level = IPPROTO_PGM,
+ *		const int		optname = PGM_RECV_TIMESTAMP,
+ *		const void*		optval,
+ *		const socklen_t		optlen = sizeof(int)
+ *	)
+ */
+
+START_TEST (test_set_recv_timestamp_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_RECV_TIMESTAMP;
+	const int recv_timestamp = 0;
+	const void* optval	= &recv_timestamp;
+	const socklen_t optlen	= sizeof(recv_timestamp);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_recv_timestamp failed");
+	fail_unless (FALSE == sock->use_kernel_tstamp, "use_kernel_tstamp set");
+}
+END_TEST
+
+START_TEST (test_set_recv_timestamp_fail_001)
+{
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_RECV_TIMESTAMP;
+	const int recv_timestamp = 1;
+	const void* optval	= &recv_timestamp;
+	const socklen_t optlen	= sizeof(recv_timestamp);
+	fail_unless (FALSE == pgm_setsockopt (NULL, level, optname, optval, optlen), "set_recv_timestamp failed");
+}
+END_TEST
+
+/* must be set before bind */
+START_TEST (test_set_recv_timestamp_fail_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_RECV_TIMESTAMP;
+	const int recv_timestamp = 1;
+	const void* optval	= &recv_timestamp;
+	const socklen_t optlen	= sizeof(recv_timestamp);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_recv_timestamp failed");
+}
+END_TEST
+
+/* not with a shared receive socket */
+START_TEST (test_set_recv_timestamp_fail_003)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->use_demux = TRUE;
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_RECV_TIMESTAMP;
+	const int recv_timestamp = 1;
+	const void* optval	= &recv_timestamp;
+	const socklen_t optlen	= sizeof(recv_timestamp);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_recv_timestamp failed");
+	fail_unless (FALSE == sock->use_kernel_tstamp, "use_kernel_tstamp set");
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_setsockopt (
+ *		pgm_sock_t* const	sock,
+ *		const int		level = IPPROTO_PGM,
+ *		const int		optname = PGM_TXW_LOCKLESS,
+ *		const void*		optval,
+ *		const socklen_t		optlen = sizeof(int)
+ *	)
+ */
+
+START_TEST (test_set_txw_lockless_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_TXW_LOCKLESS;
+	const int txw_lockless	= 1;
+	const void* optval	= &txw_lockless;
+	const socklen_t optlen	= sizeof(txw_lockless);
+	fail_unless (TRUE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_txw_lockless failed");
+	fail_unless (TRUE == sock->use_lockless_txw, "use_lockless_txw not set");
+	fail_unless (INVALID_SOCKET == sock->repair_sock, "repair socket opened before bind");
+}
+END_TEST
+
+START_TEST (test_set_txw_lockless_fail_001)
+{
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_TXW_LOCKLESS;
+	const int txw_lockless	= 1;
+	const void* optval	= &txw_lockless;
+	const socklen_t optlen	= sizeof(txw_lockless);
+	fail_unless (FALSE == pgm_setsockopt (NULL, level, optname, optval, optlen), "set_txw_lockless failed");
+}
+END_TEST
+
+/* must be set before bind */
+START_TEST (test_set_txw_lockless_fail_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	const int level		= IPPROTO_PGM;
+	const int optname	= PGM_TXW_LOCKLESS;
+	const int txw_lockless	= 1;
+	const void* optval	= &txw_lockless;
+	const socklen_t optlen	= sizeof(txw_lockless);
+	fail_unless (FALSE == pgm_setsockopt (sock, level, optname, optval, optlen), "set_txw_lockless failed");
+	fail_unless (FALSE == sock->use_lockless_txw, "use_lockless_txw set");
+}
+END_TEST
+
 static
 Suite*
 make_test_suite (void)
@@ -1275,6 +2145,103 @@ make_test_suite (void)
 	tcase_add_test (tc_set_udp_multicast, test_set_udp_multicast_pass_001);
 	tcase_add_test (tc_set_udp_multicast, test_set_udp_multicast_fail_001);
 
+	TCase* tc_set_recv_demux = tcase_create ("set-recv-demux");
+	suite_add_tcase (s, tc_set_recv_demux);
+	tcase_add_checked_fixture (tc_set_recv_demux, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_recv_demux, test_set_recv_demux_pass_001);
+	tcase_add_test (tc_set_recv_demux, test_set_recv_demux_pass_002);
+	tcase_add_test (tc_set_recv_demux, test_set_recv_demux_fail_001);
+	tcase_add_test (tc_set_recv_demux, test_set_recv_demux_fail_002);
+	tcase_add_test (tc_set_recv_demux, test_set_recv_demux_fail_003);
+
+	TCase* tc_set_rate_pacing = tcase_create ("set-rate-pacing");
+	suite_add_tcase (s, tc_set_rate_pacing);
+	tcase_add_checked_fixture (tc_set_rate_pacing, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_rate_pacing, test_set_rate_pacing_pass_001);
+	tcase_add_test (tc_set_rate_pacing, test_set_rate_pacing_fail_001);
+	tcase_add_test (tc_set_rate_pacing, test_set_rate_pacing_fail_002);
+
+	TCase* tc_get_latency_stats = tcase_create ("get-latency-stats");
+	suite_add_tcase (s, tc_get_latency_stats);
+	tcase_add_checked_fixture (tc_get_latency_stats, mock_setup, mock_teardown);
+	tcase_add_test (tc_get_latency_stats, test_get_latency_stats_pass_001);
+	tcase_add_test (tc_get_latency_stats, test_get_latency_stats_fail_001);
+	tcase_add_test (tc_get_latency_stats, test_get_latency_stats_fail_002);
+
+	TCase* tc_set_recv_batch = tcase_create ("set-recv-batch");
+	suite_add_tcase (s, tc_set_recv_batch);
+	tcase_add_checked_fixture (tc_set_recv_batch, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_recv_batch, test_set_recv_batch_pass_001);
+	tcase_add_test (tc_set_recv_batch, test_set_recv_batch_fail_001);
+	tcase_add_test (tc_set_recv_batch, test_set_recv_batch_fail_002);
+
+	TCase* tc_get_recv_batch_stats = tcase_create ("get-recv-batch-stats");
+	suite_add_tcase (s, tc_get_recv_batch_stats);
+	tcase_add_checked_fixture (tc_get_recv_batch_stats, mock_setup, mock_teardown);
+	tcase_add_test (tc_get_recv_batch_stats, test_get_recv_batch_stats_pass_001);
+	tcase_add_test (tc_get_recv_batch_stats, test_get_recv_batch_stats_fail_001);
+	tcase_add_test (tc_get_recv_batch_stats, test_get_recv_batch_stats_fail_002);
+
+	TCase* tc_get_skb_pool_stats = tcase_create ("get-skb-pool-stats");
+	suite_add_tcase (s, tc_get_skb_pool_stats);
+	tcase_add_checked_fixture (tc_get_skb_pool_stats, mock_setup, mock_teardown);
+	tcase_add_test (tc_get_skb_pool_stats, test_get_skb_pool_stats_pass_001);
+	tcase_add_test (tc_get_skb_pool_stats, test_get_skb_pool_stats_fail_001);
+	tcase_add_test (tc_get_skb_pool_stats, test_get_skb_pool_stats_fail_002);
+
+	TCase* tc_set_single_thread = tcase_create ("set-single-thread");
+	suite_add_tcase (s, tc_set_single_thread);
+	tcase_add_checked_fixture (tc_set_single_thread, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_single_thread, test_set_single_thread_pass_001);
+	tcase_add_test (tc_set_single_thread, test_set_single_thread_fail_001);
+	tcase_add_test (tc_set_single_thread, test_set_single_thread_fail_002);
+
+	TCase* tc_set_coalesce = tcase_create ("set-coalesce");
+	suite_add_tcase (s, tc_set_coalesce);
+	tcase_add_checked_fixture (tc_set_coalesce, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_coalesce, test_set_coalesce_pass_001);
+	tcase_add_test (tc_set_coalesce, test_set_coalesce_fail_001);
+	tcase_add_test (tc_set_coalesce, test_set_coalesce_fail_002);
+	tcase_add_test (tc_set_coalesce, test_set_coalesce_fail_003);
+
+	TCase* tc_set_zerocopy = tcase_create ("set-zerocopy");
+	suite_add_tcase (s, tc_set_zerocopy);
+	tcase_add_checked_fixture (tc_set_zerocopy, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_zerocopy, test_set_zerocopy_pass_001);
+	tcase_add_test (tc_set_zerocopy, test_set_zerocopy_fail_001);
+	tcase_add_test (tc_set_zerocopy, test_set_zerocopy_fail_002);
+	tcase_add_test (tc_set_zerocopy, test_set_zerocopy_fail_003);
+
+	TCase* tc_set_udp_gso = tcase_create ("set-udp-gso");
+	suite_add_tcase (s, tc_set_udp_gso);
+	tcase_add_checked_fixture (tc_set_udp_gso, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_udp_gso, test_set_udp_gso_pass_001);
+	tcase_add_test (tc_set_udp_gso, test_set_udp_gso_fail_001);
+	tcase_add_test (tc_set_udp_gso, test_set_udp_gso_fail_002);
+
+	TCase* tc_set_udp_gro = tcase_create ("set-udp-gro");
+	suite_add_tcase (s, tc_set_udp_gro);
+	tcase_add_checked_fixture (tc_set_udp_gro, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_udp_gro, test_set_udp_gro_pass_001);
+	tcase_add_test (tc_set_udp_gro, test_set_udp_gro_fail_001);
+	tcase_add_test (tc_set_udp_gro, test_set_udp_gro_fail_002);
+	tcase_add_test (tc_set_udp_gro, test_set_udp_gro_fail_003);
+
+	TCase* tc_set_recv_timestamp = tcase_create ("set-recv-timestamp");
+	suite_add_tcase (s, tc_set_recv_timestamp);
+	tcase_add_checked_fixture (tc_set_recv_timestamp, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_recv_timestamp, test_set_recv_timestamp_pass_001);
+	tcase_add_test (tc_set_recv_timestamp, test_set_recv_timestamp_fail_001);
+	tcase_add_test (tc_set_recv_timestamp, test_set_recv_timestamp_fail_002);
+	tcase_add_test (tc_set_recv_timestamp, test_set_recv_timestamp_fail_003);
+
+	TCase* tc_set_txw_lockless = tcase_create ("set-txw-lockless");
+	suite_add_tcase (s, tc_set_txw_lockless);
+	tcase_add_checked_fixture (tc_set_txw_lockless, mock_setup, mock_teardown);
+	tcase_add_test (tc_set_txw_lockless, test_set_txw_lockless_pass_001);
+	tcase_add_test (tc_set_txw_lockless, test_set_txw_lockless_fail_001);
+	tcase_add_test (tc_set_txw_lockless, test_set_txw_lockless_fail_002);
+
 	return s;
 }
 
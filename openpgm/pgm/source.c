@@ -45,9 +45,9 @@ static inline bool peer_is_peer (const pgm_peer_t*) PGM_GNUC_CONST;
 static void reset_heartbeat_spm (pgm_sock_t*const, const pgm_time_t);
 static bool send_ncf (pgm_sock_t*const restrict, const struct sockaddr*const restrict, const struct sockaddr*const restrict, const uint32_t, const bool);
 static bool send_ncf_list (pgm_sock_t*const restrict, const struct sockaddr*const restrict, const struct sockaddr*const restrict, struct pgm_sqn_list_t*const restrict, const bool);
-static int send_odata (pgm_sock_t*const restrict, struct pgm_sk_buff_t*const restrict, size_t*restrict);
-static int send_odata_copy (pgm_sock_t*const restrict, const void*restrict, const uint16_t, size_t*restrict);
-static int send_odatav (pgm_sock_t*const restrict, const struct pgm_iovec*const restrict, const unsigned, size_t*restrict);
+static int send_odata (pgm_sock_t*const restrict, struct pgm_sk_buff_t*const restrict, pgm_time_t*restrict, size_t*restrict);
+static int send_odata_copy (pgm_sock_t*const restrict, const void*restrict, const uint16_t, pgm_time_t*restrict, size_t*restrict);
+static int send_odatav (pgm_sock_t*const restrict, const struct pgm_iovec*const restrict, const unsigned, pgm_time_t*restrict, size_t*restrict);
 static bool send_rdata (pgm_sock_t*restrict, struct pgm_sk_buff_t*restrict);
 
 
@@ -110,6 +110,26 @@ source_max_tsdu (
 	return max_tsdu;
 }
 
+/* append to the transmit window, serialised against the repair thread unless
+ * the window publishes lead with atomics.  parity is folded in beforehand so
+ * that no encoding happens under the window lock.
+ */
+
+static inline
+void
+txw_add (
+	pgm_sock_t*		  const restrict sock,
+	struct pgm_sk_buff_t* const restrict skb
+	)
+{
+	pgm_txw_fold_parity (sock->window, skb);
+	if (!sock->use_lockless_txw)
+		pgm_sock_spinlock_lock (sock, &sock->txw_spinlock);
+	pgm_txw_add (sock->window, skb);
+	if (!sock->use_lockless_txw)
+		pgm_sock_spinlock_unlock (sock, &sock->txw_spinlock);
+}
+
 /* prototype of function to send pro-active parity NAKs.
  */
 
@@ -158,11 +178,16 @@ pgm_on_deferred_nak (
 /* peek from the retransmit queue so we can eliminate duplicate NAKs up until the repair packet
  * has been retransmitted.
  */
-	pgm_spinlock_lock (&sock->txw_spinlock);
+/* zero-copy sends pin packets as in transit until their completions are read */
+	if (sock->zerocopy_min)
+		pgm_zerocopy_reap (sock);
+	if (!sock->use_lockless_txw)
+		pgm_sock_spinlock_lock (sock, &sock->txw_spinlock);
 	skb = pgm_txw_retransmit_try_peek (sock->window);
 	if (skb) {
 		skb = pgm_skb_get (skb);
-		pgm_spinlock_unlock (&sock->txw_spinlock);
+		if (!sock->use_lockless_txw)
+			pgm_sock_spinlock_unlock (sock, &sock->txw_spinlock);
 		if (!send_rdata (sock, skb)) {
 			pgm_free_skb (skb);
 			pgm_notify_send (&sock->rdata_notify);
@@ -171,8 +196,8 @@ pgm_on_deferred_nak (
 		pgm_free_skb (skb);
 /* now remove sequence number from retransmit queue, re-enabling NAK processing for this sequence number */
 		pgm_txw_retransmit_remove_head (sock->window);
-	} else
-		pgm_spinlock_unlock (&sock->txw_spinlock);
+	} else if (!sock->use_lockless_txw)
+		pgm_sock_spinlock_unlock (sock, &sock->txw_spinlock);
 	return TRUE;
 }
 
@@ -815,6 +840,7 @@ pgm_send_spm (
 	sent = pgm_sendto (sock,
 			   flags != PGM_OPT_SYN && sock->is_controlled_spm,	/* rate limited */
 			   NULL,
+			   NULL,
 			   TRUE,		/* with router alert */
 			   buf,
 			   tpdu_length,
@@ -908,6 +934,7 @@ send_ncf (
 	sent = pgm_sendto (sock,
 			   FALSE,			/* not rate limited */
 			   NULL,
+			   NULL,
 			   TRUE,			/* with router alert */
 			   buf,
 			   tpdu_length,
@@ -1023,6 +1050,7 @@ send_ncf_list (
 	sent = pgm_sendto (sock,
 			   FALSE,			/* not rate limited */
 			   NULL,
+			   NULL,
 			   TRUE,			/* with router alert */
 			   buf,
 			   tpdu_length,
@@ -1046,7 +1074,7 @@ reset_heartbeat_spm (
 	const pgm_time_t	now
 	)
 {
-	pgm_mutex_lock (&sock->timer_mutex);
+	pgm_sock_mutex_lock (sock, &sock->timer_mutex);
 	const pgm_time_t next_poll = sock->next_poll;
 	const pgm_time_t spm_heartbeat_interval = sock->spm_heartbeat_interval[ sock->spm_heartbeat_state = 1 ];
 	sock->next_heartbeat_spm = now + spm_heartbeat_interval;
@@ -1058,13 +1086,101 @@ reset_heartbeat_spm (
 			sock->is_pending_read = TRUE;
 		}
 	}
-	pgm_mutex_unlock (&sock->timer_mutex);
+	pgm_sock_mutex_unlock (sock, &sock->timer_mutex);
 }
 
 /* state helper for resuming sends
  */
 #define STATE(x)	(sock->pkt_dontwait_state.x)
 
+/* send the pending APDU fragments of the odata batch, resuming after any
+ * fragments already sent.  a batch of one uses the regular send path, as does
+ * each fragment when pacing.  now is the time of the API call, refreshed by
+ * the rate check when it has to wait.
+ *
+ * on success, returns TRUE.  on block for non-blocking sockets or when rate
+ * limited returns FALSE and sets errno appropriately.
+ */
+
+static
+bool
+send_odata_batch (
+	pgm_sock_t*	const restrict	sock,
+	pgm_time_t*	      restrict	now,
+	size_t*		      restrict	bytes_sent,
+	unsigned*	      restrict	packets_sent,
+	size_t*		      restrict	data_bytes_sent
+	)
+{
+	const struct sockaddr* to = (const struct sockaddr*)&sock->send_gsr.gsr_group;
+	const socklen_t tolen = pgm_sockaddr_len (to);
+
+	while (STATE(batch_offset) < STATE(batch_len))
+	{
+		struct pgm_sk_buff_t**const skbs = &sock->odata_batch[ STATE(batch_offset) ];
+/* paced sockets space out every fragment rather than the whole batch */
+		const unsigned count = (sock->use_pacing && !STATE(is_rate_limited)) ? 1 : STATE(batch_len) - STATE(batch_offset);
+		unsigned done;
+		ssize_t sent;
+
+		if (1 == count) {
+			const size_t tpdu_length = (char*)skbs[0]->tail - (char*)skbs[0]->head;
+			sent = pgm_sendto_skb (sock,
+					       !STATE(is_rate_limited),	/* rate limit on blocking */
+					       &sock->odata_rate_control,
+					       now,
+					       FALSE,			/* regular socket */
+					       skbs[0],
+					       to,
+					       tolen);
+			if (sent >= 0)
+				sent = ((size_t)sent == tpdu_length) ? 1 : 0;
+		} else {
+			sent = pgm_sendmmsg (sock,
+					     !STATE(is_rate_limited),	/* rate limit on blocking */
+					     &sock->odata_rate_control,
+					     now,
+					     skbs,
+					     count,
+					     to,
+					     tolen);
+		}
+		if (sent < 0) {
+			const int save_errno = pgm_get_last_sock_error();
+			if (PGM_LIKELY(PGM_SOCK_EAGAIN == save_errno || PGM_SOCK_ENOBUFS == save_errno))
+			{
+				sock->blocklen = 0;
+				for (unsigned i = 0; i < count; i++)
+					sock->blocklen += (char*)skbs[i]->tail - (char*)skbs[i]->head + sock->iphdr_len;
+				pgm_set_last_sock_error (save_errno);
+				return FALSE;
+			}
+/* fall through silently on other errors */
+			done = count;
+		} else {
+			done = (1 == count) ? 1 : (unsigned)sent;
+			for (unsigned i = 0; i < (unsigned)sent; i++) {
+				*bytes_sent += (char*)skbs[i]->tail - (char*)skbs[i]->head + sock->iphdr_len;	/* as counted at IP layer */
+				(*packets_sent)++;								/* IP packets */
+				*data_bytes_sent += ntohs (skbs[i]->pgm_header->pgm_tsdu_length);
+			}
+		}
+
+/* check for end of transmission group */
+		if (sock->use_proactive_parity) {
+			const uint32_t tg_sqn_mask = 0xffffffff << sock->tg_sqn_shift;
+			for (unsigned i = 0; i < done; i++) {
+				const uint32_t odata_sqn = ntohl (skbs[i]->pgm_data->data_sqn);
+				if (!((odata_sqn + 1) & ~tg_sqn_mask))
+					pgm_schedule_proactive_nak (sock, odata_sqn & tg_sqn_mask);
+			}
+		}
+
+		STATE(batch_offset) += done;
+	}
+	return TRUE;
+}
+
 /* send one PGM data packet, transmit window owned memory.
  *
  * On success, returns PGM_IO_STATUS_NORMAL and the number of data bytes pushed
@@ -1083,6 +1199,7 @@ int
 send_odata (
 	pgm_sock_t*           const restrict sock,
 	struct pgm_sk_buff_t* const restrict skb,
+	pgm_time_t*		    restrict now,
 	size_t*			    restrict bytes_written
 	)
 {
@@ -1103,14 +1220,14 @@ send_odata (
 
 /* continue if send would block */
 	if (sock->is_apdu_eagain) {
-		STATE(skb)->tstamp = pgm_time_update_now();
+		STATE(skb)->tstamp = *now;
 		goto retry_send;
 	}
 
 /* add PGM header to skbuff */
 	STATE(skb) = pgm_skb_get(skb);
 	STATE(skb)->sock = sock;
-	STATE(skb)->tstamp = pgm_time_update_now();
+	STATE(skb)->tstamp = *now;
 
 	STATE(skb)->pgm_header = (struct pgm_header*)STATE(skb)->head;
 	STATE(skb)->pgm_data   = (struct pgm_data*)(STATE(skb)->pgm_header + 1);
@@ -1157,9 +1274,7 @@ send_odata (
         STATE(skb)->pgm_header->pgm_checksum	= pgm_csum_fold (pgm_csum_block_add (unfolded_header, STATE(unfolded_odata), (uint16_t)pgm_header_len));
 
 /* add to transmit window, skb::data set to payload */
-	pgm_spinlock_lock (&sock->txw_spinlock);
-	pgm_txw_add (sock->window, STATE(skb));
-	pgm_spinlock_unlock (&sock->txw_spinlock);
+	txw_add (sock, STATE(skb));
 
 /* check rate limit at last moment */
 	STATE(is_rate_limited) = FALSE;
@@ -1168,7 +1283,8 @@ send_odata (
 		if (!pgm_rate_check2 (&sock->rate_control,		/* total rate limit */
 				      &sock->odata_rate_control,	/* original data limit */
 				      tpdu_length,			/* excludes IP header len */
-				      sock->is_nonblocking))
+				      sock->is_nonblocking,
+				      now))
 		{
 			sock->is_apdu_eagain = TRUE;
 			sock->blocklen = tpdu_length + sock->iphdr_len;
@@ -1192,14 +1308,14 @@ retry_send:
 		return PGM_IO_STATUS_CONGESTION;	/* peer expiration to re-elect ACKer */
 	}
 
-	sent = pgm_sendto (sock,
-			   !STATE(is_rate_limited),	/* rate limit on blocking */
-			   &sock->odata_rate_control,
-			   FALSE,			/* regular socket */
-			   STATE(skb)->head,
-			   tpdu_length,
-			   (struct sockaddr*)&sock->send_gsr.gsr_group,
-			   pgm_sockaddr_len((struct sockaddr*)&sock->send_gsr.gsr_group));
+	sent = pgm_sendto_skb (sock,
+			       !STATE(is_rate_limited),	/* rate limit on blocking */
+			       &sock->odata_rate_control,
+			       now,
+			       FALSE,			/* regular socket */
+			       STATE(skb),
+			       (struct sockaddr*)&sock->send_gsr.gsr_group,
+			       pgm_sockaddr_len((struct sockaddr*)&sock->send_gsr.gsr_group));
 	if (sent < 0) {
 		const int save_errno = pgm_get_last_sock_error();
 		if (PGM_LIKELY(PGM_SOCK_EAGAIN == save_errno || PGM_SOCK_ENOBUFS == save_errno))
@@ -1259,6 +1375,7 @@ send_odata_copy (
 	pgm_sock_t*      const restrict	sock,
 	const void*	       restrict	tsdu,
 	const uint16_t			tsdu_length,
+	pgm_time_t*	       restrict	now,
 	size_t*		       restrict	bytes_written
 	)
 {
@@ -1278,13 +1395,13 @@ send_odata_copy (
 
 /* continue if blocked mid-apdu, updating timestamp */
 	if (sock->is_apdu_eagain) {
-		STATE(skb)->tstamp = pgm_time_update_now();
+		STATE(skb)->tstamp = *now;
 		goto retry_send;
 	}
 
-	STATE(skb) = pgm_alloc_skb (sock->max_tpdu);
+	STATE(skb) = pgm_skb_pool_alloc (sock->skb_pool, sock->max_tpdu);
 	STATE(skb)->sock = sock;
-	STATE(skb)->tstamp = pgm_time_update_now();
+	STATE(skb)->tstamp = *now;
 	pgm_skb_reserve (STATE(skb), (uint16_t)pgm_pkt_offset (FALSE, pgmcc_family));
 	pgm_skb_put (STATE(skb), (uint16_t)tsdu_length);
 
@@ -1334,9 +1451,7 @@ send_odata_copy (
 	STATE(skb)->pgm_header->pgm_checksum	= pgm_csum_fold (pgm_csum_block_add (unfolded_header, STATE(unfolded_odata), (uint16_t)pgm_header_len));
 
 /* add to transmit window, skb::data set to payload */
-	pgm_spinlock_lock (&sock->txw_spinlock);
-	pgm_txw_add (sock->window, STATE(skb));
-	pgm_spinlock_unlock (&sock->txw_spinlock);
+	txw_add (sock, STATE(skb));
 
 /* check rate limit at last moment */
 	STATE(is_rate_limited) = FALSE;
@@ -1345,7 +1460,8 @@ send_odata_copy (
 		if (!pgm_rate_check2 (&sock->rate_control,		/* total rate limit */
 				      &sock->odata_rate_control,	/* original data limit */
 				      tpdu_length,			/* excludes IP header len */
-				      sock->is_nonblocking))
+				      sock->is_nonblocking,
+				      now))
 		{
 			sock->is_apdu_eagain = TRUE;
 			sock->blocklen = tpdu_length + sock->iphdr_len;
@@ -1365,14 +1481,14 @@ retry_send:
 		return PGM_IO_STATUS_CONGESTION;
 	}
 
-	sent = pgm_sendto (sock,
-			   !STATE(is_rate_limited),	/* rate limit on blocking */
-			   &sock->odata_rate_control,
-			   FALSE,			/* regular socket */
-			   STATE(skb)->head,
-			   tpdu_length,
-			   (struct sockaddr*)&sock->send_gsr.gsr_group,
-			   pgm_sockaddr_len((struct sockaddr*)&sock->send_gsr.gsr_group));
+	sent = pgm_sendto_skb (sock,
+			       !STATE(is_rate_limited),	/* rate limit on blocking */
+			       &sock->odata_rate_control,
+			       now,
+			       FALSE,			/* regular socket */
+			       STATE(skb),
+			       (struct sockaddr*)&sock->send_gsr.gsr_group,
+			       pgm_sockaddr_len((struct sockaddr*)&sock->send_gsr.gsr_group));
 	if (sent < 0) {
 		const int save_errno = pgm_get_last_sock_error();
 		if (PGM_LIKELY(PGM_SOCK_EAGAIN == save_errno || PGM_SOCK_ENOBUFS == save_errno))
@@ -1438,6 +1554,7 @@ send_odatav (
 	pgm_sock_t*		const restrict sock,
 	const struct pgm_iovec* const restrict vector,
 	const unsigned			       count,		/* number of items in vector */
+	pgm_time_t*		      restrict now,
 	size_t*		 	      restrict bytes_written
 	)
 {
@@ -1454,7 +1571,7 @@ send_odatav (
 		(const void*)sock, (const void*)vector, count, (const void*)bytes_written);
 
 	if (PGM_UNLIKELY(0 == count))
-		return send_odata_copy (sock, NULL, 0, bytes_written);
+		return send_odata_copy (sock, NULL, 0, now, bytes_written);
 
 /* continue if blocked on send */
 	if (sock->is_apdu_eagain) {
@@ -1475,9 +1592,9 @@ send_odatav (
 	}
 	pgm_return_val_if_fail (STATE(tsdu_length) <= sock->max_tsdu, PGM_IO_STATUS_ERROR);
 
-	STATE(skb) = pgm_alloc_skb (sock->max_tpdu);
+	STATE(skb) = pgm_skb_pool_alloc (sock->skb_pool, sock->max_tpdu);
 	STATE(skb)->sock = sock;
-	STATE(skb)->tstamp = pgm_time_update_now();
+	STATE(skb)->tstamp = *now;
 	const sa_family_t pgmcc_family = sock->use_pgmcc ? sock->family : 0;
 	pgm_skb_reserve (STATE(skb), (uint16_t)pgm_pkt_offset (FALSE, pgmcc_family));
 	pgm_skb_put (STATE(skb), (uint16_t)STATE(tsdu_length));
@@ -1513,9 +1630,7 @@ send_odatav (
 	STATE(skb)->pgm_header->pgm_checksum	= pgm_csum_fold (pgm_csum_block_add (unfolded_header, STATE(unfolded_odata), (uint16_t)pgm_header_len));
 
 /* add to transmit window, skb::data set to payload */
-	pgm_spinlock_lock (&sock->txw_spinlock);
-	pgm_txw_add (sock->window, STATE(skb));
-	pgm_spinlock_unlock (&sock->txw_spinlock);
+	txw_add (sock, STATE(skb));
 
 	pgm_assert ((char*)STATE(skb)->tail > (char*)STATE(skb)->head);
 	tpdu_length = (char*)STATE(skb)->tail - (char*)STATE(skb)->head;
@@ -1527,7 +1642,8 @@ send_odatav (
 		if (!pgm_rate_check2 (&sock->rate_control,		/* total rate limit */
 				      &sock->odata_rate_control,	/* original data limit */
 				      tpdu_length,			/* excludes IP header len */
-				      sock->is_nonblocking))
+				      sock->is_nonblocking,
+				      now))
 		{
 			sock->is_apdu_eagain = TRUE;
 			sock->blocklen = tpdu_length + sock->iphdr_len;
@@ -1537,14 +1653,14 @@ send_odatav (
 	}
 
 retry_send:
-	sent = pgm_sendto (sock,
-			   !STATE(is_rate_limited),	/* rate limit on blocking */
-			   &sock->odata_rate_control,
-			   FALSE,			/* regular socket */
-			   STATE(skb)->head,
-			   tpdu_length,
-			   (struct sockaddr*)&sock->send_gsr.gsr_group,
-			   pgm_sockaddr_len((struct sockaddr*)&sock->send_gsr.gsr_group));
+	sent = pgm_sendto_skb (sock,
+			       !STATE(is_rate_limited),	/* rate limit on blocking */
+			       &sock->odata_rate_control,
+			       now,
+			       FALSE,			/* regular socket */
+			       STATE(skb),
+			       (struct sockaddr*)&sock->send_gsr.gsr_group,
+			       pgm_sockaddr_len((struct sockaddr*)&sock->send_gsr.gsr_group));
 	if (sent < 0) {
 		const int save_errno = pgm_get_last_sock_error();
 		if (PGM_LIKELY(PGM_SOCK_EAGAIN == save_errno || PGM_SOCK_ENOBUFS == save_errno))
@@ -1600,6 +1716,7 @@ send_apdu (
 	pgm_sock_t* 	 const restrict	sock,
 	const void*	       restrict	apdu,
 	const size_t			apdu_length,
+	pgm_time_t*	       restrict	now,
 	size_t*		       restrict	bytes_written
 	)
 {
@@ -1634,7 +1751,8 @@ send_apdu (
 		if (!pgm_rate_check2 (&sock->rate_control,
 				      &sock->odata_rate_control,
 				      tpdu_length - sock->iphdr_len,	/* includes 1 × IP header len */
-				      sock->is_nonblocking))
+				      sock->is_nonblocking,
+				      now))
 		{
 			sock->blocklen = tpdu_length;
 			return PGM_IO_STATUS_RATE_LIMITED;
@@ -1644,20 +1762,21 @@ send_apdu (
 
 	STATE(data_bytes_offset)	= 0;
 	STATE(first_sqn)		= pgm_txw_next_lead(sock->window);
+	STATE(batch_len)		= 0;
+	STATE(batch_offset)		= 0;
 
 	do {
-		size_t			 tpdu_length, header_length;
+		size_t			 header_length;
 		struct pgm_opt_header	*opt_header;
 		struct pgm_opt_length	*opt_len;
-		ssize_t			 sent;
 
 /* retrieve packet storage from transmit window */
 		header_length = pgm_pkt_offset (TRUE, pgmcc_family);
 		STATE(tsdu_length) = MIN( source_max_tsdu (sock, TRUE), apdu_length - STATE(data_bytes_offset) );
 
-		STATE(skb) = pgm_alloc_skb (sock->max_tpdu);
+		STATE(skb) = pgm_skb_pool_alloc (sock->skb_pool, sock->max_tpdu);
 		STATE(skb)->sock = sock;
-		STATE(skb)->tstamp = pgm_time_update_now();
+		STATE(skb)->tstamp = *now;
 		pgm_skb_reserve (STATE(skb), (uint16_t)header_length);
 		pgm_skb_put (STATE(skb), (uint16_t)STATE(tsdu_length));
 
@@ -1700,50 +1819,27 @@ send_apdu (
 		STATE(skb)->pgm_header->pgm_checksum	= pgm_csum_fold (pgm_csum_block_add (unfolded_header, STATE(unfolded_odata), (uint16_t)pgm_header_len));
 
 /* add to transmit window, skb::data set to payload */
-		pgm_spinlock_lock (&sock->txw_spinlock);
-		pgm_txw_add (sock->window, STATE(skb));
-		pgm_spinlock_unlock (&sock->txw_spinlock);
-
-retry_send:
-		pgm_assert ((char*)STATE(skb)->tail > (char*)STATE(skb)->head);
-		tpdu_length = (char*)STATE(skb)->tail - (char*)STATE(skb)->head;
-		sent = pgm_sendto (sock,
-				   !STATE(is_rate_limited),	/* rate limit on blocking */
-			   	   &sock->odata_rate_control,
-				   FALSE,			/* regular socket */
-				   STATE(skb)->head,
-				   tpdu_length,
-				   (struct sockaddr*)&sock->send_gsr.gsr_group,
-				   pgm_sockaddr_len((struct sockaddr*)&sock->send_gsr.gsr_group));
-		if (sent < 0) {
-			save_errno = pgm_get_last_sock_error();
-			if (PGM_LIKELY(PGM_SOCK_EAGAIN == save_errno || PGM_SOCK_ENOBUFS == save_errno))
-			{
-				sock->is_apdu_eagain = TRUE;
-				sock->blocklen = tpdu_length + sock->iphdr_len;
-				goto blocked;
-			}
-/* fall through silently on other errors */
-		}
+		txw_add (sock, STATE(skb));
 
 /* save unfolded odata for retransmissions */
 		pgm_txw_set_unfolded_checksum (STATE(skb), STATE(unfolded_odata));
 
-		if (PGM_LIKELY((size_t)sent == tpdu_length)) {
-			bytes_sent += tpdu_length + sock->iphdr_len;	/* as counted at IP layer */
-			packets_sent++;					/* IP packets */
-			data_bytes_sent += STATE(tsdu_length);
-		}
-
+		pgm_assert ((char*)STATE(skb)->tail > (char*)STATE(skb)->head);
+		sock->odata_batch[ STATE(batch_len)++ ] = STATE(skb);
 		STATE(data_bytes_offset) += STATE(tsdu_length);
 
-/* check for end of transmission group */
-		if (sock->use_proactive_parity) {
-			const uint32_t odata_sqn = ntohl (STATE(skb)->pgm_data->data_sqn);
-			const uint32_t tg_sqn_mask = 0xffffffff << sock->tg_sqn_shift;
-			if (!((odata_sqn + 1) & ~tg_sqn_mask))
-				pgm_schedule_proactive_nak (sock, odata_sqn & tg_sqn_mask);
+/* defer until batch is full or APDU complete */
+		if (STATE(batch_len) < sock->send_batch &&
+		    STATE(data_bytes_offset) < apdu_length)
+			continue;
+
+retry_send:
+		if (!send_odata_batch (sock, now, &bytes_sent, &packets_sent, &data_bytes_sent)) {
+			save_errno = pgm_get_last_sock_error();
+			sock->is_apdu_eagain = TRUE;
+			goto blocked;
 		}
+		STATE(batch_len) = STATE(batch_offset) = 0;
 
 	} while ( STATE(data_bytes_offset)  < apdu_length);
 	pgm_assert( STATE(data_bytes_offset) == apdu_length );
@@ -1774,6 +1870,236 @@ blocked:
 	return PGM_IO_STATUS_WOULD_BLOCK;
 }
 
+/* send the pending coalesced TSDU as one ODATA packet.  the TSDU is a run of
+ * APDUs each preceded by a 16-bit length in network order, marked by a single
+ * fragment OPT_FRAGMENT with PGM_OPT_FRAGMENT_COALESCED set in the offset,
+ * which unlike the reserved byte is covered by parity.  now is refreshed by
+ * the rate check when it has to wait.
+ *
+ * on success, returns PGM_IO_STATUS_NORMAL, on block for non-blocking sockets
+ * returns PGM_IO_STATUS_WOULD_BLOCK, returns PGM_IO_STATUS_RATE_LIMITED if
+ * packet size exceeds the current rate limit.  a blocked flush keeps the
+ * pending TSDU and resumes on the next call.
+ */
+
+static
+int
+send_coalesced (
+	pgm_sock_t* 	 const restrict	sock,
+	pgm_time_t*	       restrict	now
+	)
+{
+	struct pgm_sk_buff_t*	skb = sock->coalesce_skb;
+	struct pgm_opt_header*	opt_header;
+	struct pgm_opt_length*	opt_len;
+	size_t			bytes_sent = 0;		/* counted at IP layer */
+	unsigned		packets_sent = 0;	/* IP packets */
+	size_t			data_bytes_sent = 0;
+
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (NULL != skb);
+
+	pgm_debug ("send_coalesced (sock:%p now:%p)",
+		(void*)sock, (void*)now);
+
+	const uint16_t tsdu_length = skb->len;
+	const size_t   tpdu_length = (char*)skb->tail - (char*)skb->head;
+
+/* continue if send would block */
+	if (sock->is_apdu_eagain)
+		goto retry_send;
+
+/* check rate limit before committing to the transmit window */
+	STATE(is_rate_limited) = FALSE;
+	if (sock->is_nonblocking && sock->is_controlled_odata)
+	{
+		if (!pgm_rate_check2 (&sock->rate_control,		/* total rate limit */
+				      &sock->odata_rate_control,	/* original data limit */
+				      tpdu_length,			/* excludes IP header len */
+				      sock->is_nonblocking,
+				      now))
+		{
+			sock->blocklen = tpdu_length + sock->iphdr_len;
+			return PGM_IO_STATUS_RATE_LIMITED;
+		}
+		STATE(is_rate_limited) = TRUE;
+	}
+
+	skb->tstamp = *now;
+	skb->pgm_header	= (struct pgm_header*)skb->head;
+	skb->pgm_data	= (struct pgm_data*)(skb->pgm_header + 1);
+	memcpy (skb->pgm_header->pgm_gsi, &sock->tsi.gsi, sizeof(pgm_gsi_t));
+	skb->pgm_header->pgm_sport	= sock->tsi.sport;
+	skb->pgm_header->pgm_dport	= sock->dport;
+	skb->pgm_header->pgm_type	= PGM_ODATA;
+	skb->pgm_header->pgm_options	= PGM_OPT_PRESENT;
+	skb->pgm_header->pgm_tsdu_length = htons (tsdu_length);
+
+/* ODATA */
+	skb->pgm_data->data_sqn		= htonl (pgm_txw_next_lead(sock->window));
+	skb->pgm_data->data_trail	= htonl (pgm_txw_trail(sock->window));
+
+/* OPT_LENGTH */
+	opt_len				= (struct pgm_opt_length*)(skb->pgm_data + 1);
+	opt_len->opt_type		= PGM_OPT_LENGTH;
+	opt_len->opt_length		= sizeof(struct pgm_opt_length);
+	opt_len->opt_total_length	= htons ((uint16_t)(sizeof(struct pgm_opt_length) +
+							sizeof(struct pgm_opt_header) +
+							sizeof(struct pgm_opt_fragment)));
+/* OPT_FRAGMENT */
+	opt_header			= (struct pgm_opt_header*)(opt_len + 1);
+	opt_header->opt_type		= PGM_OPT_FRAGMENT | PGM_OPT_END;
+	opt_header->opt_length		= sizeof(struct pgm_opt_header) +
+					  sizeof(struct pgm_opt_fragment);
+	skb->pgm_opt_fragment			= (struct pgm_opt_fragment*)(opt_header + 1);
+	skb->pgm_opt_fragment->opt_reserved	= 0;
+	skb->pgm_opt_fragment->opt_sqn		= skb->pgm_data->data_sqn;
+	skb->pgm_opt_fragment->opt_frag_off	= htonl (PGM_OPT_FRAGMENT_COALESCED);
+	skb->pgm_opt_fragment->opt_frag_len	= htonl ((uint32_t)tsdu_length);
+	pgm_assert (skb->data == (skb->pgm_opt_fragment + 1));
+
+	skb->pgm_header->pgm_checksum	= 0;
+	const size_t   pgm_header_len	= (char*)skb->data - (char*)skb->pgm_header;
+	const uint32_t unfolded_header	= pgm_csum_partial (skb->pgm_header, (uint16_t)pgm_header_len, 0);
+	STATE(unfolded_odata)		= pgm_csum_partial (skb->data, tsdu_length, 0);
+	skb->pgm_header->pgm_checksum	= pgm_csum_fold (pgm_csum_block_add (unfolded_header, STATE(unfolded_odata), (uint16_t)pgm_header_len));
+
+/* add to transmit window, the window takes the pending reference */
+	txw_add (sock, skb);
+
+/* save unfolded odata for retransmissions */
+	pgm_txw_set_unfolded_checksum (skb, STATE(unfolded_odata));
+
+	sock->odata_batch[ 0 ] = skb;
+	STATE(batch_len)	= 1;
+	STATE(batch_offset)	= 0;
+
+retry_send:
+	if (!send_odata_batch (sock, now, &bytes_sent, &packets_sent, &data_bytes_sent)) {
+		const int save_errno = pgm_get_last_sock_error();
+		sock->is_apdu_eagain = TRUE;
+		if (PGM_SOCK_ENOBUFS == save_errno)
+			return PGM_IO_STATUS_RATE_LIMITED;
+		if (sock->use_pgmcc)
+			pgm_notify_clear (&sock->ack_notify);
+		return PGM_IO_STATUS_WOULD_BLOCK;
+	}
+	STATE(batch_len) = STATE(batch_offset) = 0;
+
+/* success */
+	sock->is_apdu_eagain = FALSE;
+	sock->coalesce_skb = NULL;
+/* SPM heartbeats decay from last sent data packet */
+	reset_heartbeat_spm (sock, skb->tstamp);
+/* increment socket statistics */
+	pgm_atomic_add32 (&sock->cumulative_stats[PGM_PC_SOURCE_BYTES_SENT], (uint32_t)bytes_sent);
+	sock->cumulative_stats[PGM_PC_SOURCE_DATA_MSGS_SENT]  += packets_sent;
+	sock->cumulative_stats[PGM_PC_SOURCE_DATA_BYTES_SENT] += data_bytes_sent;
+	return PGM_IO_STATUS_NORMAL;
+}
+
+/* hold a small APDU in the pending coalesced TSDU, sending the TSDU first when
+ * the APDU does not fit, the hold time has passed, or a previous flush blocked.
+ * APDUs too large to share a TPDU take the regular send path.  the first APDU
+ * of a TSDU brings the timer forward to the hold expiry so that a quiet
+ * application still sees its data sent.
+ *
+ * on success, returns PGM_IO_STATUS_NORMAL, otherwise returns the status of
+ * the blocked flush and the APDU is not taken, the call must be repeated.
+ */
+
+static
+int
+send_coalesce (
+	pgm_sock_t* 	 const restrict	sock,
+	const void*	       restrict	apdu,
+	const size_t			apdu_length,
+	pgm_time_t*	       restrict	now,
+	size_t*		       restrict	bytes_written
+	)
+{
+	const size_t max_tsdu     = source_max_tsdu (sock, TRUE);
+	const size_t frame_length = sizeof(uint16_t) + apdu_length;
+	uint16_t     prefix;
+
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+	pgm_assert (sock->coalesce_ivl > 0);
+
+	pgm_debug ("send_coalesce (sock:%p apdu:%p apdu-length:%" PRIzu " bytes-written:%p)",
+		(void*)sock, apdu, apdu_length, (void*)bytes_written);
+
+	if (NULL != sock->coalesce_skb &&
+	    (sock->is_apdu_eagain ||
+	     sock->coalesce_skb->len + frame_length > max_tsdu ||
+	     pgm_time_after_eq (*now, sock->coalesce_expiry)))
+	{
+		const int status = send_coalesced (sock, now);
+		if (PGM_IO_STATUS_NORMAL != status)
+			return status;
+	}
+
+/* pass on APDUs that cannot share a packet */
+	if (frame_length > max_tsdu)
+		return (apdu_length <= sock->max_tsdu) ?
+			send_odata_copy (sock, apdu, (uint16_t)apdu_length, now, bytes_written) :
+			send_apdu (sock, apdu, apdu_length, now, bytes_written);
+
+	if (NULL == sock->coalesce_skb)
+	{
+		sock->coalesce_skb = pgm_skb_pool_alloc (sock->skb_pool, sock->max_tpdu);
+		sock->coalesce_skb->sock = sock;
+		pgm_skb_reserve (sock->coalesce_skb, (uint16_t)pgm_pkt_offset (TRUE, 0));
+		sock->coalesce_expiry = *now + sock->coalesce_ivl;
+		pgm_sock_mutex_lock (sock, &sock->timer_mutex);
+		if (pgm_time_after (sock->next_poll, sock->coalesce_expiry))
+		{
+			sock->next_poll = sock->coalesce_expiry;
+			if (!sock->is_pending_read) {
+				pgm_notify_send (&sock->pending_notify);
+				sock->is_pending_read = TRUE;
+			}
+		}
+		pgm_sock_mutex_unlock (sock, &sock->timer_mutex);
+	}
+
+	prefix = htons ((uint16_t)apdu_length);
+	memcpy (pgm_skb_put (sock->coalesce_skb, sizeof(prefix)), &prefix, sizeof(prefix));
+	if (PGM_LIKELY(apdu_length))
+		memcpy (pgm_skb_put (sock->coalesce_skb, (uint16_t)apdu_length), apdu, apdu_length);
+
+	if (bytes_written)
+		*bytes_written = apdu_length;
+	return PGM_IO_STATUS_NORMAL;
+}
+
+/* timer callback to send the pending coalesced TSDU once its hold time has
+ * passed, or to resume a flush that blocked.  called with the source lock held.
+ *
+ * returns TRUE on success, returns FALSE if the flush would block.
+ */
+
+PGM_GNUC_INTERNAL
+bool
+pgm_on_coalesce_expiry (
+	pgm_sock_t* const	sock,
+	const pgm_time_t	now
+	)
+{
+	pgm_time_t now_ = now;
+
+/* pre-conditions */
+	pgm_assert (NULL != sock);
+
+	if (NULL == sock->coalesce_skb)
+		return TRUE;
+	if (!sock->is_apdu_eagain &&
+	    pgm_time_after (sock->coalesce_expiry, now))
+		return TRUE;
+	return (PGM_IO_STATUS_NORMAL == send_coalesced (sock, &now_));
+}
+
 /* Send one APDU, whether it fits within one TPDU or more.
  *
  * on success, returns PGM_IO_STATUS_NORMAL, on block for non-blocking sockets
@@ -1797,7 +2123,7 @@ pgm_send (
 	if (PGM_LIKELY(apdu_length)) pgm_return_val_if_fail (NULL != apdu, PGM_IO_STATUS_ERROR);
 
 /* shutdown */
-	if (PGM_UNLIKELY(!pgm_rwlock_reader_trylock (&sock->lock)))
+	if (PGM_UNLIKELY(!pgm_sock_reader_trylock (sock)))
 		pgm_return_val_if_reached (PGM_IO_STATUS_ERROR);
 
 /* state */
@@ -1805,26 +2131,38 @@ pgm_send (
 	    sock->is_destroyed ||
 	    apdu_length > sock->max_apdu))
 	{
-		pgm_rwlock_reader_unlock (&sock->lock);
+		pgm_sock_reader_unlock (sock);
 		pgm_return_val_if_reached (PGM_IO_STATUS_ERROR);
 	}
 
 /* source */
-	pgm_mutex_lock (&sock->source_mutex);
+	pgm_sock_mutex_lock (sock, &sock->source_mutex);
+
+/* one time read per call */
+	pgm_time_t now = pgm_time_update_now();
+
+/* small APDUs share packets */
+	if (sock->coalesce_ivl)
+	{
+		const int status = send_coalesce (sock, apdu, apdu_length, &now, bytes_written);
+		pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+		pgm_sock_reader_unlock (sock);
+		return status;
+	}
 
 /* pass on non-fragment calls */
 	if (apdu_length <= sock->max_tsdu)
 	{
-		const int status = send_odata_copy (sock, apdu, (uint16_t)apdu_length, bytes_written);
-		pgm_mutex_unlock (&sock->source_mutex);
-		pgm_rwlock_reader_unlock (&sock->lock);
+		const int status = send_odata_copy (sock, apdu, (uint16_t)apdu_length, &now, bytes_written);
+		pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+		pgm_sock_reader_unlock (sock);
 		return status;
 	}
 	else
 	{
-		const int status = send_apdu (sock, apdu, (uint16_t)apdu_length, bytes_written);
-		pgm_mutex_unlock (&sock->source_mutex);
-		pgm_rwlock_reader_unlock (&sock->lock);
+		const int status = send_apdu (sock, apdu, (uint16_t)apdu_length, &now, bytes_written);
+		pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+		pgm_sock_reader_unlock (sock);
 		return status;
 	}
 }
@@ -1873,23 +2211,35 @@ pgm_sendv (
 	pgm_return_val_if_fail (NULL != sock, PGM_IO_STATUS_ERROR);
 	pgm_return_val_if_fail (count <= PGM_MAX_FRAGMENTS, PGM_IO_STATUS_ERROR);
 	if (PGM_LIKELY(count)) pgm_return_val_if_fail (NULL != vector, PGM_IO_STATUS_ERROR);
-	if (PGM_UNLIKELY(!pgm_rwlock_reader_trylock (&sock->lock)))
+	if (PGM_UNLIKELY(!pgm_sock_reader_trylock (sock)))
 		pgm_return_val_if_reached (PGM_IO_STATUS_ERROR);
 	if (PGM_UNLIKELY(!sock->is_bound ||
 	    sock->is_destroyed))
 	{
-		pgm_rwlock_reader_unlock (&sock->lock);
+		pgm_sock_reader_unlock (sock);
 		pgm_return_val_if_reached (PGM_IO_STATUS_ERROR);
 	}
 
-	pgm_mutex_lock (&sock->source_mutex);
+	pgm_sock_mutex_lock (sock, &sock->source_mutex);
+	pgm_time_t now = pgm_time_update_now();
+
+/* held small APDUs go first to keep sequence order */
+	if (sock->coalesce_skb)
+	{
+		const int status = send_coalesced (sock, &now);
+		if (PGM_IO_STATUS_NORMAL != status) {
+			pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+			pgm_sock_reader_unlock (sock);
+			return status;
+		}
+	}
 
 /* pass on zero length as cannot count vector lengths */
 	if (PGM_UNLIKELY(0 == count))
 	{
-		const int status = send_odata_copy (sock, NULL, 0, bytes_written);
-		pgm_mutex_unlock (&sock->source_mutex);
-		pgm_rwlock_reader_unlock (&sock->lock);
+		const int status = send_odata_copy (sock, NULL, 0, &now, bytes_written);
+		pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+		pgm_sock_reader_unlock (sock);
 		return status;
 	}
 
@@ -1900,9 +2250,9 @@ pgm_sendv (
 		if (is_one_apdu) {
 			if (STATE(apdu_length) <= sock->max_tsdu)
 			{
-				const int status = send_odatav (sock, vector, count, bytes_written);
-				pgm_mutex_unlock (&sock->source_mutex);
-				pgm_rwlock_reader_unlock (&sock->lock);
+				const int status = send_odatav (sock, vector, count, &now, bytes_written);
+				pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+				pgm_sock_reader_unlock (sock);
 				return status;
 			}
 			else
@@ -1924,8 +2274,8 @@ pgm_sendv (
 		if (!is_one_apdu &&
 		    vector[i].iov_len > sock->max_apdu)
 		{
-			pgm_mutex_unlock (&sock->source_mutex);
-			pgm_rwlock_reader_unlock (&sock->lock);
+			pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+			pgm_sock_reader_unlock (sock);
 			pgm_return_val_if_reached (PGM_IO_STATUS_ERROR);
 		}
 		STATE(apdu_length) += vector[i].iov_len;
@@ -1934,13 +2284,13 @@ pgm_sendv (
 /* pass on non-fragment calls */
 	if (is_one_apdu) {
 		if (STATE(apdu_length) <= sock->max_tsdu) {
-			const int status = send_odatav (sock, vector, count, bytes_written);
-			pgm_mutex_unlock (&sock->source_mutex);
-			pgm_rwlock_reader_unlock (&sock->lock);
+			const int status = send_odatav (sock, vector, count, &now, bytes_written);
+			pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+			pgm_sock_reader_unlock (sock);
 			return status;
 		} else if (STATE(apdu_length) > sock->max_apdu) {
-			pgm_mutex_unlock (&sock->source_mutex);
-			pgm_rwlock_reader_unlock (&sock->lock);
+			pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+			pgm_sock_reader_unlock (sock);
 			pgm_return_val_if_reached (PGM_IO_STATUS_ERROR);
 		}
 	}
@@ -1956,6 +2306,7 @@ retry_send:
 			status = send_apdu (sock,
 					    vector[STATE(data_pkt_offset)].iov_base,
 					    vector[STATE(data_pkt_offset)].iov_len,
+					    &now,
 					    &wrote_bytes);
 			switch (status) {
 			case PGM_IO_STATUS_NORMAL:
@@ -1963,12 +2314,12 @@ retry_send:
 			case PGM_IO_STATUS_WOULD_BLOCK:
 			case PGM_IO_STATUS_RATE_LIMITED:
 				sock->is_apdu_eagain = TRUE;
-				pgm_mutex_unlock (&sock->source_mutex);
-				pgm_rwlock_reader_unlock (&sock->lock);
+				pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+				pgm_sock_reader_unlock (sock);
 				return status;
 			case PGM_IO_STATUS_ERROR:
-				pgm_mutex_unlock (&sock->source_mutex);
-				pgm_rwlock_reader_unlock (&sock->lock);
+				pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+				pgm_sock_reader_unlock (sock);
 				return status;
 			default:
 				pgm_assert_not_reached();
@@ -1979,8 +2330,8 @@ retry_send:
 		sock->is_apdu_eagain = FALSE;
 		if (bytes_written)
 			*bytes_written = data_bytes_sent;
-		pgm_mutex_unlock (&sock->source_mutex);
-		pgm_rwlock_reader_unlock (&sock->lock);
+		pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+		pgm_sock_reader_unlock (sock);
 		return PGM_IO_STATUS_NORMAL;
 	}
 
@@ -2001,11 +2352,12 @@ retry_send:
                 if (!pgm_rate_check2 (&sock->rate_control,
 				      &sock->odata_rate_control,
 				      tpdu_length - sock->iphdr_len,	/* includes 1 × IP header len */
-				      sock->is_nonblocking))
+				      sock->is_nonblocking,
+				      &now))
 		{
 			sock->blocklen = tpdu_length;
-			pgm_mutex_unlock (&sock->source_mutex);
-			pgm_rwlock_reader_unlock (&sock->lock);
+			pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+			pgm_sock_reader_unlock (sock);
 			return PGM_IO_STATUS_RATE_LIMITED;
 		}
 		STATE(is_rate_limited) = TRUE;
@@ -2014,24 +2366,25 @@ retry_send:
 	STATE(data_bytes_offset)	= 0;
 	STATE(vector_index)		= 0;
 	STATE(vector_offset)		= 0;
+	STATE(batch_len)		= 0;
+	STATE(batch_offset)		= 0;
 
 	STATE(first_sqn)		= pgm_txw_next_lead(sock->window);
 
 	do {
-		size_t			 tpdu_length, header_length;
+		size_t			 header_length;
 		struct pgm_opt_header	*opt_header;
 		struct pgm_opt_length	*opt_len;
 		const char		*src;
 		char			*dst;
 		size_t			 src_length, dst_length, copy_length;
-		ssize_t			 sent;
 
 /* retrieve packet storage from transmit window */
 		header_length = pgm_pkt_offset (TRUE, pgmcc_family);
 		STATE(tsdu_length) = MIN( source_max_tsdu (sock, TRUE), STATE(apdu_length) - STATE(data_bytes_offset) );
-		STATE(skb) = pgm_alloc_skb (sock->max_tpdu);
+		STATE(skb) = pgm_skb_pool_alloc (sock->skb_pool, sock->max_tpdu);
 		STATE(skb)->sock = sock;
-		STATE(skb)->tstamp = pgm_time_update_now();
+		STATE(skb)->tstamp = now;
 		pgm_skb_reserve (STATE(skb), (uint16_t)header_length);
 		pgm_skb_put (STATE(skb), (uint16_t)STATE(tsdu_length));
 
@@ -2112,49 +2465,26 @@ retry_send:
 		STATE(skb)->pgm_header->pgm_checksum = pgm_csum_fold (pgm_csum_block_add (unfolded_header, STATE(unfolded_odata), (uint16_t)pgm_header_len));
 
 /* add to transmit window, skb::data set to payload */
-		pgm_spinlock_lock (&sock->txw_spinlock);
-		pgm_txw_add (sock->window, STATE(skb));
-		pgm_spinlock_unlock (&sock->txw_spinlock);
-
-retry_one_apdu_send:
-		tpdu_length = (char*)STATE(skb)->tail - (char*)STATE(skb)->head;
-		sent = pgm_sendto (sock,
-				   !STATE(is_rate_limited),	/* rate limited on blocking */
-			   	   &sock->odata_rate_control,
-				   FALSE,			/* regular socket */
-				   STATE(skb)->head,
-				   tpdu_length,
-				   (struct sockaddr*)&sock->send_gsr.gsr_group,
-				   pgm_sockaddr_len((struct sockaddr*)&sock->send_gsr.gsr_group));
-		if (sent < 0) {
-			save_errno = pgm_get_last_sock_error();
-			if (PGM_LIKELY(PGM_SOCK_EAGAIN == save_errno || PGM_SOCK_ENOBUFS == save_errno))
-			{
-				sock->is_apdu_eagain = TRUE;
-				sock->blocklen = tpdu_length + sock->iphdr_len;
-				goto blocked;
-			}
-/* fall through silently on other errors */
-		}
+		txw_add (sock, STATE(skb));
 
 /* save unfolded odata for retransmissions */
 		pgm_txw_set_unfolded_checksum (STATE(skb), STATE(unfolded_odata));
 
-		if (PGM_LIKELY((size_t)sent == tpdu_length)) {
-			bytes_sent += tpdu_length + sock->iphdr_len;	/* as counted at IP layer */
-			packets_sent++;					/* IP packets */
-			data_bytes_sent += STATE(tsdu_length);
-		}
-
+		sock->odata_batch[ STATE(batch_len)++ ] = STATE(skb);
 		STATE(data_bytes_offset) += STATE(tsdu_length);
 
-/* check for end of transmission group */
-		if (sock->use_proactive_parity) {
-			const uint32_t odata_sqn = ntohl (STATE(skb)->pgm_data->data_sqn);
-			const uint32_t tg_sqn_mask = 0xffffffff << sock->tg_sqn_shift;
-			if (!((odata_sqn + 1) & ~tg_sqn_mask))
-				pgm_schedule_proactive_nak (sock, odata_sqn & tg_sqn_mask);
+/* defer until batch is full or APDU complete */
+		if (STATE(batch_len) < sock->send_batch &&
+		    STATE(data_bytes_offset) < STATE(apdu_length))
+			continue;
+
+retry_one_apdu_send:
+		if (!send_odata_batch (sock, &now, &bytes_sent, &packets_sent, &data_bytes_sent)) {
+			save_errno = pgm_get_last_sock_error();
+			sock->is_apdu_eagain = TRUE;
+			goto blocked;
 		}
+		STATE(batch_len) = STATE(batch_offset) = 0;
 
 	} while ( STATE(data_bytes_offset)  < STATE(apdu_length) );
 	pgm_assert( STATE(data_bytes_offset) == STATE(apdu_length) );
@@ -2169,8 +2499,8 @@ retry_one_apdu_send:
 	sock->cumulative_stats[PGM_PC_SOURCE_DATA_BYTES_SENT] += data_bytes_sent;
 	if (bytes_written)
 		*bytes_written = STATE(apdu_length);
-	pgm_mutex_unlock (&sock->source_mutex);
-	pgm_rwlock_reader_unlock (&sock->lock);
+	pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+	pgm_sock_reader_unlock (sock);
 	return PGM_IO_STATUS_NORMAL;
 
 blocked:
@@ -2180,8 +2510,8 @@ blocked:
 		sock->cumulative_stats[PGM_PC_SOURCE_DATA_MSGS_SENT]  += packets_sent;
 		sock->cumulative_stats[PGM_PC_SOURCE_DATA_BYTES_SENT] += data_bytes_sent;
 	}
-	pgm_mutex_unlock (&sock->source_mutex);
-	pgm_rwlock_reader_unlock (&sock->lock);
+	pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+	pgm_sock_reader_unlock (sock);
 	if (PGM_SOCK_ENOBUFS == save_errno)
 		return PGM_IO_STATUS_RATE_LIMITED;
 	if (sock->use_pgmcc)
@@ -2224,30 +2554,42 @@ pgm_send_skbv (
 	pgm_return_val_if_fail (NULL != sock, PGM_IO_STATUS_ERROR);
 	pgm_return_val_if_fail (count <= PGM_MAX_FRAGMENTS, PGM_IO_STATUS_ERROR);
 	if (PGM_LIKELY(count)) pgm_return_val_if_fail (NULL != vector, PGM_IO_STATUS_ERROR);
-	if (PGM_UNLIKELY(!pgm_rwlock_reader_trylock (&sock->lock)))
+	if (PGM_UNLIKELY(!pgm_sock_reader_trylock (sock)))
 		pgm_return_val_if_reached (PGM_IO_STATUS_ERROR);
 	if (PGM_UNLIKELY(!sock->is_bound ||
 	    sock->is_destroyed))
 	{
-		pgm_rwlock_reader_unlock (&sock->lock);
+		pgm_sock_reader_unlock (sock);
 		pgm_return_val_if_reached (PGM_IO_STATUS_ERROR);
 	}
 
-	pgm_mutex_lock (&sock->source_mutex);
+	pgm_sock_mutex_lock (sock, &sock->source_mutex);
+	pgm_time_t now = pgm_time_update_now();
+
+/* held small APDUs go first to keep sequence order */
+	if (sock->coalesce_skb)
+	{
+		const int status = send_coalesced (sock, &now);
+		if (PGM_IO_STATUS_NORMAL != status) {
+			pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+			pgm_sock_reader_unlock (sock);
+			return status;
+		}
+	}
 
 /* pass on zero length as cannot count vector lengths */
 	if (PGM_UNLIKELY(0 == count))
 	{
-		const int status = send_odata_copy (sock, NULL, 0, bytes_written);
-		pgm_mutex_unlock (&sock->source_mutex);
-		pgm_rwlock_reader_unlock (&sock->lock);
+		const int status = send_odata_copy (sock, NULL, 0, &now, bytes_written);
+		pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+		pgm_sock_reader_unlock (sock);
 		return status;
 	}
 	else if (1 == count)
 	{
-		const int status = send_odata (sock, vector[0], bytes_written);
-		pgm_mutex_unlock (&sock->source_mutex);
-		pgm_rwlock_reader_unlock (&sock->lock);
+		const int status = send_odata (sock, vector[0], &now, bytes_written);
+		pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+		pgm_sock_reader_unlock (sock);
 		return status;
 	}
 
@@ -2268,11 +2610,12 @@ pgm_send_skbv (
 		if (!pgm_rate_check2 (&sock->rate_control,
 				      &sock->odata_rate_control,
 				      total_tpdu_length - sock->iphdr_len,	/* includes 1 × IP header len */
-				      sock->is_nonblocking))
+				      sock->is_nonblocking,
+				      &now))
 		{
 			sock->blocklen = total_tpdu_length;
-			pgm_mutex_unlock (&sock->source_mutex);
-			pgm_rwlock_reader_unlock (&sock->lock);
+			pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+			pgm_sock_reader_unlock (sock);
 			return PGM_IO_STATUS_RATE_LIMITED;
 		}
 		STATE(is_rate_limited) = TRUE;
@@ -2285,15 +2628,15 @@ pgm_send_skbv (
 		for (unsigned i = 0; i < count; i++)
 		{
 			if (PGM_UNLIKELY(vector[i]->len > sock->max_tsdu_fragment)) {
-				pgm_mutex_unlock (&sock->source_mutex);
-				pgm_rwlock_reader_unlock (&sock->lock);
+				pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+				pgm_sock_reader_unlock (sock);
 				return PGM_IO_STATUS_ERROR;
 			}
 			STATE(apdu_length) += vector[i]->len;
 		}
 		if (PGM_UNLIKELY(STATE(apdu_length) > sock->max_apdu)) {
-			pgm_mutex_unlock (&sock->source_mutex);
-			pgm_rwlock_reader_unlock (&sock->lock);
+			pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+			pgm_sock_reader_unlock (sock);
 			return PGM_IO_STATUS_ERROR;
 		}
 	}
@@ -2307,7 +2650,7 @@ pgm_send_skbv (
 		
 		STATE(skb) = pgm_skb_get(vector[STATE(vector_index)]);
 		STATE(skb)->sock = sock;
-		STATE(skb)->tstamp = pgm_time_update_now();
+		STATE(skb)->tstamp = now;
 
 		STATE(skb)->pgm_header = (struct pgm_header*)STATE(skb)->head;
 		STATE(skb)->pgm_data   = (struct pgm_data*)(STATE(skb)->pgm_header + 1);
@@ -2361,20 +2704,18 @@ pgm_send_skbv (
 		STATE(skb)->pgm_header->pgm_checksum	= pgm_csum_fold (pgm_csum_block_add (unfolded_header, STATE(unfolded_odata), (uint16_t)header_length));
 
 /* add to transmit window, skb::data set to payload */
-		pgm_spinlock_lock (&sock->txw_spinlock);
-		pgm_txw_add (sock->window, STATE(skb));
-		pgm_spinlock_unlock (&sock->txw_spinlock);
+		txw_add (sock, STATE(skb));
 retry_send:
 		pgm_assert ((char*)STATE(skb)->tail > (char*)STATE(skb)->head);
 		tpdu_length = (char*)STATE(skb)->tail - (char*)STATE(skb)->head;
-		sent = pgm_sendto (sock,
-				   !STATE(is_rate_limited),	/* rate limited on blocking */
-			   	   &sock->odata_rate_control,
-				   FALSE,			/* regular socket */
-				   STATE(skb)->head,
-				   tpdu_length,
-				   (struct sockaddr*)&sock->send_gsr.gsr_group,
-				   pgm_sockaddr_len((struct sockaddr*)&sock->send_gsr.gsr_group));
+		sent = pgm_sendto_skb (sock,
+				       !STATE(is_rate_limited),	/* rate limited on blocking */
+			   	       &sock->odata_rate_control,
+				       &now,
+				       FALSE,			/* regular socket */
+				       STATE(skb),
+				       (struct sockaddr*)&sock->send_gsr.gsr_group,
+				       pgm_sockaddr_len((struct sockaddr*)&sock->send_gsr.gsr_group));
 		if (sent < 0) {
 			save_errno = pgm_get_last_sock_error();
 			if (PGM_LIKELY(PGM_SOCK_EAGAIN == save_errno || PGM_SOCK_ENOBUFS == save_errno))
@@ -2424,8 +2765,8 @@ retry_send:
 	sock->cumulative_stats[PGM_PC_SOURCE_DATA_BYTES_SENT] += data_bytes_sent;
 	if (bytes_written)
 		*bytes_written = data_bytes_sent;
-	pgm_mutex_unlock (&sock->source_mutex);
-	pgm_rwlock_reader_unlock (&sock->lock);
+	pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+	pgm_sock_reader_unlock (sock);
 	return PGM_IO_STATUS_NORMAL;
 
 blocked:
@@ -2435,8 +2776,8 @@ blocked:
 		sock->cumulative_stats[PGM_PC_SOURCE_DATA_MSGS_SENT]  += packets_sent;
 		sock->cumulative_stats[PGM_PC_SOURCE_DATA_BYTES_SENT] += data_bytes_sent;
 	}
-	pgm_mutex_unlock (&sock->source_mutex);
-	pgm_rwlock_reader_unlock (&sock->lock);
+	pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+	pgm_sock_reader_unlock (sock);
 	if (PGM_SOCK_ENOBUFS == save_errno)
 		return PGM_IO_STATUS_RATE_LIMITED;
 	if (sock->use_pgmcc)
@@ -2444,6 +2785,159 @@ blocked:
 	return PGM_IO_STATUS_WOULD_BLOCK;
 }
 
+/* send any small APDUs held by PGM_COALESCE without waiting for the hold time
+ * to pass.
+ *
+ * on success, returns PGM_IO_STATUS_NORMAL, on block for non-blocking sockets
+ * returns PGM_IO_STATUS_WOULD_BLOCK, returns PGM_IO_STATUS_RATE_LIMITED if
+ * packet size exceeds the current rate limit.
+ */
+
+int
+pgm_send_flush (
+	pgm_sock_t* const	sock
+	)
+{
+	int status = PGM_IO_STATUS_NORMAL;
+
+	pgm_debug ("pgm_send_flush (sock:%p)", (const void*)sock);
+
+	pgm_return_val_if_fail (NULL != sock, PGM_IO_STATUS_ERROR);
+	if (PGM_UNLIKELY(!pgm_sock_reader_trylock (sock)))
+		pgm_return_val_if_reached (PGM_IO_STATUS_ERROR);
+	if (PGM_UNLIKELY(!sock->is_bound ||
+	    sock->is_destroyed))
+	{
+		pgm_sock_reader_unlock (sock);
+		pgm_return_val_if_reached (PGM_IO_STATUS_ERROR);
+	}
+
+	pgm_sock_mutex_lock (sock, &sock->source_mutex);
+	if (sock->coalesce_skb) {
+		pgm_time_t now = pgm_time_update_now();
+		status = send_coalesced (sock, &now);
+	}
+	pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+	pgm_sock_reader_unlock (sock);
+	return status;
+}
+
+/* reserve a payload region for one TSDU of up to length bytes, with headroom
+ * for the PGM header already in place, so the application can serialize
+ * directly into transmit window memory.  the claim is sent by
+ * pgm_send_commit(), claiming again before then returns the same region.
+ *
+ * returns a pointer to the payload, or NULL if length exceeds one TPDU or a
+ * blocked commit has to be repeated first.
+ */
+
+void*
+pgm_send_claim (
+	pgm_sock_t* const	sock,
+	const size_t		length
+	)
+{
+	void* data = NULL;
+
+	pgm_debug ("pgm_send_claim (sock:%p length:%" PRIzu ")",
+		(const void*)sock, length);
+
+	pgm_return_val_if_fail (NULL != sock, NULL);
+	if (PGM_UNLIKELY(!pgm_sock_reader_trylock (sock)))
+		pgm_return_val_if_reached (NULL);
+	if (PGM_UNLIKELY(!sock->is_bound ||
+	    sock->is_destroyed))
+	{
+		pgm_sock_reader_unlock (sock);
+		pgm_return_val_if_reached (NULL);
+	}
+
+	pgm_sock_mutex_lock (sock, &sock->source_mutex);
+	if (PGM_UNLIKELY(length > sock->max_tsdu ||
+	    (NULL != sock->claim_skb && sock->is_apdu_eagain)))
+		goto out;
+	if (NULL == sock->claim_skb) {
+		const sa_family_t pgmcc_family = sock->use_pgmcc ? sock->family : 0;
+		sock->claim_skb = pgm_skb_pool_alloc (sock->skb_pool, sock->max_tpdu);
+		pgm_skb_reserve (sock->claim_skb, (uint16_t)pgm_pkt_offset (FALSE, pgmcc_family));
+	}
+	data = sock->claim_skb->data;
+out:
+	pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+	pgm_sock_reader_unlock (sock);
+	return data;
+}
+
+/* send the first length bytes of the region reserved by pgm_send_claim() as
+ * one TSDU.  the header and checksum are built in place and the buffer passes
+ * to the transmit window without a copy.
+ *
+ * on success, returns PGM_IO_STATUS_NORMAL, on block for non-blocking sockets
+ * returns PGM_IO_STATUS_WOULD_BLOCK, returns PGM_IO_STATUS_RATE_LIMITED if
+ * packet size exceeds the current rate limit.  a blocked commit is repeated
+ * with the same arguments.
+ */
+
+int
+pgm_send_commit (
+	pgm_sock_t* const restrict	sock,
+	const size_t			length,
+	size_t*		  restrict	bytes_written
+	)
+{
+	struct pgm_sk_buff_t* skb;
+	int status;
+
+	pgm_debug ("pgm_send_commit (sock:%p length:%" PRIzu " bytes-written:%p)",
+		(const void*)sock, length, (const void*)bytes_written);
+
+	pgm_return_val_if_fail (NULL != sock, PGM_IO_STATUS_ERROR);
+	if (PGM_UNLIKELY(!pgm_sock_reader_trylock (sock)))
+		pgm_return_val_if_reached (PGM_IO_STATUS_ERROR);
+	if (PGM_UNLIKELY(!sock->is_bound ||
+	    sock->is_destroyed))
+	{
+		pgm_sock_reader_unlock (sock);
+		pgm_return_val_if_reached (PGM_IO_STATUS_ERROR);
+	}
+
+	pgm_sock_mutex_lock (sock, &sock->source_mutex);
+	skb = sock->claim_skb;
+	if (PGM_UNLIKELY(NULL == skb ||
+	    length > sock->max_tsdu))
+	{
+		pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+		pgm_sock_reader_unlock (sock);
+		return PGM_IO_STATUS_ERROR;
+	}
+	pgm_time_t now = pgm_time_update_now();
+
+/* held small APDUs go first to keep sequence order */
+	if (sock->coalesce_skb)
+	{
+		status = send_coalesced (sock, &now);
+		if (PGM_IO_STATUS_NORMAL != status) {
+			pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+			pgm_sock_reader_unlock (sock);
+			return status;
+		}
+	}
+
+	if (!sock->is_apdu_eagain) {
+		skb->sock = sock;
+		skb->tail = (char*)skb->data + length;
+		skb->len  = (uint16_t)length;
+	}
+	status = send_odata (sock, skb, &now, bytes_written);
+	if (PGM_IO_STATUS_NORMAL == status) {
+/* the transmit window holds the remaining reference */
+		sock->claim_skb = NULL;
+	}
+	pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+	pgm_sock_reader_unlock (sock);
+	return status;
+}
+
 /* cleanup resuming send state helper 
  */
 #undef STATE
@@ -2471,13 +2965,15 @@ send_rdata (
 	pgm_assert ((char*)skb->tail > (char*)skb->head);
 
 	tpdu_length = (char*)skb->tail - (char*)skb->head;
+	pgm_time_t now = pgm_time_update_now();
 
 /* rate check including rdata specific limits */
 	if (sock->is_controlled_rdata &&
 	    !pgm_rate_check2 (&sock->rate_control,		/* total rate limit */
 			      &sock->rdata_rate_control,	/* repair data limit */
 			      tpdu_length,			/* excludes IP header len */
-			      sock->is_nonblocking))
+			      sock->is_nonblocking,
+			      &now))
 	{
 		sock->blocklen = tpdu_length + sock->iphdr_len;
 		return FALSE;
@@ -2505,14 +3001,23 @@ send_rdata (
 		return FALSE;
 	}
 
-	sent = pgm_sendto (sock,
-			   FALSE,			/* already rate limited */
-			   &sock->rdata_rate_control,
-			   TRUE,			/* with router alert */
-			   header,
-			   tpdu_length,
-			   (struct sockaddr*)&sock->send_gsr.gsr_group,
-			   pgm_sockaddr_len((struct sockaddr*)&sock->send_gsr.gsr_group));
+	if (sock->use_lockless_txw)
+		sent = pgm_sendto_repair (sock,
+					  FALSE,		/* already rate limited */
+					  &sock->rdata_rate_control,
+					  &now,
+					  skb,
+					  (struct sockaddr*)&sock->send_gsr.gsr_group,
+					  pgm_sockaddr_len((struct sockaddr*)&sock->send_gsr.gsr_group));
+	else
+		sent = pgm_sendto_skb (sock,
+				       FALSE,		/* already rate limited */
+				       &sock->rdata_rate_control,
+				       &now,
+				       TRUE,		/* with router alert */
+				       skb,
+				       (struct sockaddr*)&sock->send_gsr.gsr_group,
+				       pgm_sockaddr_len((struct sockaddr*)&sock->send_gsr.gsr_group));
 	if (sent < 0) {
 		const int save_errno = pgm_get_last_sock_error();
 		if (PGM_LIKELY(PGM_SOCK_EAGAIN == save_errno || PGM_SOCK_ENOBUFS == save_errno))
@@ -2523,8 +3028,6 @@ send_rdata (
 /* fall through silently on other errors */
 	}
 
-	const pgm_time_t now = pgm_time_update_now();
-
 	if (sock->use_pgmcc) {
 		sock->tokens -= pgm_fp8 (1);
 		sock->ack_expiry = now + sock->ack_expiry_ivl;
@@ -2532,10 +3035,10 @@ send_rdata (
 
 /* re-set spm timer: we are already in the timer thread, no need to prod timers
  */
-	pgm_mutex_lock (&sock->timer_mutex);
+	pgm_sock_mutex_lock (sock, &sock->timer_mutex);
 	sock->spm_heartbeat_state = 1;
 	sock->next_heartbeat_spm = now + sock->spm_heartbeat_interval[sock->spm_heartbeat_state++];
-	pgm_mutex_unlock (&sock->timer_mutex);
+	pgm_sock_mutex_unlock (sock, &sock->timer_mutex);
 
 	pgm_txw_inc_retransmit_count (skb);
 	sock->cumulative_stats[PGM_PC_SOURCE_SELECTIVE_BYTES_RETRANSMITTED] += ntohs(header->pgm_tsdu_length);
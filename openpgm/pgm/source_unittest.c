@@ -69,6 +69,7 @@ static gboolean mock_is_valid_nnak = TRUE;
 #define pgm_txw_set_unfolded_checksum	mock_pgm_txw_set_unfolded_checksum
 #define pgm_txw_inc_retransmit_count	mock_pgm_txw_inc_retransmit_count
 #define pgm_txw_add			mock_pgm_txw_add
+#define pgm_txw_fold_parity		mock_pgm_txw_fold_parity
 #define pgm_txw_peek			mock_pgm_txw_peek
 #define pgm_txw_retransmit_push		mock_pgm_txw_retransmit_push
 #define pgm_txw_retransmit_try_peek	mock_pgm_txw_retransmit_try_peek
@@ -84,6 +85,10 @@ static gboolean mock_is_valid_nnak = TRUE;
 #define pgm_csum_block_add		mock_pgm_csum_block_add
 #define pgm_csum_fold			mock_pgm_csum_fold
 #define pgm_sendto_hops			mock_pgm_sendto_hops
+#define pgm_sendto_skb			mock_pgm_sendto_skb
+#define pgm_sendto_repair		mock_pgm_sendto_repair
+#define pgm_sendmmsg			mock_pgm_sendmmsg
+#define pgm_zerocopy_reap		mock_pgm_zerocopy_reap
 #define pgm_time_update_now		mock_pgm_time_update_now
 #define pgm_setsockopt			mock_pgm_setsockopt
 
@@ -300,6 +305,14 @@ mock_pgm_txw_add (
 		(gpointer)window, (gpointer)skb);
 }
 
+void
+mock_pgm_txw_fold_parity (
+	pgm_txw_t* const		window,
+	const struct pgm_sk_buff_t* const skb
+	)
+{
+}
+
 struct pgm_sk_buff_t*
 mock_pgm_txw_peek (
 	const pgm_txw_t* const		window,
@@ -387,7 +400,8 @@ bool
 mock_pgm_rate_check (
 	pgm_rate_t*			bucket,
 	const size_t			data_size,
-	const bool			is_nonblocking
+	const bool			is_nonblocking,
+	pgm_time_t*			now
 	)
 {
 	g_debug ("mock_pgm_rate_check (bucket:%p data-size:%u is-nonblocking:%s)",
@@ -472,6 +486,7 @@ mock_pgm_sendto_hops (
 	pgm_sock_t*			sock,
 	bool				use_rate_limit,
 	pgm_rate_t*			minor_rate_control,
+	pgm_time_t*			now,
 	bool				use_router_alert,
 	int				level,
 	const void*			buf,
@@ -495,6 +510,91 @@ mock_pgm_sendto_hops (
 	return len;
 }
 
+PGM_GNUC_INTERNAL
+ssize_t
+mock_pgm_sendto_skb (
+	pgm_sock_t*			sock,
+	bool				use_rate_limit,
+	pgm_rate_t*			minor_rate_control,
+	pgm_time_t*			now,
+	bool				use_router_alert,
+	struct pgm_sk_buff_t*		skb,
+	const struct sockaddr*		to,
+	socklen_t			tolen
+	)
+{
+	char saddr[INET6_ADDRSTRLEN];
+	pgm_sockaddr_ntop (to, saddr, sizeof(saddr));
+	g_debug ("mock_pgm_sendto_skb (sock:%p use-rate-limit:%s minor-rate-control:%p use-router-alert:%s skb:%p to:%s tolen:%d)",
+		(gpointer)sock,
+		use_rate_limit ? "YES" : "NO",
+		(gpointer)minor_rate_control,
+		use_router_alert ? "YES" : "NO",
+		(gpointer)skb,
+		saddr,
+		tolen);
+	return (char*)skb->tail - (char*)skb->head;
+}
+
+PGM_GNUC_INTERNAL
+ssize_t
+mock_pgm_sendto_repair (
+	pgm_sock_t*			sock,
+	bool				use_rate_limit,
+	pgm_rate_t*			minor_rate_control,
+	pgm_time_t*			now,
+	struct pgm_sk_buff_t*		skb,
+	const struct sockaddr*		to,
+	socklen_t			tolen
+	)
+{
+	char saddr[INET6_ADDRSTRLEN];
+	pgm_sockaddr_ntop (to, saddr, sizeof(saddr));
+	g_debug ("mock_pgm_sendto_repair (sock:%p use-rate-limit:%s minor-rate-control:%p skb:%p to:%s tolen:%d)",
+		(gpointer)sock,
+		use_rate_limit ? "YES" : "NO",
+		(gpointer)minor_rate_control,
+		(gpointer)skb,
+		saddr,
+		tolen);
+	return (char*)skb->tail - (char*)skb->head;
+}
+
+PGM_GNUC_INTERNAL
+ssize_t
+mock_pgm_sendmmsg (
+	pgm_sock_t*			sock,
+	bool				use_rate_limit,
+	pgm_rate_t*			minor_rate_control,
+	pgm_time_t*			now,
+	struct pgm_sk_buff_t**		vector,
+	unsigned			count,
+	const struct sockaddr*		to,
+	socklen_t			tolen
+	)
+{
+	char saddr[INET6_ADDRSTRLEN];
+	pgm_sockaddr_ntop (to, saddr, sizeof(saddr));
+	g_debug ("mock_pgm_sendmmsg (sock:%p use-rate-limit:%s minor-rate-control:%p vector:%p count:%u to:%s tolen:%d)",
+		(gpointer)sock,
+		use_rate_limit ? "YES" : "NO",
+		(gpointer)minor_rate_control,
+		(gpointer)vector,
+		count,
+		saddr,
+		tolen);
+	return count;
+}
+
+PGM_GNUC_INTERNAL
+void
+mock_pgm_zerocopy_reap (
+	pgm_sock_t*			sock
+	)
+{
+	g_debug ("mock_pgm_zerocopy_reap (sock:%p)", (gpointer)sock);
+}
+
 /** time module */
 static pgm_time_t _mock_pgm_time_update_now (void);
 pgm_time_update_func mock_pgm_time_update_now = _mock_pgm_time_update_now;
@@ -583,6 +683,31 @@ START_TEST (test_send_pass_002)
 }
 END_TEST
 
+/* coalesced small apdus, held until the packet fills */
+START_TEST (test_send_pass_003)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	sock->coalesce_ivl = pgm_msecs(1);
+	const gsize apdu_length = 100;
+	guint8 buffer[ apdu_length ];
+	gsize bytes_written;
+	const unsigned per_tsdu = source_max_tsdu (sock, TRUE) / (sizeof(guint16) + apdu_length);
+	for (unsigned i = 0; i < per_tsdu; i++) {
+		fail_unless (PGM_IO_STATUS_NORMAL == pgm_send (sock, buffer, apdu_length, &bytes_written), "send not normal");
+		fail_unless ((gssize)apdu_length == bytes_written, "send underrun");
+	}
+	fail_unless (0 == sock->cumulative_stats[PGM_PC_SOURCE_DATA_MSGS_SENT], "packet sent early");
+	fail_if (NULL == sock->coalesce_skb, "apdus not held");
+	fail_unless (per_tsdu * (sizeof(guint16) + apdu_length) == sock->coalesce_skb->len, "held length mismatch");
+/* next apdu does not fit */
+	fail_unless (PGM_IO_STATUS_NORMAL == pgm_send (sock, buffer, apdu_length, &bytes_written), "send not normal");
+	fail_unless (1 == sock->cumulative_stats[PGM_PC_SOURCE_DATA_MSGS_SENT], "packet not sent");
+	fail_unless ((sizeof(guint16) + apdu_length) == sock->coalesce_skb->len, "held length mismatch");
+}
+END_TEST
+
 START_TEST (test_send_fail_001)
 {
 	guint8 buffer[ TEST_TXW_SQNS * TEST_MAX_TPDU ];
@@ -669,6 +794,23 @@ START_TEST (test_sendv_pass_004)
 }
 END_TEST
 
+/* large apdu, batched fragments */
+START_TEST (test_sendv_pass_005)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	sock->send_batch = 4;
+	const gsize apdu_length = 16000;
+	guint8 buffer[ apdu_length ];
+	struct pgm_iovec vector[] = { { .iov_base = buffer, .iov_len = apdu_length } };
+	gsize bytes_written;
+	fail_unless (PGM_IO_STATUS_NORMAL == pgm_sendv (sock, vector, 1, TRUE, &bytes_written), "send not normal");
+	fail_unless ((gssize)apdu_length == bytes_written, "send underrun");
+	fail_unless (0 == sock->pkt_dontwait_state.batch_len, "batch not flushed");
+}
+END_TEST
+
 START_TEST (test_sendv_fail_001)
 {
 	guint8 buffer[ TEST_TXW_SQNS * TEST_MAX_TPDU ];
@@ -752,6 +894,128 @@ START_TEST (test_send_skbv_fail_001)
 }
 END_TEST
 
+/* target:
+ *	PGMIOStatus
+ *	pgm_send_flush (
+ *		pgm_sock_t*	sock
+ *		)
+ */
+
+START_TEST (test_send_flush_pass_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	sock->coalesce_ivl = pgm_msecs(1);
+	const gsize apdu_length = 100;
+	guint8 buffer[ apdu_length ];
+	gsize bytes_written;
+/* nothing held */
+	fail_unless (PGM_IO_STATUS_NORMAL == pgm_send_flush (sock), "flush not normal");
+	fail_unless (0 == sock->cumulative_stats[PGM_PC_SOURCE_DATA_MSGS_SENT], "packet sent");
+	fail_unless (PGM_IO_STATUS_NORMAL == pgm_send (sock, buffer, apdu_length, &bytes_written), "send not normal");
+	fail_unless (PGM_IO_STATUS_NORMAL == pgm_send (sock, buffer, apdu_length, &bytes_written), "send not normal");
+	fail_unless (PGM_IO_STATUS_NORMAL == pgm_send_flush (sock), "flush not normal");
+	fail_unless (1 == sock->cumulative_stats[PGM_PC_SOURCE_DATA_MSGS_SENT], "packet not sent");
+	fail_unless (NULL == sock->coalesce_skb, "apdus still held");
+}
+END_TEST
+
+/* held apdus sent by the timer once expired */
+START_TEST (test_send_flush_pass_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	sock->coalesce_ivl = pgm_msecs(1);
+	const gsize apdu_length = 100;
+	guint8 buffer[ apdu_length ];
+	gsize bytes_written;
+	fail_unless (PGM_IO_STATUS_NORMAL == pgm_send (sock, buffer, apdu_length, &bytes_written), "send not normal");
+	fail_unless (pgm_on_coalesce_expiry (sock, sock->coalesce_expiry - 1), "on_coalesce_expiry failed");
+	fail_if (NULL == sock->coalesce_skb, "apdus not held");
+	fail_unless (pgm_on_coalesce_expiry (sock, sock->coalesce_expiry), "on_coalesce_expiry failed");
+	fail_unless (NULL == sock->coalesce_skb, "apdus still held");
+	fail_unless (1 == sock->cumulative_stats[PGM_PC_SOURCE_DATA_MSGS_SENT], "packet not sent");
+}
+END_TEST
+
+START_TEST (test_send_flush_fail_001)
+{
+	fail_unless (PGM_IO_STATUS_ERROR == pgm_send_flush (NULL), "flush not error");
+}
+END_TEST
+
+/* target:
+ *	gpointer
+ *	pgm_send_claim (
+ *		pgm_sock_t*	sock,
+ *		gsize		length
+ *		)
+ *
+ *	PGMIOStatus
+ *	pgm_send_commit (
+ *		pgm_sock_t*	sock,
+ *		gsize		length,
+ *		gsize*		bytes_written
+ *		)
+ */
+
+START_TEST (test_send_claim_pass_001)
+{
+	const char source[] = "i am not a string";
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	gpointer data = pgm_send_claim (sock, sock->max_tsdu);
+	fail_if (NULL == data, "claim failed");
+	fail_unless (data == pgm_send_claim (sock, sizeof(source)), "claim not repeated");
+	memcpy (data, source, sizeof(source));
+	gsize bytes_written;
+	fail_unless (PGM_IO_STATUS_NORMAL == pgm_send_commit (sock, sizeof(source), &bytes_written), "commit not normal");
+	fail_unless (sizeof(source) == bytes_written, "commit underrun");
+	fail_unless (NULL == sock->claim_skb, "claim still held");
+	fail_unless (1 == sock->cumulative_stats[PGM_PC_SOURCE_DATA_MSGS_SENT], "packet not sent");
+/* payload sent in place behind the PGM header */
+	const struct pgm_header* header = (const struct pgm_header*)((const char*)data - pgm_pkt_offset (FALSE, FALSE));
+	fail_unless (PGM_ODATA == header->pgm_type, "not odata");
+	fail_unless (sizeof(source) == g_ntohs (header->pgm_tsdu_length), "tsdu length mismatch");
+}
+END_TEST
+
+/* held small apdus sent first */
+START_TEST (test_send_claim_pass_002)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	sock->coalesce_ivl = pgm_msecs(1);
+	const gsize apdu_length = 100;
+	guint8 buffer[ apdu_length ];
+	gsize bytes_written;
+	fail_unless (PGM_IO_STATUS_NORMAL == pgm_send (sock, buffer, apdu_length, &bytes_written), "send not normal");
+	fail_if (NULL == pgm_send_claim (sock, apdu_length), "claim failed");
+	fail_unless (PGM_IO_STATUS_NORMAL == pgm_send_commit (sock, apdu_length, &bytes_written), "commit not normal");
+	fail_unless (NULL == sock->coalesce_skb, "apdus still held");
+	fail_unless (2 == sock->cumulative_stats[PGM_PC_SOURCE_DATA_MSGS_SENT], "packets not sent");
+}
+END_TEST
+
+START_TEST (test_send_claim_fail_001)
+{
+	pgm_sock_t* sock = generate_sock ();
+	fail_if (NULL == sock, "generate_sock failed");
+	sock->is_bound = TRUE;
+	gsize bytes_written;
+	fail_unless (NULL == pgm_send_claim (NULL, 100), "claim not NULL");
+	fail_unless (NULL == pgm_send_claim (sock, sock->max_tsdu + 1), "claim not NULL");
+	fail_unless (PGM_IO_STATUS_ERROR == pgm_send_commit (sock, 100, &bytes_written), "commit without claim not error");
+	fail_if (NULL == pgm_send_claim (sock, 100), "claim failed");
+	fail_unless (PGM_IO_STATUS_ERROR == pgm_send_commit (sock, sock->max_tsdu + 1, &bytes_written), "commit not error");
+	fail_unless (PGM_IO_STATUS_ERROR == pgm_send_commit (NULL, 100, &bytes_written), "commit not error");
+}
+END_TEST
+
 /* target:
  *	gboolean
  *	pgm_send_spm (
@@ -1158,6 +1422,7 @@ make_test_suite (void)
 	tcase_add_checked_fixture (tc_send, mock_setup, NULL);
 	tcase_add_test (tc_send, test_send_pass_001);
 	tcase_add_test (tc_send, test_send_pass_002);
+	tcase_add_test (tc_send, test_send_pass_003);
 	tcase_add_test (tc_send, test_send_fail_001);
 
 	TCase* tc_sendv = tcase_create ("sendv");
@@ -1167,6 +1432,7 @@ make_test_suite (void)
 	tcase_add_test (tc_sendv, test_sendv_pass_002);
 	tcase_add_test (tc_sendv, test_sendv_pass_003);
 	tcase_add_test (tc_sendv, test_sendv_pass_004);
+	tcase_add_test (tc_sendv, test_sendv_pass_005);
 	tcase_add_test (tc_sendv, test_sendv_fail_001);
 
 	TCase* tc_send_skbv = tcase_create ("send-skbv");
@@ -1176,6 +1442,20 @@ make_test_suite (void)
 	tcase_add_test (tc_send_skbv, test_send_skbv_pass_002);
 	tcase_add_test (tc_send_skbv, test_send_skbv_fail_001);
 
+	TCase* tc_send_flush = tcase_create ("send-flush");
+	suite_add_tcase (s, tc_send_flush);
+	tcase_add_checked_fixture (tc_send_flush, mock_setup, NULL);
+	tcase_add_test (tc_send_flush, test_send_flush_pass_001);
+	tcase_add_test (tc_send_flush, test_send_flush_pass_002);
+	tcase_add_test (tc_send_flush, test_send_flush_fail_001);
+
+	TCase* tc_send_claim = tcase_create ("send-claim");
+	suite_add_tcase (s, tc_send_claim);
+	tcase_add_checked_fixture (tc_send_claim, mock_setup, NULL);
+	tcase_add_test (tc_send_claim, test_send_claim_pass_001);
+	tcase_add_test (tc_send_claim, test_send_claim_pass_002);
+	tcase_add_test (tc_send_claim, test_send_claim_fail_001);
+
 	TCase* tc_send_spm = tcase_create ("send-spm");
 	suite_add_tcase (s, tc_send_spm);
 	tcase_add_checked_fixture (tc_send_spm, mock_setup, NULL);
@@ -451,7 +451,7 @@ on_io_data (
                 goto out;
 
 /* search for TSI peer context or create a new one */
-        pgm_peer_t* sender = pgm_hashtable_lookup (sock->peers_hashtable, &skb->tsi);
+        pgm_peer_t* sender = pgm_tsitable_lookup (sock->peers_table, &skb->tsi);
         if (sender == NULL)
         {
 		printf ("new peer, tsi %s, local nla %s\n",
@@ -463,7 +463,7 @@ on_io_data (
 		((struct sockaddr_in*)&peer->nla)->sin_addr.s_addr = INADDR_ANY;
 		memcpy (&peer->local_nla, &src_addr, src_addr_len);
 
-		pgm_hashtable_insert (sock->peers_hashtable, &peer->tsi, peer);
+		pgm_tsitable_insert (sock->peers_table, &peer->tsi, peer);
 		sender = peer;
         }
 
@@ -555,8 +555,8 @@ fake_pgm_bind3 (
 
 /* create peer list */
         if (sock->can_recv_data) {
-                sock->peers_hashtable = pgm_hashtable_new (pgm_tsi_hash, pgm_tsi_equal);
-                pgm_assert (NULL != sock->peers_hashtable);
+                sock->peers_table = pgm_tsitable_new ();
+                pgm_assert (NULL != sock->peers_table);
         }
 
 /* IP/PGM only */
@@ -829,9 +829,9 @@ fake_pgm_close (
                 closesocket (sock->send_sock);
                 sock->send_sock = INVALID_SOCKET;
         }
-	if (sock->peers_hashtable) {
-		pgm_hashtable_destroy (sock->peers_hashtable);
-                sock->peers_hashtable = NULL;
+	if (sock->peers_table) {
+		pgm_tsitable_destroy (sock->peers_table);
+                sock->peers_table = NULL;
         }
         if (sock->peers_list) {
 		do {
@@ -1689,7 +1689,7 @@ net_send_spmr (
 	pgm_sock_t* sock = sess->sock;
 
 /* check that the peer exists */
-	pgm_peer_t* peer = pgm_hashtable_lookup (sock->peers_hashtable, tsi);
+	pgm_peer_t* peer = pgm_tsitable_lookup (sock->peers_table, tsi);
 	struct sockaddr_storage peer_nla;
 	pgm_gsi_t* peer_gsi;
 	guint16 peer_sport;
@@ -1777,7 +1777,7 @@ net_send_ncf (
 
 /* check that the peer exists */
 	pgm_sock_t* sock = sess->sock;
-	pgm_peer_t* peer = pgm_hashtable_lookup (sock->peers_hashtable, tsi);
+	pgm_peer_t* peer = pgm_tsitable_lookup (sock->peers_table, tsi);
 	if (peer == NULL) {
 		printf ("FAILED: peer \"%s\" not found\n", pgm_tsi_print (tsi));
 		return;
@@ -1876,7 +1876,7 @@ net_send_nak (
 
 /* check that the peer exists */
 	pgm_sock_t* sock = sess->sock;
-	pgm_peer_t* peer = pgm_hashtable_lookup (sock->peers_hashtable, tsi);
+	pgm_peer_t* peer = pgm_tsitable_lookup (sock->peers_table, tsi);
 	if (peer == NULL) {
 		printf ("FAILED: peer \"%s\" not found\n", pgm_tsi_print(tsi));
 		return;
@@ -31,6 +31,9 @@
 #	include <windows.h>
 #	include <mmsystem.h>
 #endif
+#if defined( HAVE_RDTSC ) && !defined( HAVE_PROC_CPUINFO ) && defined( __GNUC__ )
+#	include <cpuid.h>
+#endif
 #include <impl/i18n.h>
 #include <impl/framework.h>
 
@@ -63,12 +66,17 @@ pgm_time_since_epoch_func	pgm_time_since_epoch PGM_GNUC_READ_MOSTLY;
 static volatile uint32_t	time_ref_count = 0;
 static pgm_time_t		rel_offset PGM_GNUC_READ_MOSTLY = 0;
 
+/* optional count of clock reads, PGM_TIME_COUNT interposes a counting stub */
+static pgm_time_update_func	time_update_uncounted PGM_GNUC_READ_MOSTLY = NULL;
+static volatile uint32_t	time_read_count = 0;
+
 #ifdef _WIN32
 static UINT			wTimerRes = 0;
 #endif
 
 static void			pgm_time_conv (const pgm_time_t*const restrict, time_t*restrict);
 static void			pgm_time_conv_from_reset (const pgm_time_t*const restrict, time_t*restrict);
+static pgm_time_t		pgm_time_update_counted (void);
 
 #if defined(HAVE_CLOCK_GETTIME)
 #	include <time.h>
@@ -226,6 +234,46 @@ us_to_tsc (
 static bool			pgm_tsc_init (pgm_error_t**);
 #	endif
 static pgm_time_t		pgm_tsc_update (void);
+
+#	ifdef HAVE_CLOCK_GETTIME
+/* TSC is extrapolated from an anchor sample of a reference clock that is not
+ * slewed by NTP, every TSC_RESYNC_SECS the anchor is refreshed and the rate
+ * recomputed over the whole run to remove calibration error and drift.
+ */
+#		ifdef CLOCK_MONOTONIC_RAW
+#			define TSC_CLOCK_ID	CLOCK_MONOTONIC_RAW
+#		else
+#			define TSC_CLOCK_ID	CLOCK_MONOTONIC
+#		endif
+#		define TSC_CALIBRATION_MSECS	10
+#		define TSC_RESYNC_SECS		1
+#		define TSC_FINE_SCALE		32
+/* minimum run before the refined frequency is written back to the cache */
+#		define TSC_CACHE_SECS		10
+/* cached frequency is only trusted if within 1/TSC_CACHE_TOLERANCE of calibration */
+#		define TSC_CACHE_TOLERANCE	100
+
+struct tsc_anchor_t {
+	uint64_t	tsc;
+	pgm_time_t	usecs;
+	uint64_t	us_mul;		/* microseconds per tick << TSC_FINE_SCALE */
+};
+
+/* anchor is published under a sequence count, odd whilst being updated */
+static volatile uint32_t		tsc_seq = 0;
+static volatile struct tsc_anchor_t	tsc_anchor;
+static volatile uint32_t		tsc_resync_lock = 0;
+static uint64_t				tsc_resync_ticks PGM_GNUC_READ_MOSTLY = 0;
+static uint64_t				tsc_origin_tsc = 0;
+static uint64_t				tsc_origin_nsecs = 0;
+static char*				tsc_cache_path = NULL;
+
+static void			pgm_tsc_shutdown (void);
+static bool			pgm_tsc_resync (pgm_time_t*restrict);
+#		define TSC_FALLBACK_UPDATE	pgm_clock_update
+#	else
+#		define TSC_FALLBACK_UPDATE	pgm_gettimeofday_update
+#	endif
 #endif
 
 
@@ -255,6 +303,10 @@ pgm_time_init (
 /* default time stamp function */
 #if defined(_WIN32)
 			"MMTIME"
+#elif defined(HAVE_RDTSC) && defined(HAVE_CLOCK_GETTIME)
+			"TSC"
+#elif defined(HAVE_CLOCK_GETTIME)
+			"CLOCK_GETTIME"
 #else
 			"GETTIMEOFDAY"
 #endif
@@ -274,6 +326,7 @@ pgm_time_init (
 	case 'C':
 		pgm_minor (_("Using clock_gettime() timer."));
 		pgm_time_update_now	= pgm_clock_update;
+		pgm_time_since_epoch	= pgm_time_conv_from_reset;
 		break;
 #endif
 #ifdef HAVE_DEV_RTC
@@ -372,20 +425,17 @@ pgm_time_init (
 	{
 		char	*rdtsc_frequency;
 
-#ifdef HAVE_PROC_CPUINFO
-/* attempt to parse clock ticks from kernel
+#ifdef __linux__
+/* TSC frequency as measured by the kernel at boot, "cpu MHz" of /proc/cpuinfo
+ * is the current core frequency and unrelated to the rate of an invariant TSC.
  */
-		FILE	*fp = fopen ("/proc/cpuinfo", "r");
+		FILE	*fp = fopen ("/sys/devices/system/cpu/cpu0/tsc_freq_khz", "r");
 		if (fp)
 		{
-			char buffer[1024];
-			while (!feof(fp) && fgets (buffer, sizeof(buffer), fp))
-			{
-				if (strstr (buffer, "cpu MHz")) {
-					const char *p = strchr (buffer, ':');
-					if (p) tsc_khz = atoi (p + 1) * 1000;
-					break;
-				}
+			unsigned khz;
+			if (1 == fscanf (fp, "%u", &khz)) {
+				tsc_khz = khz;
+				pgm_minor (_("Kernel reports TSC frequency %u KHz"), khz);
 			}
 			fclose (fp);
 		}
@@ -476,9 +526,21 @@ pgm_time_init (
 			pgm_free (rdtsc_frequency);
 		}
 
+#ifdef HAVE_CLOCK_GETTIME
+/* e.g. export RDTSC_CACHE=/var/tmp/pgm_tsc_khz
+ *
+ * File to carry the refined TSC frequency across runs.
+ */
+		err = pgm_dupenv_s (&tsc_cache_path, &envlen, "RDTSC_CACHE");
+		if (0 != err || 0 == envlen) {
+			pgm_free (tsc_cache_path);
+			tsc_cache_path = NULL;
+		}
+#endif
+
 #ifndef _WIN32
-/* calibrate */
-		if (0 >= tsc_khz) {
+/* stability test and calibration */
+		{
 			pgm_error_t* sub_error = NULL;
 			if (!pgm_tsc_init (&sub_error)) {
 				pgm_propagate_error (error, sub_error);
@@ -486,8 +548,10 @@ pgm_time_init (
 			}
 		}
 #endif
-		pgm_minor (_("TSC frequency set at %u KHz"), (unsigned)(tsc_khz));
-		set_tsc_mul (tsc_khz);
+		if (pgm_time_update_now == pgm_tsc_update) {
+			pgm_minor (_("TSC frequency set at %u KHz"), (unsigned)(tsc_khz));
+			set_tsc_mul (tsc_khz);
+		}
 	}
 #endif /* HAVE_RDTSC */
 
@@ -505,8 +569,11 @@ pgm_time_init (
 	pgm_time_update_now();
 
 /* calculate relative time offset */
-#if defined(HAVE_DEV_RTC) || defined(HAVE_RDTSC) || defined(HAVE_DEV_HPET) || defined(_WIN32)
+#if defined(HAVE_CLOCK_GETTIME) || defined(HAVE_DEV_RTC) || defined(HAVE_RDTSC) || defined(HAVE_DEV_HPET) || defined(_WIN32)
 	if (	0
+#	ifdef HAVE_CLOCK_GETTIME
+		|| pgm_time_update_now == pgm_clock_update
+#	endif
 #	ifdef HAVE_DEV_RTC
 		|| pgm_time_update_now == pgm_rtc_update
 #	endif
@@ -534,6 +601,21 @@ pgm_time_init (
 	rel_offset = 0;
 #endif
 
+/* e.g. export PGM_TIME_COUNT=1 and compare pgm_time_read_count() with packet counts
+ */
+	{
+		char	*time_count;
+
+		err = pgm_dupenv_s (&time_count, &envlen, "PGM_TIME_COUNT");
+		if (0 == err && envlen > 0) {
+			pgm_free (time_count);
+			pgm_atomic_write32 (&time_read_count, 0);
+			time_update_uncounted	= pgm_time_update_now;
+			pgm_time_update_now	= pgm_time_update_counted;
+			pgm_minor (_("Counting time stamp reads."));
+		}
+	}
+
 /* update Windows timer resolution to 1ms */
 #ifdef _WIN32
 	TIMECAPS tc;
@@ -569,6 +651,12 @@ pgm_time_shutdown (void)
 	if (pgm_atomic_exchange_and_add32 (&time_ref_count, (uint32_t)-1) != 1)
 		return retval;
 
+	if (NULL != time_update_uncounted) {
+		pgm_minor (_("%" PRIu32 " time stamp reads."), pgm_atomic_read32 (&time_read_count));
+		pgm_time_update_now	= time_update_uncounted;
+		time_update_uncounted	= NULL;
+	}
+
 #ifdef _WIN32
 	timeEndPeriod (wTimerRes);
 #endif
@@ -580,10 +668,34 @@ pgm_time_shutdown (void)
 #ifdef HAVE_DEV_HPET
 	if (pgm_time_update_now == pgm_hpet_update)
 		retval = pgm_hpet_shutdown ();
+#endif
+#if defined(HAVE_RDTSC) && defined(HAVE_CLOCK_GETTIME)
+	pgm_tsc_shutdown ();
 #endif
 	return retval;
 }
 
+/* counting stub in front of the configured time stamp function.
+ */
+
+static
+pgm_time_t
+pgm_time_update_counted (void)
+{
+	pgm_atomic_inc32 (&time_read_count);
+	return time_update_uncounted ();
+}
+
+/* returns count of time stamp reads since initialisation when PGM_TIME_COUNT is
+ * set in the environment, otherwise zero.  wraps at 2³².
+ */
+
+uint32_t
+pgm_time_read_count (void)
+{
+	return pgm_atomic_read32 (&time_read_count);
+}
+
 #ifdef HAVE_GETTIMEOFDAY
 static
 pgm_time_t
@@ -792,9 +904,223 @@ pgm_rdtsc (void)
 #	endif
 }
 
+#	ifdef HAVE_CLOCK_GETTIME
+/* sample the reference clock bracketed by TSC reads, the narrowest of a few
+ * attempts is kept to reject samples interrupted or preempted mid-read.
+ */
+
+static
+void
+pgm_tsc_sample (
+	uint64_t*restrict	tsc,
+	uint64_t*restrict	nsecs
+	)
+{
+	struct timespec	clock_now;
+	uint64_t	start, stop, window = UINT64_MAX;
+	unsigned	i;
+
+	for (i = 0; i < 3; i++)
+	{
+		start = pgm_rdtsc();
+		clock_gettime (TSC_CLOCK_ID, &clock_now);
+		stop = pgm_rdtsc();
+		if (stop - start < window) {
+			window = stop - start;
+			*tsc   = start + (window / 2);
+			*nsecs = secs_to_nsecs (clock_now.tv_sec) + clock_now.tv_nsec;
+		}
+	}
+}
+
+/* publish a new anchor, readers retry whilst the sequence count is odd or has
+ * moved.  TSC implies x86 where stores are not reordered with other stores, so
+ * volatile access suffices to order the anchor against the count.
+ */
+
+static
+void
+pgm_tsc_publish (
+	const uint64_t		tsc,
+	const pgm_time_t	usecs,
+	const uint64_t		us_mul
+	)
+{
+	pgm_atomic_inc32 (&tsc_seq);
+	tsc_anchor.tsc    = tsc;
+	tsc_anchor.usecs  = usecs;
+	tsc_anchor.us_mul = us_mul;
+	pgm_atomic_inc32 (&tsc_seq);
+}
+
+/* returns cached TSC frequency in KHz, or 0 if unavailable.
+ */
+
+static
+uint_fast32_t
+pgm_tsc_cache_read (void)
+{
+	FILE*		fp;
+	unsigned	khz = 0;
+
+	if (NULL == tsc_cache_path)
+		return 0;
+	fp = fopen (tsc_cache_path, "r");
+	if (NULL == fp)
+		return 0;
+	if (1 != fscanf (fp, "%u", &khz))
+		khz = 0;
+	fclose (fp);
+	return khz;
+}
+
+/* determine ratio of ticks to micro-seconds against the reference clock over a
+ * short interval, accuracy is recovered by pgm_tsc_resync() re-measuring the
+ * ratio over the entire run.
+ */
+
+static
+bool
+pgm_tsc_calibrate (void)
+{
+	struct timespec	req = {
+				.tv_sec  = 0,
+				.tv_nsec = msecs_to_nsecs (TSC_CALIBRATION_MSECS)
+			};
+	uint64_t	tsc, nsecs;
+	uint_fast32_t	cached_khz;
+
+	pgm_tsc_sample (&tsc_origin_tsc, &tsc_origin_nsecs);
+	tsc   = tsc_origin_tsc;
+	nsecs = tsc_origin_nsecs;
+
+/* calibrate unless frequency provided by kernel or environment */
+	if (0 == tsc_khz)
+	{
+		while (-1 == nanosleep (&req, &req) && EINTR == errno);
+		pgm_tsc_sample (&tsc, &nsecs);
+		if (tsc <= tsc_origin_tsc || nsecs <= tsc_origin_nsecs) {
+			pgm_warn (_("Unstable TSC detected, calibration resulted in a non-monotonic "
+				   "time response rendering the TSC unsuitable for high resolution timing."));
+			return FALSE;
+		}
+		tsc_khz = (uint_fast32_t)(((tsc - tsc_origin_tsc) * 1000000) / (nsecs - tsc_origin_nsecs));
+		pgm_minor (_("Calibrated TSC frequency %" PRIuFAST32 " KHz over %u ms."),
+			   tsc_khz, (unsigned)TSC_CALIBRATION_MSECS);
+
+/* a refined frequency from a prior run is preferred if consistent with this system */
+		cached_khz = pgm_tsc_cache_read();
+		if (cached_khz > 0 &&
+		    cached_khz > tsc_khz - (tsc_khz / TSC_CACHE_TOLERANCE) &&
+		    cached_khz < tsc_khz + (tsc_khz / TSC_CACHE_TOLERANCE))
+		{
+			pgm_minor (_("Using cached TSC frequency %" PRIuFAST32 " KHz from %s"),
+				   cached_khz, tsc_cache_path);
+			tsc_khz = cached_khz;
+		}
+	}
+
+	tsc_resync_ticks = (uint64_t)tsc_khz * secs_to_msecs (TSC_RESYNC_SECS);
+	pgm_tsc_publish (tsc, nsecs_to_usecs (nsecs), ((uint64_t)1000 << TSC_FINE_SCALE) / tsc_khz);
+	return TRUE;
+}
+
+/* refresh the anchor from the reference clock and recompute the ratio from the
+ * origin sample.  Only one caller proceeds, others continue to extrapolate from
+ * the current anchor.
+ *
+ * returns TRUE and sets now on resync, returns FALSE if already in progress.
+ */
+
+static
+bool
+pgm_tsc_resync (
+	pgm_time_t*restrict	now
+	)
+{
+	uint64_t	tsc, nsecs, elapsed_tsc, elapsed_nsecs;
+
+	if (0 != pgm_atomic_exchange_and_add32 (&tsc_resync_lock, 1)) {
+		pgm_atomic_dec32 (&tsc_resync_lock);
+		return FALSE;
+	}
+
+	pgm_tsc_sample (&tsc, &nsecs);
+	elapsed_tsc   = tsc - tsc_origin_tsc;
+	elapsed_nsecs = nsecs - tsc_origin_nsecs;
+/* keep the scaled ratio within 64 bits */
+	while (elapsed_nsecs >= (UINT64_C(1) << (64 - TSC_FINE_SCALE))) {
+		elapsed_nsecs >>= 1;
+		elapsed_tsc   >>= 1;
+	}
+	if (PGM_LIKELY(elapsed_tsc > 0))
+		pgm_tsc_publish (tsc, nsecs_to_usecs (nsecs), ((elapsed_nsecs << TSC_FINE_SCALE) / elapsed_tsc) / 1000);
+	else
+		pgm_tsc_publish (tsc, nsecs_to_usecs (nsecs), tsc_anchor.us_mul);
+
+	pgm_atomic_dec32 (&tsc_resync_lock);
+	*now = nsecs_to_usecs (nsecs);
+	return TRUE;
+}
+
+/* save frequency measured over this run for the next.
+ */
+
+static
+void
+pgm_tsc_shutdown (void)
+{
+	FILE*		fp;
+	uint64_t	tsc, nsecs;
+
+	if (NULL == tsc_cache_path)
+		return;
+	pgm_tsc_sample (&tsc, &nsecs);
+	if (pgm_time_update_now == pgm_tsc_update &&
+	    nsecs - tsc_origin_nsecs >= secs_to_nsecs (TSC_CACHE_SECS) &&
+	    tsc > tsc_origin_tsc)
+	{
+		const uint64_t khz = ((tsc - tsc_origin_tsc) * 1000) / nsecs_to_usecs (nsecs - tsc_origin_nsecs);
+		fp = fopen (tsc_cache_path, "w");
+		if (NULL != fp) {
+			fprintf (fp, "%u\n", (unsigned)khz);
+			fclose (fp);
+		} else {
+			char errbuf[1024];
+			pgm_warn (_("Cannot write TSC frequency cache %s: %s"),
+				  tsc_cache_path,
+				  pgm_strerror_s (errbuf, sizeof (errbuf), errno));
+		}
+	}
+	pgm_free (tsc_cache_path);
+	tsc_cache_path = NULL;
+}
+#	endif /* HAVE_CLOCK_GETTIME */
+
+#	if !defined( _WIN32 ) && !defined( HAVE_PROC_CPUINFO )
+/* test for an invariant TSC, CPUID.80000007H:EDX[8], that ticks at a constant
+ * rate through frequency scaling and deep sleep states.  the leaf is shared by
+ * Intel and AMD, compilers without cpuid.h are presumed lacking.
+ */
+
+static
+bool
+pgm_tsc_is_invariant (void)
+{
+#		ifdef __GNUC__
+	unsigned eax, ebx, ecx, edx;
+
+	if (!__get_cpuid (0x80000007, &eax, &ebx, &ecx, &edx))
+		return FALSE;
+	return 0 != (edx & (1 << 8));
+#		else
+	return FALSE;
+#		endif
+}
+#	endif
+
 #	ifndef _WIN32
-/* determine ratio of ticks to nano-seconds, use /dev/rtc for high accuracy
- * millisecond timer and convert.
+/* test for a stable TSC and determine ratio of ticks to micro-seconds.
  *
  * WARNING: time is relative to start of timer.
  */
@@ -824,17 +1150,29 @@ pgm_tsc_init (
 	if (!flags || !strstr (flags, " tsc")) {
 		pgm_warn (_("Linux kernel reports no Time Stamp Counter (TSC)."));
 /* force both to stable clocks even though one might be OK */
-		pgm_time_update_now	= pgm_gettimeofday_update;
+		pgm_time_update_now	= TSC_FALLBACK_UPDATE;
 		return TRUE;
 	}
 	if (!strstr (flags, " constant_tsc")) {
 		pgm_warn (_("Linux kernel reports non-constant Time Stamp Counter (TSC)."));
 /* force both to stable clocks even though one might be OK */
-		pgm_time_update_now	= pgm_gettimeofday_update;
+		pgm_time_update_now	= TSC_FALLBACK_UPDATE;
+		return TRUE;
+	}
+#		else
+	if (!pgm_tsc_is_invariant()) {
+		pgm_warn (_("Processor reports no invariant Time Stamp Counter (TSC)."));
+		pgm_time_update_now	= TSC_FALLBACK_UPDATE;
 		return TRUE;
 	}
 #		endif /* HAVE_PROC_CPUINFO */
 
+#		ifdef HAVE_CLOCK_GETTIME
+	if (!pgm_tsc_calibrate()) {
+		pgm_time_update_now	= TSC_FALLBACK_UPDATE;
+	}
+	return TRUE;
+#		else
 	pgm_time_t		start, stop, elapsed;
 	const pgm_time_t	calibration_usec = secs_to_usecs (4);
 	struct timespec		req = {
@@ -842,6 +1180,10 @@ pgm_tsc_init (
 					.tv_nsec = 0
 				};
 
+/* frequency provided by kernel or environment */
+	if (tsc_khz > 0)
+		return TRUE;
+
 	pgm_info (_("Running a benchmark to measure system clock frequency..."));
 
 	start = pgm_rdtsc();
@@ -855,7 +1197,7 @@ pgm_tsc_init (
 			   "timing.  To prevent the start delay from this benchmark and use a stable clock "
 			   "source set the environment variable PGM_TIMER to GTOD."));
 /* force both to stable clocks even though one might be OK */
-		pgm_time_update_now = pgm_gettimeofday_update;
+		pgm_time_update_now = TSC_FALLBACK_UPDATE;
 		return TRUE;
 	}
 
@@ -875,6 +1217,7 @@ pgm_tsc_init (
 		   "architecture and should be determined separately for each server."),
 		   tsc_khz);
 	return TRUE;
+#		endif /* !HAVE_CLOCK_GETTIME */
 }
 #	endif
 
@@ -883,6 +1226,39 @@ pgm_tsc_init (
  * used, preferably HPET on x86/AMD64 or gettimeofday() on SPARC.
  */
 
+#	ifdef HAVE_CLOCK_GETTIME
+static
+pgm_time_t
+pgm_tsc_update (void)
+{
+	static pgm_time_t	last = 0;
+	uint64_t		anchor_tsc, us_mul, tsc;
+	pgm_time_t		anchor_usecs, now;
+	uint32_t		seq;
+
+	do {
+		seq          = pgm_atomic_read32 (&tsc_seq);
+		anchor_tsc   = tsc_anchor.tsc;
+		anchor_usecs = tsc_anchor.usecs;
+		us_mul       = tsc_anchor.us_mul;
+	} while (PGM_UNLIKELY((seq & 1) || seq != pgm_atomic_read32 (&tsc_seq)));
+
+	tsc = pgm_rdtsc();
+	if (PGM_LIKELY(tsc - anchor_tsc < tsc_resync_ticks) || !pgm_tsc_resync (&now))
+	{
+/* another core may trail the anchor by a few ticks */
+		if (PGM_UNLIKELY(tsc < anchor_tsc))
+			now = anchor_usecs;
+		else
+			now = anchor_usecs + (((tsc - anchor_tsc) * us_mul) >> TSC_FINE_SCALE);
+	}
+
+	if (PGM_UNLIKELY(now < last))
+		return last;
+	else
+		return last = now;
+}
+#	else
 static
 pgm_time_t
 pgm_tsc_update (void)
@@ -895,6 +1271,7 @@ pgm_tsc_update (void)
 	else
 		return last = now;
 }
+#	endif /* !HAVE_CLOCK_GETTIME */
 #endif /* HAVE_RDTSC */
 
 #ifdef HAVE_DEV_HPET
@@ -126,6 +126,28 @@ START_TEST (test_update_now_pass_001)
 }
 END_TEST
 
+/* timer must remain monotonic and track elapsed time across TSC resync */
+
+START_TEST (test_update_now_pass_002)
+{
+	fail_unless (TRUE == pgm_time_init (NULL), "init failed");
+	const pgm_time_t start_time = pgm_time_update_now ();
+	pgm_time_t last_time = start_time;
+	for (unsigned i = 1; i <= 15; i++)
+	{
+		g_usleep (100 * 1000);
+		const pgm_time_t check_time = pgm_time_update_now ();
+		fail_unless (check_time >= last_time, "non-monotonic");
+		last_time = check_time;
+	}
+	const gint64 elapsed_time = last_time - start_time;
+	g_message ("elapsed-time:   %" G_GINT64_FORMAT "us", pgm_to_usecs(elapsed_time));
+	fail_unless (elapsed_time >= pgm_msecs(1500), "elapsed time too short");
+	fail_unless (elapsed_time < pgm_secs(3), "elapsed time too long");
+	fail_unless (TRUE == pgm_time_shutdown (), "shutdown failed");
+}
+END_TEST
+
 /* target:
  *	void
  *	pgm_time_since_epoch (
@@ -172,6 +194,7 @@ make_test_suite (void)
 	TCase* tc_update_now = tcase_create ("update-now");
 	suite_add_tcase (s, tc_update_now);
 	tcase_add_test (tc_update_now, test_update_now_pass_001);
+	tcase_add_test (tc_update_now, test_update_now_pass_002);
 
 	TCase* tc_since_epoch = tcase_create ("since-epoch");
 	suite_add_tcase (s, tc_since_epoch);
@@ -27,6 +27,7 @@
 #include <impl/timer.h>
 #include <impl/receiver.h>
 #include <impl/source.h>
+#include <impl/net.h>
 
 
 //#define TIMER_DEBUG
@@ -36,23 +37,25 @@
  * and check whether its already due.
  *
  * called in sock creation so locks unrequired.
+ *
+ * all timer functions take the caller's time so one clock read serves the
+ * whole API call.
  */
 
 PGM_GNUC_INTERNAL
 bool
 pgm_timer_prepare (
-	pgm_sock_t* const	sock
+	pgm_sock_t* const	sock,
+	const pgm_time_t	now
 	)
 {
-	pgm_time_t	now, expiration;
+	pgm_time_t	expiration;
 	int32_t		msec;
 
 /* pre-conditions */
 	pgm_assert (NULL != sock);
 	pgm_assert (sock->can_send_data || sock->can_recv_data);
 
-	now = pgm_time_update_now();
-
 	if (sock->can_send_data)
 		expiration = sock->next_ambient_spm;
 	else
@@ -75,10 +78,10 @@ pgm_timer_prepare (
 PGM_GNUC_INTERNAL
 bool
 pgm_timer_check (
-	pgm_sock_t* const	sock
+	pgm_sock_t* const	sock,
+	const pgm_time_t	now
 	)
 {
-	const pgm_time_t now = pgm_time_update_now();
 	bool expired;
 
 /* pre-conditions */
@@ -96,10 +99,10 @@ pgm_timer_check (
 PGM_GNUC_INTERNAL
 pgm_time_t
 pgm_timer_expiration (
-	pgm_sock_t* const	sock
+	pgm_sock_t* const	sock,
+	const pgm_time_t	now
 	)
 {
-	const pgm_time_t now = pgm_time_update_now();
 	pgm_time_t expiration;
 
 /* pre-conditions */
@@ -111,8 +114,8 @@ pgm_timer_expiration (
 	return expiration;
 }
 
-/* call all timers, assume that time_now has been updated by either pgm_timer_prepare
- * or pgm_timer_check and no other method calls here.
+/* call all timers at time now, as passed to pgm_timer_prepare or pgm_timer_check
+ * by the same caller.
  * 
  * returns TRUE on success, returns FALSE on blocked send-in-receive operation.
  */
@@ -120,10 +123,10 @@ pgm_timer_expiration (
 PGM_GNUC_INTERNAL
 bool
 pgm_timer_dispatch (
-	pgm_sock_t* const	sock
+	pgm_sock_t* const	sock,
+	const pgm_time_t	now
 	)
 {
-	const pgm_time_t now = pgm_time_update_now();
 	pgm_time_t next_expiration = 0;
 
 /* pre-conditions */
@@ -165,11 +168,28 @@ printf ("ACK timeout, T:%u W:%u\n", pgm_fp8tou(sock->tokens), pgm_fp8tou(sock->c
 			next_expiration = next_expiration > 0 ? MIN(next_expiration, sock->ack_expiry) : sock->ack_expiry;
 		}
 
+/* small APDUs held past their coalescing time, retry later if the source is busy */
+		if (sock->coalesce_ivl)
+		{
+			pgm_time_t next_coalesce = now + sock->coalesce_ivl;
+			if (pgm_sock_mutex_trylock (sock, &sock->source_mutex)) {
+				if (pgm_on_coalesce_expiry (sock, now))
+					next_coalesce = sock->coalesce_skb ? sock->coalesce_expiry : 0;
+				pgm_sock_mutex_unlock (sock, &sock->source_mutex);
+			}
+			if (next_coalesce)
+				next_expiration = next_expiration > 0 ? MIN(next_expiration, next_coalesce) : next_coalesce;
+		}
+
+/* release packets the kernel has finished sending with MSG_ZEROCOPY */
+		if (sock->zerocopy_min)
+			pgm_zerocopy_reap (sock);
+
 /* SPM broadcast */
-		pgm_mutex_lock (&sock->timer_mutex);
+		pgm_sock_mutex_lock (sock, &sock->timer_mutex);
 		const unsigned spm_heartbeat_state = sock->spm_heartbeat_state;
 		const pgm_time_t next_heartbeat_spm = sock->next_heartbeat_spm;
-		pgm_mutex_unlock (&sock->timer_mutex);
+		pgm_sock_mutex_unlock (sock, &sock->timer_mutex);
 
 /* no lock needed on ambient */
 		const pgm_time_t next_ambient_spm = sock->next_ambient_spm;
@@ -200,7 +220,7 @@ printf ("ACK timeout, T:%u W:%u\n", pgm_fp8tou(sock->tokens), pgm_fp8tou(sock->c
 				}
 			} while (pgm_time_after_eq (now, new_heartbeat_spm));
 /* check for reset heartbeat */
-			pgm_mutex_lock (&sock->timer_mutex);
+			pgm_sock_mutex_lock (sock, &sock->timer_mutex);
 			if (next_heartbeat_spm == sock->next_heartbeat_spm) {
 				sock->spm_heartbeat_state = new_heartbeat_state;
 				sock->next_heartbeat_spm  = new_heartbeat_spm;
@@ -208,16 +228,16 @@ printf ("ACK timeout, T:%u W:%u\n", pgm_fp8tou(sock->tokens), pgm_fp8tou(sock->c
 			} else
 				next_spm = MIN(sock->next_ambient_spm, sock->next_heartbeat_spm);
 			sock->next_poll = next_expiration > 0 ? MIN(next_expiration, next_spm) : next_spm;
-			pgm_mutex_unlock (&sock->timer_mutex);
+			pgm_sock_mutex_unlock (sock, &sock->timer_mutex);
 			return TRUE;
 		}
 
 		next_expiration = next_expiration > 0 ? MIN(next_expiration, next_spm) : next_spm;
 
 /* check for reset */
-		pgm_mutex_lock (&sock->timer_mutex);
+		pgm_sock_mutex_lock (sock, &sock->timer_mutex);
 		sock->next_poll = sock->next_poll > now ? MIN(sock->next_poll, next_expiration) : next_expiration;
-		pgm_mutex_unlock (&sock->timer_mutex);
+		pgm_sock_mutex_unlock (sock, &sock->timer_mutex);
 	}
 	else
 		sock->next_poll = next_expiration;
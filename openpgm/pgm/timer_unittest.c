@@ -225,7 +225,8 @@ mock_pgm_send_spm (
 /* target:
  *	bool
  *	pgm_timer_prepare (
- *		pgm_sock_t*	sock
+ *		pgm_sock_t*	sock,
+ *		pgm_time_t	now
  *	)
  */
 
@@ -235,13 +236,13 @@ START_TEST (test_prepare_pass_001)
 	fail_if (NULL == sock, "generate_sock failed");
 	sock->can_send_data = TRUE;
 	sock->next_ambient_spm = mock_pgm_time_now + pgm_secs(10);
-	fail_unless (FALSE == pgm_timer_prepare (sock), "prepare failed");
+	fail_unless (FALSE == pgm_timer_prepare (sock, mock_pgm_time_now), "prepare failed");
 }
 END_TEST
 
 START_TEST (test_prepare_fail_001)
 {
-	gboolean expired = pgm_timer_prepare (NULL);
+	gboolean expired = pgm_timer_prepare (NULL, mock_pgm_time_now);
 	fail ("reached");
 }
 END_TEST
@@ -249,7 +250,8 @@ END_TEST
 /* target:
  *	bool
  *	pgm_timer_check (
- *		pgm_sock_t*	sock
+ *		pgm_sock_t*	sock,
+ *		pgm_time_t	now
  *	)
  */
 
@@ -257,13 +259,13 @@ START_TEST (test_check_pass_001)
 {
 	pgm_sock_t* sock = generate_sock ();
 	fail_if (NULL == sock, "generate_sock failed");
-	fail_unless (TRUE == pgm_timer_check (sock), "check failed");
+	fail_unless (TRUE == pgm_timer_check (sock, mock_pgm_time_now), "check failed");
 }
 END_TEST
 
 START_TEST (test_check_fail_001)
 {
-	gboolean expired = pgm_timer_check (NULL);
+	gboolean expired = pgm_timer_check (NULL, mock_pgm_time_now);
 	fail ("reached");
 }
 END_TEST
@@ -271,7 +273,8 @@ END_TEST
 /* target:
  *	pgm_time_t
  *	pgm_timer_expiration (
- *		pgm_sock_t*	sock
+ *		pgm_sock_t*	sock,
+ *		pgm_time_t	now
  *	)
  */
 
@@ -280,13 +283,13 @@ START_TEST (test_expiration_pass_001)
 	pgm_sock_t* sock = generate_sock ();
 	fail_if (NULL == sock, "generate_sock failed");
 	sock->next_poll = mock_pgm_time_now + pgm_secs(300);
-	fail_unless (pgm_secs(300) == pgm_timer_expiration (sock), "expiration failed");
+	fail_unless (pgm_secs(300) == pgm_timer_expiration (sock, mock_pgm_time_now), "expiration failed");
 }
 END_TEST
 
 START_TEST (test_expiration_fail_001)
 {
-	long expiration = pgm_timer_expiration (NULL);
+	long expiration = pgm_timer_expiration (NULL, mock_pgm_time_now);
 	fail ("reached");
 }
 END_TEST
@@ -294,7 +297,8 @@ END_TEST
 /* target:
  *	void
  *	pgm_timer_dispatch (
- *		pgm_sock_t*	sock
+ *		pgm_sock_t*	sock,
+ *		pgm_time_t	now
  *	)
  */
 
@@ -302,13 +306,13 @@ START_TEST (test_dispatch_pass_001)
 {
 	pgm_sock_t* sock = generate_sock ();
 	fail_if (NULL == sock, "generate_sock failed");
-	pgm_timer_dispatch (sock);
+	pgm_timer_dispatch (sock, mock_pgm_time_now);
 }
 END_TEST
 
 START_TEST (test_dispatch_fail_001)
 {
-	pgm_timer_dispatch (NULL);
+	pgm_timer_dispatch (NULL, mock_pgm_time_now);
 	fail ("reached");
 }
 END_TEST
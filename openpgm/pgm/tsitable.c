@@ -0,0 +1,200 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * open addressing table of transport session identifiers.
+ *
+ * Copyright (c) 2010-2011 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+#include <impl/framework.h>
+
+
+//#define TSITABLE_DEBUG
+
+/* linear probing, four entries per cache line, grown at half load */
+#define TSITABLE_MIN_BITS	4
+#define TSITABLE_CACHELINE	64
+
+static void pgm_tsitable_resize (pgm_tsitable_t*const, const unsigned);
+
+static inline
+uint32_t
+_pgm_tsitable_index (
+	const pgm_tsitable_t* const table,
+	const uint64_t		    key
+	)
+{
+	return (uint32_t)(_pgm_tsitable_hash (key) >> table->shift);
+}
+
+static inline
+struct pgm_tsientry_t*
+_pgm_tsitable_cache (
+	pgm_tsitable_t* const	table,
+	const uint64_t		key
+	)
+{
+	return &table->cache[(uint32_t)_pgm_tsitable_hash (key) >> (32 - PGM_TSITABLE_CACHE_BITS)];
+}
+
+PGM_GNUC_INTERNAL
+pgm_tsitable_t*
+pgm_tsitable_new (void)
+{
+	pgm_tsitable_t* table;
+
+	table = pgm_new0 (pgm_tsitable_t, 1);
+	pgm_tsitable_resize (table, TSITABLE_MIN_BITS);
+	return table;
+}
+
+PGM_GNUC_INTERNAL
+void
+pgm_tsitable_destroy (
+	pgm_tsitable_t*		table
+	)
+{
+	pgm_return_if_fail (NULL != table);
+
+	pgm_free (table->alloc);
+	pgm_free (table);
+}
+
+/* replace any existing value for tsi.
+ */
+
+PGM_GNUC_INTERNAL
+void
+pgm_tsitable_insert (
+	pgm_tsitable_t*  restrict table,
+	const pgm_tsi_t* restrict tsi,
+	void*		 restrict value
+	)
+{
+	const uint64_t key = _pgm_tsitable_key (tsi);
+	uint32_t i;
+
+	pgm_return_if_fail (NULL != table);
+	pgm_return_if_fail (NULL != value);
+
+	if (PGM_UNLIKELY(2 * (table->nnodes + 1) > table->mask + 1))
+		pgm_tsitable_resize (table, 64 - table->shift + 1);
+
+	i = _pgm_tsitable_index (table, key);
+	while (NULL != table->entries[i].value) {
+		if (key == table->entries[i].key) {
+			struct pgm_tsientry_t* cached = _pgm_tsitable_cache (table, key);
+			if (key == cached->key)
+				cached->value = NULL;
+			table->entries[i].value = value;
+			return;
+		}
+		i = (i + 1) & table->mask;
+	}
+	table->entries[i].key   = key;
+	table->entries[i].value = value;
+	table->nnodes++;
+}
+
+/* backward shift deletion, moves following entries of the probe sequence into
+ * the hole so no tombstones are needed.
+ *
+ * returns TRUE if tsi was found and removed, FALSE otherwise.
+ */
+
+PGM_GNUC_INTERNAL
+bool
+pgm_tsitable_remove (
+	pgm_tsitable_t*  restrict table,
+	const pgm_tsi_t* restrict tsi
+	)
+{
+	const uint64_t key = _pgm_tsitable_key (tsi);
+	struct pgm_tsientry_t* cached;
+	uint32_t i, j;
+
+	pgm_return_val_if_fail (NULL != table, FALSE);
+
+	i = _pgm_tsitable_index (table, key);
+	for (;;) {
+		if (NULL == table->entries[i].value)
+			return FALSE;
+		if (key == table->entries[i].key)
+			break;
+		i = (i + 1) & table->mask;
+	}
+
+	cached = _pgm_tsitable_cache (table, key);
+	if (key == cached->key)
+		cached->value = NULL;
+
+	j = i;
+	for (;;) {
+		uint32_t home;
+		j = (j + 1) & table->mask;
+		if (NULL == table->entries[j].value)
+			break;
+		home = _pgm_tsitable_index (table, table->entries[j].key);
+/* entry stays if its home slot lies cyclically within (i, j] */
+		if (i <= j ? (i < home && home <= j) : (i < home || home <= j))
+			continue;
+		table->entries[i] = table->entries[j];
+		i = j;
+	}
+	table->entries[i].key   = 0;
+	table->entries[i].value = NULL;
+	table->nnodes--;
+	return TRUE;
+}
+
+static
+void
+pgm_tsitable_resize (
+	pgm_tsitable_t* const	table,
+	const unsigned		bits
+	)
+{
+	struct pgm_tsientry_t* old_entries = table->entries;
+	void* old_alloc = table->alloc;
+	const uint32_t old_size = old_entries ? table->mask + 1 : 0;
+	const uint32_t new_size = UINT32_C(1) << bits;
+
+	table->alloc   = pgm_malloc0 (new_size * sizeof (struct pgm_tsientry_t) + TSITABLE_CACHELINE - 1);
+	table->entries = (struct pgm_tsientry_t*)(((uintptr_t)table->alloc + TSITABLE_CACHELINE - 1) & ~(uintptr_t)(TSITABLE_CACHELINE - 1));
+	table->mask    = new_size - 1;
+	table->shift   = 64 - bits;
+
+	for (uint32_t k = 0; k < old_size; k++)
+	{
+		uint32_t i;
+		if (NULL == old_entries[k].value)
+			continue;
+		i = _pgm_tsitable_index (table, old_entries[k].key);
+		while (NULL != table->entries[i].value)
+			i = (i + 1) & table->mask;
+		table->entries[i] = old_entries[k];
+	}
+	pgm_free (old_alloc);
+
+#ifdef TSITABLE_DEBUG
+	pgm_debug ("tsitable resize %" PRIu32 " -> %" PRIu32 " entries", old_size, new_size);
+#endif
+}
+
+/* eof */
@@ -0,0 +1,281 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * performance tests for TSI peer lookup
+ *
+ * Copyright (c) 2010-2011 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <check.h>
+
+
+/* mock state */
+
+static unsigned perf_peers	= 0;
+
+
+static
+void
+mock_setup_1 (void)
+{
+	perf_peers	= 1;
+}
+
+static
+void
+mock_setup_16 (void)
+{
+	perf_peers	= 16;
+}
+
+static
+void
+mock_setup_256 (void)
+{
+	perf_peers	= 256;
+}
+
+static
+void
+mock_setup_4096 (void)
+{
+	perf_peers	= 4096;
+}
+
+static
+void
+mock_setup_65536 (void)
+{
+	perf_peers	= 65536;
+}
+
+/* mock functions for external references */
+
+size_t
+pgm_transport_pkt_offset2 (
+        const bool                      can_fragment,
+        const bool                      use_pgmcc
+        )
+{
+	return 0;
+}
+
+#define TSITABLE_DEBUG
+#include "tsitable.c"
+
+PGM_GNUC_INTERNAL
+int
+pgm_get_nprocs (void)
+{
+	return 1;
+}
+
+static
+void
+mock_setup (void)
+{
+	g_assert (pgm_time_init (NULL));
+}
+
+static
+void
+mock_teardown (void)
+{
+	g_assert (pgm_time_shutdown ());
+}
+
+/* random GSI per peer, packets arrive interleaved across all peers.
+ */
+
+static
+pgm_tsi_t*
+generate_peers (
+	const unsigned	count
+	)
+{
+	pgm_tsi_t* tsi = g_new0 (pgm_tsi_t, count);
+	for (unsigned i = 0, j = 0; i < count; i++) {
+		for (unsigned k = 0; k < sizeof (tsi[i].gsi.identifier); k++) {
+			j = j * 1103515245 + 12345;
+			tsi[i].gsi.identifier[k] = j >> 16;
+		}
+		tsi[i].sport = g_htons (7500 + (i & 0xff));
+	}
+	return tsi;
+}
+
+static
+unsigned*
+generate_sequence (
+	const unsigned	count,
+	const unsigned	iterations
+	)
+{
+	unsigned* sequence = g_new (unsigned, iterations);
+	for (unsigned i = 0, j = 0; i < iterations; i++) {
+		j = j * 1103515245 + 12345;
+		sequence[i] = (j >> 8) % count;
+	}
+	return sequence;
+}
+
+/* target:
+ *	gpointer
+ *	pgm_hashtable_lookup (
+ *		const pgm_hashtable_t*	hash_table,
+ *		gconstpointer		key
+ *	)
+ */
+
+START_TEST (test_hashtable)
+{
+	const unsigned iterations = 1000000;
+	pgm_tsi_t* tsi = generate_peers (perf_peers);
+	unsigned* sequence = generate_sequence (perf_peers, iterations);
+	pgm_hashtable_t* hashtable = pgm_hashtable_new (pgm_tsi_hash, pgm_tsi_equal);
+	for (unsigned i = 0; i < perf_peers; i++)
+		pgm_hashtable_insert (hashtable, &tsi[i], &tsi[i]);
+
+	pgm_time_t start, check;
+
+	start = pgm_time_update_now();
+	for (unsigned i = 0; i < iterations; i++) {
+		const pgm_tsi_t* peer = pgm_hashtable_lookup (hashtable, &tsi[sequence[i]]);
+		fail_unless (peer == &tsi[sequence[i]], "lookup failed");
+	}
+
+	check = pgm_time_update_now();
+	g_message ("hashtable/%u: elapsed time %" PGM_TIME_FORMAT " us, unit time %.1f ns",
+		perf_peers,
+		(guint64)(check - start),
+		(double)(check - start) * 1000.0 / iterations);
+
+	pgm_hashtable_destroy (hashtable);
+	g_free (sequence);
+	g_free (tsi);
+}
+END_TEST
+
+/* target:
+ *	void*
+ *	pgm_tsitable_lookup_cached (
+ *		pgm_tsitable_t*		table,
+ *		const pgm_tsi_t*	tsi
+ *	)
+ */
+
+START_TEST (test_tsitable)
+{
+	const unsigned iterations = 1000000;
+	pgm_tsi_t* tsi = generate_peers (perf_peers);
+	unsigned* sequence = generate_sequence (perf_peers, iterations);
+	pgm_tsitable_t* table = pgm_tsitable_new ();
+	for (unsigned i = 0; i < perf_peers; i++)
+		pgm_tsitable_insert (table, &tsi[i], &tsi[i]);
+
+	pgm_time_t start, check;
+
+	start = pgm_time_update_now();
+	for (unsigned i = 0; i < iterations; i++) {
+		const pgm_tsi_t* peer = pgm_tsitable_lookup_cached (table, &tsi[sequence[i]]);
+		fail_unless (peer == &tsi[sequence[i]], "lookup failed");
+	}
+
+	check = pgm_time_update_now();
+	g_message ("tsitable/%u: elapsed time %" PGM_TIME_FORMAT " us, unit time %.1f ns",
+		perf_peers,
+		(guint64)(check - start),
+		(double)(check - start) * 1000.0 / iterations);
+
+	pgm_tsitable_destroy (table);
+	g_free (sequence);
+	g_free (tsi);
+}
+END_TEST
+
+
+static
+Suite*
+make_lookup_performance_suite (void)
+{
+	Suite* s;
+
+	s = suite_create ("TSI lookup performance");
+
+	TCase* tc_1 = tcase_create ("1");
+	suite_add_tcase (s, tc_1);
+	tcase_add_checked_fixture (tc_1, mock_setup, mock_teardown);
+	tcase_add_checked_fixture (tc_1, mock_setup_1, NULL);
+	tcase_add_test (tc_1, test_hashtable);
+	tcase_add_test (tc_1, test_tsitable);
+
+	TCase* tc_16 = tcase_create ("16");
+	suite_add_tcase (s, tc_16);
+	tcase_add_checked_fixture (tc_16, mock_setup, mock_teardown);
+	tcase_add_checked_fixture (tc_16, mock_setup_16, NULL);
+	tcase_add_test (tc_16, test_hashtable);
+	tcase_add_test (tc_16, test_tsitable);
+
+	TCase* tc_256 = tcase_create ("256");
+	suite_add_tcase (s, tc_256);
+	tcase_add_checked_fixture (tc_256, mock_setup, mock_teardown);
+	tcase_add_checked_fixture (tc_256, mock_setup_256, NULL);
+	tcase_add_test (tc_256, test_hashtable);
+	tcase_add_test (tc_256, test_tsitable);
+
+	TCase* tc_4096 = tcase_create ("4096");
+	suite_add_tcase (s, tc_4096);
+	tcase_add_checked_fixture (tc_4096, mock_setup, mock_teardown);
+	tcase_add_checked_fixture (tc_4096, mock_setup_4096, NULL);
+	tcase_add_test (tc_4096, test_hashtable);
+	tcase_add_test (tc_4096, test_tsitable);
+
+	TCase* tc_65536 = tcase_create ("65536");
+	suite_add_tcase (s, tc_65536);
+	tcase_add_checked_fixture (tc_65536, mock_setup, mock_teardown);
+	tcase_add_checked_fixture (tc_65536, mock_setup_65536, NULL);
+	tcase_add_test (tc_65536, test_hashtable);
+	tcase_add_test (tc_65536, test_tsitable);
+
+	return s;
+}
+
+static
+Suite*
+make_master_suite (void)
+{
+	Suite* s = suite_create ("Master");
+	return s;
+}
+
+int
+main (void)
+{
+	SRunner* sr = srunner_create (make_master_suite ());
+	srunner_add_suite (sr, make_lookup_performance_suite ());
+	srunner_run_all (sr, CK_ENV);
+	int number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* eof */
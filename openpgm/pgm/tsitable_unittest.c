@@ -0,0 +1,266 @@
+/* vim:ts=8:sts=8:sw=4:noai:noexpandtab
+ *
+ * unit tests for the transport session ID table.
+ *
+ * Copyright (c) 2010-2011 Miru Limited.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <check.h>
+
+
+/* mock state */
+
+/* mock functions for external references */
+
+size_t
+pgm_transport_pkt_offset2 (
+        const bool                      can_fragment,
+        const bool                      use_pgmcc
+        )
+{
+        return 0;
+}
+
+#define TSITABLE_DEBUG
+#include "tsitable.c"
+
+PGM_GNUC_INTERNAL
+int
+pgm_get_nprocs (void)
+{
+	return 1;
+}
+
+static
+void
+generate_tsi (
+	pgm_tsi_t*	tsi,
+	unsigned	n
+	)
+{
+	memset (tsi, 0, sizeof (pgm_tsi_t));
+	tsi->gsi.identifier[0] = 1;
+	tsi->gsi.identifier[4] = (uint8_t)(n >> 8);
+	tsi->gsi.identifier[5] = (uint8_t)n;
+	tsi->sport = g_htons ((uint16_t)(1000 + (n >> 16)));
+}
+
+/* target:
+ *	pgm_tsitable_t*
+ *	pgm_tsitable_new (void)
+ */
+
+START_TEST (test_new_pass_001)
+{
+	pgm_tsitable_t* table = pgm_tsitable_new ();
+	fail_if (NULL == table, "new failed");
+	fail_unless (0 == pgm_tsitable_size (table), "size not zero");
+	fail_unless (0 == ((uintptr_t)table->entries % TSITABLE_CACHELINE), "entries not aligned");
+	pgm_tsitable_destroy (table);
+}
+END_TEST
+
+/* target:
+ *	void
+ *	pgm_tsitable_insert (
+ *		pgm_tsitable_t*		table,
+ *		const pgm_tsi_t*	tsi,
+ *		void*			value
+ *	)
+ */
+
+START_TEST (test_insert_pass_001)
+{
+	pgm_tsitable_t* table = pgm_tsitable_new ();
+	pgm_tsi_t tsi;
+	int value = 1;
+	generate_tsi (&tsi, 1);
+	pgm_tsitable_insert (table, &tsi, &value);
+	fail_unless (1 == pgm_tsitable_size (table), "size mismatch");
+	fail_unless (&value == pgm_tsitable_lookup (table, &tsi), "lookup failed");
+	fail_unless (&value == pgm_tsitable_lookup_cached (table, &tsi), "cached lookup failed");
+	pgm_tsitable_destroy (table);
+}
+END_TEST
+
+/* replace existing value, cached entry must not return stale value */
+START_TEST (test_insert_pass_002)
+{
+	pgm_tsitable_t* table = pgm_tsitable_new ();
+	pgm_tsi_t tsi;
+	int value1 = 1, value2 = 2;
+	generate_tsi (&tsi, 1);
+	pgm_tsitable_insert (table, &tsi, &value1);
+	fail_unless (&value1 == pgm_tsitable_lookup_cached (table, &tsi), "cached lookup failed");
+	pgm_tsitable_insert (table, &tsi, &value2);
+	fail_unless (1 == pgm_tsitable_size (table), "size mismatch");
+	fail_unless (&value2 == pgm_tsitable_lookup_cached (table, &tsi), "stale cached value");
+	pgm_tsitable_destroy (table);
+}
+END_TEST
+
+/* grow past initial size */
+START_TEST (test_insert_pass_003)
+{
+	const unsigned count = 10000;
+	pgm_tsitable_t* table = pgm_tsitable_new ();
+	int* values = g_new (int, count);
+	pgm_tsi_t tsi;
+	for (unsigned i = 0; i < count; i++) {
+		generate_tsi (&tsi, i);
+		pgm_tsitable_insert (table, &tsi, &values[i]);
+	}
+	fail_unless (count == pgm_tsitable_size (table), "size mismatch");
+	fail_unless (2 * count <= table->mask + 1, "load factor exceeded");
+	for (unsigned i = 0; i < count; i++) {
+		generate_tsi (&tsi, i);
+		fail_unless (&values[i] == pgm_tsitable_lookup_cached (table, &tsi), "lookup failed");
+	}
+	generate_tsi (&tsi, count);
+	fail_unless (NULL == pgm_tsitable_lookup (table, &tsi), "lookup of unknown tsi succeeded");
+	pgm_tsitable_destroy (table);
+	g_free (values);
+}
+END_TEST
+
+/* invalid table is rejected without fault */
+START_TEST (test_insert_pass_004)
+{
+	pgm_tsi_t tsi;
+	int value = 1;
+	generate_tsi (&tsi, 1);
+	pgm_tsitable_insert (NULL, &tsi, &value);
+}
+END_TEST
+
+/* target:
+ *	bool
+ *	pgm_tsitable_remove (
+ *		pgm_tsitable_t*		table,
+ *		const pgm_tsi_t*	tsi
+ *	)
+ */
+
+START_TEST (test_remove_pass_001)
+{
+	pgm_tsitable_t* table = pgm_tsitable_new ();
+	pgm_tsi_t tsi;
+	int value = 1;
+	generate_tsi (&tsi, 1);
+	fail_unless (FALSE == pgm_tsitable_remove (table, &tsi), "remove of unknown tsi succeeded");
+	pgm_tsitable_insert (table, &tsi, &value);
+	fail_unless (&value == pgm_tsitable_lookup_cached (table, &tsi), "cached lookup failed");
+	fail_unless (TRUE == pgm_tsitable_remove (table, &tsi), "remove failed");
+	fail_unless (0 == pgm_tsitable_size (table), "size not zero");
+	fail_unless (NULL == pgm_tsitable_lookup_cached (table, &tsi), "cached lookup after remove");
+	fail_unless (NULL == pgm_tsitable_lookup (table, &tsi), "lookup after remove");
+	pgm_tsitable_destroy (table);
+}
+END_TEST
+
+/* remove every other entry, remaining probe sequences must stay intact */
+START_TEST (test_remove_pass_002)
+{
+	const unsigned count = 4096;
+	pgm_tsitable_t* table = pgm_tsitable_new ();
+	int* values = g_new (int, count);
+	pgm_tsi_t tsi;
+	for (unsigned i = 0; i < count; i++) {
+		generate_tsi (&tsi, i);
+		pgm_tsitable_insert (table, &tsi, &values[i]);
+	}
+	for (unsigned i = 0; i < count; i += 2) {
+		generate_tsi (&tsi, i);
+		fail_unless (TRUE == pgm_tsitable_remove (table, &tsi), "remove failed");
+	}
+	fail_unless (count / 2 == pgm_tsitable_size (table), "size mismatch");
+	for (unsigned i = 0; i < count; i++) {
+		generate_tsi (&tsi, i);
+		if (i & 1)
+			fail_unless (&values[i] == pgm_tsitable_lookup (table, &tsi), "lookup failed");
+		else
+			fail_unless (NULL == pgm_tsitable_lookup (table, &tsi), "lookup after remove");
+	}
+	pgm_tsitable_destroy (table);
+	g_free (values);
+}
+END_TEST
+
+START_TEST (test_remove_pass_003)
+{
+	pgm_tsi_t tsi;
+	generate_tsi (&tsi, 1);
+	fail_unless (FALSE == pgm_tsitable_remove (NULL, &tsi), "remove on invalid table succeeded");
+}
+END_TEST
+
+
+static
+Suite*
+make_test_suite (void)
+{
+	Suite* s;
+
+	s = suite_create (__FILE__);
+
+	TCase* tc_new = tcase_create ("new");
+	suite_add_tcase (s, tc_new);
+	tcase_add_test (tc_new, test_new_pass_001);
+
+	TCase* tc_insert = tcase_create ("insert");
+	suite_add_tcase (s, tc_insert);
+	tcase_add_test (tc_insert, test_insert_pass_001);
+	tcase_add_test (tc_insert, test_insert_pass_002);
+	tcase_add_test (tc_insert, test_insert_pass_003);
+	tcase_add_test (tc_insert, test_insert_pass_004);
+
+	TCase* tc_remove = tcase_create ("remove");
+	suite_add_tcase (s, tc_remove);
+	tcase_add_test (tc_remove, test_remove_pass_001);
+	tcase_add_test (tc_remove, test_remove_pass_002);
+	tcase_add_test (tc_remove, test_remove_pass_003);
+
+	return s;
+}
+
+static
+Suite*
+make_master_suite (void)
+{
+	Suite* s = suite_create ("Master");
+	return s;
+}
+
+int
+main (void)
+{
+	pgm_messages_init();
+	SRunner* sr = srunner_create (make_master_suite ());
+	srunner_add_suite (sr, make_test_suite ());
+	srunner_run_all (sr, CK_ENV);
+	int number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+	pgm_messages_shutdown();
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* eof */
@@ -89,6 +89,44 @@ _pgm_txw_peek (
 	return skb;
 }
 
+/* lockless window: peek from the repair thread whilst the publisher may be
+ * evicting the trail.  a hazard is published on the window index before the
+ * trail is re-read, the publisher tests the hazard after advancing the trail
+ * and defers release of a pinned buffer.
+ *
+ * returns the skb with an additional reference, or NULL if not in window.
+ */
+
+static
+struct pgm_sk_buff_t*
+_pgm_txw_peek_get (
+	pgm_txw_t*const		window,
+	const uint32_t		sequence
+	)
+{
+	const uint32_t index_ = sequence % pgm_txw_max_length (window);
+	struct pgm_sk_buff_t* skb = NULL;
+
+/* pre-conditions */
+	pgm_assert (NULL != window);
+	pgm_assert (window->is_lockless);
+
+/* locked add as a full barrier: hazard store visible before trail load */
+	pgm_atomic_add32 (&window->pin, (index_ + 1) - window->pin);
+	if (pgm_uint32_gte (sequence, pgm_txw_trail_atomic (window)) &&
+	    pgm_uint32_lte (sequence, pgm_txw_lead_atomic (window)))
+	{
+/* slot may already hold a newer sequence or be cleared */
+		skb = window->pdata[index_];
+		if (NULL != skb && skb->sequence == sequence)
+			skb = pgm_skb_get (skb);
+		else
+			skb = NULL;
+	}
+	pgm_atomic_write32 (&window->pin, 0);
+	return skb;
+}
+
 /* testing function: can a request be peeked from the retransmit queue.
  *
  * returns TRUE if request is available, returns FALSE if not available.
@@ -152,8 +190,11 @@ pgm_txw_retransmit_is_empty (
 /* globals */
 
 static void pgm_txw_remove_tail (pgm_txw_t*const);
+static void pgm_txw_release (pgm_txw_t*const, struct pgm_sk_buff_t*const, const uint32_t);
 static bool pgm_txw_retransmit_push_parity (pgm_txw_t*const, const uint32_t, const uint8_t);
 static bool pgm_txw_retransmit_push_selective (pgm_txw_t*const, const uint32_t);
+static void pgm_txw_finish_parity (pgm_txw_t*const, struct pgm_sk_buff_t*const, const uint8_t);
+static void pgm_txw_free_parity (pgm_txw_t*const, struct pgm_sk_buff_t**const);
 
 
 /* constructor for transmit window.  zero-length windows are not permitted.
@@ -255,6 +296,20 @@ pgm_txw_shutdown (
 		pgm_txw_remove_tail (window);
 	}
 
+/* lockless retransmit queue holds a reference per request */
+	if (window->is_lockless) {
+		struct pgm_sk_buff_t* skb;
+		while (NULL != (skb = (struct pgm_sk_buff_t*)pgm_queue_pop_tail_link (&window->retransmit_queue))) {
+			pgm_txw_state_t* state = (pgm_txw_state_t*)&skb->cb;
+			state->waiting_retransmit = 0;
+			pgm_free_skb (skb);
+		}
+		if (NULL != window->parked) {
+			pgm_free_skb (window->parked);
+			window->parked = NULL;
+		}
+	}
+
 /* window must now be empty */
 	pgm_assert_cmpuint (pgm_txw_length (window), ==, 0);
 	pgm_assert_cmpuint (pgm_txw_size (window), ==, 0);
@@ -266,6 +321,10 @@ pgm_txw_shutdown (
 
 /* free reed-solomon state */
 	if (window->is_fec_enabled) {
+		if (NULL != window->parity_acc)
+			pgm_txw_free_parity (window, window->parity_acc);
+		if (NULL != window->parity_ready)
+			pgm_txw_free_parity (window, window->parity_ready);
 		pgm_free_skb (window->parity_buffer);
 		pgm_rs_destroy (&window->rs);
 	}
@@ -316,8 +375,7 @@ pgm_txw_add (
 	}
 
 /* generate new sequence number */
-	pgm_atomic_inc32 (&window->lead);
-	skb->sequence = window->lead;
+	skb->sequence = pgm_txw_next_lead (window);
 
 /* add skb to window */
 	const uint_fast32_t index_ = skb->sequence % pgm_txw_max_length (window);
@@ -326,11 +384,228 @@ pgm_txw_add (
 /* statistics */
 	window->size += skb->len;
 
+/* publish slot to a lockless repair thread */
+	pgm_atomic_inc32 (&window->lead);
+
+/* hand completed parity to the transmission group lead */
+	if (NULL != window->parity_ready) {
+		struct pgm_sk_buff_t* lead_skb = _pgm_txw_peek (window, window->parity_tg_sqn);
+		if (NULL != lead_skb) {
+			pgm_txw_state_t*const state = (pgm_txw_state_t*const)&lead_skb->cb;
+			pgm_assert (NULL == state->parity);
+			state->parity = window->parity_ready;
+		} else
+			pgm_txw_free_parity (window, window->parity_ready);
+		window->parity_ready = NULL;
+	}
+
 /* post-conditions */
 	pgm_assert_cmpuint (pgm_txw_length (window), >, 0);
 	pgm_assert_cmpuint (pgm_txw_length (window), <=, pgm_txw_max_length (window));
 }
 
+/* fold an original data packet into the running parity of its transmission
+ * group.  called by the publisher before pgm_txw_add() and outside of the
+ * window lock, such that on-demand parity is encoded as data is sent rather
+ * than at repair time.  the first parity_h parity packets of a group are
+ * accumulated, once all k originals are folded the group is handed to its
+ * lead on the next add.
+ *
+ * accumulators are laid out as if OPT_FRAGMENT is encoded with the TSDU
+ * length trailer at the end of the buffer, both are moved into place when
+ * the group completes.
+ */
+
+#define PGM_TXW_PARITY_OPT_LENGTH	(sizeof(struct pgm_opt_length) + sizeof(struct pgm_opt_header) + sizeof(struct pgm_opt_fragment))
+#define PGM_TXW_PARITY_DATA_OFFSET	(sizeof(struct pgm_header) + sizeof(struct pgm_data) + PGM_TXW_PARITY_OPT_LENGTH)
+#define PGM_TXW_PARITY_OPT_OFFSET	(PGM_TXW_PARITY_DATA_OFFSET - sizeof(struct pgm_opt_fragment) + sizeof(struct pgm_opt_header))
+
+PGM_GNUC_INTERNAL
+void
+pgm_txw_fold_parity (
+	pgm_txw_t*		    const restrict window,
+	const struct pgm_sk_buff_t* const restrict skb
+	)
+{
+	struct pgm_opt_fragment	null_opt_fragment;
+	const pgm_gf8_t*	opt_src;
+	uint32_t		sequence, tg_sqn_mask;
+	uint16_t		tsdu_length;
+	uint8_t			pkt_sqn;
+
+/* pre-conditions */
+	pgm_assert (NULL != window);
+	pgm_assert (NULL != skb);
+
+	if (!window->parity_h)
+		return;
+
+	sequence    = ntohl (skb->pgm_data->data_sqn);
+	tg_sqn_mask = 0xffffffff << window->tg_sqn_shift;
+	pkt_sqn     = (uint8_t)(sequence & ~tg_sqn_mask);
+	tsdu_length = ntohs (skb->pgm_header->pgm_tsdu_length);
+
+	pgm_debug ("fold_parity (window:%p sequence:%" PRIu32 ")",
+		(const void*)window, sequence);
+
+	if (0 == pkt_sqn)
+	{
+		if (NULL == window->parity_acc) {
+			const uint16_t size = (uint16_t)((char*)skb->end - (char*)skb->head + PGM_TXW_PARITY_OPT_LENGTH + sizeof(uint16_t));
+			window->parity_acc = pgm_new (struct pgm_sk_buff_t*, window->parity_h);
+			for (uint_fast8_t h = 0; h < window->parity_h; h++)
+				window->parity_acc[h] = pgm_alloc_skb (size);
+		}
+		for (uint_fast8_t h = 0; h < window->parity_h; h++) {
+			struct pgm_sk_buff_t* parity_skb = window->parity_acc[h];
+			memset ((char*)parity_skb->head + PGM_TXW_PARITY_OPT_OFFSET, 0, sizeof(struct pgm_opt_fragment) - sizeof(struct pgm_opt_header));
+			memset ((char*)parity_skb->end - sizeof(uint16_t), 0, sizeof(uint16_t));
+		}
+		window->parity_tg_sqn		= sequence;
+		window->parity_folded		= 0;
+		window->parity_length		= 0;
+		window->parity_is_var_pktlen	= 0;
+		window->parity_is_op_encoded	= 0;
+	}
+/* joined mid-group or a previous packet did not fit */
+	else if (NULL == window->parity_acc ||
+		 window->parity_folded != pkt_sqn ||
+		 window->parity_tg_sqn != (sequence & tg_sqn_mask))
+	{
+		return;
+	}
+
+	if ((char*)window->parity_acc[0]->head + PGM_TXW_PARITY_DATA_OFFSET + tsdu_length > (char*)window->parity_acc[0]->end - sizeof(uint16_t)) {
+		pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Packet #%" PRIu32 " exceeds parity buffer, group parity encoded on demand."), sequence);
+		window->parity_folded = UINT8_MAX;
+		return;
+	}
+
+	if (pkt_sqn && tsdu_length != window->parity_length)
+		window->parity_is_var_pktlen = 1;
+	if (skb->pgm_header->pgm_options & PGM_OPT_PRESENT)
+		window->parity_is_op_encoded = 1;
+	if (NULL != skb->pgm_opt_fragment) {
+/* skip three bytes of header */
+		opt_src = (const pgm_gf8_t*)((const char*)skb->pgm_opt_fragment + sizeof (struct pgm_opt_header));
+	} else {
+		memset (&null_opt_fragment, 0, sizeof(null_opt_fragment));
+		*(uint8_t*)&null_opt_fragment |= PGM_OP_ENCODED_NULL;
+		opt_src = (const pgm_gf8_t*)&null_opt_fragment;
+	}
+
+	for (uint_fast8_t h = 0; h < window->parity_h; h++)
+	{
+		struct pgm_sk_buff_t* parity_skb = window->parity_acc[h];
+		const uint8_t offset = window->rs.k + h;
+		char* data = (char*)parity_skb->head + PGM_TXW_PARITY_DATA_OFFSET;
+
+/* zero extend the accumulator to the longest TSDU */
+		if (tsdu_length > window->parity_length)
+			memset (data + window->parity_length, 0, tsdu_length - window->parity_length);
+		pgm_rs_encode_fold (&window->rs, skb->data, pkt_sqn, offset, (pgm_gf8_t*)data, tsdu_length);
+		pgm_rs_encode_fold (&window->rs,
+				    opt_src,
+				    pkt_sqn,
+				    offset,
+				    (pgm_gf8_t*)parity_skb->head + PGM_TXW_PARITY_OPT_OFFSET,
+				    sizeof(struct pgm_opt_fragment) - sizeof(struct pgm_opt_header));
+		pgm_rs_encode_fold (&window->rs,
+				    (const pgm_gf8_t*)&tsdu_length,
+				    pkt_sqn,
+				    offset,
+				    (pgm_gf8_t*)parity_skb->end - sizeof(uint16_t),
+				    sizeof(uint16_t));
+	}
+	if (tsdu_length > window->parity_length)
+		window->parity_length = tsdu_length;
+
+	if (++window->parity_folded < window->rs.k)
+		return;
+
+/* transmission group complete */
+	for (uint_fast8_t h = 0; h < window->parity_h; h++)
+		pgm_txw_finish_parity (window, window->parity_acc[h], h);
+	if (NULL != window->parity_ready)
+		pgm_txw_free_parity (window, window->parity_ready);
+	window->parity_ready = window->parity_acc;
+	window->parity_acc = NULL;
+}
+
+/* complete the header of a folded parity packet ready for send_rdata().
+ */
+
+static
+void
+pgm_txw_finish_parity (
+	pgm_txw_t*	      const window,
+	struct pgm_sk_buff_t* const skb,
+	const uint8_t		    rs_h
+	)
+{
+	char*		data = (char*)skb->head + PGM_TXW_PARITY_DATA_OFFSET;
+	uint16_t	parity_length = window->parity_length;
+
+/* pre-conditions */
+	pgm_assert (NULL != window);
+	pgm_assert (NULL != skb);
+
+	if (window->parity_is_var_pktlen) {
+		memmove (data + parity_length, (char*)skb->end - sizeof(uint16_t), sizeof(uint16_t));
+		parity_length += 2;
+	}
+	if (!window->parity_is_op_encoded) {
+		memmove (data - PGM_TXW_PARITY_OPT_LENGTH, data, parity_length);
+		data -= PGM_TXW_PARITY_OPT_LENGTH;
+	}
+
+	skb->data = skb->tail = skb->head;
+	skb->len = 0;
+	pgm_skb_put (skb, sizeof(struct pgm_header));
+	skb->pgm_header		= skb->data;
+	skb->pgm_data		= (void*)( skb->pgm_header + 1 );
+	memcpy (skb->pgm_header->pgm_gsi, &window->tsi->gsi, sizeof(pgm_gsi_t));
+	skb->pgm_header->pgm_options = PGM_OPT_PARITY;
+	if (window->parity_is_var_pktlen)
+		skb->pgm_header->pgm_options |= PGM_OPT_VAR_PKTLEN;
+	skb->pgm_header->pgm_tsdu_length = htons (parity_length);
+	pgm_skb_put (skb, sizeof(struct pgm_data));
+	skb->pgm_data->data_sqn = htonl (window->parity_tg_sqn | rs_h);
+
+	if (window->parity_is_op_encoded)
+	{
+		struct pgm_opt_length* opt_len = (struct pgm_opt_length*)(skb->pgm_data + 1);
+		struct pgm_opt_header* opt_header = (struct pgm_opt_header*)(opt_len + 1);
+
+		skb->pgm_header->pgm_options |= PGM_OPT_PRESENT;
+		pgm_skb_put (skb, PGM_TXW_PARITY_OPT_LENGTH);
+		opt_len->opt_type		= PGM_OPT_LENGTH;
+		opt_len->opt_length		= sizeof(struct pgm_opt_length);
+		opt_len->opt_total_length	= htons ( PGM_TXW_PARITY_OPT_LENGTH );
+		opt_header->opt_type		= PGM_OPT_FRAGMENT | PGM_OPT_END;
+		opt_header->opt_length		= sizeof(struct pgm_opt_header) + sizeof(struct pgm_opt_fragment);
+		opt_header->opt_reserved	= PGM_OP_ENCODED;
+		memset (opt_header + 1, 0, sizeof(struct pgm_opt_header));
+	}
+	pgm_skb_put (skb, parity_length);
+	pgm_assert ((char*)skb->tail - parity_length == data);
+
+	memset (skb->cb, 0, sizeof(skb->cb));
+	pgm_txw_set_unfolded_checksum (skb, pgm_csum_partial (data, parity_length, 0));
+}
+
+static
+void
+pgm_txw_free_parity (
+	pgm_txw_t*	       const window,
+	struct pgm_sk_buff_t** const parity
+	)
+{
+	for (uint_fast8_t h = 0; h < window->parity_h; h++)
+		pgm_free_skb (parity[h]);
+	pgm_free (parity);
+}
+
 /* peek an entry from the window for retransmission.
  *
  * returns pointer to skbuff on success, returns NULL on invalid parameters.
@@ -372,7 +647,10 @@ pgm_txw_remove_tail (
 	pgm_assert (pgm_tsi_is_null (&skb->tsi));
 
 	state = (pgm_txw_state_t*)&skb->cb;
-	if (state->waiting_retransmit) {
+/* a lockless retransmit queue is owned by the repair thread and holds its own
+ * reference, stale requests are dropped on peek.
+ */
+	if (!window->is_lockless && state->waiting_retransmit) {
 		pgm_queue_unlink (&window->retransmit_queue, (pgm_list_t*)skb);
 		state->waiting_retransmit = 0;
 	}
@@ -386,6 +664,24 @@ pgm_txw_remove_tail (
 		PGM_HISTOGRAM_COUNTS("Tx.NakEliminationCount", state->nak_elimination_count);
 	}
 
+	if (window->is_lockless) {
+		const uint_fast32_t index_ = skb->sequence % pgm_txw_max_length (window);
+/* advance trailing pointer before testing the repair thread hazard */
+		pgm_atomic_inc32 (&window->trail);
+		if (PGM_UNLIKELY(pgm_mem_gc_friendly))
+			window->pdata[index_] = NULL;
+		pgm_txw_release (window, skb, (uint32_t)index_);
+		return;
+	}
+
+/* precomputed parity leaves with the transmission group lead, a repair in
+ * flight holds its own reference.
+ */
+	if (NULL != state->parity) {
+		pgm_txw_free_parity (window, state->parity);
+		state->parity = NULL;
+	}
+
 /* remove reference to skb */
 	if (PGM_UNLIKELY(pgm_mem_gc_friendly)) {
 		const uint_fast32_t index_ = skb->sequence % pgm_txw_max_length (window);
@@ -400,6 +696,47 @@ pgm_txw_remove_tail (
 	pgm_assert (!pgm_txw_is_full (window));
 }
 
+/* drop the window reference of an evicted skb, unless the repair thread holds
+ * a hazard on its window index in which case release is deferred to a later
+ * eviction.  a second pinned eviction of the same index waits out the hazard,
+ * which only covers taking a reference.
+ */
+
+static
+void
+pgm_txw_release (
+	pgm_txw_t*	      const window,
+	struct pgm_sk_buff_t* const skb,
+	const uint32_t		    index_
+	)
+{
+	uint32_t pin;
+
+/* pre-conditions */
+	pgm_assert (NULL != window);
+	pgm_assert (NULL != skb);
+	pgm_assert (window->is_lockless);
+
+	pin = pgm_atomic_read32 (&window->pin);
+	if (NULL != window->parked && pin != window->parked_index + 1) {
+		pgm_free_skb (window->parked);
+		window->parked = NULL;
+	}
+	if (pin != index_ + 1) {
+		pgm_free_skb (skb);
+		return;
+	}
+	while (NULL != window->parked) {
+		if (pgm_atomic_read32 (&window->pin) != window->parked_index + 1) {
+			pgm_free_skb (window->parked);
+			window->parked = NULL;
+		} else
+			pgm_thread_yield();
+	}
+	window->parked = skb;
+	window->parked_index = index_;
+}
+
 /* Try to add a sequence number to the retransmit queue, ignore if
  * already there or no longer in the transmit window.
  *
@@ -461,7 +798,7 @@ pgm_txw_retransmit_push_parity (
 	const uint32_t tg_sqn_mask = 0xffffffff << tg_sqn_shift;
 	const uint32_t nak_tg_sqn  = sequence &  tg_sqn_mask;	/* left unshifted */
 	const uint32_t nak_pkt_cnt = sequence & ~tg_sqn_mask;
-	skb = _pgm_txw_peek (window, nak_tg_sqn);
+	skb = window->is_lockless ? _pgm_txw_peek_get (window, nak_tg_sqn) : _pgm_txw_peek (window, nak_tg_sqn);
 
 	if (NULL == skb) {
 		pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Transmission group lead #%" PRIu32 " not in window."), nak_tg_sqn);
@@ -482,6 +819,8 @@ pgm_txw_retransmit_push_parity (
 			state->pkt_cnt_requested = nak_pkt_cnt;
 		}
 		state->nak_elimination_count++;
+		if (window->is_lockless)
+			pgm_free_skb (skb);
 		return FALSE;
 	}
 	else
@@ -511,7 +850,7 @@ pgm_txw_retransmit_push_selective (
 /* pre-conditions */
 	pgm_assert (NULL != window);
 
-	skb = _pgm_txw_peek (window, sequence);
+	skb = window->is_lockless ? _pgm_txw_peek_get (window, sequence) : _pgm_txw_peek (window, sequence);
 	if (NULL == skb) {
 		pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Requested packet #%" PRIu32 " not in window."), sequence);
 		return FALSE;
@@ -525,6 +864,8 @@ pgm_txw_retransmit_push_selective (
 	if (state->waiting_retransmit) {
 		pgm_assert (!pgm_queue_is_empty (&window->retransmit_queue));
 		state->nak_elimination_count++;
+		if (window->is_lockless)
+			pgm_free_skb (skb);
 		return FALSE;
 	}
 
@@ -555,12 +896,14 @@ pgm_txw_retransmit_try_peek (
 	bool			  is_op_encoded = FALSE;
 	uint16_t		  parity_length = 0;
 	const pgm_gf8_t		**src;
+	struct pgm_sk_buff_t	**odata;
 	void			 *data;
 
 /* pre-conditions */
 	pgm_assert (NULL != window);
 
 	src = pgm_newa (const pgm_gf8_t*, window->rs.k);
+	odata = pgm_newa (struct pgm_sk_buff_t*, window->rs.k);
 
 	pgm_debug ("retransmit_try_peek (window:%p)", (const void*)window);
 
@@ -578,8 +921,18 @@ pgm_txw_retransmit_try_peek (
 		pgm_assert (((const pgm_list_t*)skb)->next == NULL);
 		pgm_assert (((const pgm_list_t*)skb)->prev == NULL);
 	}
-/* packet payload still in transit */
-	if (PGM_UNLIKELY(1 != pgm_atomic_read32 (&skb->users))) {
+/* lockless request for a sequence since evicted by the publisher */
+	if (window->is_lockless &&
+	    pgm_uint32_lt (skb->sequence, pgm_txw_trail_atomic (window)))
+	{
+		pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Retransmit sqn #%" PRIu32 " no longer in window."), skb->sequence);
+		pgm_queue_pop_tail_link (&window->retransmit_queue);
+		state->waiting_retransmit = 0;
+		pgm_free_skb (skb);
+		return NULL;
+	}
+/* packet payload still in transit, a lockless queue holds a second reference */
+	if (PGM_UNLIKELY((window->is_lockless ? 2 : 1) != pgm_atomic_read32 (&skb->users))) {
 		pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Retransmit sqn #%" PRIu32 " is still in transit in transmit thread."), skb->sequence);
 		return NULL;
 	}
@@ -589,12 +942,30 @@ pgm_txw_retransmit_try_peek (
 
 /* generate parity packet to satisify request */	
 	const uint8_t rs_h = state->pkt_cnt_sent % (window->rs.n - window->rs.k);
+	if (NULL != state->parity && rs_h < window->parity_h) {
+		pgm_debug ("parity #%u of transmission group #%" PRIu32 " precomputed.", (unsigned)rs_h, skb->sequence);
+		return state->parity[rs_h];
+	}
 	const uint32_t tg_sqn_mask = 0xffffffff << window->tg_sqn_shift;
 	const uint32_t tg_sqn = skb->sequence & tg_sqn_mask;
 	for (uint_fast8_t i = 0; i < window->rs.k; i++)
 	{
-		const struct pgm_sk_buff_t* odata_skb = pgm_txw_peek (window, tg_sqn + i);
-		const uint16_t odata_tsdu_length = ntohs (odata_skb->pgm_header->pgm_tsdu_length);
+		struct pgm_sk_buff_t* odata_skb = window->is_lockless ? _pgm_txw_peek_get (window, tg_sqn + i) : pgm_txw_peek (window, tg_sqn + i);
+		uint16_t odata_tsdu_length;
+		if (PGM_UNLIKELY(NULL == odata_skb)) {
+			pgm_trace (PGM_LOG_ROLE_TX_WINDOW,_("Transmission group #%" PRIu32 " no longer in window."), tg_sqn);
+			if (window->is_lockless) {
+				while (i--)
+					pgm_free_skb (odata[i]);
+			}
+			pgm_queue_pop_tail_link (&window->retransmit_queue);
+			state->waiting_retransmit = 0;
+			if (window->is_lockless)
+				pgm_free_skb (skb);
+			return NULL;
+		}
+		odata[i] = odata_skb;
+		odata_tsdu_length = ntohs (odata_skb->pgm_header->pgm_tsdu_length);
 		if (!parity_length)
 		{
 			parity_length = odata_tsdu_length;
@@ -632,7 +1003,7 @@ pgm_txw_retransmit_try_peek (
 
 		for (uint_fast8_t i = 0; i < window->rs.k; i++)
 		{
-			struct pgm_sk_buff_t* odata_skb = pgm_txw_peek (window, tg_sqn + i);
+			struct pgm_sk_buff_t* odata_skb = odata[i];
 			const uint16_t odata_tsdu_length = ntohs (odata_skb->pgm_header->pgm_tsdu_length);
 
 			pgm_assert (odata_tsdu_length == odata_skb->len);
@@ -672,7 +1043,7 @@ pgm_txw_retransmit_try_peek (
 
 		for (uint_fast8_t i = 0; i < window->rs.k; i++)
 		{
-			const struct pgm_sk_buff_t* odata_skb = pgm_txw_peek (window, tg_sqn + i);
+			const struct pgm_sk_buff_t* odata_skb = odata[i];
 
 			if (odata_skb->pgm_opt_fragment)
 			{
@@ -725,9 +1096,15 @@ pgm_txw_retransmit_try_peek (
 			data,
 			parity_length);
 
+/* release transmission group */
+	if (window->is_lockless) {
+		for (uint_fast8_t i = 0; i < window->rs.k; i++)
+			pgm_free_skb (odata[i]);
+	}
+
 /* calculate partial checksum */
 	const uint16_t tsdu_length = ntohs (skb->pgm_header->pgm_tsdu_length);
-	state->unfolded_checksum = pgm_csum_partial ((char*)skb->tail - tsdu_length, tsdu_length, 0);
+	pgm_txw_set_unfolded_checksum (skb, pgm_csum_partial ((char*)skb->tail - tsdu_length, tsdu_length, 0));
 	return skb;
 }
 
@@ -767,12 +1144,16 @@ pgm_txw_retransmit_remove_head (
 		if (state->pkt_cnt_sent == state->pkt_cnt_requested) {
 			pgm_queue_pop_tail_link (&window->retransmit_queue);
 			state->waiting_retransmit = 0;
+			if (window->is_lockless)
+				pgm_free_skb (skb);
 		}
 	}
 	else	/* selective request */
 	{
 		pgm_queue_pop_tail_link (&window->retransmit_queue);
 		state->waiting_retransmit = 0;
+		if (window->is_lockless)
+			pgm_free_skb (skb);
 	}
 }
 
@@ -37,6 +37,7 @@
 #define pgm_rs_create			mock_pgm_rs_create
 #define pgm_rs_destroy			mock_pgm_rs_destroy
 #define pgm_rs_encode			mock_pgm_rs_encode
+#define pgm_rs_encode_fold		mock_pgm_rs_encode_fold
 #define pgm_compat_csum_partial		mock_pgm_compat_csum_partial
 #define pgm_histogram_init		mock_pgm_histogram_init
 
@@ -72,6 +73,18 @@ mock_pgm_rs_encode(
 {
 }
 
+void
+mock_pgm_rs_encode_fold (
+	pgm_rs_t*		rs,
+	const pgm_gf8_t*	src,
+	const uint8_t		i,
+	const uint8_t		offset,
+	pgm_gf8_t*		dst,
+	const uint16_t		len
+	)
+{
+}
+
 /** checksum module */
 uint32_t
 mock_pgm_compat_csum_partial (
@@ -635,6 +648,105 @@ START_TEST (test_retransmit_remove_head_fail_002)
 }
 END_TEST
 
+/* lockless window: a queued request survives eviction of its sequence and
+ * is dropped on peek.
+ */
+START_TEST (test_lockless_pass_001)
+{
+	const pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+	pgm_txw_t* window = pgm_txw_create (&tsi, 0, 2, 0, 0, FALSE, 0, 0);
+	fail_if (NULL == window, "create failed");
+	window->is_lockless = TRUE;
+	struct pgm_sk_buff_t* skb = generate_valid_skb ();
+	fail_if (NULL == skb, "generate_valid_skb failed");
+	pgm_txw_add (window, skb);
+	const uint32_t sequence = window->trail;
+	fail_unless (TRUE == pgm_txw_retransmit_push (window, sequence, FALSE, 0), "retransmit_push failed");
+	fail_unless (2 == pgm_atomic_read32 (&skb->users), "queue reference missing");
+/* evict requested sequence */
+	for (unsigned i = 0; i < 2; i++) {
+		struct pgm_sk_buff_t* skb2 = generate_valid_skb ();
+		fail_if (NULL == skb2, "generate_valid_skb failed");
+		pgm_txw_add (window, skb2);
+	}
+	fail_unless (pgm_uint32_gt (window->trail, sequence), "not evicted");
+	fail_unless (1 == pgm_atomic_read32 (&skb->users), "window reference not released");
+	fail_unless (NULL == pgm_txw_retransmit_try_peek (window), "retransmit_try_peek failed");
+	fail_unless (pgm_txw_retransmit_is_empty (window), "stale request not dropped");
+	pgm_txw_shutdown (window);
+}
+END_TEST
+
+/* lockless window: eviction of a pinned index is deferred */
+START_TEST (test_lockless_pass_002)
+{
+	const pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+	pgm_txw_t* window = pgm_txw_create (&tsi, 0, 2, 0, 0, FALSE, 0, 0);
+	fail_if (NULL == window, "create failed");
+	window->is_lockless = TRUE;
+	struct pgm_sk_buff_t* skb = generate_valid_skb ();
+	fail_if (NULL == skb, "generate_valid_skb failed");
+	pgm_txw_add (window, skb);
+	const uint32_t index_ = skb->sequence % pgm_txw_max_length (window);
+	pgm_atomic_write32 (&window->pin, index_ + 1);
+	for (unsigned i = 0; i < 2; i++) {
+		struct pgm_sk_buff_t* skb2 = generate_valid_skb ();
+		fail_if (NULL == skb2, "generate_valid_skb failed");
+		pgm_txw_add (window, skb2);
+	}
+	fail_unless (skb == window->parked, "pinned skb not parked");
+	pgm_atomic_write32 (&window->pin, 0);
+	pgm_txw_shutdown (window);
+}
+END_TEST
+
+/* target:
+ *	void
+ *	pgm_txw_fold_parity (
+ *		pgm_txw_t* const		window,
+ *		const struct pgm_sk_buff_t* const	skb
+ *		)
+ */
+
+/* completed transmission group serves parity without encoding */
+START_TEST (test_fold_parity_pass_001)
+{
+	const pgm_tsi_t tsi = { { 1, 2, 3, 4, 5, 6 }, 1000 };
+	pgm_txw_t* window = pgm_txw_create (&tsi, 0, 100, 0, 0, TRUE, 255, 2);
+	fail_if (NULL == window, "create failed");
+	window->rs.n = 255;
+	window->rs.k = 2;
+	window->parity_h = 1;
+	for (unsigned i = 0; i < 2; i++) {
+		struct pgm_sk_buff_t* skb = generate_valid_skb ();
+		fail_if (NULL == skb, "generate_valid_skb failed");
+		skb->pgm_data->data_sqn = g_htonl (pgm_txw_next_lead (window));
+		pgm_txw_fold_parity (window, skb);
+		pgm_txw_add (window, skb);
+	}
+	struct pgm_sk_buff_t* lead_skb = pgm_txw_peek (window, window->trail);
+	const pgm_txw_state_t* state = (const pgm_txw_state_t*)&lead_skb->cb;
+	fail_if (NULL == state->parity, "parity not attached to lead");
+	fail_unless (TRUE == pgm_txw_retransmit_push (window, window->trail | 1, TRUE, window->tg_sqn_shift), "retransmit_push failed");
+	struct pgm_sk_buff_t* skb = pgm_txw_retransmit_try_peek (window);
+	fail_unless (state->parity[0] == skb, "precomputed parity not served");
+	fail_unless (PGM_OPT_PARITY == skb->pgm_header->pgm_options, "parity option not set");
+	fail_unless (1000 == g_ntohs (skb->pgm_header->pgm_tsdu_length), "parity length mismatch");
+	fail_unless ((sizeof(struct pgm_header) + sizeof(struct pgm_data) + 1000) == (size_t)((char*)skb->tail - (char*)skb->head), "parity packet length mismatch");
+	pgm_txw_shutdown (window);
+}
+END_TEST
+
+/* null window */
+START_TEST (test_fold_parity_fail_001)
+{
+	struct pgm_sk_buff_t* skb = generate_valid_skb ();
+	fail_if (NULL == skb, "generate_valid_skb failed");
+	pgm_txw_fold_parity (NULL, skb);
+	fail ("reached");
+}
+END_TEST
+
 static
 Suite*
 make_test_suite (void)
@@ -758,6 +870,18 @@ make_test_suite (void)
 	tcase_add_test_raise_signal (tc_retransmit_remove_head, test_retransmit_remove_head_fail_002, SIGABRT);
 #endif
 
+	TCase* tc_lockless = tcase_create ("lockless");
+	suite_add_tcase (s, tc_lockless);
+	tcase_add_test (tc_lockless, test_lockless_pass_001);
+	tcase_add_test (tc_lockless, test_lockless_pass_002);
+
+	TCase* tc_fold_parity = tcase_create ("fold-parity");
+	suite_add_tcase (s, tc_fold_parity);
+	tcase_add_test (tc_fold_parity, test_fold_parity_pass_001);
+#ifndef PGM_CHECK_NOFORK
+	tcase_add_test_raise_signal (tc_fold_parity, test_fold_parity_fail_001, SIGABRT);
+#endif
+
 	return s;
 }
 